@@ -446,10 +446,28 @@ godot_tools = [
         "type": "function",
         "function": {
             "name": "get_all_nodes",
-            "description": "Get all nodes in the current scene with their information",
+            "description": "Get the nodes of the current scene, paged. Every result has a scene 'version'; pass it back as 'since_version' to get only the nodes added, removed or modified since then.",
             "parameters": {
                 "type": "object",
-                "properties": {},
+                "properties": {
+                    "since_version": {
+                        "type": "integer",
+                        "description": "Return only changes after this version (from a previous result). If 'resync_required' is set, the full listing is returned instead."
+                    },
+                    "offset": {
+                        "type": "integer",
+                        "description": "Index of the first entry to return (default: 0); use 'next_offset' from the previous page"
+                    },
+                    "limit": {
+                        "type": "integer",
+                        "description": "Maximum number of entries (default: 1000, 0 for no limit)"
+                    },
+                    "fields": {
+                        "type": "array",
+                        "items": {"type": "string", "enum": ["name", "type", "path", "parent", "owner", "child_count", "index", "script", "properties"]},
+                        "description": "Fields to include per node (default: name, type, path, owner, child_count)"
+                    }
+                },
                 "required": []
             }
         }
@@ -748,6 +766,44 @@ godot_tools = [
                         "type": "boolean",
                         "description": "If true, return full paths (recommended for navigation)",
                         "default": True
+                    },
+                    "extensions": {
+                        "type": "array",
+                        "items": {"type": "string"},
+                        "description": "Only files with these extensions (e.g., ['gd', 'tscn'])"
+                    },
+                    "types": {
+                        "type": "array",
+                        "items": {"type": "string"},
+                        "description": "Only resources of these types or their subclasses (e.g., ['PackedScene', 'Texture2D'])"
+                    },
+                    "min_size": {
+                        "type": "integer",
+                        "description": "Minimum file size in bytes"
+                    },
+                    "max_size": {
+                        "type": "integer",
+                        "description": "Maximum file size in bytes"
+                    },
+                    "exclude": {
+                        "type": "array",
+                        "items": {"type": "string"},
+                        "description": "gitignore-style patterns to skip (e.g., ['addons/', '*.import', '!addons/my_plugin/'])"
+                    },
+                    "respect_gitignore": {
+                        "type": "boolean",
+                        "description": "Also skip paths ignored by the project's .gitignore",
+                        "default": True
+                    },
+                    "offset": {
+                        "type": "integer",
+                        "description": "Number of results to skip, for paging (use next_offset from the previous call)",
+                        "default": 0
+                    },
+                    "limit": {
+                        "type": "integer",
+                        "description": "Maximum number of results per page",
+                        "default": 500
                     }
                 },
                 "required": []
@@ -758,7 +814,7 @@ godot_tools = [
         "type": "function",
         "function": {
             "name": "search_project_files",
-            "description": "Search for files and directories matching a pattern across the entire project",
+            "description": "Search the whole project for files by name pattern, extension, resource type or size, optionally only those containing some text (returns matching lines). Results are paged.",
             "parameters": {
                 "type": "object",
                 "properties": {
@@ -774,9 +830,56 @@ godot_tools = [
                         "type": "boolean",
                         "description": "Whether search should be case sensitive",
                         "default": False
+                    },
+                    "content": {
+                        "type": "string",
+                        "description": "Only files containing this text; returns matching lines with line numbers"
+                    },
+                    "max_matches_per_file": {
+                        "type": "integer",
+                        "description": "Maximum matching lines reported per file when searching content",
+                        "default": 5
+                    },
+                    "extensions": {
+                        "type": "array",
+                        "items": {"type": "string"},
+                        "description": "Only files with these extensions (e.g., ['gd', 'tscn'])"
+                    },
+                    "types": {
+                        "type": "array",
+                        "items": {"type": "string"},
+                        "description": "Only resources of these types or their subclasses (e.g., ['PackedScene', 'Texture2D'])"
+                    },
+                    "min_size": {
+                        "type": "integer",
+                        "description": "Minimum file size in bytes"
+                    },
+                    "max_size": {
+                        "type": "integer",
+                        "description": "Maximum file size in bytes"
+                    },
+                    "exclude": {
+                        "type": "array",
+                        "items": {"type": "string"},
+                        "description": "gitignore-style patterns to skip (e.g., ['addons/', '*.import', '!addons/my_plugin/'])"
+                    },
+                    "respect_gitignore": {
+                        "type": "boolean",
+                        "description": "Also skip paths ignored by the project's .gitignore",
+                        "default": True
+                    },
+                    "offset": {
+                        "type": "integer",
+                        "description": "Number of results to skip, for paging (use next_offset from the previous call)",
+                        "default": 0
+                    },
+                    "limit": {
+                        "type": "integer",
+                        "description": "Maximum number of results per page",
+                        "default": 500
                     }
                 },
-                "required": ["pattern"]
+                "required": []
             }
         }
     },
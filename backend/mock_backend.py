@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""Local stand-in for the chat backend that replays recorded NDJSON streams.
+
+Used to measure the editor side of the chat round-trip (stream parsing, tool
+dispatch, markdown rendering, saves) without a model provider in the loop.
+
+A session is a directory of `*.ndjson` files, one per /chat request, replayed
+in name order. The turn served for a request is picked from how many times
+the editor has posted tool results since the last user message, so a recorded
+tool-call turn is followed by its answer once the results come back.
+
+    python mock_backend.py --session ../tests/data/ai_chat/tool_round_trip
+    IS_DEV=true godot --editor --path <project>
+
+Only the standard library is required.
+"""
+
+import argparse
+import json
+import os
+import sys
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+MOCK_USER = {"id": "mock-user", "name": "Mock User", "email": "mock@localhost", "provider": "guest"}
+
+
+def load_session(path):
+    turns = []
+    for name in sorted(os.listdir(path)):
+        if name.endswith(".ndjson"):
+            with open(os.path.join(path, name), "rb") as f:
+                turns.append((name, f.read()))
+    if not turns:
+        raise SystemExit(f"No .ndjson files in {path}")
+    return turns
+
+
+class MockBackendHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    server_version = "MockChatBackend/1.0"
+
+    def log_message(self, format, *args):
+        if not self.server.quiet:
+            super().log_message(format, *args)
+
+    def _read_json(self):
+        length = int(self.headers.get("Content-Length") or 0)
+        if length <= 0:
+            return {}
+        try:
+            return json.loads(self.rfile.read(length))
+        except ValueError:
+            return {}
+
+    def _send_json(self, payload, status=200):
+        body = json.dumps(payload).encode("utf-8")
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def _write_chunk(self, data):
+        self.wfile.write(b"%x\r\n%s\r\n" % (len(data), data))
+        self.wfile.flush()
+
+    def _pick_turn(self, messages):
+        # The editor can add several assistant messages per turn (streamed
+        # text, then the tool calls), so count runs of tool results instead.
+        turn = 0
+        previous_role = None
+        for message in messages:
+            role = message.get("role") if isinstance(message, dict) else None
+            if role == "user":
+                turn = 0
+            elif role == "tool" and previous_role != "tool":
+                turn += 1
+            previous_role = role
+        return self.server.turns[turn % len(self.server.turns)]
+
+    def _stream_turn(self, data):
+        messages = data.get("messages") or []
+        name, stream = self._pick_turn(messages)
+        if not self.server.quiet:
+            print(f"Replaying {name} ({len(stream)} bytes) for {len(messages)} messages", file=sys.stderr)
+
+        self.send_response(200)
+        self.send_header("Content-Type", "application/x-ndjson")
+        self.send_header("Transfer-Encoding", "chunked")
+        self.end_headers()
+
+        # Fixed-size chunks, so line boundaries fall inside chunks like they do
+        # over a real connection.
+        chunk_size = self.server.chunk_size
+        delay = self.server.delay_ms / 1000.0
+        try:
+            for offset in range(0, len(stream), chunk_size):
+                self._write_chunk(stream[offset : offset + chunk_size])
+                if delay > 0:
+                    time.sleep(delay)
+            self.wfile.write(b"0\r\n\r\n")
+            self.wfile.flush()
+        except (BrokenPipeError, ConnectionResetError):
+            # The editor stopped the request.
+            self.close_connection = True
+
+    def do_GET(self):
+        if self.path.startswith("/health"):
+            self._send_json({"status": "ok", "mock": True})
+        elif self.path.startswith("/auth/providers"):
+            self._send_json({"success": True, "providers": ["guest"]})
+        else:
+            self._send_json({"error": "not found"}, 404)
+
+    def do_POST(self):
+        data = self._read_json()
+        if self.path.startswith("/chat"):
+            self._stream_turn(data)
+        elif self.path.startswith("/stop"):
+            self._send_json({"success": True})
+        elif self.path.startswith("/auth/status") or self.path.startswith("/auth/guest"):
+            self._send_json({"success": True, "user": MOCK_USER, "token": "mock-token"})
+        elif self.path.startswith("/auth/logout"):
+            self._send_json({"success": True})
+        elif self.path.startswith("/embed") or self.path.startswith("/search_project"):
+            self._send_json({"success": True, "results": []})
+        else:
+            self._send_json({"error": "not found"}, 404)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--session", required=True, help="directory of recorded .ndjson streams")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8000, help="the editor's dev endpoint is port 8000")
+    parser.add_argument("--chunk-size", type=int, default=256, help="bytes per HTTP chunk")
+    parser.add_argument("--delay-ms", type=float, default=2.0, help="pause between chunks")
+    parser.add_argument("--quiet", action="store_true")
+    args = parser.parse_args()
+
+    server = ThreadingHTTPServer((args.host, args.port), MockBackendHandler)
+    server.turns = load_session(args.session)
+    server.chunk_size = max(1, args.chunk_size)
+    server.delay_ms = max(0.0, args.delay_ms)
+    server.quiet = args.quiet
+    print(f"Mock backend on http://{args.host}:{args.port} replaying {len(server.turns)} turns from {args.session}")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
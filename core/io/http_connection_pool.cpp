@@ -0,0 +1,675 @@
+/**************************************************************************/
+/*  http_connection_pool.cpp                                              */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+
+#include "http_connection_pool.h"
+
+#include "core/io/stream_peer_tcp.h"
+#include "core/io/stream_peer_tls.h"
+#include "core/os/os.h"
+
+HTTPConnectionPool *HTTPConnectionPool::singleton = nullptr;
+
+// Upper bound for sleeping on one connection's socket, so other connections
+// and newly queued requests are still looked at regularly.
+static constexpr int WAIT_FOR_ACTIVITY_MSEC = 10;
+
+void HTTPConnectionPool::_thread_func(void *p_user) {
+	HTTPConnectionPool *pool = (HTTPConnectionPool *)p_user;
+	while (!pool->exit_thread.is_set()) {
+		bool progress = false;
+		if (!pool->_poll(progress)) {
+			pool->work_semaphore.wait();
+		} else if (!progress) {
+			pool->_wait_for_activity();
+		}
+	}
+}
+
+HTTPConnectionPool::RequestID HTTPConnectionPool::_queue_request(const Request &p_request, Semaphore *p_done) {
+	String scheme;
+	String host;
+	String path;
+	String fragment;
+	int port = 0;
+	Error err = p_request.url.parse_url(scheme, host, port, path, fragment);
+	ERR_FAIL_COND_V_MSG(err != OK, INVALID_REQUEST_ID, vformat("Error parsing URL: '%s'.", p_request.url));
+
+	bool tls = false;
+	if (scheme == "https://") {
+		tls = true;
+	} else if (scheme != "http://") {
+		ERR_FAIL_V_MSG(INVALID_REQUEST_ID, vformat("Invalid URL scheme: '%s'.", scheme));
+	}
+	if (port == 0) {
+		port = tls ? 443 : 80;
+	}
+	if (path.is_empty()) {
+		path = "/";
+	}
+
+	Task *task = memnew(Task);
+	task->request = p_request;
+	task->host_key = scheme + host + ":" + itos(port);
+	task->path = path;
+	task->done = p_done;
+	if (p_done) {
+		task->request.on_chunk = Callable();
+		task->request.on_completed = Callable();
+	}
+
+	MutexLock lock(mutex);
+	task->last_activity = OS::get_singleton()->get_ticks_usec();
+
+	Host *entry = hosts.getptr(task->host_key);
+	if (!entry) {
+		Host new_host;
+		new_host.host = host;
+		new_host.port = port;
+		new_host.tls = tls;
+		entry = &hosts.insert(task->host_key, new_host)->value;
+	}
+
+	const RequestID id = ++last_request_id;
+	tasks.insert(id, task);
+	entry->queue.push_back(id);
+
+#ifdef THREADS_ENABLED
+	if (!thread.is_started()) {
+		thread.start(_thread_func, this);
+	}
+#endif
+	work_semaphore.post();
+	return id;
+}
+
+HTTPConnectionPool::Connection *HTTPConnectionPool::_acquire_connection(Host &p_host, uint64_t p_now) {
+	int open_connections = 0;
+	for (Connection *connection : p_host.connections) {
+		if (connection->client.is_null()) {
+			continue;
+		}
+		if (connection->task) {
+			open_connections++;
+			continue;
+		}
+		// Idle connections may have been closed by the server in the meantime.
+		if (p_now - connection->idle_since < keep_alive_timeout_usec.get()) {
+			connection->client->poll();
+			if (connection->client->get_status() == HTTPClient::STATUS_CONNECTED) {
+				connection->reused = true;
+				return connection;
+			}
+		}
+		_release_connection(connection, false, p_now);
+	}
+
+	if (open_connections >= max_connections_per_host.get()) {
+		return nullptr;
+	}
+
+	Connection *connection = memnew(Connection);
+	connection->client = Ref<HTTPClient>(HTTPClient::create());
+	// A failed connection attempt leaves the client disconnected, which fails
+	// the request when it's polled.
+	connection->client->connect_to_host(p_host.host, p_host.port, p_host.tls ? TLSOptions::client() : Ref<TLSOptions>());
+	connection->idle_since = p_now;
+	p_host.connections.push_back(connection);
+	return connection;
+}
+
+void HTTPConnectionPool::_release_connection(Connection *p_connection, bool p_reusable, uint64_t p_now) {
+	p_connection->request = INVALID_REQUEST_ID;
+	p_connection->task = nullptr;
+	p_connection->request_sent = false;
+	if (p_reusable && !p_connection->close_after_response && p_connection->client->get_status() == HTTPClient::STATUS_CONNECTED) {
+		p_connection->idle_since = p_now;
+		return;
+	}
+	// Closed connections are removed from their host after polling.
+	p_connection->client->close();
+	p_connection->client.unref();
+}
+
+void HTTPConnectionPool::_drop_idle_connections(Host &p_host) {
+	for (Connection *connection : p_host.connections) {
+		if (connection->client.is_valid() && !connection->task) {
+			_release_connection(connection, false, 0);
+		}
+	}
+}
+
+void HTTPConnectionPool::_remove_closed_connections(Host &p_host) {
+	for (int i = int(p_host.connections.size()) - 1; i >= 0; i--) {
+		if (p_host.connections[i]->client.is_null()) {
+			memdelete(p_host.connections[i]);
+			p_host.connections.remove_at_unordered(i);
+		}
+	}
+}
+
+void HTTPConnectionPool::_read_response_headers(Connection *p_connection, Task *p_task) {
+	HTTPClient *client = p_connection->client.ptr();
+	p_task->has_response = true;
+	p_task->response.code = client->get_response_code();
+	p_task->read_until_close = !client->is_response_chunked() && client->get_response_body_length() < 0;
+
+	List<String> headers;
+	client->get_response_headers(&headers);
+	for (const String &header : headers) {
+		p_task->response.headers.push_back(header);
+		if (header.to_lower().begins_with("connection: close")) {
+			p_connection->close_after_response = true;
+		}
+	}
+}
+
+void HTTPConnectionPool::_finish_task_locked(RequestID p_id, Task *p_task, Result p_result) {
+	p_task->response.result = p_result;
+	p_task->connection = nullptr;
+	p_task->finished = true;
+
+	if (p_task->cancelled) {
+		// Already removed from `tasks` by cancel().
+		memdelete(p_task);
+		return;
+	}
+
+	if (p_task->done) {
+		p_task->done->post();
+		return;
+	}
+
+	if (p_task->request.on_completed.is_valid() || p_task->request.on_chunk.is_valid()) {
+		// The task stays around until the event is dispatched, so it can still
+		// be cancelled.
+		Event event;
+		event.request = p_id;
+		event.completed = true;
+		event.response = p_task->response;
+		events.push_back(event);
+		return;
+	}
+
+	tasks.erase(p_id);
+	memdelete(p_task);
+}
+
+void HTTPConnectionPool::_expire_queued_tasks_locked(Host &p_host, uint64_t p_now) {
+	// Waiting for a free connection counts as no progress.
+	for (List<RequestID>::Element *E = p_host.queue.front(); E;) {
+		List<RequestID>::Element *next = E->next();
+		Task *task = tasks[E->get()];
+		if (task->request.timeout > 0.0 && p_now - task->last_activity > uint64_t(task->request.timeout * 1000000.0)) {
+			const RequestID id = E->get();
+			p_host.queue.erase(E);
+			_finish_task_locked(id, task, RESULT_TIMEOUT);
+		}
+		E = next;
+	}
+}
+
+void HTTPConnectionPool::_complete_task(Connection *p_connection, bool p_reusable, Result p_result, uint64_t p_now) {
+	const RequestID id = p_connection->request;
+	Task *task = p_connection->task;
+	_release_connection(p_connection, p_reusable, p_now);
+
+	MutexLock lock(mutex);
+	_finish_task_locked(id, task, p_result);
+}
+
+void HTTPConnectionPool::_retry_task(Host &p_host, Connection *p_connection, uint64_t p_now) {
+	const RequestID id = p_connection->request;
+	Task *task = p_connection->task;
+	_release_connection(p_connection, false, p_now);
+	// The other idle connections to this host were most likely closed too.
+	_drop_idle_connections(p_host);
+
+	MutexLock lock(mutex);
+	task->connection = nullptr;
+	if (task->cancelled) {
+		memdelete(task);
+		return;
+	}
+	task->retried = true;
+	task->last_activity = p_now;
+	p_host.queue.push_front(id);
+}
+
+bool HTTPConnectionPool::_poll_connection(Host &p_host, Connection *p_connection, uint64_t p_now) {
+	const RequestID id = p_connection->request;
+	Task *task = p_connection->task;
+	bool cancelled = false;
+	{
+		MutexLock lock(mutex);
+		cancelled = task->cancelled;
+	}
+	if (cancelled) {
+		// The rest of the response would have to be drained before the
+		// connection could be reused.
+		_release_connection(p_connection, false, p_now);
+		memdelete(task);
+		return true;
+	}
+
+	HTTPClient *client = p_connection->client.ptr();
+	const HTTPClient::Status previous_status = client->get_status();
+	client->poll();
+	const HTTPClient::Status status = client->get_status();
+	bool progress = status != previous_status;
+	switch (status) {
+		case HTTPClient::STATUS_RESOLVING:
+		case HTTPClient::STATUS_CONNECTING:
+		case HTTPClient::STATUS_REQUESTING: {
+		} break;
+		case HTTPClient::STATUS_CONNECTED: {
+			if (!p_connection->request_sent) {
+				const Request &request = task->request;
+				client->set_read_chunk_size(request.read_chunk_size);
+				p_connection->close_after_response = false;
+				Error err = client->request(request.method, task->path, request.headers, request.body.ptr(), request.body.size());
+				if (err != OK) {
+					_complete_task(p_connection, false, RESULT_REQUEST_FAILED, p_now);
+					return true;
+				}
+				p_connection->request_sent = true;
+				task->last_activity = p_now;
+				return true;
+			}
+
+			// The response had no body.
+			if (!client->has_response()) {
+				_complete_task(p_connection, false, RESULT_NO_RESPONSE, p_now);
+				return true;
+			}
+			if (!task->has_response) {
+				_read_response_headers(p_connection, task);
+			}
+			_complete_task(p_connection, true, RESULT_SUCCESS, p_now);
+			return true;
+		}
+		case HTTPClient::STATUS_BODY: {
+			if (!task->has_response) {
+				_read_response_headers(p_connection, task);
+			}
+
+			PackedByteArray chunk = client->read_response_body_chunk();
+			if (!chunk.is_empty()) {
+				task->last_activity = p_now;
+				progress = true;
+				if (task->request.on_chunk.is_valid()) {
+					Event event;
+					event.request = id;
+					event.response.body = chunk;
+					MutexLock lock(mutex);
+					events.push_back(event);
+				} else {
+					task->response.body.append_array(chunk);
+				}
+			}
+
+			const HTTPClient::Status body_status = client->get_status();
+			if (body_status == HTTPClient::STATUS_CONNECTED) {
+				_complete_task(p_connection, true, RESULT_SUCCESS, p_now);
+				return true;
+			}
+			if (body_status == HTTPClient::STATUS_DISCONNECTED) {
+				_complete_task(p_connection, false, task->read_until_close ? RESULT_SUCCESS : RESULT_CONNECTION_ERROR, p_now);
+				return true;
+			}
+			// Errors are handled on the next poll.
+		} break;
+		case HTTPClient::STATUS_DISCONNECTED:
+		case HTTPClient::STATUS_CANT_RESOLVE:
+		case HTTPClient::STATUS_CANT_CONNECT:
+		case HTTPClient::STATUS_CONNECTION_ERROR:
+		case HTTPClient::STATUS_TLS_HANDSHAKE_ERROR: {
+			if (p_connection->reused && !task->has_response && !task->retried) {
+				_retry_task(p_host, p_connection, p_now);
+				return true;
+			}
+
+			Result result = RESULT_CONNECTION_ERROR;
+			if (status == HTTPClient::STATUS_CANT_RESOLVE) {
+				result = RESULT_CANT_RESOLVE;
+			} else if (status == HTTPClient::STATUS_TLS_HANDSHAKE_ERROR) {
+				result = RESULT_TLS_HANDSHAKE_ERROR;
+			} else if (status == HTTPClient::STATUS_CANT_CONNECT || !p_connection->request_sent) {
+				result = RESULT_CANT_CONNECT;
+			} else if (status == HTTPClient::STATUS_DISCONNECTED && task->has_response && task->read_until_close) {
+				result = RESULT_SUCCESS;
+			}
+			_complete_task(p_connection, false, result, p_now);
+			return true;
+		}
+	}
+
+	if (task->request.timeout > 0.0 && p_now - task->last_activity > uint64_t(task->request.timeout * 1000000.0)) {
+		_complete_task(p_connection, false, RESULT_TIMEOUT, p_now);
+		return true;
+	}
+	return progress;
+}
+
+void HTTPConnectionPool::_wait_for_activity() {
+	Ref<StreamPeerTCP> stream;
+	NetSocket::PollType poll_type = NetSocket::POLL_TYPE_IN;
+	{
+		MutexLock poll_lock(poll_mutex);
+		MutexLock lock(mutex);
+		for (const KeyValue<String, Host> &E : hosts) {
+			for (const Connection *connection : E.value.connections) {
+				if (!connection->task || connection->client.is_null()) {
+					continue;
+				}
+				const HTTPClient::Status status = connection->client->get_status();
+				if (status != HTTPClient::STATUS_CONNECTING && status != HTTPClient::STATUS_REQUESTING && status != HTTPClient::STATUS_BODY) {
+					continue;
+				}
+				// TLS connections are waited on through their TCP stream.
+				Ref<StreamPeer> peer = connection->client->get_connection();
+				Ref<StreamPeerTLS> tls = peer;
+				stream = tls.is_valid() ? tls->get_stream() : peer;
+				if (stream.is_valid() && stream->get_status() != StreamPeerTCP::STATUS_NONE) {
+					poll_type = status == HTTPClient::STATUS_CONNECTING ? NetSocket::POLL_TYPE_OUT : NetSocket::POLL_TYPE_IN;
+					break;
+				}
+				stream.unref();
+			}
+			if (stream.is_valid()) {
+				break;
+			}
+		}
+	}
+
+	if (stream.is_null() || stream->wait(poll_type, WAIT_FOR_ACTIVITY_MSEC) != OK) {
+		// Still resolving, or nothing to wait on.
+		OS::get_singleton()->delay_usec(1000);
+	}
+}
+
+void HTTPConnectionPool::_dispatch_events() {
+	LocalVector<Event> pending;
+	{
+		MutexLock lock(mutex);
+		pending = events;
+		events.clear();
+		dispatch_queued = false;
+	}
+
+	for (const Event &event : pending) {
+		Callable callback;
+		{
+			MutexLock lock(mutex);
+			Task **task_ptr = tasks.getptr(event.request);
+			if (!task_ptr) {
+				// Cancelled.
+				continue;
+			}
+			Task *task = *task_ptr;
+			if (event.completed) {
+				callback = task->request.on_completed;
+				tasks.erase(event.request);
+				memdelete(task);
+			} else {
+				callback = task->request.on_chunk;
+			}
+		}
+
+		if (!callback.is_valid()) {
+			continue;
+		}
+		if (event.completed) {
+			callback.call(int(event.response.result), event.response.code, event.response.headers, event.response.body);
+		} else {
+			callback.call(event.response.body);
+		}
+	}
+}
+
+HTTPConnectionPool::RequestID HTTPConnectionPool::request(const Request &p_request) {
+	return _queue_request(p_request, nullptr);
+}
+
+HTTPConnectionPool::RequestID HTTPConnectionPool::request(const String &p_url, HTTPClient::Method p_method, const Vector<String> &p_headers, const String &p_body, const Callable &p_on_completed) {
+	Request request;
+	request.url = p_url;
+	request.method = p_method;
+	request.headers = p_headers;
+	request.body = p_body.to_utf8_buffer();
+	request.on_completed = p_on_completed;
+	return _queue_request(request, nullptr);
+}
+
+Error HTTPConnectionPool::request_blocking(const Request &p_request, Response &r_response) {
+#ifdef THREADS_ENABLED
+	ERR_FAIL_COND_V_MSG(thread.is_started() && Thread::get_caller_id() == thread.get_id(), ERR_UNAVAILABLE, "Can't wait for a request on the connection pool's thread.");
+#endif
+
+	Semaphore done;
+	const RequestID id = _queue_request(p_request, &done);
+	if (id == INVALID_REQUEST_ID) {
+		r_response = Response();
+		return ERR_INVALID_PARAMETER;
+	}
+
+#ifdef THREADS_ENABLED
+	done.wait();
+#else
+	// Nothing else polls the connections.
+	bool finished = false;
+	while (!finished) {
+		poll();
+		{
+			MutexLock lock(mutex);
+			finished = tasks[id]->finished;
+		}
+		if (!finished) {
+			OS::get_singleton()->delay_usec(1000);
+		}
+	}
+#endif
+
+	MutexLock lock(mutex);
+	Task *task = tasks[id];
+	r_response = task->response;
+	tasks.erase(id);
+	memdelete(task);
+	return r_response.result == RESULT_SUCCESS ? OK : FAILED;
+}
+
+void HTTPConnectionPool::cancel(RequestID p_id) {
+	MutexLock lock(mutex);
+	Task **task_ptr = tasks.getptr(p_id);
+	if (!task_ptr) {
+		return;
+	}
+	Task *task = *task_ptr;
+	ERR_FAIL_COND_MSG(task->done != nullptr, "Blocking requests can't be cancelled.");
+	tasks.erase(p_id);
+
+	if (task->connection) {
+		// In flight: the poller closes the connection and deletes the task.
+		task->cancelled = true;
+		work_semaphore.post();
+		return;
+	}
+	if (!task->finished) {
+		Host *host = hosts.getptr(task->host_key);
+		if (host) {
+			host->queue.erase(p_id);
+		}
+	}
+	memdelete(task);
+}
+
+bool HTTPConnectionPool::is_request_pending(RequestID p_id) const {
+	MutexLock lock(mutex);
+	return tasks.has(p_id);
+}
+
+bool HTTPConnectionPool::_poll(bool &r_progress) {
+	MutexLock poll_lock(poll_mutex);
+	const uint64_t now = OS::get_singleton()->get_ticks_usec();
+	r_progress = false;
+
+	// Hosts are never removed, so they stay valid while the mutex is released.
+	LocalVector<Host *> host_list;
+	{
+		MutexLock lock(mutex);
+		for (KeyValue<String, Host> &E : hosts) {
+			_expire_queued_tasks_locked(E.value, now);
+			host_list.push_back(&E.value);
+		}
+	}
+
+	bool active = false;
+	for (Host *host : host_list) {
+		// Hand queued requests to idle or new connections.
+		while (true) {
+			{
+				MutexLock lock(mutex);
+				if (host->queue.is_empty()) {
+					break;
+				}
+			}
+			Connection *connection = _acquire_connection(*host, now);
+			if (!connection) {
+				break;
+			}
+
+			MutexLock lock(mutex);
+			if (host->queue.is_empty()) {
+				// Cancelled meanwhile; the connection stays idle.
+				break;
+			}
+			const RequestID id = host->queue.front()->get();
+			host->queue.pop_front();
+			Task *task = tasks[id];
+			task->connection = connection;
+			task->last_activity = now;
+			connection->request = id;
+			connection->task = task;
+			r_progress = true;
+		}
+
+		for (Connection *connection : host->connections) {
+			if (connection->task && _poll_connection(*host, connection, now)) {
+				r_progress = true;
+			}
+		}
+		_remove_closed_connections(*host);
+
+		for (const Connection *connection : host->connections) {
+			if (connection->task) {
+				active = true;
+			}
+		}
+	}
+
+	bool queue_dispatch = false;
+	{
+		MutexLock lock(mutex);
+		for (Host *host : host_list) {
+			if (!host->queue.is_empty()) {
+				active = true;
+			}
+		}
+		if (!events.is_empty() && !dispatch_queued) {
+			dispatch_queued = true;
+			queue_dispatch = true;
+		}
+	}
+
+	if (queue_dispatch) {
+		callable_mp(this, &HTTPConnectionPool::_dispatch_events).call_deferred();
+	}
+	return active;
+}
+
+bool HTTPConnectionPool::poll() {
+	bool progress = false;
+	return _poll(progress);
+}
+
+void HTTPConnectionPool::close_idle_connections() {
+	MutexLock poll_lock(poll_mutex);
+	for (KeyValue<String, Host> &E : hosts) {
+		_drop_idle_connections(E.value);
+		_remove_closed_connections(E.value);
+	}
+}
+
+void HTTPConnectionPool::set_max_connections_per_host(int p_max) {
+	ERR_FAIL_COND(p_max < 1);
+	max_connections_per_host.set(p_max);
+}
+
+int HTTPConnectionPool::get_max_connections_per_host() const {
+	return max_connections_per_host.get();
+}
+
+void HTTPConnectionPool::set_keep_alive_timeout(double p_seconds) {
+	ERR_FAIL_COND(p_seconds < 0.0);
+	keep_alive_timeout_usec.set(uint64_t(p_seconds * 1000000.0));
+}
+
+double HTTPConnectionPool::get_keep_alive_timeout() const {
+	return keep_alive_timeout_usec.get() / 1000000.0;
+}
+
+HTTPConnectionPool::HTTPConnectionPool() {
+	singleton = this;
+}
+
+HTTPConnectionPool::~HTTPConnectionPool() {
+	if (thread.is_started()) {
+		exit_thread.set();
+		work_semaphore.post();
+		thread.wait_to_finish();
+	}
+
+	for (KeyValue<String, Host> &E : hosts) {
+		for (Connection *connection : E.value.connections) {
+			if (connection->client.is_valid()) {
+				connection->client->close();
+			}
+			if (connection->task && connection->task->cancelled) {
+				// No longer listed in `tasks`.
+				memdelete(connection->task);
+			}
+			memdelete(connection);
+		}
+	}
+	for (KeyValue<RequestID, Task *> &E : tasks) {
+		memdelete(E.value);
+	}
+	singleton = nullptr;
+}
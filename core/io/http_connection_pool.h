@@ -0,0 +1,230 @@
+/**************************************************************************/
+/*  http_connection_pool.h                                                */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+
+#pragma once
+
+#include "core/io/http_client.h"
+#include "core/object/object.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/list.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/safe_refcount.h"
+
+// Shared pool of keep-alive HTTP connections.
+//
+// Requests are queued per host (scheme, host and port) and sent over up to
+// `max_connections_per_host` persistent `HTTPClient` connections. A connection
+// that finishes a response is handed the next queued request for its host
+// without a new TCP or TLS handshake. A request that fails on a reused
+// connection before any response arrives (the server closed it while idle) is
+// retried once on a fresh connection.
+//
+// Connections are polled on a dedicated thread, which sleeps on a socket of a
+// request in flight while no data arrives. Body chunks and completion are
+// delivered to the request's callables on the main thread, in order. Without
+// thread support, `poll()` has to be called regularly instead.
+//
+// Connections are only touched by the thread that polls, which holds
+// `poll_mutex`; `mutex` guards the queues and requests and is never held
+// across network I/O, so queueing or cancelling a request never waits on it.
+class HTTPConnectionPool : public Object {
+	GDCLASS(HTTPConnectionPool, Object);
+
+public:
+	typedef int64_t RequestID;
+
+	enum {
+		INVALID_REQUEST_ID = -1
+	};
+
+	enum Result {
+		RESULT_SUCCESS,
+		RESULT_CANT_CONNECT,
+		RESULT_CANT_RESOLVE,
+		RESULT_CONNECTION_ERROR,
+		RESULT_TLS_HANDSHAKE_ERROR,
+		RESULT_NO_RESPONSE,
+		RESULT_REQUEST_FAILED,
+		RESULT_TIMEOUT,
+	};
+
+	struct Request {
+		String url;
+		HTTPClient::Method method = HTTPClient::METHOD_GET;
+		Vector<String> headers;
+		Vector<uint8_t> body;
+		// Seconds without any progress before the request fails with
+		// RESULT_TIMEOUT. Zero disables the timeout.
+		double timeout = 0.0;
+		int read_chunk_size = 65536;
+		// Receives each body chunk as it arrives: `(chunk: PackedByteArray)`.
+		// When set, the body is not accumulated for `on_completed`.
+		Callable on_chunk;
+		// Receives `(result: int, response_code: int, headers: PackedStringArray,
+		// body: PackedByteArray)`, like HTTPRequest's `request_completed` signal.
+		Callable on_completed;
+	};
+
+	struct Response {
+		Result result = RESULT_REQUEST_FAILED;
+		int code = 0;
+		PackedStringArray headers;
+		PackedByteArray body;
+	};
+
+private:
+	static HTTPConnectionPool *singleton;
+
+	struct Task;
+
+	struct Connection {
+		Ref<HTTPClient> client;
+		RequestID request = INVALID_REQUEST_ID;
+		Task *task = nullptr;
+		bool request_sent = false;
+		bool reused = false;
+		// The server answered with `Connection: close`.
+		bool close_after_response = false;
+		uint64_t idle_since = 0;
+	};
+
+	struct Host {
+		String host;
+		int port = -1;
+		bool tls = false;
+		// Owned by the poller.
+		LocalVector<Connection *> connections;
+		// Guarded by `mutex`.
+		List<RequestID> queue;
+	};
+
+	struct Task {
+		Request request;
+		String host_key;
+		String path;
+		Connection *connection = nullptr;
+		bool has_response = false;
+		// The response has no length and ends when the server disconnects.
+		bool read_until_close = false;
+		bool retried = false;
+		bool finished = false;
+		// Cancelled while in flight; the poller closes its connection and
+		// deletes it.
+		bool cancelled = false;
+		uint64_t last_activity = 0;
+		Response response;
+		// Set for blocking requests, which are collected by their caller.
+		Semaphore *done = nullptr;
+	};
+
+	struct Event {
+		RequestID request = INVALID_REQUEST_ID;
+		bool completed = false;
+		// Holds the chunk for body events.
+		Response response;
+	};
+
+	mutable Mutex mutex;
+	BinaryMutex poll_mutex;
+	HashMap<String, Host> hosts;
+	HashMap<RequestID, Task *> tasks;
+	RequestID last_request_id = 0;
+	LocalVector<Event> events;
+	bool dispatch_queued = false;
+
+	SafeNumeric<int> max_connections_per_host{ 4 };
+	SafeNumeric<uint64_t> keep_alive_timeout_usec{ 30000000 };
+
+	Thread thread;
+	Semaphore work_semaphore;
+	SafeFlag exit_thread;
+
+	static void _thread_func(void *p_user);
+
+	RequestID _queue_request(const Request &p_request, Semaphore *p_done);
+
+	// These do network I/O; they expect `poll_mutex` to be held and take
+	// `mutex` only to publish results.
+	Connection *_acquire_connection(Host &p_host, uint64_t p_now);
+	void _release_connection(Connection *p_connection, bool p_reusable, uint64_t p_now);
+	void _drop_idle_connections(Host &p_host);
+	void _remove_closed_connections(Host &p_host);
+	bool _poll_connection(Host &p_host, Connection *p_connection, uint64_t p_now);
+	void _read_response_headers(Connection *p_connection, Task *p_task);
+	void _complete_task(Connection *p_connection, bool p_reusable, Result p_result, uint64_t p_now);
+	void _retry_task(Host &p_host, Connection *p_connection, uint64_t p_now);
+	bool _poll(bool &r_progress);
+	void _wait_for_activity();
+
+	// These expect `mutex` to be held.
+	void _finish_task_locked(RequestID p_id, Task *p_task, Result p_result);
+	void _expire_queued_tasks_locked(Host &p_host, uint64_t p_now);
+
+	void _dispatch_events();
+
+protected:
+	static void _bind_methods() {}
+
+public:
+	static HTTPConnectionPool *get_singleton() { return singleton; }
+
+	// Queues an asynchronous request. Returns INVALID_REQUEST_ID if the URL
+	// can't be parsed.
+	RequestID request(const Request &p_request);
+	RequestID request(const String &p_url, HTTPClient::Method p_method, const Vector<String> &p_headers, const String &p_body, const Callable &p_on_completed);
+
+	// Sends a request and waits for the whole response. Callables in
+	// `p_request` are ignored. Safe to call from any thread but the pool's.
+	Error request_blocking(const Request &p_request, Response &r_response);
+
+	// Stops a request. Its connection is closed if it was in flight. When
+	// called on the main thread, no callable of the request runs afterwards.
+	// Blocking requests can't be cancelled.
+	void cancel(RequestID p_id);
+	// True until the request's `on_completed` has been called.
+	bool is_request_pending(RequestID p_id) const;
+
+	// Polls every connection once. Returns true while requests are in flight.
+	bool poll();
+	// Closes the connections that are not serving a request.
+	void close_idle_connections();
+
+	void set_max_connections_per_host(int p_max);
+	int get_max_connections_per_host() const;
+	void set_keep_alive_timeout(double p_seconds);
+	double get_keep_alive_timeout() const;
+
+	HTTPConnectionPool();
+	~HTTPConnectionPool();
+};
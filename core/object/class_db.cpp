@@ -62,8 +62,10 @@ ClassDB::APIType ClassDB::get_current_api() {
 }
 
 HashMap<StringName, ClassDB::ClassInfo> ClassDB::classes;
+SafeNumeric<uint64_t> ClassDB::class_list_version;
 HashMap<StringName, StringName> ClassDB::resource_base_extensions;
 HashMap<StringName, StringName> ClassDB::compat_classes;
+LocalVector<ClassDB::ClassInfo *> ClassDB::flat_lookup_classes;
 
 #ifdef TOOLS_ENABLED
 HashMap<StringName, ObjectGDExtension> ClassDB::placeholder_extensions;
@@ -848,6 +850,7 @@ void ClassDB::_add_class(const StringName &p_class, const StringName &p_inherits
 	ERR_FAIL_COND_MSG(classes.has(name), vformat("Class '%s' already exists.", String(p_class)));
 
 	classes[name] = ClassInfo();
+	class_list_version.increment();
 	ClassInfo &ti = classes[name];
 	ti.name = name;
 	ti.inherits = p_inherits;
@@ -1039,11 +1042,91 @@ bool ClassDB::get_method_info(const StringName &p_class, const StringName &p_met
 	return false;
 }
 
-MethodBind *ClassDB::get_method(const StringName &p_class, const StringName &p_name) {
-	Locker::Lock lock(Locker::STATE_READ);
+const ClassDB::FlatLookup *ClassDB::_get_flat_lookup(ClassInfo *p_type) {
+	FlatLookup *lookup = p_type->flat_lookup.table.load(std::memory_order_acquire);
+	if (likely(lookup)) {
+		return lookup;
+	}
 
-	ClassInfo *type = classes.getptr(p_class);
+	MutexLock lock(flat_lookup_mutex);
+	lookup = p_type->flat_lookup.table.load(std::memory_order_relaxed);
+	if (lookup) {
+		return lookup;
+	}
+
+	uint32_t capacity = 0;
+	for (ClassInfo *check = p_type; check; check = check->inherits_ptr) {
+		capacity += check->method_map.size() + check->property_setget.size() + check->constant_map.size() + check->signal_map.size();
+	}
+
+	lookup = memnew(FlatLookup);
+	lookup->reserve(capacity);
+
+	// Walk from the class up, so the most derived definition of a name wins. Within
+	// a class, get_property() prefers properties, then constants, methods and signals.
+	for (ClassInfo *check = p_type; check; check = check->inherits_ptr) {
+		for (const KeyValue<StringName, PropertySetGet> &E : check->property_setget) {
+			FlatMember &member = (*lookup)[E.key];
+			if (!member.setget) {
+				member.setget = &E.value;
+			}
+			if (member.get_kind == FlatMember::GET_NONE) {
+				member.get_kind = FlatMember::GET_SETGET;
+			}
+		}
+		for (const KeyValue<StringName, int64_t> &E : check->constant_map) {
+			FlatMember &member = (*lookup)[E.key];
+			if (member.get_kind == FlatMember::GET_NONE) {
+				member.get_kind = FlatMember::GET_CONSTANT;
+				member.constant = E.value;
+			}
+		}
+		for (const KeyValue<StringName, MethodBind *> &E : check->method_map) {
+			FlatMember &member = (*lookup)[E.key];
+			if (!member.method) {
+				member.method = E.value;
+			}
+			if (member.get_kind == FlatMember::GET_NONE) {
+				member.get_kind = FlatMember::GET_METHOD;
+			}
+		}
+		for (const KeyValue<StringName, MethodInfo> &E : check->signal_map) {
+			FlatMember &member = (*lookup)[E.key];
+			if (member.get_kind == FlatMember::GET_NONE) {
+				member.get_kind = FlatMember::GET_SIGNAL;
+			}
+		}
+	}
+
+	p_type->flat_lookup.table.store(lookup, std::memory_order_release);
+	flat_lookup_classes.push_back(p_type);
+	return lookup;
+}
+
+void ClassDB::_invalidate_flat_lookups(ClassInfo *p_type) {
+	MutexLock lock(flat_lookup_mutex);
+
+	for (uint32_t i = 0; i < flat_lookup_classes.size();) {
+		ClassInfo *type = flat_lookup_classes[i];
+		bool inherits = false;
+		for (ClassInfo *check = type; check; check = check->inherits_ptr) {
+			if (check == p_type) {
+				inherits = true;
+				break;
+			}
+		}
 
+		if (inherits) {
+			type->flat_lookup.reset();
+			flat_lookup_classes.remove_at_unordered(i);
+		} else {
+			i++;
+		}
+	}
+}
+
+MethodBind *ClassDB::_find_method_in_chain(ClassInfo *p_type, const StringName &p_name) {
+	ClassInfo *type = p_type;
 	while (type) {
 		MethodBind **method = type->method_map.getptr(p_name);
 		if (method && *method) {
@@ -1054,6 +1137,18 @@ MethodBind *ClassDB::get_method(const StringName &p_class, const StringName &p_n
 	return nullptr;
 }
 
+MethodBind *ClassDB::get_method(const StringName &p_class, const StringName &p_name) {
+	Locker::Lock lock(Locker::STATE_READ);
+
+	ClassInfo *type = classes.getptr(p_class);
+	if (!type) {
+		return nullptr;
+	}
+
+	const FlatMember *member = _get_flat_lookup(type)->getptr(p_name);
+	return member ? member->method : nullptr;
+}
+
 Vector<uint32_t> ClassDB::get_method_compatibility_hashes(const StringName &p_class, const StringName &p_name) {
 	Locker::Lock lock(Locker::STATE_READ);
 
@@ -1120,6 +1215,7 @@ void ClassDB::bind_integer_constant(const StringName &p_class, const StringName
 	}
 
 	type->constant_map[p_name] = p_constant;
+	_invalidate_flat_lookups(type);
 
 	String enum_name = p_enum;
 	if (!enum_name.is_empty()) {
@@ -1359,6 +1455,7 @@ void ClassDB::add_signal(const StringName &p_class, const MethodInfo &p_signal)
 #endif // DEBUG_ENABLED
 
 	type->signal_map[sname] = p_signal;
+	_invalidate_flat_lookups(type);
 }
 
 void ClassDB::get_signal_list(const StringName &p_class, List<MethodInfo> *p_signals, bool p_no_inheritance) {
@@ -1464,7 +1561,7 @@ void ClassDB::add_property(const StringName &p_class, const PropertyInfo &p_pinf
 
 	MethodBind *mb_set = nullptr;
 	if (p_setter) {
-		mb_set = get_method(p_class, p_setter);
+		mb_set = _find_method_in_chain(type, p_setter);
 #ifdef DEBUG_ENABLED
 
 		ERR_FAIL_NULL_MSG(mb_set, vformat("Invalid setter '%s::%s' for property '%s'.", p_class, p_setter, p_pinfo.name));
@@ -1476,7 +1573,7 @@ void ClassDB::add_property(const StringName &p_class, const PropertyInfo &p_pinf
 
 	MethodBind *mb_get = nullptr;
 	if (p_getter) {
-		mb_get = get_method(p_class, p_getter);
+		mb_get = _find_method_in_chain(type, p_getter);
 #ifdef DEBUG_ENABLED
 
 		ERR_FAIL_NULL_MSG(mb_get, vformat("Invalid getter '%s::%s' for property '%s'.", p_class, p_getter, p_pinfo.name));
@@ -1509,6 +1606,7 @@ void ClassDB::add_property(const StringName &p_class, const PropertyInfo &p_pinf
 	psg.type = p_pinfo.type;
 
 	type->property_setget[p_pinfo.name] = psg;
+	_invalidate_flat_lookups(type);
 }
 
 void ClassDB::set_property_default_value(const StringName &p_class, const StringName &p_name, const Variant &p_default) {
@@ -1606,99 +1704,97 @@ bool ClassDB::set_property(Object *p_object, const StringName &p_property, const
 	ERR_FAIL_NULL_V(p_object, false);
 
 	ClassInfo *type = classes.getptr(p_object->get_class_name());
-	ClassInfo *check = type;
-	while (check) {
-		const PropertySetGet *psg = check->property_setget.getptr(p_property);
-		if (psg) {
-			if (!psg->setter) {
-				if (r_valid) {
-					*r_valid = false;
-				}
-				return true; //return true but do nothing
-			}
+	if (!type) {
+		return false;
+	}
 
-			Callable::CallError ce;
+	const FlatMember *member = _get_flat_lookup(type)->getptr(p_property);
+	if (!member || !member->setget) {
+		return false;
+	}
 
-			if (psg->index >= 0) {
-				Variant index = psg->index;
-				const Variant *arg[2] = { &index, &p_value };
-				//p_object->call(psg->setter,arg,2,ce);
-				if (psg->_setptr) {
-					psg->_setptr->call(p_object, arg, 2, ce);
-				} else {
-					p_object->callp(psg->setter, arg, 2, ce);
-				}
+	const PropertySetGet *psg = member->setget;
+	if (!psg->setter) {
+		if (r_valid) {
+			*r_valid = false;
+		}
+		return true; //return true but do nothing
+	}
 
-			} else {
-				const Variant *arg[1] = { &p_value };
-				if (psg->_setptr) {
-					psg->_setptr->call(p_object, arg, 1, ce);
-				} else {
-					p_object->callp(psg->setter, arg, 1, ce);
-				}
-			}
+	Callable::CallError ce;
 
-			if (r_valid) {
-				*r_valid = ce.error == Callable::CallError::CALL_OK;
-			}
+	if (psg->index >= 0) {
+		Variant index = psg->index;
+		const Variant *arg[2] = { &index, &p_value };
+		//p_object->call(psg->setter,arg,2,ce);
+		if (psg->_setptr) {
+			psg->_setptr->call(p_object, arg, 2, ce);
+		} else {
+			p_object->callp(psg->setter, arg, 2, ce);
+		}
 
-			return true;
+	} else {
+		const Variant *arg[1] = { &p_value };
+		if (psg->_setptr) {
+			psg->_setptr->call(p_object, arg, 1, ce);
+		} else {
+			p_object->callp(psg->setter, arg, 1, ce);
 		}
+	}
 
-		check = check->inherits_ptr;
+	if (r_valid) {
+		*r_valid = ce.error == Callable::CallError::CALL_OK;
 	}
 
-	return false;
+	return true;
 }
 
 bool ClassDB::get_property(Object *p_object, const StringName &p_property, Variant &r_value) {
 	ERR_FAIL_NULL_V(p_object, false);
 
 	ClassInfo *type = classes.getptr(p_object->get_class_name());
-	ClassInfo *check = type;
-	while (check) {
-		const PropertySetGet *psg = check->property_setget.getptr(p_property);
-		if (psg) {
-			if (!psg->getter) {
-				return true; //return true but do nothing
-			}
+	const FlatMember *member = type ? _get_flat_lookup(type)->getptr(p_property) : nullptr;
+	if (member) {
+		switch (member->get_kind) {
+			case FlatMember::GET_SETGET: {
+				const PropertySetGet *psg = member->setget;
+				if (!psg->getter) {
+					return true; //return true but do nothing
+				}
 
-			if (psg->index >= 0) {
-				Variant index = psg->index;
-				const Variant *arg[1] = { &index };
-				Callable::CallError ce;
-				const Variant value = p_object->callp(psg->getter, arg, 1, ce);
-				r_value = (ce.error == Callable::CallError::CALL_OK) ? value : Variant();
+				if (psg->index >= 0) {
+					Variant index = psg->index;
+					const Variant *arg[1] = { &index };
+					Callable::CallError ce;
+					const Variant value = p_object->callp(psg->getter, arg, 1, ce);
+					r_value = (ce.error == Callable::CallError::CALL_OK) ? value : Variant();
 
-			} else {
-				Callable::CallError ce;
-				if (psg->_getptr) {
-					r_value = psg->_getptr->call(p_object, nullptr, 0, ce);
 				} else {
-					const Variant value = p_object->callp(psg->getter, nullptr, 0, ce);
-					r_value = (ce.error == Callable::CallError::CALL_OK) ? value : Variant();
+					Callable::CallError ce;
+					if (psg->_getptr) {
+						r_value = psg->_getptr->call(p_object, nullptr, 0, ce);
+					} else {
+						const Variant value = p_object->callp(psg->getter, nullptr, 0, ce);
+						r_value = (ce.error == Callable::CallError::CALL_OK) ? value : Variant();
+					}
 				}
+				return true;
 			}
-			return true;
-		}
-
-		const int64_t *c = check->constant_map.getptr(p_property); //constants count
-		if (c) {
-			r_value = *c;
-			return true;
-		}
-
-		if (check->method_map.has(p_property)) { //methods count
-			r_value = Callable(p_object, p_property);
-			return true;
-		}
-
-		if (check->signal_map.has(p_property)) { //signals count
-			r_value = Signal(p_object, p_property);
-			return true;
+			case FlatMember::GET_CONSTANT: { //constants count
+				r_value = member->constant;
+				return true;
+			}
+			case FlatMember::GET_METHOD: { //methods count
+				r_value = Callable(p_object, p_property);
+				return true;
+			}
+			case FlatMember::GET_SIGNAL: { //signals count
+				r_value = Signal(p_object, p_property);
+				return true;
+			}
+			case FlatMember::GET_NONE: {
+			} break;
 		}
-
-		check = check->inherits_ptr;
 	}
 
 	// The "free()" method is special, so we assume it exists and return a Callable.
@@ -1892,6 +1988,7 @@ void ClassDB::_bind_method_custom(const StringName &p_class, MethodBind *p_metho
 #endif // DEBUG_ENABLED
 
 	type->method_map[method_name] = p_method;
+	_invalidate_flat_lookups(type);
 }
 
 MethodBind *ClassDB::_bind_vararg_method(MethodBind *p_bind, const StringName &p_name, const Vector<Variant> &p_default_args, bool p_compatibility) {
@@ -1918,6 +2015,7 @@ MethodBind *ClassDB::_bind_vararg_method(MethodBind *p_bind, const StringName &p
 		ERR_FAIL_V_MSG(nullptr, vformat("Method already bound: '%s::%s'.", instance_type, p_name));
 	}
 	type->method_map[p_name] = bind;
+	_invalidate_flat_lookups(type);
 #ifdef DEBUG_ENABLED
 	// FIXME: <reduz> set_return_type is no longer in MethodBind, so I guess it should be moved to vararg method bind
 	//bind->set_return_type("Variant");
@@ -1981,6 +2079,7 @@ MethodBind *ClassDB::bind_methodfi(uint32_t p_flags, MethodBind *p_bind, bool p_
 		_bind_compatibility(type, p_bind);
 	} else {
 		type->method_map[mdname] = p_bind;
+		_invalidate_flat_lookups(type);
 	}
 
 	Vector<Variant> defvals;
@@ -2112,6 +2211,7 @@ void ClassDB::set_class_enabled(const StringName &p_class, bool p_enable) {
 
 	ERR_FAIL_COND_MSG(!classes.has(p_class), vformat("Request for nonexistent class '%s'.", p_class));
 	classes[p_class].disabled = !p_enable;
+	class_list_version.increment();
 }
 
 bool ClassDB::is_class_enabled(const StringName &p_class) {
@@ -2325,17 +2425,20 @@ void ClassDB::register_extension_class(ObjectGDExtension *p_extension) {
 #endif
 
 	classes[p_extension->class_name] = c;
+	class_list_version.increment();
 }
 
 void ClassDB::unregister_extension_class(const StringName &p_class, bool p_free_method_binds) {
 	ClassInfo *c = classes.getptr(p_class);
 	ERR_FAIL_NULL_MSG(c, vformat("Class '%s' does not exist.", String(p_class)));
+	_invalidate_flat_lookups(c);
 	if (p_free_method_binds) {
 		for (KeyValue<StringName, MethodBind *> &F : c->method_map) {
 			memdelete(F.value);
 		}
 	}
 	classes.erase(p_class);
+	class_list_version.increment();
 	default_values_cached.erase(p_class);
 	default_values.erase(p_class);
 #ifdef TOOLS_ENABLED
@@ -2392,6 +2495,7 @@ void ClassDB::cleanup() {
 		}
 	}
 
+	flat_lookup_classes.clear();
 	classes.clear();
 	resource_base_extensions.clear();
 	compat_classes.clear();
@@ -37,6 +37,7 @@
 // Makes callable_mp readily available in all classes connecting signals.
 // Needs to come after method_bind and object have been included.
 #include "core/object/callable_method_pointer.h"
+#include "core/templates/a_hash_map.h"
 #include "core/templates/hash_set.h"
 
 #include <type_traits>
@@ -99,6 +100,47 @@ public:
 		Variant::Type type;
 	};
 
+	// A method or property reachable from a class, with inheritance already
+	// resolved, so a lookup costs one probe instead of one per ancestor.
+	struct FlatMember {
+		enum GetKind : uint8_t {
+			GET_NONE,
+			GET_SETGET,
+			GET_CONSTANT,
+			GET_METHOD,
+			GET_SIGNAL,
+		};
+
+		MethodBind *method = nullptr;
+		const PropertySetGet *setget = nullptr;
+		// What get_property() finds first for this name.
+		GetKind get_kind = GET_NONE;
+		int64_t constant = 0;
+	};
+
+	typedef AHashMap<StringName, FlatMember> FlatLookup;
+
+	// Built on first lookup and dropped when the class or one of its ancestors
+	// changes. Copies start empty, as the table would be stale.
+	struct FlatLookupRef {
+		std::atomic<FlatLookup *> table{ nullptr };
+
+		void reset() {
+			FlatLookup *old = table.exchange(nullptr);
+			if (old) {
+				memdelete(old);
+			}
+		}
+
+		FlatLookupRef() {}
+		FlatLookupRef(const FlatLookupRef &) {}
+		FlatLookupRef &operator=(const FlatLookupRef &) {
+			reset();
+			return *this;
+		}
+		~FlatLookupRef() { reset(); }
+	};
+
 	struct ClassInfo {
 		APIType api = API_NONE;
 		ClassInfo *inherits_ptr = nullptr;
@@ -136,6 +178,8 @@ public:
 		HashMap<StringName, PropertySetGet> property_setget;
 		HashMap<StringName, Vector<uint32_t>> virtual_methods_compat;
 
+		FlatLookupRef flat_lookup;
+
 		StringName inherits;
 		StringName name;
 		bool disabled = false;
@@ -185,9 +229,15 @@ public:
 	};
 
 	static HashMap<StringName, ClassInfo> classes;
+	// Bumped whenever a class is added, removed, enabled or disabled.
+	static SafeNumeric<uint64_t> class_list_version;
 	static HashMap<StringName, StringName> resource_base_extensions;
 	static HashMap<StringName, StringName> compat_classes;
 
+	// Guards building flat lookups and the list of classes that have one.
+	inline static BinaryMutex flat_lookup_mutex;
+	static LocalVector<ClassInfo *> flat_lookup_classes;
+
 #ifdef TOOLS_ENABLED
 	static HashMap<StringName, ObjectGDExtension> placeholder_extensions;
 #endif
@@ -228,6 +278,13 @@ private:
 
 	static bool _can_instantiate(ClassInfo *p_class_info, bool p_exposed_only = true);
 
+	static const FlatLookup *_get_flat_lookup(ClassInfo *p_type);
+	// Drops the flat lookups of p_type and every class inheriting it. Must be called whenever
+	// the methods, properties, constants or signals of p_type change.
+	static void _invalidate_flat_lookups(ClassInfo *p_type);
+	// Walks the inheritance chain, for use while classes are still being registered.
+	static MethodBind *_find_method_in_chain(ClassInfo *p_type, const StringName &p_name);
+
 public:
 	template <typename T>
 	static void register_class(bool p_virtual = false) {
@@ -312,6 +369,7 @@ public:
 	}
 
 	static void get_class_list(List<StringName> *p_classes);
+	static uint64_t get_class_list_version() { return class_list_version.get(); }
 #ifdef TOOLS_ENABLED
 	static void get_extensions_class_list(List<StringName> *p_classes);
 	static void get_extension_class_list(const Ref<GDExtension> &p_extension, List<StringName> *p_classes);
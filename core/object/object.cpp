@@ -1212,9 +1212,7 @@ Error Object::emit_signalp(const StringName &p_name, const Variant **p_args, int
 		return ERR_CANT_ACQUIRE_RESOURCE; //no emit, signals blocked
 	}
 
-	Callable *slot_callables = nullptr;
-	uint32_t *slot_flags = nullptr;
-	uint32_t slot_count = 0;
+	SignalData::Snapshot *snapshot = nullptr;
 
 	{
 		OBJ_SIGNAL_LOCK
@@ -1234,30 +1232,40 @@ Error Object::emit_signalp(const StringName &p_name, const Variant **p_args, int
 		// which is needed in certain edge cases; e.g., https://github.com/godotengine/godot/issues/73889.
 		Ref<RefCounted> rc = Ref<RefCounted>(Object::cast_to<RefCounted>(this));
 
-		// Ensure that disconnecting the signal or even deleting the object
-		// will not affect the signal calling.
-		slot_callables = (Callable *)alloca(sizeof(Callable) * s->slot_map.size());
-		slot_flags = (uint32_t *)alloca(sizeof(uint32_t) * s->slot_map.size());
+		if (!s->snapshot.snapshot) {
+			snapshot = memnew(SignalData::Snapshot);
+			snapshot->refcount.init();
+			snapshot->entries.resize(s->slot_map.size());
 
-		for (const KeyValue<Callable, SignalData::Slot> &slot_kv : s->slot_map) {
-			memnew_placement(&slot_callables[slot_count], Callable(slot_kv.value.conn.callable));
-			slot_flags[slot_count] = slot_kv.value.conn.flags;
-			++slot_count;
+			uint32_t slot_index = 0;
+			for (const KeyValue<Callable, SignalData::Slot> &slot_kv : s->slot_map) {
+				SignalData::Snapshot::Entry &entry = snapshot->entries[slot_index++];
+				entry.callable = slot_kv.value.conn.callable;
+				entry.flags = slot_kv.value.conn.flags;
+				snapshot->has_one_shot = snapshot->has_one_shot || (entry.flags & CONNECT_ONE_SHOT);
+			}
+
+			s->snapshot.snapshot = snapshot;
 		}
 
-		DEV_ASSERT(slot_count == s->slot_map.size());
+		// Ensure that disconnecting the signal or even deleting the object
+		// will not affect the signal calling.
+		snapshot = s->snapshot.snapshot;
+		snapshot->refcount.ref();
 
 		// Disconnect all one-shot connections before emitting to prevent recursion.
-		for (uint32_t i = 0; i < slot_count; ++i) {
-			bool disconnect = slot_flags[i] & CONNECT_ONE_SHOT;
+		if (snapshot->has_one_shot) {
+			for (const SignalData::Snapshot::Entry &entry : snapshot->entries) {
+				bool disconnect = entry.flags & CONNECT_ONE_SHOT;
 #ifdef TOOLS_ENABLED
-			if (disconnect && (slot_flags[i] & CONNECT_PERSIST) && Engine::get_singleton()->is_editor_hint()) {
-				// This signal was connected from the editor, and is being edited. Just don't disconnect for now.
-				disconnect = false;
-			}
+				if (disconnect && (entry.flags & CONNECT_PERSIST) && Engine::get_singleton()->is_editor_hint()) {
+					// This signal was connected from the editor, and is being edited. Just don't disconnect for now.
+					disconnect = false;
+				}
 #endif
-			if (disconnect) {
-				_disconnect(p_name, slot_callables[i]);
+				if (disconnect) {
+					_disconnect(p_name, entry.callable);
+				}
 			}
 		}
 	}
@@ -1266,9 +1274,9 @@ Error Object::emit_signalp(const StringName &p_name, const Variant **p_args, int
 
 	Error err = OK;
 
-	for (uint32_t i = 0; i < slot_count; ++i) {
-		const Callable &callable = slot_callables[i];
-		const uint32_t &flags = slot_flags[i];
+	for (const SignalData::Snapshot::Entry &entry : snapshot->entries) {
+		const Callable &callable = entry.callable;
+		const uint32_t &flags = entry.flags;
 
 		if (!callable.is_valid()) {
 			// Target might have been deleted during signal callback, this is expected and OK.
@@ -1304,8 +1312,8 @@ Error Object::emit_signalp(const StringName &p_name, const Variant **p_args, int
 		}
 	}
 
-	for (uint32_t i = 0; i < slot_count; ++i) {
-		slot_callables[i].~Callable();
+	if (snapshot->refcount.unref()) {
+		memdelete(snapshot);
 	}
 
 	return err;
@@ -1533,6 +1541,7 @@ Error Object::connect(const StringName &p_signal, const Callable &p_callable, ui
 
 	//use callable version as key, so binds can be ignored
 	s->slot_map[*p_callable.get_base_comparator()] = slot;
+	s->snapshot.reset();
 
 	return OK;
 }
@@ -1613,6 +1622,7 @@ bool Object::_disconnect(const StringName &p_signal, const Callable &p_callable,
 	}
 
 	s->slot_map.erase(*p_callable.get_base_comparator());
+	s->snapshot.reset();
 
 	if (s->slot_map.is_empty() && ClassDB::has_signal(get_class_name(), p_signal)) {
 		//not user signal, delete
@@ -39,6 +39,7 @@
 #include "core/templates/hash_map.h"
 #include "core/templates/hash_set.h"
 #include "core/templates/list.h"
+#include "core/templates/local_vector.h"
 #include "core/templates/rb_map.h"
 #include "core/templates/safe_refcount.h"
 #include "core/variant/callable_bind.h"
@@ -617,8 +618,42 @@ private:
 			List<Connection>::Element *cE = nullptr;
 		};
 
+		// Immutable copy of the connections, shared by every emission until the
+		// next connect or disconnect, so emitting doesn't copy each callable.
+		struct Snapshot {
+			struct Entry {
+				Callable callable;
+				uint32_t flags = 0;
+			};
+
+			SafeRefCount refcount;
+			LocalVector<Entry> entries;
+			bool has_one_shot = false;
+		};
+
+		// Built by the first emission after a change. Copies start empty.
+		struct SnapshotRef {
+			Snapshot *snapshot = nullptr;
+
+			void reset() {
+				if (snapshot && snapshot->refcount.unref()) {
+					memdelete(snapshot);
+				}
+				snapshot = nullptr;
+			}
+
+			SnapshotRef() {}
+			SnapshotRef(const SnapshotRef &) {}
+			SnapshotRef &operator=(const SnapshotRef &) {
+				reset();
+				return *this;
+			}
+			~SnapshotRef() { reset(); }
+		};
+
 		MethodInfo user;
 		HashMap<Callable, Slot, HashableHasher<Callable>> slot_map;
+		SnapshotRef snapshot;
 		bool removable = false;
 	};
 	friend struct _ObjectSignalLock;
@@ -91,25 +91,39 @@ void WorkerThreadPool::_process_task(Task *p_task) {
 	if (p_task->group) {
 		// Handling a group
 		bool do_post = false;
+		Group *group = p_task->group;
+		const uint32_t max = group->max;
+		// Elements are claimed in chunks that shrink as the group drains (guided scheduling),
+		// so large groups don't bounce the shared counters between cores on every element,
+		// while the tail still balances across the tasks.
+		const uint32_t chunk_divisor = MAX(1u, group->tasks_used) * GROUP_CHUNK_DIVISOR;
 
 		while (true) {
-			uint32_t work_index = p_task->group->index.postincrement();
-
-			if (work_index >= p_task->group->max) {
+			const uint32_t claimed = group->index.get();
+			if (claimed >= max) {
 				break;
 			}
-			if (p_task->native_group_func) {
-				p_task->native_group_func(p_task->native_func_userdata, work_index);
-			} else if (p_task->template_userdata) {
-				p_task->template_userdata->callback_indexed(work_index);
-			} else {
-				p_task->callable.call(work_index);
+			const uint32_t chunk = MAX(1u, (max - claimed) / chunk_divisor);
+			const uint32_t work_begin = group->index.postadd(chunk);
+			if (work_begin >= max) {
+				break;
+			}
+			const uint32_t work_end = MIN(work_begin + chunk, max);
+
+			for (uint32_t work_index = work_begin; work_index < work_end; work_index++) {
+				if (p_task->native_group_func) {
+					p_task->native_group_func(p_task->native_func_userdata, work_index);
+				} else if (p_task->template_userdata) {
+					p_task->template_userdata->callback_indexed(work_index);
+				} else {
+					p_task->callable.call(work_index);
+				}
 			}
 
 			// This is the only way to ensure posting is done when all tasks are really complete.
-			uint32_t completed_amount = p_task->group->completed_index.increment();
+			uint32_t completed_amount = group->completed_index.add(work_end - work_begin);
 
-			if (completed_amount == p_task->group->max) {
+			if (completed_amount == max) {
 				do_post = true;
 			}
 		}
@@ -125,15 +139,13 @@ void WorkerThreadPool::_process_task(Task *p_task) {
 		uint32_t max_users = p_task->group->tasks_used + 1; // Add 1 because the thread waiting for it is also user. Read before to avoid another thread freeing task after increment.
 		uint32_t finished_users = p_task->group->finished.increment();
 
+		task_mutex.lock();
 		if (finished_users == max_users) {
 			// Get rid of the group, because nobody else is using it.
-			MutexLock task_lock(task_mutex);
 			group_allocator.free(p_task->group);
 		}
 
 		// For groups, tasks get rid of themselves.
-
-		task_mutex.lock();
 		task_allocator.free(p_task);
 	} else {
 		if (p_task->native_func) {
@@ -187,7 +199,13 @@ void WorkerThreadPool::_thread_function(void *p_user) {
 
 	while (true) {
 		Task *task_to_process = nullptr;
-		{
+
+		// While running normally, own, injected and stolen tasks are taken without the lock.
+		if (likely(thread_data->pool->lock_free_pop_enabled.is_set())) {
+			task_to_process = thread_data->pool->_pop_queued_task(thread_data);
+		}
+
+		if (!task_to_process) {
 			// Create the lock outside the inner loop so it isn't needlessly unlocked and relocked
 			//  when no task was found to process, and the loop is re-entered.
 			MutexLock lock(thread_data->pool->task_mutex);
@@ -200,17 +218,22 @@ void WorkerThreadPool::_thread_function(void *p_user) {
 
 				thread_data->signaled = false;
 
-				if (!thread_data->pool->task_queue.first()) {
-					// There wasn't a task available yet.
-					// Let's wait for the next notification, then recheck.
-					thread_data->cond_var.wait(lock);
-					continue;
+				if (thread_data->pool->task_queue.first()) {
+					task_to_process = thread_data->pool->task_queue.first()->self();
+					thread_data->pool->task_queue.remove(thread_data->pool->task_queue.first());
+					break;
 				}
 
-				// Got a task to process! Remove it from the queue, then break into the task handling section.
-				task_to_process = thread_data->pool->task_queue.first()->self();
-				thread_data->pool->task_queue.remove(thread_data->pool->task_queue.first());
-				break;
+				// Tasks are only pushed with the lock held, so if the deques are empty now,
+				// whoever pushes next will notify after this thread starts waiting.
+				task_to_process = thread_data->pool->_pop_queued_task(thread_data);
+				if (task_to_process) {
+					break;
+				}
+
+				// There wasn't a task available yet.
+				// Let's wait for the next notification, then recheck.
+				thread_data->cond_var.wait(lock);
 			}
 		}
 
@@ -247,7 +270,12 @@ void WorkerThreadPool::_post_tasks(Task **p_tasks, uint32_t p_count, bool p_high
 	for (uint32_t i = 0; i < p_count; i++) {
 		p_tasks[i]->low_priority = !p_high_priority;
 		if (p_high_priority || low_priority_threads_used < max_low_priority_threads) {
-			task_queue.add_last(&p_tasks[i]->task_elem);
+			if (p_pump_task) {
+				// Pump tasks stay on the locked queue, since threads decide there whether they can take one.
+				task_queue.add_last(&p_tasks[i]->task_elem);
+			} else {
+				_queue_task(caller_pool_thread, p_tasks[i]);
+			}
 			if (!p_high_priority) {
 				low_priority_threads_used++;
 			}
@@ -338,6 +366,60 @@ bool WorkerThreadPool::_try_promote_low_priority_task() {
 	}
 }
 
+void WorkerThreadPool::_queue_task(ThreadData *p_caller_pool_thread, Task *p_task) {
+	// Tasks posted from a pool thread go to its own deque, others to the injection queue.
+	// If those are full, they fall back to the locked queue.
+	if (p_caller_pool_thread && p_caller_pool_thread->deque.push(p_task)) {
+		return;
+	}
+	if (injection_queue.push(p_task)) {
+		return;
+	}
+	task_queue.add_last(&p_task->task_elem);
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::_pop_queued_task(ThreadData *p_thread_data) {
+	Task *task = p_thread_data->deque.pop();
+	if (task) {
+		return task;
+	}
+
+	bool retry = false;
+	do {
+		retry = false;
+
+		task = injection_queue.steal(retry);
+		if (task) {
+			return task;
+		}
+
+		// Threads are only ever added, and never relocated, so the array can be read without the lock.
+		ThreadData *thread_array = threads.ptr();
+		const uint32_t thread_count = deque_thread_count.get();
+		for (uint32_t i = 1; i < thread_count; i++) {
+			ThreadData &victim = thread_array[(p_thread_data->index + i) % thread_count];
+			task = victim.deque.steal(retry);
+			if (task) {
+				return task;
+			}
+		}
+	} while (retry);
+
+	return nullptr;
+}
+
+bool WorkerThreadPool::_has_queued_tasks() const {
+	if (!injection_queue.is_empty()) {
+		return true;
+	}
+	for (uint32_t i = 0; i < threads.size(); i++) {
+		if (!threads[i].deque.is_empty()) {
+			return true;
+		}
+	}
+	return false;
+}
+
 WorkerThreadPool::TaskID WorkerThreadPool::add_native_task(void (*p_func)(void *), void *p_userdata, bool p_high_priority, const String &p_description) {
 	return _add_task(Callable(), p_func, p_userdata, nullptr, p_high_priority, p_description);
 }
@@ -381,6 +463,7 @@ WorkerThreadPool::TaskID WorkerThreadPool::_add_task(const Callable &p_callable,
 			threads.resize_initialized(thread_count + 1);
 			threads[thread_count].index = thread_count;
 			threads[thread_count].pool = this;
+			deque_thread_count.set(thread_count + 1);
 			threads[thread_count].thread.start(&WorkerThreadPool::_thread_function, &threads[thread_count], settings);
 			thread_ids.insert(threads[thread_count].thread.get_id(), thread_count);
 		}
@@ -528,7 +611,7 @@ void WorkerThreadPool::_wait_collaboratively(ThreadData *p_caller_pool_thread, T
 				if (was_signaled) {
 					// This thread was awaken for some additional reason, but it's about to exit.
 					// Let's find out what may be pending and forward the requests.
-					uint32_t to_process = task_queue.first() ? 1 : 0;
+					uint32_t to_process = task_queue.first() || _has_queued_tasks() ? 1 : 0;
 					uint32_t to_promote = p_caller_pool_thread->current_task->low_priority && low_priority_task_queue.first() ? 1 : 0;
 					if (to_process || to_promote) {
 						// This thread must be left alone since it won't loop again.
@@ -546,7 +629,10 @@ void WorkerThreadPool::_wait_collaboratively(ThreadData *p_caller_pool_thread, T
 				}
 			}
 
-			if (p_caller_pool_thread->pool->task_queue.first()) {
+			// Queued tasks are never pump tasks, so they can always be taken here.
+			task_to_process = _pop_queued_task(p_caller_pool_thread);
+
+			if (!task_to_process && task_queue.first()) {
 				task_to_process = task_queue.first()->self();
 				if ((p_task == ThreadData::YIELDING || p_caller_pool_thread->has_pump_task == true) && task_to_process->is_pump_task) {
 					task_to_process = nullptr;
@@ -583,6 +669,7 @@ void WorkerThreadPool::_wait_collaboratively(ThreadData *p_caller_pool_thread, T
 void WorkerThreadPool::_switch_runlevel(Runlevel p_runlevel) {
 	DEV_ASSERT(p_runlevel > runlevel);
 	runlevel = p_runlevel;
+	lock_free_pop_enabled.clear();
 	memset(&runlevel_data, 0, sizeof(runlevel_data));
 	for (uint32_t i = 0; i < threads.size(); i++) {
 		threads[i].cond_var.notify_one();
@@ -599,7 +686,7 @@ bool WorkerThreadPool::_handle_runlevel(ThreadData *p_thread_data, MutexLock<Bin
 		} break;
 		case RUNLEVEL_PRE_EXIT_LANGUAGES: {
 			if (!p_thread_data->pre_exited_languages) {
-				if (!task_queue.first() && !low_priority_task_queue.first()) {
+				if (!task_queue.first() && !low_priority_task_queue.first() && !_has_queued_tasks()) {
 					p_thread_data->pre_exited_languages = true;
 					runlevel_data.pre_exit_languages.num_idle_threads++;
 					control_cond_var.notify_all();
@@ -667,6 +754,8 @@ WorkerThreadPool::GroupID WorkerThreadPool::_add_group_task(const Callable &p_ca
 	if (p_tasks < 0) {
 		p_tasks = MAX(1u, threads.size());
 	}
+	// Tasks beyond the element count would only wake threads to find nothing left to claim.
+	p_tasks = MIN(p_tasks, p_elements);
 
 	MutexLock<BinaryMutex> lock(task_mutex);
 
@@ -822,6 +911,7 @@ void WorkerThreadPool::init(int p_thread_count, float p_low_priority_task_ratio)
 	ERR_FAIL_COND(threads.size() > 0);
 
 	runlevel = RUNLEVEL_NORMAL;
+	lock_free_pop_enabled.set();
 
 	if (p_thread_count < 0) {
 		p_thread_count = OS::get_singleton()->get_default_thread_pool_size();
@@ -851,6 +941,7 @@ void WorkerThreadPool::init(int p_thread_count, float p_low_priority_task_ratio)
 #endif
 #endif
 
+	deque_thread_count.set(threads.size());
 	for (uint32_t i = 0; i < threads.size(); i++) {
 		threads[i].index = i;
 		threads[i].pool = this;
@@ -906,6 +997,8 @@ void WorkerThreadPool::finish() {
 		}
 	}
 
+	deque_thread_count.set(0);
+	injection_queue.clear();
 	threads.clear();
 }
 
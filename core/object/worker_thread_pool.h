@@ -97,14 +97,97 @@ private:
 				task_elem(this) {}
 	};
 
+	// Chase-Lev work-stealing deque with a fixed capacity. Only the owner pushes and pops at the bottom,
+	// while any thread may steal from the top without locking. Pushes always happen with task_mutex held,
+	// so for the injection queue the owner is whoever holds it (nobody pops from that one).
+	template <uint32_t Capacity>
+	struct TaskDeque {
+		static_assert((Capacity & (Capacity - 1)) == 0, "TaskDeque capacity must be a power of two.");
+		static const uint32_t MASK = Capacity - 1;
+
+		std::atomic<int64_t> top{ 0 };
+		uint8_t padding[64 - sizeof(std::atomic<int64_t>)]; // Keep thieves off the owner's cache line.
+		std::atomic<int64_t> bottom{ 0 };
+		std::atomic<Task *> buffer[Capacity];
+
+		// Returns false if full, so the caller can fall back to another queue.
+		_FORCE_INLINE_ bool push(Task *p_task) {
+			const int64_t b = bottom.load(std::memory_order_relaxed);
+			const int64_t t = top.load(std::memory_order_acquire);
+			if (b - t >= (int64_t)Capacity) {
+				return false;
+			}
+			buffer[b & MASK].store(p_task, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Owner only. Takes the most recently pushed task, whose data is most likely still in cache.
+		_FORCE_INLINE_ Task *pop() {
+			const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t t = top.load(std::memory_order_relaxed);
+			if (t > b) {
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+			Task *task = buffer[b & MASK].load(std::memory_order_relaxed);
+			if (t == b) {
+				// Last one; race thieves for it.
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+					task = nullptr;
+				}
+				bottom.store(b + 1, std::memory_order_relaxed);
+			}
+			return task;
+		}
+
+		// Takes the oldest task. Sets r_retry if another thread won the race for it, in which case the deque may not be empty.
+		_FORCE_INLINE_ Task *steal(bool &r_retry) {
+			int64_t t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const int64_t b = bottom.load(std::memory_order_acquire);
+			if (t >= b) {
+				return nullptr;
+			}
+			Task *task = buffer[t & MASK].load(std::memory_order_relaxed);
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				r_retry = true;
+				return nullptr;
+			}
+			return task;
+		}
+
+		_FORCE_INLINE_ bool is_empty() const {
+			return bottom.load(std::memory_order_acquire) <= top.load(std::memory_order_acquire);
+		}
+
+		void clear() {
+			top.store(0);
+			bottom.store(0);
+		}
+	};
+
 	static const uint32_t TASKS_PAGE_SIZE = 1024;
 	static const uint32_t GROUPS_PAGE_SIZE = 256;
+	// Group tasks claim about `remaining / (tasks * GROUP_CHUNK_DIVISOR)` elements at a time.
+	static const uint32_t GROUP_CHUNK_DIVISOR = 2;
+	static const uint32_t THREAD_DEQUE_CAPACITY = 1024;
+	static const uint32_t INJECTION_QUEUE_CAPACITY = 4096;
 
 	PagedAllocator<Task, false, TASKS_PAGE_SIZE> task_allocator;
 	PagedAllocator<Group, false, GROUPS_PAGE_SIZE> group_allocator;
 
 	SelfList<Task>::List low_priority_task_queue;
+	// Pump tasks, promoted low priority tasks and overflow from the deques. Guarded by task_mutex.
 	SelfList<Task>::List task_queue;
+	// Tasks posted from outside the pool. Worker threads steal from it without taking task_mutex.
+	TaskDeque<INJECTION_QUEUE_CAPACITY> injection_queue;
+	// Number of entries in `threads` whose deques can be stolen from, readable without task_mutex.
+	SafeNumeric<uint32_t> deque_thread_count;
+	// Set while in RUNLEVEL_NORMAL. Otherwise threads only take tasks under task_mutex, after handling the runlevel.
+	SafeFlag lock_free_pop_enabled;
 
 	BinaryMutex task_mutex;
 
@@ -122,6 +205,7 @@ private:
 		Task *awaited_task = nullptr; // Null if not awaiting the condition variable, or special value (YIELDING).
 		ConditionVariable cond_var;
 		WorkerThreadPool *pool = nullptr;
+		TaskDeque<THREAD_DEQUE_CAPACITY> deque; // Tasks posted by this thread.
 
 		ThreadData() :
 				signaled(false),
@@ -182,6 +266,10 @@ private:
 
 	bool _try_promote_low_priority_task();
 
+	void _queue_task(ThreadData *p_caller_pool_thread, Task *p_task);
+	Task *_pop_queued_task(ThreadData *p_thread_data);
+	bool _has_queued_tasks() const;
+
 	static WorkerThreadPool *singleton;
 
 #ifdef THREADS_ENABLED
@@ -47,6 +47,7 @@
 #include "core/io/dtls_server.h"
 #include "core/io/file_access_encrypted.h"
 #include "core/io/http_client.h"
+#include "core/io/http_connection_pool.h"
 #include "core/io/image_loader.h"
 #include "core/io/json.h"
 #include "core/io/marshalls.h"
@@ -110,6 +111,7 @@ static CoreBind::Geometry2D *_geometry_2d = nullptr;
 static CoreBind::Geometry3D *_geometry_3d = nullptr;
 
 static WorkerThreadPool *worker_thread_pool = nullptr;
+static HTTPConnectionPool *http_connection_pool = nullptr;
 
 extern Mutex _global_mutex;
 
@@ -315,6 +317,7 @@ void register_core_types() {
 	GDREGISTER_NATIVE_STRUCT(ScriptLanguageExtensionProfilingInfo, "StringName signature;uint64_t call_count;uint64_t total_time;uint64_t self_time");
 
 	worker_thread_pool = memnew(WorkerThreadPool);
+	http_connection_pool = memnew(HTTPConnectionPool);
 
 	OS::get_singleton()->benchmark_end_measure("Core", "Register Types");
 }
@@ -405,6 +408,7 @@ void unregister_core_types() {
 
 	// Destroy singletons in reverse order to ensure dependencies are not broken.
 
+	memdelete(http_connection_pool);
 	memdelete(worker_thread_pool);
 
 	memdelete(_engine_debugger);
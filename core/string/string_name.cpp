@@ -33,36 +33,209 @@
 #include "core/os/mutex.h"
 #include "core/os/os.h"
 #include "core/string/print_string.h"
-
+#include "core/templates/local_vector.h"
+#include "core/templates/paged_allocator.h"
+
+// Buckets are split into shards by their low bits, each shard with its own lock.
+//
+// Lookups walk the chains without locking and only take the shard lock to add
+// a name or to revive one that was released. Releasing the last reference
+// leaves the entry in its chain; the next insertion into a shard with enough
+// released entries sweeps them out, and they are freed once no lock-free
+// lookup on that shard can still be walking over them.
+//
+// Lookups register under the shard's current epoch. A sweep flips the epoch
+// once the lookups of the previous one have left, and frees what was swept
+// before that flip, so a steady stream of lookups never holds them back.
 struct StringName::Table {
 	constexpr static uint32_t TABLE_BITS = 16;
 	constexpr static uint32_t TABLE_LEN = 1 << TABLE_BITS;
 	constexpr static uint32_t TABLE_MASK = TABLE_LEN - 1;
 
-	static inline _Data *table[TABLE_LEN];
-	static inline BinaryMutex mutex;
-	static inline PagedAllocator<_Data> allocator;
+	constexpr static uint32_t SHARD_BITS = 6;
+	constexpr static uint32_t SHARD_COUNT = 1 << SHARD_BITS;
+	constexpr static uint32_t SHARD_MASK = SHARD_COUNT - 1;
+	constexpr static int32_t SWEEP_THRESHOLD = 256;
+
+	// Only ever lives in static storage, so the counters start zeroed.
+	struct alignas(64) Shard {
+		BinaryMutex mutex;
+		// Only flipped under the lock.
+		std::atomic<uint32_t> epoch;
+		// Lookups currently walking this shard's chains without the lock, by
+		// the epoch they started in.
+		std::atomic<uint32_t> readers[2];
+		std::atomic<int32_t> released;
+		// Entries swept in each epoch, waiting for its readers to leave.
+		LocalVector<_Data *> limbo[2];
+		// Size of both limbos, for the stats.
+		std::atomic<uint32_t> awaiting_free;
+
+		std::atomic<uint64_t> hits;
+		std::atomic<uint64_t> misses;
+		std::atomic<uint64_t> contended;
+	};
+
+	static inline std::atomic<_Data *> table[TABLE_LEN];
+	static inline Shard shards[SHARD_COUNT];
+	static inline PagedAllocator<_Data, true> allocator;
+
+	_FORCE_INLINE_ static Shard &get_shard(uint32_t p_idx) {
+		return shards[p_idx & SHARD_MASK];
+	}
+
+	template <typename T>
+	static _Data *find(uint32_t p_idx, uint32_t p_hash, const T &p_name) {
+		_Data *d = table[p_idx].load();
+		while (d) {
+			// compare hash first
+			if (d->hash == p_hash && d->name == p_name) {
+				return d;
+			}
+			d = d->next.load();
+		}
+		return nullptr;
+	}
+
+	static void sweep(uint32_t p_shard_index) {
+		Shard &shard = shards[p_shard_index];
+
+		int32_t swept = 0;
+		const uint32_t epoch = shard.epoch.load(std::memory_order_relaxed);
+		for (uint32_t i = p_shard_index; i < TABLE_LEN; i += SHARD_COUNT) {
+			std::atomic<_Data *> *link = &table[i];
+			_Data *d = link->load(std::memory_order_relaxed);
+			while (d) {
+				_Data *next = d->next.load(std::memory_order_relaxed);
+				if (d->refcount.get() == 0) {
+					// Only revived under the lock, so it stays dead. Its own link is
+					// left intact for any reader standing on it.
+					link->store(next);
+					shard.limbo[epoch].push_back(d);
+					swept++;
+				} else {
+					link = &d->next;
+				}
+				d = next;
+			}
+		}
+		shard.released.fetch_sub(swept, std::memory_order_relaxed);
+
+		const uint32_t previous = epoch ^ 1;
+		if (shard.readers[previous].load() == 0) {
+			// Whatever was swept in the previous epoch was unlinked before the
+			// flip away from it, and the only lookups that could still reach it
+			// have left. Anyone registering under it from now on comes too late.
+			for (_Data *d : shard.limbo[previous]) {
+				allocator.free(d);
+			}
+			shard.limbo[previous].clear();
+			// Lookups that registered under this epoch before the flip are the
+			// only ones that can reach the entries just swept.
+			shard.epoch.store(previous);
+		}
+		shard.awaiting_free.store(shard.limbo[0].size() + shard.limbo[1].size(), std::memory_order_relaxed);
+	}
+
+	template <typename T>
+	static _Data *intern(const T &p_name, uint32_t p_hash, bool p_static) {
+		const uint32_t idx = p_hash & TABLE_MASK;
+		Shard &shard = get_shard(idx);
+
+#ifdef DEBUG_ENABLED
+		// The reference ranking is only counted under the lock.
+		if (likely(!debug_stringname))
+#endif
+		{
+			const uint32_t epoch = shard.epoch.load();
+			shard.readers[epoch].fetch_add(1);
+			_Data *d = find(idx, p_hash, p_name);
+			const bool alive = d && d->refcount.ref();
+			shard.readers[epoch].fetch_sub(1);
+
+			if (alive) {
+				if (p_static) {
+					d->static_count.increment();
+				}
+				shard.hits.fetch_add(1, std::memory_order_relaxed);
+				return d;
+			}
+		}
+
+		shard.misses.fetch_add(1, std::memory_order_relaxed);
+		if (!shard.mutex.try_lock()) {
+			shard.contended.fetch_add(1, std::memory_order_relaxed);
+			shard.mutex.lock();
+		}
+
+		_Data *d = find(idx, p_hash, p_name);
+		if (d) {
+			// exists
+			if (!d->refcount.ref()) {
+				// Released but not swept yet, bring it back.
+				d->refcount.init();
+				d->static_count.set(0);
+				shard.released.fetch_sub(1, std::memory_order_relaxed);
+			}
+			if (p_static) {
+				d->static_count.increment();
+			}
+#ifdef DEBUG_ENABLED
+			if (unlikely(debug_stringname)) {
+				d->debug_references++;
+			}
+#endif
+			shard.mutex.unlock();
+			return d;
+		}
+
+		if (shard.released.load(std::memory_order_relaxed) >= SWEEP_THRESHOLD) {
+			sweep(idx & SHARD_MASK);
+		}
+
+		d = allocator.alloc();
+		d->name = p_name;
+		d->refcount.init();
+		d->static_count.set(p_static ? 1 : 0);
+		d->hash = p_hash;
+		d->next.store(table[idx].load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+#ifdef DEBUG_ENABLED
+		if (unlikely(debug_stringname)) {
+			// Keep in memory, force static.
+			d->refcount.ref();
+			d->static_count.increment();
+		}
+#endif
+		// Publishes the fully built entry to lock-free lookups.
+		table[idx].store(d, std::memory_order_release);
+
+		shard.mutex.unlock();
+		return d;
+	}
 };
 
 void StringName::setup() {
 	ERR_FAIL_COND(configured);
 	for (uint32_t i = 0; i < Table::TABLE_LEN; i++) {
-		Table::table[i] = nullptr;
+		Table::table[i].store(nullptr, std::memory_order_relaxed);
 	}
 	configured = true;
 }
 
 void StringName::cleanup() {
-	MutexLock lock(Table::mutex);
+	for (Table::Shard &shard : Table::shards) {
+		shard.mutex.lock();
+	}
 
 #ifdef DEBUG_ENABLED
 	if (unlikely(debug_stringname)) {
 		Vector<_Data *> data;
 		for (uint32_t i = 0; i < Table::TABLE_LEN; i++) {
-			_Data *d = Table::table[i];
+			_Data *d = Table::table[i].load();
 			while (d) {
 				data.push_back(d);
-				d = d->next;
+				d = d->next.load();
 			}
 		}
 
@@ -86,8 +259,8 @@ void StringName::cleanup() {
 #endif
 	int lost_strings = 0;
 	for (uint32_t i = 0; i < Table::TABLE_LEN; i++) {
-		while (Table::table[i]) {
-			_Data *d = Table::table[i];
+		_Data *d = Table::table[i].load();
+		while (d) {
 			if (d->static_count.get() != d->refcount.get()) {
 				lost_strings++;
 
@@ -96,36 +269,64 @@ void StringName::cleanup() {
 				}
 			}
 
-			Table::table[i] = Table::table[i]->next;
+			_Data *next = d->next.load();
 			Table::allocator.free(d);
+			d = next;
 		}
+		Table::table[i].store(nullptr);
 	}
 	if (lost_strings) {
 		print_verbose(vformat("StringName: %d unclaimed string names at exit.", lost_strings));
 	}
+
+	const TableStats stats = get_table_stats();
+	print_verbose(vformat("StringName: %d lookups without lock, %d with lock, %d contended.", stats.hits, stats.misses, stats.contended));
+
+	for (Table::Shard &shard : Table::shards) {
+		for (LocalVector<_Data *> &limbo : shard.limbo) {
+			for (_Data *d : limbo) {
+				Table::allocator.free(d);
+			}
+			limbo.clear();
+		}
+		shard.awaiting_free.store(0);
+		shard.released.store(0);
+		shard.mutex.unlock();
+	}
 	configured = false;
 }
 
+StringName::TableStats StringName::get_table_stats() {
+	TableStats stats;
+	for (const Table::Shard &shard : Table::shards) {
+		stats.hits += shard.hits.load(std::memory_order_relaxed);
+		stats.misses += shard.misses.load(std::memory_order_relaxed);
+		stats.contended += shard.contended.load(std::memory_order_relaxed);
+		stats.released += MAX(0, shard.released.load(std::memory_order_relaxed));
+		stats.awaiting_free += shard.awaiting_free.load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
 void StringName::unref() {
 	ERR_FAIL_COND(!configured);
 
-	if (_data && _data->refcount.unref()) {
-		MutexLock lock(Table::mutex);
-
-		if (CoreGlobals::leak_reporting_enabled && _data->static_count.get() > 0) {
-			ERR_PRINT("BUG: Unreferenced static string to 0: " + _data->name);
-		}
-		if (_data->prev) {
-			_data->prev->next = _data->next;
-		} else {
-			const uint32_t idx = _data->hash & Table::TABLE_MASK;
-			Table::table[idx] = _data->next;
+	if (_data) {
+		// Once the last reference is gone a concurrent sweep can free the entry,
+		// so everything needed afterwards is read while it is still held.
+		const uint32_t hash = _data->hash;
+		String static_name;
+		if (unlikely(CoreGlobals::leak_reporting_enabled && _data->static_count.get() > 0 && _data->refcount.get() == 1)) {
+			static_name = _data->name;
 		}
 
-		if (_data->next) {
-			_data->next->prev = _data->prev;
+		if (_data->refcount.unref()) {
+			if (unlikely(!static_name.is_empty())) {
+				ERR_PRINT("BUG: Unreferenced static string to 0: " + static_name);
+			}
+			// Stays in the table until its shard is swept, so this never locks.
+			Table::get_shard(hash & Table::TABLE_MASK).released.fetch_add(1, std::memory_order_relaxed);
 		}
-		Table::allocator.free(_data);
 	}
 
 	_data = nullptr;
@@ -210,52 +411,7 @@ StringName::StringName(const char *p_name, bool p_static) {
 		return; //empty, ignore
 	}
 
-	const uint32_t hash = String::hash(p_name);
-	const uint32_t idx = hash & Table::TABLE_MASK;
-
-	MutexLock lock(Table::mutex);
-	_data = Table::table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->name == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		// exists
-		if (p_static) {
-			_data->static_count.increment();
-		}
-#ifdef DEBUG_ENABLED
-		if (unlikely(debug_stringname)) {
-			_data->debug_references++;
-		}
-#endif
-		return;
-	}
-
-	_data = Table::allocator.alloc();
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->static_count.set(p_static ? 1 : 0);
-	_data->hash = hash;
-	_data->next = Table::table[idx];
-	_data->prev = nullptr;
-
-#ifdef DEBUG_ENABLED
-	if (unlikely(debug_stringname)) {
-		// Keep in memory, force static.
-		_data->refcount.ref();
-		_data->static_count.increment();
-	}
-#endif
-	if (Table::table[idx]) {
-		Table::table[idx]->prev = _data;
-	}
-	Table::table[idx] = _data;
+	_data = Table::intern(p_name, String::hash(p_name), p_static);
 }
 
 StringName::StringName(const String &p_name, bool p_static) {
@@ -267,51 +423,7 @@ StringName::StringName(const String &p_name, bool p_static) {
 		return;
 	}
 
-	const uint32_t hash = p_name.hash();
-	const uint32_t idx = hash & Table::TABLE_MASK;
-
-	MutexLock lock(Table::mutex);
-	_data = Table::table[idx];
-
-	while (_data) {
-		if (_data->hash == hash && _data->name == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		// exists
-		if (p_static) {
-			_data->static_count.increment();
-		}
-#ifdef DEBUG_ENABLED
-		if (unlikely(debug_stringname)) {
-			_data->debug_references++;
-		}
-#endif
-		return;
-	}
-
-	_data = Table::allocator.alloc();
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->static_count.set(p_static ? 1 : 0);
-	_data->hash = hash;
-	_data->next = Table::table[idx];
-	_data->prev = nullptr;
-#ifdef DEBUG_ENABLED
-	if (unlikely(debug_stringname)) {
-		// Keep in memory, force static.
-		_data->refcount.ref();
-		_data->static_count.increment();
-	}
-#endif
-
-	if (Table::table[idx]) {
-		Table::table[idx]->prev = _data;
-	}
-	Table::table[idx] = _data;
+	_data = Table::intern(p_name, p_name.hash(), p_static);
 }
 
 bool operator==(const String &p_name, const StringName &p_string_name) {
@@ -49,8 +49,8 @@ class [[nodiscard]] StringName {
 #endif
 
 		uint32_t hash = 0;
-		_Data *prev = nullptr;
-		_Data *next = nullptr;
+		// Read without the table lock, see StringName::Table.
+		std::atomic<_Data *> next{ nullptr };
 		_Data() {}
 	};
 
@@ -77,6 +77,16 @@ class [[nodiscard]] StringName {
 	StringName(_Data *p_data) { _data = p_data; }
 
 public:
+	struct TableStats {
+		uint64_t hits = 0; // Lookups answered without taking a lock.
+		uint64_t misses = 0; // Lookups that had to lock their shard to add or revive a name.
+		uint64_t contended = 0; // Shard locks that were already held by another thread.
+		uint32_t released = 0; // Names no longer referenced but not swept from the table yet.
+		uint32_t awaiting_free = 0; // Swept names kept until no lock-free lookup can reach them.
+	};
+
+	static TableStats get_table_stats();
+
 	_FORCE_INLINE_ explicit operator bool() const { return _data; }
 
 	bool operator==(const String &p_name) const;
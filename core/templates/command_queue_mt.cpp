@@ -30,9 +30,137 @@
 
 #include "command_queue_mt.h"
 
+CommandQueueMT::Page *CommandQueueMT::_alloc_page() {
+	{
+		MutexLock lock(page_mutex);
+		if (free_pages) {
+			Page *page = free_pages;
+			free_pages = page->next_free;
+			page->next_free = nullptr;
+			return page;
+		}
+	}
+
+	Page *page = memnew(Page);
+	memset(page->data, 0, PAGE_DATA_SIZE);
+	return page;
+}
+
+void CommandQueueMT::_open_next_page(Page *p_page, uint32_t p_offset) {
+	if (p_offset < PAGE_DATA_SIZE) {
+		reinterpret_cast<Slot *>(&p_page->data[p_offset])->size.store(SLOT_END_OF_PAGE, std::memory_order_release);
+	}
+
+	Page *next = _alloc_page();
+	// Move write_page before linking, so once the consumer sees the link no
+	// new producer can pick up the old page.
+	write_page.store(next);
+	p_page->next.store(next, std::memory_order_release);
+}
+
+void CommandQueueMT::_recycle_retired_pages() {
+	if (!retired_pages || active_producers.load() != 0) {
+		// Someone may still hold one of these pages; try again after the next flush.
+		return;
+	}
+
+	MutexLock lock(page_mutex);
+	while (retired_pages) {
+		Page *page = retired_pages;
+		retired_pages = page->next_free;
+
+		// Unpublished slots must read as zero once the page is reused.
+		memset(page->data, 0, MIN(page->reserved.load(std::memory_order_relaxed), PAGE_DATA_SIZE));
+		page->reserved.store(0, std::memory_order_relaxed);
+		page->next.store(nullptr, std::memory_order_relaxed);
+
+		page->next_free = free_pages;
+		free_pages = page;
+	}
+}
+
+bool CommandQueueMT::_consume() {
+	bool consumed = false;
+
+	while (true) {
+		if (read_offset < PAGE_DATA_SIZE) {
+			Slot *slot = reinterpret_cast<Slot *>(&read_page->data[read_offset]);
+			uint32_t size = slot->size.load(std::memory_order_acquire);
+			if (size == 0) {
+				// Reserved but not published yet; its producer will flag the queue as pending.
+				break;
+			}
+
+			if (size != SLOT_END_OF_PAGE) {
+				CommandBase *cmd = reinterpret_cast<CommandBase *>(slot + 1);
+				cmd->call();
+				SyncWaiter *waiter = cmd->sync_waiter;
+				cmd->~CommandBase();
+
+				read_offset += size;
+				consumed = true;
+
+				if (unlikely(waiter)) {
+					{
+						MutexLock lock(sync_mutex);
+						waiter->done = true;
+					}
+					sync_cond_var.notify_all();
+				}
+				continue;
+			}
+		}
+
+		Page *next = read_page->next.load(std::memory_order_acquire);
+		if (!next) {
+			// The producer that filled this page is still opening the next one.
+			break;
+		}
+
+		read_page->next_free = retired_pages;
+		retired_pages = read_page;
+		read_page = next;
+		read_offset = 0;
+	}
+
+	return consumed;
+}
+
+void CommandQueueMT::_flush() {
+	if (flushing.exchange(true, std::memory_order_acquire)) {
+		// Re-entrant call, or another thread is flushing already.
+		return;
+	}
+
+	// Clear the flag before each pass, so anything published during the pass
+	// is either consumed by the next one or wakes the consumer again.
+	do {
+		pending.store(false);
+	} while (_consume());
+
+	_recycle_retired_pages();
+
+	flushing.store(false, std::memory_order_release);
+}
+
 CommandQueueMT::CommandQueueMT() {
-	command_mem.reserve(DEFAULT_COMMAND_MEM_SIZE_KB * 1024);
+	read_page = _alloc_page();
+	write_page.store(read_page);
 }
 
 CommandQueueMT::~CommandQueueMT() {
+	Page *page = read_page;
+	while (page) {
+		Page *next = page->next.load();
+		memdelete(page);
+		page = next;
+	}
+
+	for (Page *list : { retired_pages, free_pages }) {
+		while (list) {
+			Page *next = list->next_free;
+			memdelete(list);
+			list = next;
+		}
+	}
 }
@@ -33,22 +33,24 @@
 #include "core/object/worker_thread_pool.h"
 #include "core/os/condition_variable.h"
 #include "core/os/mutex.h"
-#include "core/templates/local_vector.h"
+#include "core/os/thread.h"
 #include "core/templates/simple_type.h"
 #include "core/templates/tuple.h"
 #include "core/typedefs.h"
 
 class CommandQueueMT {
+	// Set by the consumer once a synchronous command has been executed.
+	struct SyncWaiter {
+		bool done = false;
+	};
+
 	struct CommandBase {
-		bool sync = false;
+		SyncWaiter *sync_waiter = nullptr;
 		virtual void call() = 0;
 		virtual ~CommandBase() = default;
-
-		CommandBase(bool p_sync) :
-				sync(p_sync) {}
 	};
 
-	template <typename T, typename M, bool NeedsSync, typename... Args>
+	template <typename T, typename M, typename... Args>
 	struct Command : public CommandBase {
 		T *instance;
 		M method;
@@ -56,7 +58,7 @@ class CommandQueueMT {
 
 		template <typename... FwdArgs>
 		_FORCE_INLINE_ Command(T *p_instance, M p_method, FwdArgs &&...p_args) :
-				CommandBase(NeedsSync), instance(p_instance), method(p_method), args(std::forward<FwdArgs>(p_args)...) {}
+				instance(p_instance), method(p_method), args(std::forward<FwdArgs>(p_args)...) {}
 
 		void call() {
 			call_impl(BuildIndexSequence<sizeof...(Args)>{});
@@ -83,7 +85,7 @@ class CommandQueueMT {
 		Tuple<GetSimpleTypeT<Args>...> args;
 
 		_FORCE_INLINE_ CommandRet(T *p_instance, M p_method, R *p_ret, GetSimpleTypeT<Args>... p_args) :
-				CommandBase(true), instance(p_instance), method(p_method), ret(p_ret), args{ p_args... } {}
+				instance(p_instance), method(p_method), ret(p_ret), args{ p_args... } {}
 
 		void call() override {
 			*ret = call_impl(BuildIndexSequence<sizeof...(Args)>{});
@@ -103,104 +105,111 @@ class CommandQueueMT {
 
 	/***** BASE *******/
 
+	// Commands are written into fixed-size pages that are never reallocated, so
+	// producers only need an atomic bump of the page offset to reserve space and
+	// the consumer can run a command while others are being pushed.
+	//
+	// Every command is preceded by a slot header holding its size. A zero size
+	// means the slot is reserved but not published yet; the consumer stops there
+	// and the producer flags the queue as pending once it publishes.
 	static const uint32_t DEFAULT_COMMAND_MEM_SIZE_KB = 64;
+	static const uint32_t PAGE_DATA_SIZE = DEFAULT_COMMAND_MEM_SIZE_KB * 1024;
+	static const uint32_t SLOT_END_OF_PAGE = UINT32_MAX;
+
+	struct Slot {
+		std::atomic<uint32_t> size;
+		uint32_t padding;
+	};
+	static_assert(sizeof(Slot) == 8);
+
+	struct Page {
+		// Bytes reserved by producers. May grow past PAGE_DATA_SIZE while the
+		// next page is being opened.
+		std::atomic<uint32_t> reserved{ 0 };
+		std::atomic<Page *> next{ nullptr };
+		// Link in the free and retired lists.
+		Page *next_free = nullptr;
+		alignas(8) uint8_t data[PAGE_DATA_SIZE];
+	};
 
-	BinaryMutex mutex;
-	LocalVector<uint8_t> command_mem;
+	std::atomic<Page *> write_page{ nullptr };
+	// Producers between loading write_page and publishing their slot. Pages
+	// are only recycled when this drops to zero, so a producer never bumps the
+	// offset of a page that was handed out again.
+	std::atomic<uint32_t> active_producers{ 0 };
+
+	// Consumer state, owned by whoever set `flushing`.
+	std::atomic<bool> flushing{ false };
+	Page *read_page = nullptr;
+	uint32_t read_offset = 0;
+	Page *retired_pages = nullptr;
+
+	BinaryMutex page_mutex;
+	Page *free_pages = nullptr;
+
+	BinaryMutex sync_mutex;
 	ConditionVariable sync_cond_var;
-	uint32_t sync_head = 0;
-	uint32_t sync_tail = 0;
-	uint32_t sync_awaiters = 0;
-	WorkerThreadPool::TaskID pump_task_id = WorkerThreadPool::INVALID_TASK_ID;
-	uint64_t flush_read_ptr = 0;
+
+	std::atomic<WorkerThreadPool::TaskID> pump_task_id{ WorkerThreadPool::INVALID_TASK_ID };
 	std::atomic<bool> pending{ false };
 
-	template <typename T, typename... Args>
-	_FORCE_INLINE_ void create_command(Args &&...p_args) {
-		// alloc size is size+T+safeguard
-		constexpr uint64_t alloc_size = ((sizeof(T) + 8U - 1U) & ~(8U - 1U));
-		static_assert(alloc_size < UINT32_MAX, "Type too large to fit in the command queue.");
-
-		uint64_t size = command_mem.size();
-		command_mem.resize(size + alloc_size + sizeof(uint64_t));
-		*(uint64_t *)&command_mem[size] = alloc_size;
-		void *cmd = &command_mem[size + sizeof(uint64_t)];
-		new (cmd) T(std::forward<Args>(p_args)...);
-		pending.store(true);
+	Page *_alloc_page();
+	void _open_next_page(Page *p_page, uint32_t p_offset);
+	void _recycle_retired_pages();
+	bool _consume();
+	void _flush();
+
+	_FORCE_INLINE_ Slot *_reserve(uint32_t p_size) {
+		while (true) {
+			Page *page = write_page.load();
+			uint32_t offset = page->reserved.fetch_add(p_size, std::memory_order_relaxed);
+			if (likely(offset + p_size <= PAGE_DATA_SIZE)) {
+				return reinterpret_cast<Slot *>(&page->data[offset]);
+			}
+			if (offset <= PAGE_DATA_SIZE) {
+				// This reservation crossed the end of the page, so this producer opens the next one.
+				_open_next_page(page, offset);
+			} else {
+				// Another producer is opening the next page.
+				while (write_page.load() == page) {
+					Thread::yield();
+				}
+			}
+		}
 	}
 
 	template <typename T, bool NeedsSync, typename... Args>
 	_FORCE_INLINE_ void _push_internal(Args &&...args) {
-		MutexLock mlock(mutex);
-		create_command<T>(std::forward<Args>(args)...);
+		// alloc size is slot+T+safeguard
+		constexpr uint32_t alloc_size = sizeof(Slot) + ((sizeof(T) + 8U - 1U) & ~(8U - 1U));
+		static_assert(alloc_size <= PAGE_DATA_SIZE, "Type too large to fit in the command queue.");
 
-		if (pump_task_id != WorkerThreadPool::INVALID_TASK_ID) {
-			WorkerThreadPool::get_singleton()->notify_yield_over(pump_task_id);
-		}
+		SyncWaiter waiter;
 
+		active_producers.fetch_add(1);
+		Slot *slot = _reserve(alloc_size);
+		T *cmd = new (slot + 1) T(std::forward<Args>(args)...);
 		if constexpr (NeedsSync) {
-			sync_tail++;
-			_wait_for_sync(mlock);
-		}
-	}
-
-	_FORCE_INLINE_ void _prevent_sync_wraparound() {
-		bool safe_to_reset = !sync_awaiters;
-		bool already_sync_to_latest = sync_head == sync_tail;
-		if (safe_to_reset && already_sync_to_latest) {
-			sync_head = 0;
-			sync_tail = 0;
+			cmd->sync_waiter = &waiter;
 		}
-	}
-
-	void _flush() {
-		if (unlikely(flush_read_ptr)) {
-			// Re-entrant call.
-			return;
+		slot->size.store(alloc_size, std::memory_order_release);
+		active_producers.fetch_sub(1);
+
+		// Only wake the consumer on the transition to pending; it clears the flag
+		// before every pass, so later pushes are picked up by the same flush.
+		if (!pending.exchange(true)) {
+			WorkerThreadPool::TaskID pump_task = pump_task_id.load(std::memory_order_relaxed);
+			if (pump_task != WorkerThreadPool::INVALID_TASK_ID) {
+				WorkerThreadPool::get_singleton()->notify_yield_over(pump_task);
+			}
 		}
 
-		MutexLock lock(mutex);
-
-		while (flush_read_ptr < command_mem.size()) {
-			uint64_t size = *(uint64_t *)&command_mem[flush_read_ptr];
-			flush_read_ptr += 8;
-			CommandBase *cmd = reinterpret_cast<CommandBase *>(&command_mem[flush_read_ptr]);
-			uint32_t allowance_id = WorkerThreadPool::thread_enter_unlock_allowance_zone(lock);
-			cmd->call();
-			WorkerThreadPool::thread_exit_unlock_allowance_zone(allowance_id);
-
-			// Handle potential realloc due to the command and unlock allowance.
-			cmd = reinterpret_cast<CommandBase *>(&command_mem[flush_read_ptr]);
-
-			if (unlikely(cmd->sync)) {
-				sync_head++;
-				lock.~MutexLock(); // Give an opportunity to awaiters right away.
-				sync_cond_var.notify_all();
-				new (&lock) MutexLock(mutex);
-				// Handle potential realloc happened during unlock.
-				cmd = reinterpret_cast<CommandBase *>(&command_mem[flush_read_ptr]);
+		if constexpr (NeedsSync) {
+			MutexLock lock(sync_mutex);
+			while (!waiter.done) {
+				sync_cond_var.wait(lock);
 			}
-
-			cmd->~CommandBase();
-
-			flush_read_ptr += size;
 		}
-
-		command_mem.clear();
-		pending.store(false);
-		flush_read_ptr = 0;
-
-		_prevent_sync_wraparound();
-	}
-
-	_FORCE_INLINE_ void _wait_for_sync(MutexLock<BinaryMutex> &p_lock) {
-		sync_awaiters++;
-		uint32_t sync_head_goal = sync_tail;
-		do {
-			sync_cond_var.wait(p_lock);
-		} while (sync_head < sync_head_goal);
-		sync_awaiters--;
-		_prevent_sync_wraparound();
 	}
 
 	void _no_op() {}
@@ -209,14 +218,14 @@ public:
 	template <typename T, typename M, typename... Args>
 	void push(T *p_instance, M p_method, Args &&...p_args) {
 		// Standard command, no sync.
-		using CommandType = Command<T, M, false, Args...>;
+		using CommandType = Command<T, M, Args...>;
 		_push_internal<CommandType, false>(p_instance, p_method, std::forward<Args>(p_args)...);
 	}
 
 	template <typename T, typename M, typename... Args>
 	void push_and_sync(T *p_instance, M p_method, Args... p_args) {
 		// Standard command, sync.
-		using CommandType = Command<T, M, true, Args...>;
+		using CommandType = Command<T, M, Args...>;
 		_push_internal<CommandType, true>(p_instance, p_method, std::forward<Args>(p_args)...);
 	}
 
@@ -242,14 +251,14 @@ public:
 	}
 
 	void wait_and_flush() {
-		ERR_FAIL_COND(pump_task_id == WorkerThreadPool::INVALID_TASK_ID);
-		WorkerThreadPool::get_singleton()->wait_for_task_completion(pump_task_id);
+		WorkerThreadPool::TaskID pump_task = pump_task_id.load();
+		ERR_FAIL_COND(pump_task == WorkerThreadPool::INVALID_TASK_ID);
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(pump_task);
 		_flush();
 	}
 
 	void set_pump_task_id(WorkerThreadPool::TaskID p_task_id) {
-		MutexLock lock(mutex);
-		pump_task_id = p_task_id;
+		pump_task_id.store(p_task_id);
 	}
 
 	CommandQueueMT();
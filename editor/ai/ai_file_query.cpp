@@ -0,0 +1,454 @@
+/**************************************************************************/
+/*  ai_file_query.cpp                                                     */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ai_file_query.h"
+
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/resource_loader.h"
+#include "core/object/class_db.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/mutex.h"
+#include "core/os/thread.h"
+#include "core/templates/safe_refcount.h"
+#include "editor/file_system/editor_file_system.h"
+
+struct AIFileQuery::Walk {
+	const Query *query = nullptr;
+	LocalVector<Rule> rules;
+	// Entries that pass every filter but the content search. Without one,
+	// only the requested page is kept and the rest is counted.
+	LocalVector<Entry> entries;
+	int total = 0;
+	bool collect_all = false;
+
+	void add(Entry &p_entry) {
+		if (collect_all || (total >= query->offset && total < query->offset + query->limit)) {
+			entries.push_back(p_entry);
+		}
+		total++;
+	}
+};
+
+static PackedStringArray _to_string_array(const Variant &p_value) {
+	PackedStringArray values;
+	if (p_value.get_type() == Variant::STRING || p_value.get_type() == Variant::STRING_NAME) {
+		for (const String &value : String(p_value).split(",", false)) {
+			values.push_back(value.strip_edges());
+		}
+	} else if (p_value.get_type() == Variant::ARRAY || p_value.get_type() == Variant::PACKED_STRING_ARRAY) {
+		const Array array = p_value;
+		for (const Variant &value : array) {
+			values.push_back(String(value).strip_edges());
+		}
+	}
+	return values;
+}
+
+static String _get_relative_path(const String &p_path) {
+	return p_path.begins_with("res://") ? p_path.substr(6) : p_path;
+}
+
+AIFileQuery::Query AIFileQuery::parse_query(const Dictionary &p_args) {
+	Query query;
+	query.root = p_args.get("dir", p_args.get("path", "res://"));
+	if (query.root.is_empty()) {
+		query.root = "res://";
+	}
+	query.recursive = p_args.get("recursive", query.recursive);
+	query.include_directories = p_args.get("include_directories", query.include_directories);
+	query.case_sensitive = p_args.get("case_sensitive", query.case_sensitive);
+	query.respect_gitignore = p_args.get("respect_gitignore", query.respect_gitignore);
+
+	query.patterns = _to_string_array(p_args.get("pattern", Variant()));
+	query.patterns.append_array(_to_string_array(p_args.get("filter", Variant())));
+	query.patterns.append_array(_to_string_array(p_args.get("glob", Variant())));
+	for (const String &extension : _to_string_array(p_args.get("extensions", Variant()))) {
+		query.extensions.push_back(extension.trim_prefix("*").trim_prefix(".").to_lower());
+	}
+	query.types = _to_string_array(p_args.get("types", Variant()));
+	query.excludes = _to_string_array(p_args.get("exclude", Variant()));
+
+	query.min_size = p_args.get("min_size", query.min_size);
+	query.max_size = p_args.get("max_size", query.max_size);
+	query.content = p_args.get("content", "");
+	query.max_matches_per_file = MAX(1, int(p_args.get("max_matches_per_file", query.max_matches_per_file)));
+	query.offset = MAX(0, int(p_args.get("offset", 0)));
+	query.limit = CLAMP(int(p_args.get("limit", p_args.get("max_results", DEFAULT_LIMIT))), 1, 10000);
+	return query;
+}
+
+void AIFileQuery::_parse_rules(const PackedStringArray &p_lines, LocalVector<Rule> &r_rules) {
+	for (String line : p_lines) {
+		line = line.strip_edges();
+		if (line.is_empty() || line.begins_with("#")) {
+			continue;
+		}
+		Rule rule;
+		if (line.begins_with("!")) {
+			rule.negated = true;
+			line = line.substr(1);
+		}
+		if (line.ends_with("/")) {
+			rule.directory_only = true;
+			line = line.substr(0, line.length() - 1);
+		}
+		if (line.begins_with("**/")) {
+			line = line.substr(3);
+		} else if (line.contains_char('/')) {
+			rule.anchored = true;
+			line = line.trim_prefix("/");
+		}
+		if (line.is_empty()) {
+			continue;
+		}
+		// String::match() lets '*' span directories, which covers '**'.
+		rule.pattern = line.replace("**", "*");
+		r_rules.push_back(rule);
+	}
+}
+
+const LocalVector<AIFileQuery::Rule> &AIFileQuery::_get_gitignore_rules() {
+	static LocalVector<Rule> rules;
+	static uint64_t loaded_time = 0;
+	const String path = "res://.gitignore";
+	const uint64_t modified_time = FileAccess::exists(path) ? FileAccess::get_modified_time(path) : 0;
+	if (modified_time != loaded_time) {
+		rules.clear();
+		if (modified_time) {
+			_parse_rules(FileAccess::get_file_as_string(path).split("\n"), rules);
+		}
+		loaded_time = modified_time;
+	}
+	return rules;
+}
+
+bool AIFileQuery::_is_excluded(const LocalVector<Rule> &p_rules, const String &p_relative_path, bool p_is_directory) {
+	// The last matching rule wins, as in .gitignore.
+	bool excluded = false;
+	const String name = p_relative_path.get_file();
+	for (const Rule &rule : p_rules) {
+		if (rule.negated != excluded || (rule.directory_only && !p_is_directory)) {
+			continue;
+		}
+		if (rule.anchored ? p_relative_path.match(rule.pattern) : name.match(rule.pattern)) {
+			excluded = !rule.negated;
+		}
+	}
+	return excluded;
+}
+
+bool AIFileQuery::_matches_name(const Query &p_query, const String &p_file, const String &p_relative_path) {
+	if (!p_query.extensions.is_empty() && !p_query.extensions.has(p_file.get_extension().to_lower())) {
+		return false;
+	}
+	if (p_query.patterns.is_empty()) {
+		return true;
+	}
+	for (const String &pattern : p_query.patterns) {
+		const String &subject = pattern.contains_char('/') ? p_relative_path : p_file;
+		if (pattern.contains_char('*') || pattern.contains_char('?')) {
+			if (p_query.case_sensitive ? subject.match(pattern) : subject.matchn(pattern)) {
+				return true;
+			}
+		} else if (p_query.case_sensitive ? subject.contains(pattern) : subject.containsn(pattern)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool _matches_type(const PackedStringArray &p_types, const StringName &p_type) {
+	if (p_types.is_empty()) {
+		return true;
+	}
+	for (const String &type : p_types) {
+		if (p_type == type || ClassDB::is_parent_class(p_type, type)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool _matches_size(const AIFileQuery::Query &p_query, AIFileQuery::Entry &r_entry) {
+	if (p_query.min_size < 0 && p_query.max_size < 0) {
+		return true;
+	}
+	// The only filter that needs the disk.
+	r_entry.size = FileAccess::get_size(r_entry.path);
+	return r_entry.size >= 0 && (p_query.min_size < 0 || r_entry.size >= p_query.min_size) && (p_query.max_size < 0 || r_entry.size <= p_query.max_size);
+}
+
+void AIFileQuery::_walk_memory(Walk &p_walk, EditorFileSystemDirectory *p_dir) {
+	const Query &query = *p_walk.query;
+	const String dir_path = p_dir->get_path();
+	for (int i = 0; i < p_dir->get_file_count(); i++) {
+		const String file = p_dir->get_file(i);
+		const String path = dir_path.path_join(file);
+		const String relative_path = _get_relative_path(path);
+		if (!_matches_name(query, file, relative_path) || _is_excluded(p_walk.rules, relative_path, false) || !_matches_type(query.types, p_dir->get_file_type(i))) {
+			continue;
+		}
+		Entry entry;
+		entry.path = path;
+		entry.type = p_dir->get_file_type(i);
+		if (_matches_size(query, entry)) {
+			p_walk.add(entry);
+		}
+	}
+
+	for (int i = 0; i < p_dir->get_subdir_count(); i++) {
+		EditorFileSystemDirectory *subdir = p_dir->get_subdir(i);
+		const String path = dir_path.path_join(subdir->get_name());
+		const String relative_path = _get_relative_path(path);
+		if (_is_excluded(p_walk.rules, relative_path, true)) {
+			continue;
+		}
+		if (query.include_directories && query.content.is_empty() && query.types.is_empty() && _matches_name(query, subdir->get_name(), relative_path)) {
+			Entry entry;
+			entry.path = path;
+			entry.is_directory = true;
+			p_walk.add(entry);
+		}
+		if (query.recursive) {
+			_walk_memory(p_walk, subdir);
+		}
+	}
+}
+
+void AIFileQuery::_walk_disk(Walk &p_walk, const String &p_dir) {
+	const Query &query = *p_walk.query;
+	Ref<DirAccess> dir = DirAccess::open(p_dir);
+	if (dir.is_null()) {
+		return;
+	}
+	const PackedStringArray files = dir->get_files();
+	const PackedStringArray directories = dir->get_directories();
+
+	for (const String &file : files) {
+		const String path = p_dir.path_join(file);
+		const String relative_path = _get_relative_path(path);
+		if (!_matches_name(query, file, relative_path) || _is_excluded(p_walk.rules, relative_path, false)) {
+			continue;
+		}
+		Entry entry;
+		entry.path = path;
+		if (!query.types.is_empty()) {
+			entry.type = ResourceLoader::get_resource_type(path);
+			if (!_matches_type(query.types, entry.type)) {
+				continue;
+			}
+		}
+		if (_matches_size(query, entry)) {
+			p_walk.add(entry);
+		}
+	}
+
+	for (const String &name : directories) {
+		const String path = p_dir.path_join(name);
+		const String relative_path = _get_relative_path(path);
+		if (name.begins_with(".") || _is_excluded(p_walk.rules, relative_path, true)) {
+			continue;
+		}
+		if (query.include_directories && query.content.is_empty() && query.types.is_empty() && _matches_name(query, name, relative_path)) {
+			Entry entry;
+			entry.path = path;
+			entry.is_directory = true;
+			p_walk.add(entry);
+		}
+		if (query.recursive) {
+			_walk_disk(p_walk, path);
+		}
+	}
+}
+
+struct ContentSearch {
+	const AIFileQuery::Query *query = nullptr;
+	LocalVector<AIFileQuery::Entry> *entries = nullptr;
+	CharString needle;
+	// Matching files the page needs, counting from the first candidate.
+	int needed = 0;
+
+	// Candidates finish in any order. The page is only known to be filled
+	// once `needed` matches lie in the prefix of finished candidates, as
+	// skipping is only safe for candidates after all of those.
+	enum {
+		CANDIDATE_PENDING,
+		CANDIDATE_SEARCHED,
+		CANDIDATE_MATCHED,
+	};
+	LocalVector<uint8_t> states;
+	BinaryMutex prefix_mutex;
+	uint32_t prefix = 0; // Candidates before this one are all finished.
+	int prefix_found = 0;
+	SafeFlag filled;
+
+	void finish(uint32_t p_index, bool p_matched) {
+		MutexLock lock(prefix_mutex);
+		states[p_index] = p_matched ? CANDIDATE_MATCHED : CANDIDATE_SEARCHED;
+		while (prefix < states.size() && states[prefix] != CANDIDATE_PENDING) {
+			prefix_found += states[prefix] == CANDIDATE_MATCHED;
+			prefix++;
+		}
+		if (prefix_found >= needed) {
+			filled.set();
+		}
+	}
+};
+
+static inline uint8_t _fold(uint8_t p_char) {
+	return (p_char >= 'A' && p_char <= 'Z') ? p_char + ('a' - 'A') : p_char;
+}
+
+void AIFileQuery::_search_file(void *p_userdata, uint32_t p_index) {
+	ContentSearch *search = static_cast<ContentSearch *>(p_userdata);
+	// Unfinished candidates all come after the filled prefix.
+	if (search->filled.is_set()) {
+		return;
+	}
+	Entry &entry = (*search->entries)[p_index];
+	Ref<FileAccess> file = FileAccess::open(entry.path, FileAccess::READ);
+	if (file.is_null() || file->get_length() > MAX_SEARCH_FILE_SIZE) {
+		search->finish(p_index, false);
+		return;
+	}
+	Vector<uint8_t> bytes;
+	bytes.resize(file->get_length());
+	bytes.resize(file->get_buffer(bytes.ptrw(), bytes.size()));
+	const uint8_t *data = bytes.ptr();
+	const int size = bytes.size();
+	if (memchr(data, 0, MIN(size, 8192))) {
+		search->finish(p_index, false);
+		return; // Binary.
+	}
+
+	const uint8_t *needle = (const uint8_t *)search->needle.get_data();
+	const int needle_length = search->needle.length();
+	const bool case_sensitive = search->query->case_sensitive;
+	int line = 1;
+	int line_start = 0;
+	int counted_to = 0;
+	for (int i = 0; i + needle_length <= size; i++) {
+		int j = 0;
+		if (case_sensitive) {
+			while (j < needle_length && data[i + j] == needle[j]) {
+				j++;
+			}
+		} else {
+			while (j < needle_length && _fold(data[i + j]) == needle[j]) {
+				j++;
+			}
+		}
+		if (j < needle_length) {
+			continue;
+		}
+
+		for (; counted_to < i; counted_to++) {
+			if (data[counted_to] == '\n') {
+				line++;
+				line_start = counted_to + 1;
+			}
+		}
+		const uint8_t *line_end = (const uint8_t *)memchr(data + i, '\n', size - i);
+		const int line_length = (line_end ? int(line_end - data) : size) - line_start;
+		Dictionary match;
+		match["line"] = line;
+		match["text"] = String::utf8((const char *)data + line_start, MIN(line_length, 240)).strip_edges();
+		entry.matches.push_back(match);
+		if (entry.matches.size() >= search->query->max_matches_per_file || !line_end) {
+			break;
+		}
+		// One match per line.
+		i = int(line_end - data);
+	}
+	search->finish(p_index, !entry.matches.is_empty());
+}
+
+Error AIFileQuery::execute(const Query &p_query, Result &r_result, String &r_error) {
+	ERR_FAIL_COND_V_MSG(!Thread::is_main_thread(), ERR_UNAVAILABLE, "File queries must run on the main thread.");
+
+	Walk walk;
+	walk.query = &p_query;
+	walk.collect_all = !p_query.content.is_empty();
+	if (p_query.respect_gitignore && p_query.root.begins_with("res://")) {
+		walk.rules = _get_gitignore_rules();
+	}
+	_parse_rules(p_query.excludes, walk.rules);
+
+	EditorFileSystem *efs = EditorFileSystem::get_singleton();
+	EditorFileSystemDirectory *root = nullptr;
+	if (efs && p_query.root.begins_with("res://")) {
+		root = p_query.root == "res://" ? efs->get_filesystem() : efs->get_filesystem_path(p_query.root);
+	}
+	if (root) {
+		r_result.from_memory = true;
+		_walk_memory(walk, root);
+	} else {
+		if (!DirAccess::dir_exists_absolute(p_query.root)) {
+			r_error = "Could not open directory: " + p_query.root;
+			return ERR_FILE_NOT_FOUND;
+		}
+		_walk_disk(walk, p_query.root);
+	}
+
+	if (!walk.collect_all) {
+		r_result.entries = walk.entries;
+		r_result.total = walk.total;
+		r_result.has_more = p_query.offset + int(walk.entries.size()) < walk.total;
+		return OK;
+	}
+
+	ContentSearch search;
+	search.query = &p_query;
+	search.entries = &walk.entries;
+	search.needle = p_query.case_sensitive ? p_query.content.utf8() : p_query.content.to_lower().utf8();
+	// One more than the page, to know whether there is a next one.
+	search.needed = p_query.offset + p_query.limit + 1;
+	search.states.resize_initialized(walk.entries.size());
+	if (!walk.entries.is_empty()) {
+		WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_native_group_task(&_search_file, &search, walk.entries.size(), -1, true, "AI file content search");
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+	}
+
+	int matched = 0;
+	for (Entry &entry : walk.entries) {
+		if (entry.matches.is_empty()) {
+			continue;
+		}
+		if (matched >= p_query.offset && matched < p_query.offset + p_query.limit) {
+			r_result.entries.push_back(entry);
+		}
+		matched++;
+	}
+	r_result.total = matched;
+	r_result.has_more = matched > p_query.offset + p_query.limit;
+	r_result.total_is_lower_bound = search.filled.is_set();
+	return OK;
+}
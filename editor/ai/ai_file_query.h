@@ -0,0 +1,125 @@
+/**************************************************************************/
+/*  ai_file_query.h                                                       */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/string/string_name.h"
+#include "core/string/ustring.h"
+#include "core/templates/local_vector.h"
+#include "core/variant/array.h"
+#include "core/variant/dictionary.h"
+#include "core/variant/variant.h"
+
+class EditorFileSystemDirectory;
+
+// Recursive, filtered file queries for list_project_files and
+// search_project_files.
+//
+// Paths under res:// are answered from the in-memory EditorFileSystem tree,
+// without touching the disk; other roots (or an editor that has not scanned
+// yet) fall back to DirAccess. Sizes are only stat'ed for queries that filter
+// on them. Content searches read the candidate files on the WorkerThreadPool
+// and skip the remaining files once every file before them has been searched
+// and enough of those match to fill the requested page.
+//
+// Must be called on the main thread, as the EditorFileSystem tree is only
+// stable there.
+class AIFileQuery {
+public:
+	static constexpr int DEFAULT_LIMIT = 500;
+	static constexpr int DEFAULT_MAX_MATCHES_PER_FILE = 5;
+	// Larger files are skipped by content searches.
+	static constexpr int64_t MAX_SEARCH_FILE_SIZE = 4 * 1024 * 1024;
+
+	struct Query {
+		String root = "res://";
+		bool recursive = true;
+		bool include_directories = false;
+		// Wildcards (`*`, `?`) match the file name, or the path relative to
+		// `root` when they contain a '/'. Plain words match a substring of the
+		// file name. A file matches if any pattern does.
+		PackedStringArray patterns;
+		bool case_sensitive = false;
+		// Lowercase, without the dot.
+		PackedStringArray extensions;
+		// Resource types; subclasses match too.
+		PackedStringArray types;
+		int64_t min_size = -1;
+		int64_t max_size = -1;
+		// gitignore-style rules: `dir/` matches directories only, a leading or
+		// inner '/' anchors to the project root, `!` re-includes.
+		PackedStringArray excludes;
+		bool respect_gitignore = true;
+		// Case follows `case_sensitive`.
+		String content;
+		int max_matches_per_file = DEFAULT_MAX_MATCHES_PER_FILE;
+		int offset = 0;
+		int limit = DEFAULT_LIMIT;
+	};
+
+	struct Entry {
+		String path;
+		StringName type;
+		bool is_directory = false;
+		int64_t size = -1;
+		// `line` and `text` of content matches.
+		Array matches;
+	};
+
+	struct Result {
+		LocalVector<Entry> entries;
+		// Exact unless a content search stopped early (`total_is_lower_bound`).
+		int total = 0;
+		bool total_is_lower_bound = false;
+		bool has_more = false;
+		bool from_memory = false;
+	};
+
+	static Query parse_query(const Dictionary &p_args);
+	static Error execute(const Query &p_query, Result &r_result, String &r_error);
+
+private:
+	struct Rule {
+		String pattern;
+		bool negated = false;
+		bool directory_only = false;
+		bool anchored = false;
+	};
+
+	struct Walk;
+
+	static void _parse_rules(const PackedStringArray &p_lines, LocalVector<Rule> &r_rules);
+	static const LocalVector<Rule> &_get_gitignore_rules();
+	static bool _is_excluded(const LocalVector<Rule> &p_rules, const String &p_relative_path, bool p_is_directory);
+	static bool _matches_name(const Query &p_query, const String &p_file, const String &p_relative_path);
+	static void _walk_memory(Walk &p_walk, EditorFileSystemDirectory *p_dir);
+	static void _walk_disk(Walk &p_walk, const String &p_dir);
+	static void _search_file(void *p_userdata, uint32_t p_index);
+};
@@ -0,0 +1,1067 @@
+/**************************************************************************/
+/*  ai_project_index.cpp                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ai_project_index.h"
+
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/string/char_utils.h"
+#include "core/templates/hash_set.h"
+#include "core/templates/hashfuncs.h"
+#include "core/templates/sort_array.h"
+#include "editor/file_system/editor_file_system.h"
+#include "editor/file_system/editor_paths.h"
+#include "scene/main/scene_tree.h"
+
+AIProjectIndex *AIProjectIndex::singleton = nullptr;
+
+static constexpr uint32_t INDEX_FILE_MAGIC = 0x58444941; // "AIDX"
+static constexpr uint32_t JOURNAL_FILE_MAGIC = 0x4A444941; // "AIDJ"
+static constexpr int UPDATE_SLICE_FILES = 64;
+
+enum JournalRecord : uint8_t {
+	JOURNAL_ADD = 1,
+	JOURNAL_REMOVE = 2,
+	JOURNAL_TOUCH = 3,
+};
+
+// Scoring weights. BM25 dominates; exact substring hits and vector similarity
+// mostly reorder results that already matched lexically.
+static constexpr float BM25_K1 = 1.2f;
+static constexpr float BM25_B = 0.75f;
+static constexpr float EXACT_MATCH_BONUS = 4.0f;
+static constexpr float VECTOR_WEIGHT = 2.0f;
+static constexpr float VECTOR_ONLY_THRESHOLD = 0.25f;
+static constexpr int SNIPPET_MAX_CHARS = 400;
+
+static _FORCE_INLINE_ char32_t _index_lower(char32_t p_char) {
+	return is_ascii_upper_case(p_char) ? p_char + ('a' - 'A') : p_char;
+}
+
+bool AIProjectIndex::_is_indexable_path(const String &p_path) {
+	if (p_path.begins_with("res://.godot/") || p_path.get_file().begins_with(".")) {
+		return false;
+	}
+	static const HashSet<String> extensions = {
+		"gd", "cs", "gdshader", "gdshaderinc", "shader", "glsl",
+		"tscn", "escn", "tres",
+		"json", "cfg", "ini", "md", "txt", "csv", "xml", "yml", "yaml", "toml"
+	};
+	return extensions.has(p_path.get_extension().to_lower());
+}
+
+String AIProjectIndex::get_modality(const String &p_path) {
+	const String ext = p_path.get_extension().to_lower();
+	if (ext == "gd" || ext == "cs" || ext == "gdshader" || ext == "gdshaderinc" || ext == "shader" || ext == "glsl") {
+		return "script";
+	}
+	if (ext == "tscn" || ext == "escn") {
+		return "scene";
+	}
+	if (ext == "tres") {
+		return "resource";
+	}
+	return "text";
+}
+
+void AIProjectIndex::_tokenize(const String &p_text, LocalVector<uint32_t> &r_tokens) {
+	const char32_t *src = p_text.ptr();
+	const int len = p_text.length();
+	int i = 0;
+	while (i < len) {
+		while (i < len && !is_unicode_identifier_continue(src[i])) {
+			i++;
+		}
+		const int word_start = i;
+		while (i < len && is_unicode_identifier_continue(src[i])) {
+			i++;
+		}
+		const int word_end = i;
+		if (word_end - word_start < 2) {
+			continue;
+		}
+
+		// Whole identifier, then its snake_case / camelCase / digit parts so that
+		// "player_health" and "PlayerHealth" both match a query for "health".
+		uint32_t word_hash = 5381;
+		for (int j = word_start; j < word_end; j++) {
+			word_hash = hash_djb2_one_32(_index_lower(src[j]), word_hash);
+		}
+		r_tokens.push_back(word_hash);
+
+		int part_start = word_start;
+		int part_count = 0;
+		LocalVector<uint32_t> parts;
+		for (int j = word_start; j <= word_end; j++) {
+			bool boundary = j == word_end || is_underscore(src[j]);
+			if (!boundary && j > part_start) {
+				const char32_t prev = src[j - 1];
+				const char32_t cur = src[j];
+				boundary = (is_ascii_upper_case(cur) && is_ascii_lower_case(prev)) || (is_digit(cur) != is_digit(prev));
+			}
+			if (!boundary) {
+				continue;
+			}
+			if (j - part_start >= 2) {
+				uint32_t part_hash = 5381;
+				for (int k = part_start; k < j; k++) {
+					part_hash = hash_djb2_one_32(_index_lower(src[k]), part_hash);
+				}
+				parts.push_back(part_hash);
+			}
+			part_count++;
+			part_start = (j < word_end && is_underscore(src[j])) ? j + 1 : j;
+		}
+		if (part_count > 1) {
+			for (uint32_t part_hash : parts) {
+				if (part_hash != word_hash) {
+					r_tokens.push_back(part_hash);
+				}
+			}
+		}
+	}
+}
+
+void AIProjectIndex::_collect_trigrams(const String &p_text, HashSet<uint32_t> &r_trigrams) {
+	const char32_t *src = p_text.ptr();
+	const int len = p_text.length();
+	for (int i = 0; i + 2 < len; i++) {
+		uint32_t h = hash_murmur3_one_32(_index_lower(src[i]));
+		h = hash_murmur3_one_32(_index_lower(src[i + 1]), h);
+		h = hash_murmur3_one_32(_index_lower(src[i + 2]), h);
+		r_trigrams.insert(hash_fmix32(h));
+	}
+}
+
+void AIProjectIndex::_compute_vector(const LocalVector<uint32_t> &p_tokens, float *r_vector) {
+	// Signed feature hashing of the token bag, L2-normalized so that a dot
+	// product is the cosine similarity.
+	for (int i = 0; i < VECTOR_DIMENSIONS; i++) {
+		r_vector[i] = 0.0f;
+	}
+	for (uint32_t token : p_tokens) {
+		const uint32_t h = hash_fmix32(token);
+		r_vector[h % VECTOR_DIMENSIONS] += (h & 0x80000000u) ? -1.0f : 1.0f;
+	}
+	float length_squared = 0.0f;
+	for (int i = 0; i < VECTOR_DIMENSIONS; i++) {
+		length_squared += r_vector[i] * r_vector[i];
+	}
+	if (length_squared > 0.0f) {
+		const float inv_length = 1.0f / Math::sqrt(length_squared);
+		for (int i = 0; i < VECTOR_DIMENSIONS; i++) {
+			r_vector[i] *= inv_length;
+		}
+	}
+}
+
+bool AIProjectIndex::_build_document(const String &p_path, uint64_t p_modified_time, const Vector<uint8_t> &p_bytes, FileDocument &r_document) {
+	String text;
+	if (text.append_utf8((const char *)p_bytes.ptr(), p_bytes.size()) != OK) {
+		// Binary or broken encoding, nothing useful to index.
+		return false;
+	}
+
+	r_document.path = p_path;
+	r_document.modified_time = p_modified_time;
+	r_document.size = p_bytes.size();
+	r_document.content_hash = hash_murmur3_buffer(p_bytes.ptr(), p_bytes.size());
+
+	const Vector<String> lines = text.split("\n");
+	const int line_count = lines.size();
+	const int step = CHUNK_LINES - CHUNK_OVERLAP_LINES;
+	for (int start = 0; start < line_count; start += step) {
+		const int end = MIN(start + CHUNK_LINES, line_count);
+		String chunk_text = String("\n").join(lines.slice(start, end));
+		if (!chunk_text.strip_edges().is_empty()) {
+			Chunk chunk;
+			chunk.start_line = start + 1;
+			chunk.end_line = end;
+			chunk.text = chunk_text;
+			r_document.chunks.push_back(chunk);
+		}
+		if (end == line_count) {
+			break;
+		}
+	}
+	_tokenize_document(r_document);
+	return true;
+}
+
+void AIProjectIndex::_tokenize_document(FileDocument &r_document) {
+	r_document.chunk_tokens.resize(r_document.chunks.size());
+	for (uint32_t i = 0; i < r_document.chunks.size(); i++) {
+		r_document.chunk_tokens[i].clear();
+		_tokenize(r_document.chunks[i].text, r_document.chunk_tokens[i]);
+	}
+}
+
+void AIProjectIndex::_walk_filesystem(EditorFileSystemDirectory *p_dir, HashMap<String, uint64_t> &r_seen) const {
+	if (!p_dir) {
+		return;
+	}
+	for (int i = 0; i < p_dir->get_file_count(); i++) {
+		const String path = p_dir->get_file_path(i);
+		if (_is_indexable_path(path)) {
+			r_seen[path] = p_dir->get_file_modified_time(i);
+		}
+	}
+	for (int i = 0; i < p_dir->get_subdir_count(); i++) {
+		_walk_filesystem(p_dir->get_subdir(i), r_seen);
+	}
+}
+
+void AIProjectIndex::_remove_file_locked(const String &p_path) {
+	const uint32_t *file_id = file_map.getptr(p_path);
+	if (!file_id) {
+		return;
+	}
+	FileEntry &entry = files[*file_id];
+	for (uint32_t chunk_id : entry.chunks) {
+		// Postings keep pointing at dead chunks until the next compaction and
+		// are skipped by the search.
+		Chunk &chunk = chunks[chunk_id];
+		total_token_count -= chunk.token_count;
+		chunk.file = INVALID_FILE;
+		chunk.text = String();
+		live_chunk_count--;
+	}
+	entry = FileEntry();
+	free_files.push_back(*file_id);
+	file_map.erase(p_path);
+}
+
+void AIProjectIndex::_index_chunk_locked(uint32_t p_chunk_id, const LocalVector<uint32_t> &p_tokens) {
+	HashMap<uint32_t, uint32_t> frequencies;
+	for (uint32_t token : p_tokens) {
+		uint32_t *frequency = frequencies.getptr(token);
+		if (frequency) {
+			(*frequency)++;
+		} else {
+			frequencies.insert(token, 1);
+		}
+	}
+	for (const KeyValue<uint32_t, uint32_t> &E : frequencies) {
+		Posting posting;
+		posting.chunk = p_chunk_id;
+		posting.frequency = E.value;
+		token_postings[E.key].push_back(posting);
+	}
+
+	HashSet<uint32_t> trigrams;
+	_collect_trigrams(chunks[p_chunk_id].text, trigrams);
+	for (uint32_t trigram : trigrams) {
+		trigram_postings[trigram].push_back(p_chunk_id);
+	}
+
+	chunks[p_chunk_id].token_count = p_tokens.size();
+	total_token_count += p_tokens.size();
+	live_chunk_count++;
+
+	vectors.resize((p_chunk_id + 1) * VECTOR_DIMENSIONS);
+	_compute_vector(p_tokens, &vectors[p_chunk_id * VECTOR_DIMENSIONS]);
+}
+
+void AIProjectIndex::_add_document_locked(FileDocument &p_document) {
+	_remove_file_locked(p_document.path);
+
+	uint32_t file_id;
+	if (free_files.is_empty()) {
+		file_id = files.size();
+		files.push_back(FileEntry());
+	} else {
+		file_id = free_files[free_files.size() - 1];
+		free_files.resize(free_files.size() - 1);
+	}
+
+	FileEntry &entry = files[file_id];
+	entry.path = p_document.path;
+	entry.modified_time = p_document.modified_time;
+	entry.size = p_document.size;
+	entry.content_hash = p_document.content_hash;
+	file_map.insert(entry.path, file_id);
+
+	// Tokens were computed with the document, outside of the lock.
+	for (uint32_t i = 0; i < p_document.chunks.size(); i++) {
+		Chunk &chunk = p_document.chunks[i];
+		const uint32_t chunk_id = chunks.size();
+		chunk.file = file_id;
+		chunks.push_back(chunk);
+		entry.chunks.push_back(chunk_id);
+		_index_chunk_locked(chunk_id, p_document.chunk_tokens[i]);
+	}
+}
+
+void AIProjectIndex::_compact_locked() {
+	// Rebuild chunk storage and postings from live chunks only. Chunk ids are
+	// reassigned in increasing order so posting lists stay sorted.
+	LocalVector<Chunk> old_chunks = chunks;
+	chunks.clear();
+	vectors.clear();
+	token_postings.clear();
+	trigram_postings.clear();
+	live_chunk_count = 0;
+	total_token_count = 0;
+
+	for (FileEntry &entry : files) {
+		entry.chunks.clear();
+	}
+
+	LocalVector<uint32_t> tokens;
+	for (Chunk &chunk : old_chunks) {
+		if (chunk.file == INVALID_FILE) {
+			continue;
+		}
+		const uint32_t chunk_id = chunks.size();
+		chunks.push_back(chunk);
+		files[chunk.file].chunks.push_back(chunk_id);
+
+		tokens.clear();
+		_tokenize(chunk.text, tokens);
+		_index_chunk_locked(chunk_id, tokens);
+	}
+}
+
+void AIProjectIndex::_store_document(const Ref<FileAccess> &p_file, const FileDocument &p_document) {
+	p_file->store_pascal_string(p_document.path);
+	p_file->store_64(p_document.modified_time);
+	p_file->store_64(p_document.size);
+	p_file->store_32(p_document.content_hash);
+	p_file->store_32(p_document.chunks.size());
+	for (const Chunk &chunk : p_document.chunks) {
+		p_file->store_32(chunk.start_line);
+		p_file->store_32(chunk.end_line);
+		p_file->store_pascal_string(chunk.text);
+	}
+}
+
+void AIProjectIndex::_read_document(const Ref<FileAccess> &p_file, FileDocument &r_document) {
+	r_document.path = p_file->get_pascal_string();
+	r_document.modified_time = p_file->get_64();
+	r_document.size = p_file->get_64();
+	r_document.content_hash = p_file->get_32();
+	const uint32_t chunk_count = p_file->get_32();
+	for (uint32_t i = 0; i < chunk_count && !p_file->eof_reached(); i++) {
+		Chunk chunk;
+		chunk.start_line = p_file->get_32();
+		chunk.end_line = p_file->get_32();
+		chunk.text = p_file->get_pascal_string();
+		r_document.chunks.push_back(chunk);
+	}
+}
+
+Error AIProjectIndex::_save_snapshot() {
+	ERR_FAIL_COND_V(index_dir.is_empty(), ERR_UNCONFIGURED);
+
+	const String index_path = index_dir.path_join("index.bin");
+
+	// Chunk texts are shared, so copying them out is cheap and the file is
+	// written without holding the lock.
+	LocalVector<FileDocument> documents;
+	{
+		RWLockRead read_lock(lock);
+		documents.reserve(file_map.size());
+		for (const KeyValue<String, uint32_t> &E : file_map) {
+			const FileEntry &entry = files[E.value];
+			documents.push_back(FileDocument());
+			FileDocument &document = documents[documents.size() - 1];
+			document.path = entry.path;
+			document.modified_time = entry.modified_time;
+			document.size = entry.size;
+			document.content_hash = entry.content_hash;
+			for (uint32_t chunk_id : entry.chunks) {
+				document.chunks.push_back(chunks[chunk_id]);
+			}
+		}
+	}
+
+	Ref<FileAccess> f = FileAccess::open(index_path + ".tmp", FileAccess::WRITE);
+	ERR_FAIL_COND_V(f.is_null(), ERR_CANT_CREATE);
+	f->store_32(INDEX_FILE_MAGIC);
+	f->store_32(INDEX_FORMAT_VERSION);
+	f->store_32(documents.size());
+	for (const FileDocument &document : documents) {
+		_store_document(f, document);
+	}
+	const uint64_t size = f->get_position();
+	f.unref();
+
+	Ref<DirAccess> da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	const Error err = da->rename(index_path + ".tmp", index_path);
+	if (err != OK) {
+		return err;
+	}
+	snapshot_size = size;
+	// Replaying it over the new snapshot would be harmless, so a failure to
+	// remove it only costs time on the next load.
+	const String journal_path = index_dir.path_join("journal.bin");
+	if (FileAccess::exists(journal_path)) {
+		da->remove(journal_path);
+	}
+	journal_size = 0;
+	return OK;
+}
+
+Error AIProjectIndex::_append_to_journal(const LocalVector<FileDocument> &p_added, const LocalVector<Pair<String, uint64_t>> &p_touched, const LocalVector<String> &p_removed) {
+	ERR_FAIL_COND_V(index_dir.is_empty(), ERR_UNCONFIGURED);
+
+	const String journal_path = index_dir.path_join("journal.bin");
+	Ref<FileAccess> f;
+	if (journal_size > 0) {
+		f = FileAccess::open(journal_path, FileAccess::READ_WRITE);
+		ERR_FAIL_COND_V(f.is_null(), ERR_CANT_OPEN);
+		// Anything past the last complete record was torn by an interrupted write.
+		f->seek(journal_size);
+	} else {
+		f = FileAccess::open(journal_path, FileAccess::WRITE);
+		ERR_FAIL_COND_V(f.is_null(), ERR_CANT_CREATE);
+		f->store_32(JOURNAL_FILE_MAGIC);
+		f->store_32(INDEX_FORMAT_VERSION);
+	}
+
+	// Records replace what they name, so replaying them in order is enough.
+	for (const String &path : p_removed) {
+		f->store_8(JOURNAL_REMOVE);
+		f->store_pascal_string(path);
+	}
+	for (const Pair<String, uint64_t> &E : p_touched) {
+		f->store_8(JOURNAL_TOUCH);
+		f->store_pascal_string(E.first);
+		f->store_64(E.second);
+	}
+	for (const FileDocument &document : p_added) {
+		f->store_8(JOURNAL_ADD);
+		_store_document(f, document);
+	}
+	journal_size = f->get_position();
+	return OK;
+}
+
+Error AIProjectIndex::_load_from_disk(LocalVector<FileDocument> &r_documents, bool &r_compact) {
+	const String index_path = index_dir.path_join("index.bin");
+	const String journal_path = index_dir.path_join("journal.bin");
+	r_compact = false;
+	if (!FileAccess::exists(index_path)) {
+		// Only meaningful on top of the snapshot it was written against.
+		if (FileAccess::exists(journal_path)) {
+			DirAccess::remove_absolute(journal_path);
+		}
+		return ERR_FILE_NOT_FOUND;
+	}
+
+	Ref<FileAccess> f = FileAccess::open(index_path, FileAccess::READ);
+	ERR_FAIL_COND_V(f.is_null(), ERR_CANT_OPEN);
+	if (f->get_32() != INDEX_FILE_MAGIC || f->get_32() != INDEX_FORMAT_VERSION) {
+		return ERR_FILE_UNRECOGNIZED;
+	}
+
+	// Vectors are derived from the tokens, so only the chunks are stored;
+	// tokenizing dominates rebuilding either way.
+	HashMap<String, uint32_t> document_map;
+	const uint32_t file_count = f->get_32();
+	for (uint32_t i = 0; i < file_count; i++) {
+		FileDocument document;
+		_read_document(f, document);
+		if (f->eof_reached()) {
+			return ERR_FILE_CORRUPT;
+		}
+		document_map.insert(document.path, r_documents.size());
+		r_documents.push_back(document);
+	}
+	snapshot_size = f->get_position();
+	f.unref();
+
+	journal_size = 0;
+	f = FileAccess::open(journal_path, FileAccess::READ);
+	if (f.is_valid() && f->get_32() == JOURNAL_FILE_MAGIC && f->get_32() == INDEX_FORMAT_VERSION) {
+		journal_size = f->get_position();
+		while (f->get_position() < f->get_length()) {
+			const uint8_t type = f->get_8();
+			FileDocument document;
+			uint64_t modified_time = 0;
+			if (type == JOURNAL_ADD) {
+				_read_document(f, document);
+			} else if (type == JOURNAL_REMOVE || type == JOURNAL_TOUCH) {
+				document.path = f->get_pascal_string();
+				modified_time = type == JOURNAL_TOUCH ? f->get_64() : 0;
+			} else {
+				break;
+			}
+			if (f->eof_reached()) {
+				break;
+			}
+			journal_size = f->get_position();
+
+			const uint32_t *index = document_map.getptr(document.path);
+			if (type == JOURNAL_ADD) {
+				if (index) {
+					r_documents[*index] = document;
+				} else {
+					document_map.insert(document.path, r_documents.size());
+					r_documents.push_back(document);
+				}
+			} else if (index && type == JOURNAL_TOUCH) {
+				r_documents[*index].modified_time = modified_time;
+			} else if (index) {
+				// Left empty and dropped below.
+				r_documents[*index] = FileDocument();
+				document_map.erase(document.path);
+			}
+		}
+		if (journal_size < f->get_length()) {
+			// Torn by an interrupted write; start over from a clean snapshot.
+			r_compact = true;
+		}
+	} else if (f.is_valid()) {
+		r_compact = true;
+	}
+
+	LocalVector<FileDocument> live;
+	live.reserve(document_map.size());
+	for (FileDocument &document : r_documents) {
+		if (!document.path.is_empty()) {
+			_tokenize_document(document);
+			live.push_back(document);
+		}
+	}
+	r_documents = live;
+	r_compact = r_compact || journal_size > MAX(MIN_JOURNAL_COMPACT_SIZE, snapshot_size / 2);
+	return OK;
+}
+
+void AIProjectIndex::_merge_documents(LocalVector<FileDocument> &p_documents) {
+	// Merged in slices so concurrent searches are never blocked for long.
+	for (uint32_t slice_start = 0; slice_start < p_documents.size(); slice_start += UPDATE_SLICE_FILES) {
+		const uint32_t slice_end = MIN(slice_start + UPDATE_SLICE_FILES, p_documents.size());
+		RWLockWrite write_lock(lock);
+		for (uint32_t i = slice_start; i < slice_end; i++) {
+			_add_document_locked(p_documents[i]);
+		}
+	}
+}
+
+void AIProjectIndex::_load_task_func() {
+	LocalVector<FileDocument> documents;
+	bool compact = false;
+	const Error err = _load_from_disk(documents, compact);
+	if (err == OK) {
+		_merge_documents(documents);
+		print_verbose(vformat("AIProjectIndex: Loaded %d files (%d chunks) from %s.", documents.size(), live_chunk_count, index_dir));
+		if (compact && _save_snapshot() != OK) {
+			WARN_PRINT(vformat("AIProjectIndex: Failed to save the index to %s.", index_dir));
+		}
+	} else if (err != ERR_FILE_NOT_FOUND) {
+		WARN_PRINT(vformat("AIProjectIndex: Ignoring unreadable index in %s, rebuilding.", index_dir));
+	}
+
+	// Written by earlier versions of the index.
+	const String vectors_path = index_dir.path_join("vectors.bin");
+	if (FileAccess::exists(vectors_path)) {
+		DirAccess::remove_absolute(vectors_path);
+	}
+
+	callable_mp(this, &AIProjectIndex::_update_finished).call_deferred();
+}
+
+void AIProjectIndex::_schedule_update() {
+	if (!started) {
+		return;
+	}
+	if (update_running) {
+		rescan_pending = true;
+		return;
+	}
+
+	EditorFileSystem *efs = EditorFileSystem::get_singleton();
+	if (!efs || efs->is_scanning()) {
+		// filesystem_changed fires again once the scan completes.
+		return;
+	}
+
+	bool walk = false;
+	if (walk_pending) {
+		const uint64_t now = OS::get_singleton()->get_ticks_msec();
+		if (last_walk_msec == 0 || now - last_walk_msec >= WALK_INTERVAL_MSEC) {
+			walk = true;
+			walk_pending = false;
+			last_walk_msec = now;
+		} else if (!walk_timer_queued) {
+			// Coalesces bursts of signals, such as one per saved file, into one walk.
+			walk_timer_queued = true;
+			SceneTree::get_singleton()->create_timer((WALK_INTERVAL_MSEC - (now - last_walk_msec)) / 1000.0)->connect("timeout", callable_mp(this, &AIProjectIndex::_on_walk_timeout));
+		}
+	}
+
+	UpdateBatch *batch = memnew(UpdateBatch);
+	if (walk) {
+		HashMap<String, uint64_t> seen;
+		_walk_filesystem(efs->get_filesystem(), seen);
+
+		RWLockRead read_lock(lock);
+		for (const KeyValue<String, uint64_t> &E : seen) {
+			const uint32_t *file_id = file_map.getptr(E.key);
+			if (!file_id || files[*file_id].modified_time != E.value || dirty_files.has(E.key)) {
+				batch->changed.push_back(E.key);
+				batch->changed_times.push_back(E.value);
+			}
+		}
+		for (const KeyValue<String, uint32_t> &E : file_map) {
+			if (!seen.has(E.key)) {
+				batch->removed.push_back(E.key);
+			}
+		}
+	} else {
+		// Only the paths the signals named.
+		RWLockRead read_lock(lock);
+		for (const String &path : dirty_files) {
+			if (FileAccess::exists(path)) {
+				batch->changed.push_back(path);
+				batch->changed_times.push_back(FileAccess::get_modified_time(path));
+			} else if (file_map.has(path)) {
+				batch->removed.push_back(path);
+			}
+		}
+	}
+	dirty_files.clear();
+
+	if (batch->changed.is_empty() && batch->removed.is_empty()) {
+		memdelete(batch);
+		return;
+	}
+
+	update_running = true;
+	update_task = WorkerThreadPool::get_singleton()->add_template_task(this, &AIProjectIndex::_update_task_func, batch, false, SNAME("AIProjectIndex::update"));
+}
+
+void AIProjectIndex::_update_task_func(UpdateBatch *p_batch) {
+	uint64_t start_ticks = OS::get_singleton()->get_ticks_usec();
+	int reindexed = 0;
+	// What changed, for the journal.
+	LocalVector<FileDocument> added;
+	LocalVector<Pair<String, uint64_t>> touched;
+	LocalVector<String> removed;
+	for (const String &path : p_batch->removed) {
+		removed.push_back(path);
+	}
+
+	if (!p_batch->removed.is_empty()) {
+		RWLockWrite write_lock(lock);
+		for (const String &path : p_batch->removed) {
+			_remove_file_locked(path);
+		}
+	}
+
+	// Files are read and chunked outside of the lock, then merged in slices so
+	// concurrent searches are never blocked for long.
+	for (int slice_start = 0; slice_start < p_batch->changed.size(); slice_start += UPDATE_SLICE_FILES) {
+		const int slice_end = MIN(slice_start + UPDATE_SLICE_FILES, p_batch->changed.size());
+		LocalVector<FileDocument> documents;
+		const uint32_t touched_start = touched.size();
+		LocalVector<String> unreadable;
+
+		for (int i = slice_start; i < slice_end; i++) {
+			const String &path = p_batch->changed[i];
+			const uint64_t modified_time = p_batch->changed_times[i];
+
+			Ref<FileAccess> f = FileAccess::open(path, FileAccess::READ);
+			if (f.is_null() || f->get_length() > (uint64_t)MAX_INDEXED_FILE_SIZE) {
+				unreadable.push_back(path);
+				continue;
+			}
+			const Vector<uint8_t> bytes = f->get_buffer(f->get_length());
+			f.unref();
+
+			const uint32_t content_hash = hash_murmur3_buffer(bytes.ptr(), bytes.size());
+			bool unchanged = false;
+			{
+				RWLockRead read_lock(lock);
+				const uint32_t *file_id = file_map.getptr(path);
+				unchanged = file_id && files[*file_id].content_hash == content_hash && files[*file_id].size == (uint64_t)bytes.size();
+			}
+			if (unchanged) {
+				// Touched but identical (e.g. re-saved without edits).
+				touched.push_back(Pair<String, uint64_t>(path, modified_time));
+				continue;
+			}
+
+			FileDocument document;
+			if (_build_document(path, modified_time, bytes, document)) {
+				documents.push_back(document);
+			} else {
+				unreadable.push_back(path);
+			}
+		}
+
+		{
+			RWLockWrite write_lock(lock);
+			for (uint32_t i = touched_start; i < touched.size(); i++) {
+				const uint32_t *file_id = file_map.getptr(touched[i].first);
+				if (file_id) {
+					files[*file_id].modified_time = touched[i].second;
+				}
+			}
+			for (const String &path : unreadable) {
+				_remove_file_locked(path);
+			}
+			for (FileDocument &document : documents) {
+				_add_document_locked(document);
+				reindexed++;
+			}
+		}
+		for (const String &path : unreadable) {
+			removed.push_back(path);
+		}
+		for (FileDocument &document : documents) {
+			// Only the chunks are journaled.
+			document.chunk_tokens.clear();
+			added.push_back(document);
+		}
+	}
+
+	{
+		RWLockWrite write_lock(lock);
+		const uint32_t dead_chunks = chunks.size() - live_chunk_count;
+		if (dead_chunks > 4096 && dead_chunks > live_chunk_count) {
+			_compact_locked();
+		}
+	}
+
+	// Appending is proportional to the change; the snapshot is only rewritten
+	// once the journal outweighs it.
+	Error err = OK;
+	if (snapshot_size > 0) {
+		err = _append_to_journal(added, touched, removed);
+	}
+	if (err != OK || snapshot_size == 0 || journal_size > MAX(MIN_JOURNAL_COMPACT_SIZE, snapshot_size / 2)) {
+		err = _save_snapshot();
+	}
+	if (err != OK) {
+		WARN_PRINT(vformat("AIProjectIndex: Failed to save the index to %s.", index_dir));
+	}
+
+	print_verbose(vformat("AIProjectIndex: Reindexed %d file(s), removed %d in %d ms.", reindexed, p_batch->removed.size(), (OS::get_singleton()->get_ticks_usec() - start_ticks) / 1000));
+
+	memdelete(p_batch);
+	callable_mp(this, &AIProjectIndex::_update_finished).call_deferred();
+}
+
+void AIProjectIndex::_update_finished() {
+	if (update_task != WorkerThreadPool::INVALID_TASK_ID) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(update_task);
+		update_task = WorkerThreadPool::INVALID_TASK_ID;
+	}
+	update_running = false;
+	if (rescan_pending || !dirty_files.is_empty()) {
+		rescan_pending = false;
+		_schedule_update();
+	}
+}
+
+void AIProjectIndex::_on_filesystem_changed() {
+	walk_pending = true;
+	_schedule_update();
+}
+
+void AIProjectIndex::_on_walk_timeout() {
+	walk_timer_queued = false;
+	_schedule_update();
+}
+
+void AIProjectIndex::_on_resources_reimported(const PackedStringArray &p_resources) {
+	for (const String &path : p_resources) {
+		if (_is_indexable_path(path)) {
+			dirty_files.insert(path);
+		}
+	}
+	_schedule_update();
+}
+
+void AIProjectIndex::_on_sources_changed(bool p_exist) {
+	if (p_exist) {
+		walk_pending = true;
+		_schedule_update();
+	}
+}
+
+void AIProjectIndex::mark_file_dirty(const String &p_path) {
+	if (!_is_indexable_path(p_path)) {
+		return;
+	}
+	dirty_files.insert(p_path);
+	_schedule_update();
+}
+
+void AIProjectIndex::start() {
+	if (started) {
+		return;
+	}
+	started = true;
+
+	index_dir = EditorPaths::get_singleton()->get_project_data_dir().path_join("ai_index");
+	if (!DirAccess::dir_exists_absolute(index_dir)) {
+		DirAccess::make_dir_recursive_absolute(index_dir);
+	}
+
+	EditorFileSystem *efs = EditorFileSystem::get_singleton();
+	ERR_FAIL_NULL(efs);
+	efs->connect("filesystem_changed", callable_mp(this, &AIProjectIndex::_on_filesystem_changed));
+	efs->connect("resources_reimported", callable_mp(this, &AIProjectIndex::_on_resources_reimported));
+	efs->connect("sources_changed", callable_mp(this, &AIProjectIndex::_on_sources_changed));
+
+	// Changes reported while loading are picked up by the scan that follows it.
+	update_running = true;
+	rescan_pending = true;
+	walk_pending = true;
+	update_task = WorkerThreadPool::get_singleton()->add_task(callable_mp(this, &AIProjectIndex::_load_task_func), false, "AIProjectIndex::load");
+}
+
+void AIProjectIndex::stop() {
+	if (!started) {
+		return;
+	}
+	started = false;
+
+	EditorFileSystem *efs = EditorFileSystem::get_singleton();
+	if (efs) {
+		efs->disconnect("filesystem_changed", callable_mp(this, &AIProjectIndex::_on_filesystem_changed));
+		efs->disconnect("resources_reimported", callable_mp(this, &AIProjectIndex::_on_resources_reimported));
+		efs->disconnect("sources_changed", callable_mp(this, &AIProjectIndex::_on_sources_changed));
+	}
+
+	if (update_task != WorkerThreadPool::INVALID_TASK_ID) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(update_task);
+		update_task = WorkerThreadPool::INVALID_TASK_ID;
+	}
+	update_running = false;
+}
+
+bool AIProjectIndex::is_ready() const {
+	RWLockRead read_lock(lock);
+	return started && !file_map.is_empty();
+}
+
+Dictionary AIProjectIndex::get_stats() const {
+	RWLockRead read_lock(lock);
+	Dictionary stats;
+	stats["files"] = file_map.size();
+	stats["chunks"] = live_chunk_count;
+	stats["tokens"] = token_postings.size();
+	stats["trigrams"] = trigram_postings.size();
+	stats["updating"] = update_running;
+	return stats;
+}
+
+Array AIProjectIndex::search(const String &p_query, int p_max_results, const String &p_modality_filter) const {
+	struct ScoredFile {
+		uint32_t file = 0;
+		uint32_t best_chunk = 0;
+		float best_score = 0.0f;
+		int matching_chunks = 0;
+		float score = 0.0f;
+
+		bool operator<(const ScoredFile &p_other) const { return score > p_other.score; }
+	};
+
+	Array results;
+	const String needle = p_query.strip_edges();
+	if (needle.is_empty() || p_max_results <= 0) {
+		return results;
+	}
+
+	LocalVector<uint32_t> query_tokens;
+	_tokenize(needle, query_tokens);
+	HashSet<uint32_t> unique_tokens;
+	for (uint32_t token : query_tokens) {
+		unique_tokens.insert(token);
+	}
+
+	RWLockRead read_lock(lock);
+	if (live_chunk_count == 0) {
+		return results;
+	}
+
+	HashMap<uint32_t, float> chunk_scores;
+	const float chunk_total = live_chunk_count;
+	const float average_length = MAX(1.0f, (float)total_token_count / chunk_total);
+
+	// Lexical pass (BM25 over chunks).
+	for (uint32_t token : unique_tokens) {
+		const LocalVector<Posting> *postings = token_postings.getptr(token);
+		if (!postings) {
+			continue;
+		}
+		const float document_frequency = postings->size();
+		const float idf = Math::log(1.0f + (chunk_total - document_frequency + 0.5f) / (document_frequency + 0.5f));
+		for (const Posting &posting : *postings) {
+			const Chunk &chunk = chunks[posting.chunk];
+			if (chunk.file == INVALID_FILE) {
+				continue;
+			}
+			const float tf = posting.frequency;
+			const float norm = BM25_K1 * (1.0f - BM25_B + BM25_B * chunk.token_count / average_length);
+			chunk_scores[posting.chunk] += idf * tf * (BM25_K1 + 1.0f) / (tf + norm);
+		}
+	}
+
+	// Exact substring pass: intersect the (sorted) trigram posting lists,
+	// smallest first, then verify candidates against the chunk text.
+	if (needle.length() >= 3) {
+		HashSet<uint32_t> trigrams;
+		_collect_trigrams(needle, trigrams);
+		LocalVector<const LocalVector<uint32_t> *> lists;
+		bool missing = false;
+		for (uint32_t trigram : trigrams) {
+			const LocalVector<uint32_t> *list = trigram_postings.getptr(trigram);
+			if (!list) {
+				missing = true;
+				break;
+			}
+			lists.push_back(list);
+		}
+		if (!missing && !lists.is_empty()) {
+			struct ListSizeCompare {
+				bool operator()(const LocalVector<uint32_t> *p_a, const LocalVector<uint32_t> *p_b) const { return p_a->size() < p_b->size(); }
+			};
+			SortArray<const LocalVector<uint32_t> *, ListSizeCompare> sorter;
+			sorter.sort(lists.ptr(), lists.size());
+
+			LocalVector<uint32_t> candidates = *lists[0];
+			for (uint32_t l = 1; l < lists.size() && !candidates.is_empty(); l++) {
+				const LocalVector<uint32_t> &other = *lists[l];
+				LocalVector<uint32_t> merged;
+				uint32_t a = 0;
+				uint32_t b = 0;
+				while (a < candidates.size() && b < other.size()) {
+					if (candidates[a] < other[b]) {
+						a++;
+					} else if (other[b] < candidates[a]) {
+						b++;
+					} else {
+						merged.push_back(candidates[a]);
+						a++;
+						b++;
+					}
+				}
+				candidates = merged;
+			}
+			for (uint32_t chunk_id : candidates) {
+				const Chunk &chunk = chunks[chunk_id];
+				if (chunk.file != INVALID_FILE && chunk.text.findn(needle) != -1) {
+					chunk_scores[chunk_id] += EXACT_MATCH_BONUS;
+				}
+			}
+		}
+	}
+
+	// Vector pass: re-rank lexical candidates, or fall back to a full scan of
+	// the vector store when nothing matched lexically.
+	float query_vector[VECTOR_DIMENSIONS];
+	_compute_vector(query_tokens, query_vector);
+	if (chunk_scores.is_empty()) {
+		for (uint32_t chunk_id = 0; chunk_id < chunks.size(); chunk_id++) {
+			if (chunks[chunk_id].file == INVALID_FILE) {
+				continue;
+			}
+			const float *v = &vectors[chunk_id * VECTOR_DIMENSIONS];
+			float similarity = 0.0f;
+			for (int d = 0; d < VECTOR_DIMENSIONS; d++) {
+				similarity += v[d] * query_vector[d];
+			}
+			if (similarity >= VECTOR_ONLY_THRESHOLD) {
+				chunk_scores.insert(chunk_id, similarity * VECTOR_WEIGHT);
+			}
+		}
+	} else {
+		for (KeyValue<uint32_t, float> &E : chunk_scores) {
+			const float *v = &vectors[E.key * VECTOR_DIMENSIONS];
+			float similarity = 0.0f;
+			for (int d = 0; d < VECTOR_DIMENSIONS; d++) {
+				similarity += v[d] * query_vector[d];
+			}
+			E.value += MAX(0.0f, similarity) * VECTOR_WEIGHT;
+		}
+	}
+
+	// Aggregate per file: best chunk wins, extra matching chunks add a little.
+	HashMap<uint32_t, ScoredFile> per_file;
+	for (const KeyValue<uint32_t, float> &E : chunk_scores) {
+		const uint32_t file_id = chunks[E.key].file;
+		if (!p_modality_filter.is_empty() && get_modality(files[file_id].path) != p_modality_filter) {
+			continue;
+		}
+		ScoredFile *scored = per_file.getptr(file_id);
+		if (!scored) {
+			ScoredFile new_scored;
+			new_scored.file = file_id;
+			scored = &per_file.insert(file_id, new_scored)->value;
+		}
+		scored->matching_chunks++;
+		if (E.value > scored->best_score) {
+			scored->best_score = E.value;
+			scored->best_chunk = E.key;
+		}
+	}
+
+	LocalVector<ScoredFile> ranked;
+	ranked.reserve(per_file.size());
+	for (KeyValue<uint32_t, ScoredFile> &E : per_file) {
+		E.value.score = E.value.best_score * (1.0f + 0.1f * Math::log((float)E.value.matching_chunks));
+		ranked.push_back(E.value);
+	}
+	ranked.sort();
+
+	for (uint32_t i = 0; i < ranked.size() && (int)i < p_max_results; i++) {
+		const ScoredFile &scored = ranked[i];
+		const Chunk &chunk = chunks[scored.best_chunk];
+		const String &path = files[scored.file].path;
+
+		Dictionary entry;
+		entry["file_path"] = path;
+		entry["score"] = scored.score;
+		entry["start_line"] = chunk.start_line;
+		entry["end_line"] = chunk.end_line;
+		entry["snippet"] = chunk.text.length() > SNIPPET_MAX_CHARS ? chunk.text.substr(0, SNIPPET_MAX_CHARS) + "..." : chunk.text;
+		entry["modality"] = get_modality(path);
+		results.push_back(entry);
+	}
+	return results;
+}
+
+AIProjectIndex::AIProjectIndex() {
+	ERR_FAIL_COND(singleton != nullptr);
+	singleton = this;
+}
+
+AIProjectIndex::~AIProjectIndex() {
+	stop();
+	if (singleton == this) {
+		singleton = nullptr;
+	}
+}
@@ -0,0 +1,201 @@
+/**************************************************************************/
+/*  ai_project_index.h                                                    */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/io/file_access.h"
+#include "core/object/object.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/rw_lock.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/hash_set.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/pair.h"
+#include "core/variant/dictionary.h"
+
+class EditorFileSystemDirectory;
+
+// Local, on-disk index of the project's text files used to answer
+// search_across_project without a backend round-trip.
+//
+// Files are split into overlapping line chunks. Each chunk is indexed in a
+// token inverted index (BM25 scoring), a trigram index (exact substring
+// matches) and a small hashed-feature vector store (similarity re-ranking).
+// The chunks are saved under `.godot/ai_index/`; postings and vectors are
+// rebuilt from them when loading. Updates are appended to a journal next to
+// the snapshot, which is only rewritten once the journal has grown past half
+// its size. Loading and incremental updates from EditorFileSystem change
+// signals run on the WorkerThreadPool. Signals that name their files only
+// update those; the others diff the whole EditorFileSystem tree, at most once
+// per WALK_INTERVAL_MSEC.
+class AIProjectIndex : public Object {
+	GDCLASS(AIProjectIndex, Object);
+
+public:
+	static constexpr int VECTOR_DIMENSIONS = 128;
+
+private:
+	static constexpr uint32_t INDEX_FORMAT_VERSION = 1;
+	static constexpr int CHUNK_LINES = 48;
+	static constexpr int CHUNK_OVERLAP_LINES = 8;
+	static constexpr int64_t MAX_INDEXED_FILE_SIZE = 1024 * 1024;
+	static constexpr uint32_t INVALID_FILE = UINT32_MAX;
+	static constexpr uint64_t WALK_INTERVAL_MSEC = 2000;
+	static constexpr uint64_t MIN_JOURNAL_COMPACT_SIZE = 1024 * 1024;
+
+	struct Posting {
+		uint32_t chunk = 0;
+		uint32_t frequency = 0;
+	};
+
+	struct Chunk {
+		uint32_t file = INVALID_FILE;
+		uint32_t start_line = 0;
+		uint32_t end_line = 0;
+		uint32_t token_count = 0;
+		String text;
+	};
+
+	struct FileEntry {
+		String path;
+		uint64_t modified_time = 0;
+		uint64_t size = 0;
+		uint32_t content_hash = 0;
+		LocalVector<uint32_t> chunks;
+	};
+
+	// Chunked and tokenized file, prepared outside of the index lock.
+	struct FileDocument {
+		String path;
+		uint64_t modified_time = 0;
+		uint64_t size = 0;
+		uint32_t content_hash = 0;
+		LocalVector<Chunk> chunks;
+		LocalVector<LocalVector<uint32_t>> chunk_tokens;
+	};
+
+	struct UpdateBatch {
+		Vector<String> changed;
+		Vector<uint64_t> changed_times;
+		Vector<String> removed;
+	};
+
+	static AIProjectIndex *singleton;
+
+	mutable RWLock lock;
+
+	LocalVector<FileEntry> files;
+	HashMap<String, uint32_t> file_map;
+	LocalVector<uint32_t> free_files;
+	LocalVector<Chunk> chunks;
+	LocalVector<float> vectors;
+	HashMap<uint32_t, LocalVector<Posting>> token_postings;
+	HashMap<uint32_t, LocalVector<uint32_t>> trigram_postings;
+	uint32_t live_chunk_count = 0;
+	uint64_t total_token_count = 0;
+
+	bool started = false;
+	bool update_running = false;
+	bool rescan_pending = false;
+	WorkerThreadPool::TaskID update_task = WorkerThreadPool::INVALID_TASK_ID;
+	// Paths reported dirty by signals or saves; folded into the next batch.
+	HashSet<String> dirty_files;
+	// Set by signals that don't say what changed.
+	bool walk_pending = false;
+	bool walk_timer_queued = false;
+	uint64_t last_walk_msec = 0;
+
+	// Only touched by the load or update task, which never overlap.
+	uint64_t snapshot_size = 0;
+	uint64_t journal_size = 0;
+
+	String index_dir;
+
+	static bool _is_indexable_path(const String &p_path);
+	static void _tokenize(const String &p_text, LocalVector<uint32_t> &r_tokens);
+	static void _collect_trigrams(const String &p_text, HashSet<uint32_t> &r_trigrams);
+	static void _compute_vector(const LocalVector<uint32_t> &p_tokens, float *r_vector);
+	static void _tokenize_document(FileDocument &r_document);
+	static bool _build_document(const String &p_path, uint64_t p_modified_time, const Vector<uint8_t> &p_bytes, FileDocument &r_document);
+
+	void _walk_filesystem(EditorFileSystemDirectory *p_dir, HashMap<String, uint64_t> &r_seen) const;
+
+	// These expect the write lock to be held.
+	void _remove_file_locked(const String &p_path);
+	void _add_document_locked(FileDocument &p_document);
+	void _index_chunk_locked(uint32_t p_chunk_id, const LocalVector<uint32_t> &p_tokens);
+	void _compact_locked();
+
+	static void _store_document(const Ref<FileAccess> &p_file, const FileDocument &p_document);
+	static void _read_document(const Ref<FileAccess> &p_file, FileDocument &r_document);
+
+	Error _save_snapshot();
+	Error _append_to_journal(const LocalVector<FileDocument> &p_added, const LocalVector<Pair<String, uint64_t>> &p_touched, const LocalVector<String> &p_removed);
+	// Sets `r_compact` when the journal should be folded into a new snapshot.
+	Error _load_from_disk(LocalVector<FileDocument> &r_documents, bool &r_compact);
+
+	void _merge_documents(LocalVector<FileDocument> &p_documents);
+	void _load_task_func();
+	void _schedule_update();
+	void _update_task_func(UpdateBatch *p_batch);
+	void _update_finished();
+
+	void _on_filesystem_changed();
+	void _on_resources_reimported(const PackedStringArray &p_resources);
+	void _on_sources_changed(bool p_exist);
+	void _on_walk_timeout();
+
+protected:
+	static void _bind_methods() {}
+
+public:
+	static AIProjectIndex *get_singleton() { return singleton; }
+
+	// Connects to EditorFileSystem and loads the persisted index, if any, in
+	// the background.
+	void start();
+	void stop();
+
+	// Schedules a re-index of the given file (for example after a save).
+	void mark_file_dirty(const String &p_path);
+
+	bool is_ready() const;
+	Dictionary get_stats() const;
+
+	// Returns an array of dictionaries sorted by descending score. Each entry
+	// has `file_path`, `score`, `start_line`, `end_line`, `snippet` and
+	// `modality`. An empty `p_modality_filter` matches every file type.
+	Array search(const String &p_query, int p_max_results = 5, const String &p_modality_filter = String()) const;
+
+	static String get_modality(const String &p_path);
+
+	AIProjectIndex();
+	~AIProjectIndex();
+};
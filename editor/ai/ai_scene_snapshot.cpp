@@ -0,0 +1,504 @@
+/**************************************************************************/
+/*  ai_scene_snapshot.cpp                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ai_scene_snapshot.h"
+
+#include "core/object/script_language.h"
+#include "editor/editor_node.h"
+#include "scene/main/node.h"
+#include "scene/main/scene_tree.h"
+
+AISceneSnapshot *AISceneSnapshot::singleton = nullptr;
+
+Node *AISceneSnapshot::_get_scene_root() const {
+	EditorNode *editor = EditorNode::get_singleton();
+	return editor ? editor->get_tree()->get_edited_scene_root() : nullptr;
+}
+
+bool AISceneSnapshot::_sync_scene() {
+	Node *root = _get_scene_root();
+	const ObjectID root_id = root ? root->get_instance_id() : ObjectID();
+	if (root_id == scene_root) {
+		return false;
+	}
+
+	// A different scene: versions of the previous one cannot be diffed.
+	scene_root = root_id;
+	version++;
+	base_version = version;
+	changes.clear();
+	nodes.clear();
+	order_dirty = true;
+	if (root) {
+		LocalVector<Node *> stack;
+		stack.push_back(root);
+		while (!stack.is_empty()) {
+			Node *node = stack[stack.size() - 1];
+			stack.resize(stack.size() - 1);
+			nodes.insert(node->get_instance_id(), node->get_name());
+			for (int i = 0; i < node->get_child_count(); i++) {
+				stack.push_back(node->get_child(i));
+			}
+		}
+	}
+	return true;
+}
+
+void AISceneSnapshot::_record(ChangeType p_type, Node *p_node, const StringName &p_detail, const String &p_path) {
+	Change change;
+	change.version = ++version;
+	change.type = p_type;
+	change.node = p_node->get_instance_id();
+	change.detail = p_detail;
+	change.path = p_path;
+	changes.push_back(change);
+
+	if (changes.size() > MAX_CHANGES) {
+		// Drop the older half at once so trimming stays amortized O(1).
+		const uint32_t drop = changes.size() / 2;
+		base_version = changes[drop - 1].version;
+		LocalVector<Change> kept;
+		kept.reserve(changes.size() - drop);
+		for (uint32_t i = drop; i < changes.size(); i++) {
+			kept.push_back(changes[i]);
+		}
+		changes = kept;
+	}
+}
+
+void AISceneSnapshot::_rebuild_order() {
+	if (!order_dirty) {
+		return;
+	}
+	order_dirty = false;
+	order.clear();
+
+	Node *root = _get_scene_root();
+	if (!root) {
+		return;
+	}
+	order.reserve(nodes.size());
+	LocalVector<Node *> stack;
+	stack.push_back(root);
+	while (!stack.is_empty()) {
+		Node *node = stack[stack.size() - 1];
+		stack.resize(stack.size() - 1);
+		order.push_back(node->get_instance_id());
+		for (int i = node->get_child_count() - 1; i >= 0; i--) {
+			stack.push_back(node->get_child(i));
+		}
+	}
+}
+
+void AISceneSnapshot::_on_node_added(Node *p_node) {
+	if (_sync_scene()) {
+		return;
+	}
+	// Children enter the tree after their parent, so a known parent is
+	// enough to tell scene nodes from the editor's own.
+	const Node *parent = p_node->get_parent();
+	if (!parent || !nodes.has(parent->get_instance_id()) || nodes.has(p_node->get_instance_id())) {
+		return;
+	}
+	nodes.insert(p_node->get_instance_id(), p_node->get_name());
+	order_dirty = true;
+	_record(CHANGE_ADDED, p_node);
+}
+
+void AISceneSnapshot::_on_node_removed(Node *p_node) {
+	_sync_scene();
+	if (!nodes.has(p_node->get_instance_id())) {
+		return;
+	}
+	const String path = get_node_path(_get_scene_root(), p_node);
+	nodes.erase(p_node->get_instance_id());
+	order_dirty = true;
+	_record(CHANGE_REMOVED, p_node, StringName(), path);
+}
+
+void AISceneSnapshot::_on_node_renamed(Node *p_node) {
+	_sync_scene();
+	StringName *name = nodes.getptr(p_node->get_instance_id());
+	if (!name || *name == p_node->get_name()) {
+		return;
+	}
+	const StringName old_name = *name;
+	*name = p_node->get_name();
+	_record(CHANGE_RENAMED, p_node, old_name);
+}
+
+void AISceneSnapshot::_on_property_changed(Object *p_object, const StringName &p_property) {
+	Node *node = Object::cast_to<Node>(p_object);
+	if (!node || p_property == SNAME("name")) {
+		return;
+	}
+	_sync_scene();
+	if (nodes.has(node->get_instance_id())) {
+		_record(CHANGE_PROPERTY, node, p_property);
+	}
+}
+
+void AISceneSnapshot::_on_method_called(Object *p_object, const StringName &p_method) {
+	Node *node = Object::cast_to<Node>(p_object);
+	if (!node) {
+		return;
+	}
+	_sync_scene();
+	if (!nodes.has(node->get_instance_id())) {
+		return;
+	}
+
+	// Children are added, removed and renamed through the tree signals.
+	const String method = p_method;
+	if (method == "move_child") {
+		order_dirty = true;
+		_record(CHANGE_REORDERED, node);
+	} else if (method.begins_with("set_") && method != "set_name" && method != "set_owner") {
+		const StringName property = method.substr(4);
+		bool valid = false;
+		node->get(property, &valid);
+		if (valid) {
+			_record(CHANGE_PROPERTY, node, property);
+		}
+	}
+}
+
+void AISceneSnapshot::notify_property_changed(Object *p_object, const StringName &p_property) {
+	if (singleton && singleton->started) {
+		singleton->_on_property_changed(p_object, p_property);
+	}
+}
+
+void AISceneSnapshot::notify_method_called(Object *p_object, const StringName &p_method) {
+	if (singleton && singleton->started) {
+		singleton->_on_method_called(p_object, p_method);
+	}
+}
+
+void AISceneSnapshot::start() {
+	if (started) {
+		return;
+	}
+	SceneTree *tree = SceneTree::get_singleton();
+	ERR_FAIL_NULL(tree);
+	started = true;
+	tree->connect("node_added", callable_mp(this, &AISceneSnapshot::_on_node_added));
+	tree->connect("node_removed", callable_mp(this, &AISceneSnapshot::_on_node_removed));
+	tree->connect("node_renamed", callable_mp(this, &AISceneSnapshot::_on_node_renamed));
+}
+
+void AISceneSnapshot::stop() {
+	if (!started) {
+		return;
+	}
+	started = false;
+	SceneTree *tree = SceneTree::get_singleton();
+	if (tree) {
+		tree->disconnect("node_added", callable_mp(this, &AISceneSnapshot::_on_node_added));
+		tree->disconnect("node_removed", callable_mp(this, &AISceneSnapshot::_on_node_removed));
+		tree->disconnect("node_renamed", callable_mp(this, &AISceneSnapshot::_on_node_renamed));
+	}
+}
+
+uint64_t AISceneSnapshot::get_version() {
+	_sync_scene();
+	return version;
+}
+
+uint32_t AISceneSnapshot::parse_fields(const Variant &p_fields, uint32_t p_default) {
+	PackedStringArray names;
+	if (p_fields.get_type() == Variant::STRING) {
+		names = String(p_fields).split(",", false);
+	} else if (p_fields.get_type() == Variant::ARRAY || p_fields.get_type() == Variant::PACKED_STRING_ARRAY) {
+		names = p_fields;
+	}
+
+	uint32_t fields = 0;
+	for (const String &name : names) {
+		const String field = name.strip_edges().to_lower();
+		if (field == "name") {
+			fields |= FIELD_NAME;
+		} else if (field == "type") {
+			fields |= FIELD_TYPE;
+		} else if (field == "path") {
+			fields |= FIELD_PATH;
+		} else if (field == "parent") {
+			fields |= FIELD_PARENT;
+		} else if (field == "owner") {
+			fields |= FIELD_OWNER;
+		} else if (field == "child_count") {
+			fields |= FIELD_CHILD_COUNT;
+		} else if (field == "index") {
+			fields |= FIELD_INDEX;
+		} else if (field == "script") {
+			fields |= FIELD_SCRIPT;
+		} else if (field == "properties") {
+			fields |= FIELD_PROPERTIES;
+		}
+	}
+	return fields ? fields : p_default;
+}
+
+String AISceneSnapshot::get_node_path(Node *p_root, Node *p_node) {
+	if (p_root && p_node == p_root) {
+		return ".";
+	}
+	if (p_root && p_root->is_ancestor_of(p_node)) {
+		return String(p_root->get_path_to(p_node));
+	}
+	return String(p_node->get_path());
+}
+
+Dictionary AISceneSnapshot::describe_node(Node *p_root, Node *p_node, uint32_t p_fields, const LocalVector<StringName> *p_properties) {
+	Dictionary info;
+	if (p_fields & FIELD_NAME) {
+		info["name"] = p_node->get_name();
+	}
+	if (p_fields & FIELD_TYPE) {
+		info["type"] = p_node->get_class();
+	}
+	if (p_fields & FIELD_PATH) {
+		info["path"] = get_node_path(p_root, p_node);
+	}
+	if (p_fields & FIELD_PARENT) {
+		Node *parent = p_node->get_parent();
+		info["parent"] = (p_node == p_root || !parent) ? String() : get_node_path(p_root, parent);
+	}
+	if (p_fields & FIELD_OWNER) {
+		info["owner"] = p_node->get_owner() ? String(p_node->get_owner()->get_name()) : String();
+	}
+	if (p_fields & FIELD_CHILD_COUNT) {
+		info["child_count"] = p_node->get_child_count();
+	}
+	if (p_fields & FIELD_INDEX) {
+		info["index"] = p_node->get_index();
+	}
+	if (p_fields & FIELD_SCRIPT) {
+		Ref<Script> script = p_node->get_script();
+		info["script"] = script.is_valid() ? script->get_path() : String();
+	}
+	if (p_fields & FIELD_PROPERTIES) {
+		Dictionary properties;
+		if (p_properties) {
+			for (const StringName &name : *p_properties) {
+				properties[name] = p_node->get(name);
+			}
+		} else {
+			List<PropertyInfo> property_list;
+			p_node->get_property_list(&property_list);
+			for (const PropertyInfo &property : property_list) {
+				if (property.usage & PROPERTY_USAGE_EDITOR) {
+					properties[property.name] = p_node->get(property.name);
+				}
+			}
+		}
+		info["properties"] = properties;
+	}
+	return info;
+}
+
+Dictionary AISceneSnapshot::list_nodes(int p_offset, int p_limit, uint32_t p_fields) {
+	_sync_scene();
+	_rebuild_order();
+
+	Node *root = _get_scene_root();
+	const int total = order.size();
+	const int offset = CLAMP(p_offset, 0, total);
+	const int end = p_limit > 0 ? MIN(offset + p_limit, total) : total;
+
+	Array list;
+	for (int i = offset; i < end; i++) {
+		Node *node = ObjectDB::get_instance<Node>(order[i]);
+		if (node) {
+			list.push_back(describe_node(root, node, p_fields));
+		}
+	}
+
+	Dictionary result;
+	result["version"] = version;
+	result["nodes"] = list;
+	result["total"] = total;
+	result["offset"] = offset;
+	result["has_more"] = end < total;
+	if (end < total) {
+		result["next_offset"] = end;
+	}
+	return result;
+}
+
+Dictionary AISceneSnapshot::get_changes(uint64_t p_since_version, int p_offset, int p_limit, uint32_t p_fields) {
+	_sync_scene();
+	if (p_since_version < base_version || p_since_version > version) {
+		Dictionary result = list_nodes(p_offset, p_limit, p_fields);
+		result["since_version"] = p_since_version;
+		result["resync_required"] = true;
+		return result;
+	}
+
+	struct Delta {
+		ObjectID node;
+		bool added = false;
+		bool removed = false;
+		bool moved = false;
+		bool reordered = false;
+		StringName renamed_from;
+		String removed_path;
+		LocalVector<StringName> properties;
+	};
+
+	// The log is sorted by version.
+	uint32_t first = changes.size();
+	uint32_t lo = 0;
+	uint32_t hi = changes.size();
+	while (lo < hi) {
+		const uint32_t mid = (lo + hi) / 2;
+		if (changes[mid].version > p_since_version) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	first = lo;
+
+	LocalVector<Delta> deltas;
+	HashMap<ObjectID, uint32_t> delta_map;
+	for (uint32_t i = first; i < changes.size(); i++) {
+		const Change &change = changes[i];
+		uint32_t *index = delta_map.getptr(change.node);
+		if (!index) {
+			Delta delta;
+			delta.node = change.node;
+			deltas.push_back(delta);
+			index = &delta_map.insert(change.node, deltas.size() - 1)->value;
+		}
+		Delta &delta = deltas[*index];
+		switch (change.type) {
+			case CHANGE_ADDED: {
+				if (delta.removed) {
+					// Removed and added again: the node was reparented.
+					delta.removed = false;
+					delta.moved = true;
+				} else {
+					delta.added = true;
+				}
+			} break;
+			case CHANGE_REMOVED: {
+				delta.removed = true;
+				if (delta.removed_path.is_empty()) {
+					delta.removed_path = change.path;
+				}
+			} break;
+			case CHANGE_RENAMED: {
+				if (delta.renamed_from == StringName()) {
+					delta.renamed_from = change.detail;
+				}
+			} break;
+			case CHANGE_PROPERTY: {
+				if (!delta.properties.has(change.detail)) {
+					delta.properties.push_back(change.detail);
+				}
+			} break;
+			case CHANGE_REORDERED: {
+				delta.reordered = true;
+			} break;
+		}
+	}
+
+	// Nodes added and removed again since the caller's version are invisible.
+	LocalVector<uint32_t> visible;
+	for (uint32_t i = 0; i < deltas.size(); i++) {
+		const Delta &delta = deltas[i];
+		if (delta.removed && delta.added) {
+			continue;
+		}
+		visible.push_back(i);
+	}
+
+	Node *root = _get_scene_root();
+	const int total = visible.size();
+	const int offset = CLAMP(p_offset, 0, total);
+	const int end = p_limit > 0 ? MIN(offset + p_limit, total) : total;
+
+	Array list;
+	for (int i = offset; i < end; i++) {
+		const Delta &delta = deltas[visible[i]];
+		Node *node = delta.removed ? nullptr : ObjectDB::get_instance<Node>(delta.node);
+		Dictionary entry;
+		if (!node) {
+			entry["change"] = "removed";
+			entry["path"] = delta.removed_path;
+		} else if (delta.added) {
+			entry = describe_node(root, node, p_fields | FIELD_PATH);
+			entry["change"] = "added";
+		} else {
+			entry = describe_node(root, node, p_fields | FIELD_PATH, &delta.properties);
+			entry["change"] = "modified";
+			Array properties;
+			for (const StringName &property : delta.properties) {
+				properties.push_back(property);
+			}
+			entry["changed_properties"] = properties;
+			if (delta.renamed_from != StringName()) {
+				entry["renamed_from"] = delta.renamed_from;
+			}
+			if (delta.moved) {
+				entry["moved"] = true;
+			}
+			if (delta.reordered) {
+				entry["reordered"] = true;
+			}
+		}
+		list.push_back(entry);
+	}
+
+	Dictionary result;
+	result["version"] = version;
+	result["since_version"] = p_since_version;
+	result["changes"] = list;
+	result["total"] = total;
+	result["offset"] = offset;
+	result["has_more"] = end < total;
+	if (end < total) {
+		result["next_offset"] = end;
+	}
+	return result;
+}
+
+AISceneSnapshot::AISceneSnapshot() {
+	ERR_FAIL_COND(singleton != nullptr);
+	singleton = this;
+}
+
+AISceneSnapshot::~AISceneSnapshot() {
+	stop();
+	if (singleton == this) {
+		singleton = nullptr;
+	}
+}
@@ -0,0 +1,144 @@
+/**************************************************************************/
+/*  ai_scene_snapshot.h                                                   */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/class_db.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+#include "core/variant/dictionary.h"
+
+class Node;
+
+// Versioned view of the edited scene for get_all_nodes and
+// get_scene_tree_hierarchy.
+//
+// Additions, removals and renames come from the SceneTree signals, property
+// and method changes from the undo-redo notify hooks (and from tools that
+// edit nodes directly). Every change bumps the version and is appended to a
+// bounded log, so callers can ask for the changes since the version they
+// last saw instead of dumping the whole scene again. The pre-order node list
+// used for paged listings is only rebuilt after structural changes.
+class AISceneSnapshot : public Object {
+	GDCLASS(AISceneSnapshot, Object);
+
+public:
+	enum Field {
+		FIELD_NAME = 1 << 0,
+		FIELD_TYPE = 1 << 1,
+		FIELD_PATH = 1 << 2,
+		FIELD_PARENT = 1 << 3,
+		FIELD_OWNER = 1 << 4,
+		FIELD_CHILD_COUNT = 1 << 5,
+		FIELD_INDEX = 1 << 6,
+		FIELD_SCRIPT = 1 << 7,
+		FIELD_PROPERTIES = 1 << 8,
+	};
+
+private:
+	static constexpr uint32_t MAX_CHANGES = 16384;
+
+	enum ChangeType {
+		CHANGE_ADDED,
+		CHANGE_REMOVED,
+		CHANGE_RENAMED,
+		CHANGE_PROPERTY,
+		CHANGE_REORDERED,
+	};
+
+	struct Change {
+		uint64_t version = 0;
+		ChangeType type = CHANGE_PROPERTY;
+		ObjectID node;
+		// Property name, or the previous name for renames.
+		StringName detail;
+		// Scene-relative path of removed nodes, which can no longer be resolved.
+		String path;
+	};
+
+	static AISceneSnapshot *singleton;
+
+	bool started = false;
+	ObjectID scene_root;
+	uint64_t version = 0;
+	// Oldest version that can still be diffed against; older callers resync.
+	uint64_t base_version = 0;
+	LocalVector<Change> changes;
+	// Names of the nodes currently in the edited scene.
+	HashMap<ObjectID, StringName> nodes;
+	LocalVector<ObjectID> order;
+	bool order_dirty = true;
+
+	Node *_get_scene_root() const;
+	bool _sync_scene();
+	void _record(ChangeType p_type, Node *p_node, const StringName &p_detail = StringName(), const String &p_path = String());
+	void _rebuild_order();
+
+	void _on_node_added(Node *p_node);
+	void _on_node_removed(Node *p_node);
+	void _on_node_renamed(Node *p_node);
+	void _on_property_changed(Object *p_object, const StringName &p_property);
+	void _on_method_called(Object *p_object, const StringName &p_method);
+
+protected:
+	static void _bind_methods() {}
+
+public:
+	static AISceneSnapshot *get_singleton() { return singleton; }
+
+	void start();
+	void stop();
+
+	// Undo-redo and tool hooks. Safe to call when no snapshot exists.
+	static void notify_property_changed(Object *p_object, const StringName &p_property);
+	static void notify_method_called(Object *p_object, const StringName &p_method);
+
+	uint64_t get_version();
+
+	// Parses `fields` (an array or a comma-separated string of field names).
+	static uint32_t parse_fields(const Variant &p_fields, uint32_t p_default);
+	static String get_node_path(Node *p_root, Node *p_node);
+	// `p_properties` limits FIELD_PROPERTIES to the given names.
+	static Dictionary describe_node(Node *p_root, Node *p_node, uint32_t p_fields, const LocalVector<StringName> *p_properties = nullptr);
+
+	// Paged pre-order listing: `nodes`, `total`, `offset`, `has_more` and
+	// `next_offset`.
+	Dictionary list_nodes(int p_offset, int p_limit, uint32_t p_fields);
+
+	// Net changes after `p_since_version`, one entry per node with `change`
+	// ("added", "removed" or "modified"), `path` and the selected fields.
+	// Modified entries list `changed_properties` and, when applicable,
+	// `renamed_from`, `moved` and `reordered`. Sets `resync_required` when the
+	// version is older than the retained log or belongs to another scene.
+	Dictionary get_changes(uint64_t p_since_version, int p_offset, int p_limit, uint32_t p_fields);
+
+	AISceneSnapshot();
+	~AISceneSnapshot();
+};
@@ -0,0 +1,350 @@
+/**************************************************************************/
+/*  ai_screenshot_capture.cpp                                             */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ai_screenshot_capture.h"
+
+#include "ai_worker_jobs.h"
+
+#include "core/crypto/crypto_core.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/image.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/mutex.h"
+#include "core/os/os.h"
+#include "editor/editor_node.h"
+#include "editor/file_system/editor_paths.h"
+#include "scene/main/viewport.h"
+#include "servers/rendering/rendering_device.h"
+#include "servers/rendering_server.h"
+
+static constexpr int MAX_CACHED_SCREENSHOTS = 64;
+
+namespace {
+
+struct CaptureOptions {
+	bool has_region = false;
+	Rect2i region;
+	float scale = 1.0;
+	int max_size = 0;
+	String format = "png";
+	float quality = 0.85;
+	String filename;
+	String cache_dir;
+	bool save = true;
+	bool return_data = false;
+};
+
+struct CaptureJob {
+	uint64_t id = 0;
+	CaptureOptions options;
+	RID texture;
+	Ref<Image> image;
+	Callable callback;
+	Dictionary result;
+	WorkerThreadPool::TaskID task = WorkerThreadPool::INVALID_TASK_ID;
+};
+
+AIJobRegistry<CaptureJob> jobs;
+
+Dictionary _make_error(const String &p_message) {
+	Dictionary result;
+	result["success"] = false;
+	result["message"] = p_message;
+	return result;
+}
+
+bool _parse_options(const Dictionary &p_args, CaptureOptions &r_options, String &r_error) {
+	if (p_args.has("region")) {
+		const Variant region = p_args["region"];
+		switch (region.get_type()) {
+			case Variant::DICTIONARY: {
+				const Dictionary d = region;
+				r_options.region = Rect2i(d.get("x", 0), d.get("y", 0), d.get("width", 0), d.get("height", 0));
+			} break;
+			case Variant::ARRAY: {
+				const Array a = region;
+				if (a.size() != 4) {
+					r_error = "'region' must be [x, y, width, height].";
+					return false;
+				}
+				r_options.region = Rect2i(a[0], a[1], a[2], a[3]);
+			} break;
+			case Variant::RECT2:
+			case Variant::RECT2I: {
+				r_options.region = region;
+			} break;
+			default: {
+				r_error = "'region' must be a dictionary with x, y, width and height.";
+				return false;
+			}
+		}
+		if (r_options.region.size.x <= 0 || r_options.region.size.y <= 0) {
+			r_error = "'region' must have a positive width and height.";
+			return false;
+		}
+		r_options.has_region = true;
+	}
+
+	r_options.scale = p_args.get("scale", 1.0);
+	if (r_options.scale <= 0.0 || r_options.scale > 1.0) {
+		r_error = "'scale' must be greater than 0 and at most 1.";
+		return false;
+	}
+	r_options.max_size = MAX(int(p_args.get("max_size", 0)), 0);
+
+	r_options.format = String(p_args.get("format", "png")).to_lower();
+	if (r_options.format == "jpeg") {
+		r_options.format = "jpg";
+	}
+	if (r_options.format != "png" && r_options.format != "webp" && r_options.format != "jpg") {
+		r_error = "Unsupported format '" + r_options.format + "'. Use png, webp or jpg.";
+		return false;
+	}
+	r_options.quality = CLAMP(float(p_args.get("quality", 0.85)), 0.0f, 1.0f);
+
+	r_options.filename = String(p_args.get("filename", "")).get_file();
+	r_options.save = p_args.get("save", true);
+	r_options.return_data = p_args.get("return_data", false);
+	if (!r_options.save && !r_options.return_data) {
+		r_error = "Nothing to return: set 'save' or 'return_data'.";
+		return false;
+	}
+	r_options.cache_dir = AIScreenshotCapture::get_cache_dir();
+	return true;
+}
+
+// Crops, scales, encodes and stores a captured frame. Runs on any thread.
+Dictionary _process_image(const Ref<Image> &p_image, const CaptureOptions &p_options) {
+	if (p_image.is_null() || p_image->is_empty()) {
+		return _make_error("Failed to capture screenshot");
+	}
+	Ref<Image> image = p_image;
+	const int source_width = image->get_width();
+	const int source_height = image->get_height();
+
+	// The editor is opaque; dropping alpha also makes every encoding smaller.
+	if (image->get_format() != Image::FORMAT_RGB8) {
+		image->convert(Image::FORMAT_RGB8);
+	}
+
+	if (p_options.has_region) {
+		const Rect2i region = p_options.region.intersection(Rect2i(0, 0, source_width, source_height));
+		if (region.size.x <= 0 || region.size.y <= 0) {
+			return _make_error(vformat("Region is outside of the %dx%d viewport.", source_width, source_height));
+		}
+		if (region.size != Size2i(source_width, source_height)) {
+			image = image->get_region(region);
+		}
+	}
+
+	float factor = p_options.scale;
+	const int longest = MAX(image->get_width(), image->get_height());
+	if (p_options.max_size > 0 && longest * factor > p_options.max_size) {
+		factor = float(p_options.max_size) / longest;
+	}
+	if (factor < 1.0) {
+		const int width = MAX(int(Math::round(image->get_width() * factor)), 1);
+		const int height = MAX(int(Math::round(image->get_height() * factor)), 1);
+		image->resize(width, height, Image::INTERPOLATE_LANCZOS);
+	}
+
+	Vector<uint8_t> bytes;
+	String mime_type;
+	if (p_options.format == "webp") {
+		bytes = image->save_webp_to_buffer(true, p_options.quality);
+		mime_type = "image/webp";
+	} else if (p_options.format == "jpg") {
+		bytes = image->save_jpg_to_buffer(p_options.quality);
+		mime_type = "image/jpeg";
+	} else {
+		bytes = image->save_png_to_buffer();
+		mime_type = "image/png";
+	}
+	if (bytes.is_empty()) {
+		return _make_error("Failed to encode screenshot as " + p_options.format);
+	}
+
+	Dictionary result;
+	result["success"] = true;
+	result["format"] = p_options.format;
+	result["mime_type"] = mime_type;
+	result["width"] = image->get_width();
+	result["height"] = image->get_height();
+	result["source_width"] = source_width;
+	result["source_height"] = source_height;
+	result["byte_size"] = bytes.size();
+
+	if (p_options.save) {
+		String filename = p_options.filename;
+		if (filename.is_empty()) {
+			filename = vformat("screenshot_%d", OS::get_singleton()->get_ticks_usec());
+		}
+		filename = filename.get_basename() + "." + p_options.format;
+		const String path = p_options.cache_dir.path_join(filename);
+
+		DirAccess::make_dir_recursive_absolute(p_options.cache_dir);
+		Error err;
+		Ref<FileAccess> file = FileAccess::open(path, FileAccess::WRITE, &err);
+		if (file.is_null()) {
+			return _make_error("Failed to save screenshot: " + String::num_int64(err));
+		}
+		file->store_buffer(bytes.ptr(), bytes.size());
+		file.unref();
+		AIDiskCache::prune(p_options.cache_dir, MAX_CACHED_SCREENSHOTS);
+
+		result["path"] = path;
+		result["image_path"] = path;
+		result["filename"] = filename;
+	}
+	if (p_options.return_data) {
+		result["data"] = CryptoCore::b64_encode_str(bytes.ptr(), bytes.size());
+	}
+	result["message"] = p_options.save ? "Screenshot saved" : "Screenshot captured";
+	return result;
+}
+
+Viewport *_get_capture_viewport() {
+	EditorNode *editor = EditorNode::get_singleton();
+	return editor ? editor->get_viewport() : nullptr;
+}
+
+Image::Format _get_image_format(RD::DataFormat p_format) {
+	switch (p_format) {
+		case RD::DATA_FORMAT_R8G8B8A8_UNORM:
+		case RD::DATA_FORMAT_R8G8B8A8_SRGB:
+			return Image::FORMAT_RGBA8;
+		case RD::DATA_FORMAT_R16G16B16A16_SFLOAT:
+			return Image::FORMAT_RGBAH;
+		default:
+			return Image::FORMAT_MAX;
+	}
+}
+
+void _finish_job(uint64_t p_id) {
+	CaptureJob *job = jobs.take(p_id);
+	ERR_FAIL_NULL(job);
+	job->callback.call(job->result);
+	memdelete(job);
+}
+
+void _encode_task(void *p_userdata) {
+	CaptureJob *job = static_cast<CaptureJob *>(p_userdata);
+	job->result = _process_image(job->image, job->options);
+	job->image.unref();
+	callable_mp_static(&_finish_job).call_deferred(job->id);
+}
+
+// Hands a captured frame to the WorkerThreadPool. Called on the render
+// thread (async readback) or the main thread (fallback).
+void _start_encode(uint64_t p_id, const Ref<Image> &p_image) {
+	MutexLock lock(jobs.get_mutex());
+	CaptureJob *job = jobs.find(p_id);
+	ERR_FAIL_NULL(job);
+	job->image = p_image;
+	job->task = WorkerThreadPool::get_singleton()->add_native_task(&_encode_task, job, false, "AI screenshot encode");
+}
+
+// Synchronous readback for renderers without RenderingDevice.
+void _capture_fallback(uint64_t p_id) {
+	RID texture;
+	{
+		MutexLock lock(jobs.get_mutex());
+		CaptureJob *job = jobs.find(p_id);
+		ERR_FAIL_NULL(job);
+		texture = job->texture;
+	}
+	_start_encode(p_id, RS::get_singleton()->texture_2d_get(texture));
+}
+
+void _on_readback(const Vector<uint8_t> &p_data, uint64_t p_id, int p_width, int p_height, int p_format) {
+	_start_encode(p_id, Image::create_from_data(p_width, p_height, false, Image::Format(p_format), p_data));
+}
+
+void _request_readback(uint64_t p_id, RID p_rd_texture) {
+	RenderingDevice *rd = RenderingDevice::get_singleton();
+	if (rd && rd->texture_is_valid(p_rd_texture)) {
+		const RD::TextureFormat format = rd->texture_get_format(p_rd_texture);
+		const Image::Format image_format = _get_image_format(format.format);
+		if (image_format != Image::FORMAT_MAX) {
+			const Callable callback = callable_mp_static(&_on_readback).bind(p_id, format.width, format.height, image_format);
+			if (rd->texture_get_data_async(p_rd_texture, 0, callback) == OK) {
+				return;
+			}
+		}
+	}
+	callable_mp_static(&_capture_fallback).call_deferred(p_id);
+}
+
+} // namespace
+
+String AIScreenshotCapture::get_cache_dir() {
+	return EditorPaths::get_singleton()->get_cache_dir().path_join("ai_screenshots");
+}
+
+void AIScreenshotCapture::capture_async(const Dictionary &p_args, const Callable &p_callback) {
+	CaptureOptions options;
+	String error;
+	if (!_parse_options(p_args, options, error)) {
+		p_callback.call_deferred(_make_error(error));
+		return;
+	}
+	Viewport *viewport = _get_capture_viewport();
+	if (!viewport) {
+		p_callback.call_deferred(_make_error("Could not access viewport"));
+		return;
+	}
+
+	CaptureJob *job = memnew(CaptureJob);
+	job->options = options;
+	job->callback = p_callback;
+	job->texture = RS::get_singleton()->viewport_get_texture(viewport->get_viewport_rid());
+	job->id = jobs.add(job);
+
+	const RID rd_texture = RenderingDevice::get_singleton() ? RS::get_singleton()->texture_get_rd_texture(job->texture) : RID();
+	if (rd_texture.is_valid()) {
+		RS::get_singleton()->call_on_render_thread(callable_mp_static(&_request_readback).bind(job->id, rd_texture));
+	} else {
+		_capture_fallback(job->id);
+	}
+}
+
+Dictionary AIScreenshotCapture::capture(const Dictionary &p_args) {
+	CaptureOptions options;
+	String error;
+	if (!_parse_options(p_args, options, error)) {
+		return _make_error(error);
+	}
+	Viewport *viewport = _get_capture_viewport();
+	if (!viewport) {
+		return _make_error("Could not access viewport");
+	}
+	return _process_image(viewport->get_texture()->get_image(), options);
+}
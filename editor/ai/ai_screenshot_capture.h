@@ -0,0 +1,65 @@
+/**************************************************************************/
+/*  ai_screenshot_capture.h                                               */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/variant/callable.h"
+#include "core/variant/dictionary.h"
+
+// Captures the editor viewport for take_screenshot without stalling the
+// editor.
+//
+// On RenderingDevice-based renderers the render target is read back with
+// RenderingDevice::texture_get_data_async(), so the main thread never waits
+// for the GPU. Cropping, downsampling and PNG/WebP/JPEG encoding run on the
+// WorkerThreadPool. Files go to the editor cache directory rather than
+// `res://`, so captures never trigger an import.
+//
+// Arguments (all optional): `region` ({x, y, width, height} or
+// [x, y, width, height], in viewport pixels), `scale` (0-1], `max_size`
+// (longest side in pixels), `format` ("png", "webp" or "jpg"), `quality`
+// (0-1, for lossy formats), `filename`, `save` (default true) and
+// `return_data` (adds the encoded bytes as base64 `data`).
+//
+// The result has `success`, `message`, `path` and `image_path` when saved,
+// `mime_type`, `format`, `width`, `height`, `source_width`,
+// `source_height` and `byte_size`.
+class AIScreenshotCapture {
+public:
+	// Starts a capture and returns immediately. `p_callback` is called on the
+	// main thread with the result Dictionary.
+	static void capture_async(const Dictionary &p_args, const Callable &p_callback);
+
+	// Captures and encodes on the calling (main) thread. The readback blocks
+	// until the GPU has finished the current frame.
+	static Dictionary capture(const Dictionary &p_args);
+
+	static String get_cache_dir();
+};
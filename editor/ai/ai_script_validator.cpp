@@ -0,0 +1,486 @@
+/**************************************************************************/
+/*  ai_script_validator.cpp                                               */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+
+#include "ai_script_validator.h"
+
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/mutex.h"
+#include "core/string/char_utils.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/lru.h"
+#include "modules/gdscript/gdscript.h"
+#include "modules/gdscript/gdscript_analyzer.h"
+#include "modules/gdscript/gdscript_cache.h"
+#include "modules/gdscript/gdscript_compiler.h"
+#include "modules/gdscript/gdscript_parser.h"
+
+static constexpr int RESULT_CACHE_CAPACITY = 128;
+// Larger projects re-read the least recently scanned scripts.
+static constexpr int SOURCE_CACHE_CAPACITY = 1024;
+
+namespace {
+
+typedef GDScriptParser::ClassNode::Member ClassMember;
+
+struct MemberSignature {
+	ClassMember::Type type = ClassMember::UNDEFINED;
+	int required_arguments = 0;
+	int max_arguments = 0; // -1 when variadic.
+};
+
+struct ScriptInterface {
+	bool valid = false;
+	String class_name;
+	HashMap<String, MemberSignature> members;
+};
+
+struct DependencyStamp {
+	String path;
+	uint64_t modified_time = 0;
+};
+
+struct CachedResult {
+	String content;
+	Array errors;
+	Vector<DependencyStamp> dependencies;
+	ScriptInterface script_interface;
+};
+
+struct ValidationJob {
+	const AIScriptValidator::Candidate *candidate = nullptr;
+	Array errors;
+	Vector<DependencyStamp> dependencies;
+	ScriptInterface new_interface;
+	ScriptInterface old_interface;
+	bool cached = false;
+};
+
+struct SourceEntry {
+	uint64_t modified_time = 0;
+	String source;
+};
+
+Mutex validator_mutex;
+
+LRUCache<String, CachedResult> &_get_result_cache() {
+	static LRUCache<String, CachedResult> cache(RESULT_CACHE_CAPACITY);
+	return cache;
+}
+
+// Sources of project scripts, re-read only when their modification time
+// changes. Used to find dependents.
+LRUCache<String, SourceEntry> &_get_source_cache() {
+	static LRUCache<String, SourceEntry> sources(SOURCE_CACHE_CAPACITY);
+	return sources;
+}
+
+const char *_get_member_type_name(ClassMember::Type p_type) {
+	switch (p_type) {
+		case ClassMember::CLASS:
+			return "class";
+		case ClassMember::CONSTANT:
+			return "constant";
+		case ClassMember::FUNCTION:
+			return "function";
+		case ClassMember::SIGNAL:
+			return "signal";
+		case ClassMember::VARIABLE:
+			return "variable";
+		case ClassMember::ENUM:
+			return "enum";
+		case ClassMember::ENUM_VALUE:
+			return "enum value";
+		default:
+			return "member";
+	}
+}
+
+void _count_arguments(const Vector<GDScriptParser::ParameterNode *> &p_parameters, bool p_variadic, MemberSignature &r_signature) {
+	for (const GDScriptParser::ParameterNode *parameter : p_parameters) {
+		if (parameter->initializer == nullptr) {
+			r_signature.required_arguments++;
+		}
+	}
+	r_signature.max_arguments = p_variadic ? -1 : p_parameters.size();
+}
+
+void _extract_interface(const GDScriptParser::ClassNode *p_class, ScriptInterface &r_interface) {
+	r_interface.valid = true;
+	if (p_class->identifier) {
+		r_interface.class_name = p_class->identifier->name;
+	}
+	for (const ClassMember &member : p_class->members) {
+		MemberSignature signature;
+		signature.type = member.type;
+		switch (member.type) {
+			case ClassMember::UNDEFINED:
+			case ClassMember::GROUP:
+				continue;
+			case ClassMember::FUNCTION:
+				_count_arguments(member.function->parameters, member.function->rest_parameter != nullptr, signature);
+				break;
+			case ClassMember::SIGNAL:
+				_count_arguments(member.signal->parameters, false, signature);
+				break;
+			default:
+				break;
+		}
+		r_interface.members.insert(member.get_name(), signature);
+	}
+}
+
+void _append_errors(const List<GDScriptParser::ParserError> &p_errors, int p_skip, const String &p_type, Array &r_errors) {
+	int index = 0;
+	for (const GDScriptParser::ParserError &error : p_errors) {
+		if (index++ < p_skip) {
+			continue;
+		}
+		Dictionary error_dict;
+		error_dict["type"] = p_type;
+		error_dict["line"] = error.line;
+		error_dict["column"] = error.column;
+		error_dict["message"] = error.message;
+		r_errors.push_back(error_dict);
+	}
+}
+
+bool _lookup_cached_result(ValidationJob &r_job) {
+	const AIScriptValidator::Candidate &candidate = *r_job.candidate;
+	CachedResult cached;
+	{
+		MutexLock lock(validator_mutex);
+		const CachedResult *entry = _get_result_cache().getptr(candidate.path);
+		if (!entry || entry->content != candidate.content) {
+			return false;
+		}
+		cached = *entry;
+	}
+	for (const DependencyStamp &stamp : cached.dependencies) {
+		if (FileAccess::get_modified_time(stamp.path) != stamp.modified_time) {
+			return false;
+		}
+	}
+	r_job.errors = cached.errors.duplicate(true);
+	r_job.dependencies = cached.dependencies;
+	r_job.new_interface = cached.script_interface;
+	return true;
+}
+
+void _store_cached_result(const ValidationJob &p_job) {
+	CachedResult cached;
+	cached.content = p_job.candidate->content;
+	cached.errors = p_job.errors.duplicate(true);
+	cached.dependencies = p_job.dependencies;
+	cached.script_interface = p_job.new_interface;
+	MutexLock lock(validator_mutex);
+	_get_result_cache().insert(p_job.candidate->path, cached);
+}
+
+void _check_source(ValidationJob &r_job) {
+	const AIScriptValidator::Candidate &candidate = *r_job.candidate;
+	GDScriptParser parser;
+	const Error parse_err = parser.parse(candidate.content, candidate.path, false);
+	const int parser_error_count = parser.get_errors().size();
+	_append_errors(parser.get_errors(), 0, "parser_error", r_job.errors);
+	if (parse_err != OK) {
+		return;
+	}
+	_extract_interface(parser.get_tree(), r_job.new_interface);
+
+	// Dependencies resolve through GDScriptCache, so unchanged scripts are
+	// parsed once and shared between runs and threads.
+	GDScriptAnalyzer analyzer(&parser);
+	const Error analyze_err = analyzer.analyze();
+	_append_errors(parser.get_errors(), parser_error_count, "analyzer_error", r_job.errors);
+	for (const KeyValue<String, Ref<GDScriptParserRef>> &E : parser.get_depended_parsers()) {
+		DependencyStamp stamp;
+		stamp.path = E.key;
+		stamp.modified_time = FileAccess::get_modified_time(E.key);
+		r_job.dependencies.push_back(stamp);
+	}
+	if (analyze_err != OK) {
+		return;
+	}
+
+	Ref<GDScript> temp_script;
+	temp_script.instantiate();
+	GDScriptCompiler compiler;
+	if (compiler.compile(&parser, temp_script.ptr(), false) != OK) {
+		Dictionary error_dict;
+		error_dict["type"] = "compiler_error";
+		error_dict["line"] = compiler.get_error_line();
+		error_dict["column"] = compiler.get_error_column();
+		error_dict["message"] = compiler.get_error();
+		r_job.errors.push_back(error_dict);
+	}
+}
+
+void _load_old_interface(ValidationJob &r_job) {
+	const AIScriptValidator::Candidate &candidate = *r_job.candidate;
+	String original = candidate.original;
+	if (original.is_empty()) {
+		if (!FileAccess::exists(candidate.path)) {
+			return; // New file, nothing can depend on it yet.
+		}
+		original = GDScriptCache::get_source_code(candidate.path);
+	}
+	if (original == candidate.content) {
+		r_job.old_interface = r_job.new_interface;
+		return;
+	}
+
+	// Prefer the tree GDScriptCache already holds for the current version.
+	if (GDScriptCache::has_parser(candidate.path)) {
+		Error err;
+		Ref<GDScriptParserRef> ref = GDScriptCache::get_parser(candidate.path, GDScriptParserRef::PARSED, err);
+		if (err == OK && ref.is_valid() && ref->get_source_hash() == original.hash() && ref->get_parser()->get_tree()) {
+			_extract_interface(ref->get_parser()->get_tree(), r_job.old_interface);
+			return;
+		}
+	}
+	GDScriptParser parser;
+	if (parser.parse(original, candidate.path, false) == OK) {
+		_extract_interface(parser.get_tree(), r_job.old_interface);
+	}
+}
+
+void _validate_task(void *p_userdata, uint32_t p_index) {
+	ValidationJob &job = static_cast<ValidationJob *>(p_userdata)[p_index];
+	if (job.candidate->path.get_extension() != "gd") {
+		Dictionary info_dict;
+		info_dict["type"] = "info";
+		info_dict["line"] = 0;
+		info_dict["column"] = 0;
+		info_dict["message"] = "Unsupported file type for compilation checking";
+		job.errors.push_back(info_dict);
+		return;
+	}
+	job.cached = _lookup_cached_result(job);
+	if (!job.cached) {
+		_check_source(job);
+		_store_cached_result(job);
+	}
+	_load_old_interface(job);
+}
+
+struct InterfaceChange {
+	String symbol;
+	String reason;
+};
+
+void _diff_interfaces(const ScriptInterface &p_old, const ScriptInterface &p_new, Vector<InterfaceChange> &r_changes) {
+	if (!p_old.valid || !p_new.valid) {
+		return;
+	}
+	if (!p_old.class_name.is_empty() && p_old.class_name != p_new.class_name) {
+		InterfaceChange change;
+		change.symbol = p_old.class_name;
+		change.reason = p_new.class_name.is_empty() ? String("class_name was removed") : "class_name was renamed to " + p_new.class_name;
+		r_changes.push_back(change);
+	}
+	for (const KeyValue<String, MemberSignature> &E : p_old.members) {
+		const MemberSignature *current = p_new.members.getptr(E.key);
+		InterfaceChange change;
+		change.symbol = E.key;
+		if (!current) {
+			change.reason = vformat("%s was removed", _get_member_type_name(E.value.type));
+		} else if (current->type != E.value.type) {
+			change.reason = vformat("changed from %s to %s", _get_member_type_name(E.value.type), _get_member_type_name(current->type));
+		} else if (current->required_arguments > E.value.required_arguments) {
+			change.reason = vformat("now requires %d arguments instead of %d", current->required_arguments, E.value.required_arguments);
+		} else if (current->max_arguments != -1 && (E.value.max_arguments == -1 || current->max_arguments < E.value.max_arguments)) {
+			change.reason = vformat("now accepts at most %d arguments", current->max_arguments);
+		} else {
+			continue;
+		}
+		r_changes.push_back(change);
+	}
+}
+
+// Returns the 1-based line of the first whole-word occurrence, or 0.
+int _find_word_line(const String &p_source, const String &p_word) {
+	int from = 0;
+	while ((from = p_source.find(p_word, from)) != -1) {
+		const int end = from + p_word.length();
+		const bool starts_word = from == 0 || !is_ascii_identifier_char(p_source[from - 1]);
+		const bool ends_word = end >= p_source.length() || !is_ascii_identifier_char(p_source[end]);
+		if (starts_word && ends_word) {
+			return p_source.count("\n", 0, from) + 1;
+		}
+		from = end;
+	}
+	return 0;
+}
+
+void _collect_scripts(const String &p_dir, Vector<String> &r_paths) {
+	Ref<DirAccess> dir = DirAccess::open(p_dir);
+	if (dir.is_null() || dir->file_exists(".gdignore")) {
+		return;
+	}
+	dir->list_dir_begin();
+	for (String name = dir->get_next(); !name.is_empty(); name = dir->get_next()) {
+		if (name.begins_with(".")) {
+			continue;
+		}
+		const String path = p_dir.path_join(name);
+		if (dir->current_is_dir()) {
+			_collect_scripts(path, r_paths);
+		} else if (name.get_extension() == "gd") {
+			r_paths.push_back(path);
+		}
+	}
+	dir->list_dir_end();
+}
+
+// Returns the current source of every project script, reading only files
+// changed since the last call.
+HashMap<String, String> _get_project_sources() {
+	Vector<String> paths;
+	_collect_scripts("res://", paths);
+
+	HashMap<String, String> result;
+	LRUCache<String, SourceEntry> &sources = _get_source_cache();
+	for (const String &path : paths) {
+		const uint64_t modified_time = FileAccess::get_modified_time(path);
+		{
+			MutexLock lock(validator_mutex);
+			const SourceEntry *entry = sources.getptr(path);
+			if (entry && entry->modified_time == modified_time) {
+				result.insert(path, entry->source);
+				continue;
+			}
+		}
+		SourceEntry entry;
+		entry.modified_time = modified_time;
+		entry.source = FileAccess::get_file_as_string(path);
+		result.insert(path, entry.source);
+		MutexLock lock(validator_mutex);
+		sources.insert(path, entry);
+	}
+	return result;
+}
+
+} // namespace
+
+Array AIScriptValidator::validate(const Vector<Candidate> &p_candidates) {
+	Array results;
+	if (p_candidates.is_empty()) {
+		return results;
+	}
+
+	Vector<ValidationJob> jobs;
+	jobs.resize(p_candidates.size());
+	for (int i = 0; i < p_candidates.size(); i++) {
+		jobs.write[i].candidate = &p_candidates[i];
+	}
+	if (jobs.size() == 1) {
+		_validate_task(jobs.ptrw(), 0);
+	} else {
+		WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_native_group_task(&_validate_task, jobs.ptrw(), jobs.size(), -1, true, SNAME("AIScriptValidator"));
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+	}
+
+	// Find the scripts each interface change would break. Other candidates
+	// are checked in their proposed form.
+	Vector<Vector<InterfaceChange>> changes;
+	changes.resize(jobs.size());
+	bool has_changes = false;
+	for (int i = 0; i < jobs.size(); i++) {
+		_diff_interfaces(jobs[i].old_interface, jobs[i].new_interface, changes.write[i]);
+		has_changes = has_changes || !changes[i].is_empty();
+	}
+	HashMap<String, String> sources;
+	if (has_changes) {
+		sources = _get_project_sources();
+		for (const Candidate &candidate : p_candidates) {
+			sources[candidate.path] = candidate.content;
+		}
+	}
+
+	for (int i = 0; i < jobs.size(); i++) {
+		const ValidationJob &job = jobs[i];
+		const String &path = job.candidate->path;
+		Array broken_dependents;
+		if (!changes[i].is_empty()) {
+			const String &class_name = job.old_interface.class_name;
+			for (const KeyValue<String, String> &E : sources) {
+				if (E.key == path) {
+					continue;
+				}
+				const bool references = E.value.contains("\"" + path + "\"") || E.value.contains("'" + path + "'") || (!class_name.is_empty() && _find_word_line(E.value, class_name) > 0);
+				if (!references) {
+					continue;
+				}
+				for (const InterfaceChange &change : changes[i]) {
+					const int line = _find_word_line(E.value, change.symbol);
+					if (line > 0) {
+						Dictionary dependent;
+						dependent["path"] = E.key;
+						dependent["line"] = line;
+						dependent["symbol"] = change.symbol;
+						dependent["reason"] = change.reason;
+						broken_dependents.push_back(dependent);
+					}
+				}
+			}
+		}
+
+		// Other candidates this one was analyzed against, in their on-disk form.
+		Array resolved_from_disk;
+		for (const DependencyStamp &stamp : job.dependencies) {
+			for (const Candidate &candidate : p_candidates) {
+				if (candidate.path == stamp.path && candidate.path != path) {
+					resolved_from_disk.push_back(stamp.path);
+					break;
+				}
+			}
+		}
+
+		Dictionary result;
+		result["path"] = path;
+		result["errors"] = job.errors;
+		result["has_errors"] = !job.errors.is_empty();
+		result["error_count"] = job.errors.size();
+		result["broken_dependents"] = broken_dependents;
+		result["cached"] = job.cached;
+		result["resolved_from_disk"] = resolved_from_disk;
+		results.push_back(result);
+	}
+	return results;
+}
+
+void AIScriptValidator::clear_cache() {
+	MutexLock lock(validator_mutex);
+	_get_result_cache().clear();
+	_get_source_cache().clear();
+}
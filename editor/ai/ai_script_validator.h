@@ -0,0 +1,73 @@
+/**************************************************************************/
+/*  ai_script_validator.h                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+
+#pragma once
+
+#include "core/string/ustring.h"
+#include "core/templates/vector.h"
+#include "core/variant/array.h"
+
+// Validates proposed GDScript sources without writing them to disk.
+//
+// Each candidate is parsed, analyzed and compiled on the WorkerThreadPool,
+// so the files of a multi-file edit are checked concurrently. Unchanged
+// dependencies are resolved through GDScriptCache, which keeps their parsed
+// interfaces between runs. Results are cached per source and reused as long
+// as the files the script depended on keep their modification times.
+//
+// The public interface of each candidate (class_name and top-level members
+// with their argument counts) is compared with the current version, and
+// project scripts that reference the candidate and use a removed or changed
+// member are reported as broken dependents.
+//
+// Candidates are not visible to each other's analysis: a candidate that
+// extends, preloads or names the class of another candidate is checked
+// against that file as it is on disk. Those paths are reported in
+// `resolved_from_disk`, as their errors may go away once all files are
+// written. The broken dependents search does see the proposed sources.
+class AIScriptValidator {
+public:
+	struct Candidate {
+		String path;
+		String content;
+		// Previous version used for the interface comparison. The file on
+		// disk is used when this is empty.
+		String original;
+	};
+
+	// Returns one Dictionary per candidate, in order, with `path`, `errors`
+	// (`type`, `line`, `column`, `message`), `has_errors`, `error_count`,
+	// `broken_dependents` (`path`, `line`, `symbol`, `reason`), `cached` and
+	// `resolved_from_disk`.
+	// Safe to call from any thread.
+	static Array validate(const Vector<Candidate> &p_candidates);
+	static void clear_cache();
+};
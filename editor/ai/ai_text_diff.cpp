@@ -0,0 +1,478 @@
+/**************************************************************************/
+/*  ai_text_diff.cpp                                                      */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+
+#include "ai_text_diff.h"
+
+#include "core/os/mutex.h"
+#include "core/string/string_builder.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/hashfuncs.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/lru.h"
+
+// Lines repeated more often than this are not used as histogram anchors.
+static constexpr uint32_t HISTOGRAM_MAX_OCCURRENCES = 64;
+static constexpr int DIFF_CACHE_CAPACITY = 32;
+
+namespace {
+
+struct DiffCacheKey {
+	uint64_t old_hash = 0;
+	uint64_t new_hash = 0;
+
+	bool operator==(const DiffCacheKey &p_other) const {
+		return old_hash == p_other.old_hash && new_hash == p_other.new_hash;
+	}
+
+	static uint32_t hash(const DiffCacheKey &p_key) {
+		return hash_fmix32(hash_murmur3_one_64(p_key.new_hash, hash_murmur3_one_64(p_key.old_hash)));
+	}
+};
+
+struct DiffRange {
+	int a_begin = 0;
+	int a_end = 0;
+	int b_begin = 0;
+	int b_end = 0;
+	bool myers = false;
+};
+
+// Marks every line of `a` that is removed and every line of `b` that is
+// added. Ranges are processed from an explicit stack so long files cannot
+// exhaust the call stack.
+class LineDiffer {
+	const uint32_t *a = nullptr;
+	const uint32_t *b = nullptr;
+	uint8_t *removed = nullptr;
+	uint8_t *added = nullptr;
+
+	// Histogram tables, indexed by line ID. Entries are reset after use so
+	// each range only pays for its own lines.
+	LocalVector<uint32_t> counts;
+	LocalVector<int> heads;
+	LocalVector<int> next;
+
+	// Myers V arrays, indexed by diagonal + offset.
+	LocalVector<int> forward;
+	LocalVector<int> backward;
+
+	LocalVector<DiffRange> stack;
+
+	bool _split_histogram(const DiffRange &p_range);
+	void _split_myers(const DiffRange &p_range);
+
+public:
+	void run(const LocalVector<uint32_t> &p_a, const LocalVector<uint32_t> &p_b, uint32_t p_id_count, LocalVector<uint8_t> &r_removed, LocalVector<uint8_t> &r_added);
+};
+
+bool LineDiffer::_split_histogram(const DiffRange &p_range) {
+	for (int i = p_range.a_end - 1; i >= p_range.a_begin; i--) {
+		const uint32_t id = a[i];
+		next[i] = heads[id];
+		heads[id] = i;
+		counts[id]++;
+	}
+
+	// Pick the common region whose rarest line is the rarest overall,
+	// preferring longer regions on ties.
+	uint32_t best_count = HISTOGRAM_MAX_OCCURRENCES + 1;
+	int best_length = 0;
+	DiffRange before = p_range;
+	DiffRange after = p_range;
+	for (int j = p_range.b_begin; j < p_range.b_end;) {
+		const uint32_t count = counts[b[j]];
+		int next_j = j + 1;
+		if (count == 0 || count > best_count) {
+			j = next_j;
+			continue;
+		}
+		for (int i = heads[b[j]]; i != -1; i = next[i]) {
+			int a_start = i;
+			int b_start = j;
+			while (a_start > p_range.a_begin && b_start > p_range.b_begin && a[a_start - 1] == b[b_start - 1]) {
+				a_start--;
+				b_start--;
+			}
+			int a_stop = i + 1;
+			int b_stop = j + 1;
+			while (a_stop < p_range.a_end && b_stop < p_range.b_end && a[a_stop] == b[b_stop]) {
+				a_stop++;
+				b_stop++;
+			}
+			uint32_t region_count = count;
+			for (int k = a_start; k < a_stop; k++) {
+				region_count = MIN(region_count, counts[a[k]]);
+			}
+			if (region_count < best_count || (region_count == best_count && a_stop - a_start > best_length)) {
+				best_count = region_count;
+				best_length = a_stop - a_start;
+				before.a_end = a_start;
+				before.b_end = b_start;
+				after.a_begin = a_stop;
+				after.b_begin = b_stop;
+			}
+			next_j = MAX(next_j, b_stop);
+		}
+		j = next_j;
+	}
+
+	for (int i = p_range.a_begin; i < p_range.a_end; i++) {
+		heads[a[i]] = -1;
+		counts[a[i]] = 0;
+	}
+
+	if (best_length == 0) {
+		return false;
+	}
+	stack.push_back(before);
+	stack.push_back(after);
+	return true;
+}
+
+void LineDiffer::_split_myers(const DiffRange &p_range) {
+	// Finds the middle snake of the range (Myers 1986, section 4b) and
+	// splits the range there. The caller trimmed the common prefix and
+	// suffix, so the edit distance is at least 2 and both halves shrink.
+	const uint32_t *ra = a + p_range.a_begin;
+	const uint32_t *rb = b + p_range.b_begin;
+	const int n = p_range.a_end - p_range.a_begin;
+	const int m = p_range.b_end - p_range.b_begin;
+	const int delta = n - m;
+	const bool odd = delta & 1;
+	const int max_d = (n + m + 1) / 2;
+	const int offset = max_d + 1;
+	int *vf = forward.ptr() + offset;
+	int *vb = backward.ptr() + offset;
+	vf[1] = 0;
+	vb[1] = 0;
+
+	int split_a = 0;
+	int split_b = 0;
+	for (int d = 0; d <= max_d; d++) {
+		for (int k = -d; k <= d; k += 2) {
+			int x = (k == -d || (k != d && vf[k - 1] < vf[k + 1])) ? vf[k + 1] : vf[k - 1] + 1;
+			int y = x - k;
+			while (x < n && y < m && ra[x] == rb[y]) {
+				x++;
+				y++;
+			}
+			vf[k] = x;
+			const int kb = delta - k;
+			if (odd && kb >= -(d - 1) && kb <= d - 1 && x + vb[kb] >= n) {
+				split_a = x;
+				split_b = y;
+				goto found;
+			}
+		}
+		for (int k = -d; k <= d; k += 2) {
+			int x = (k == -d || (k != d && vb[k - 1] < vb[k + 1])) ? vb[k + 1] : vb[k - 1] + 1;
+			int y = x - k;
+			while (x < n && y < m && ra[n - 1 - x] == rb[m - 1 - y]) {
+				x++;
+				y++;
+			}
+			vb[k] = x;
+			const int kf = delta - k;
+			if (!odd && kf >= -d && kf <= d && x + vf[kf] >= n) {
+				split_a = n - x;
+				split_b = m - y;
+				goto found;
+			}
+		}
+	}
+
+	// Not reached for trimmed ranges; replace the range as a whole rather
+	// than push it back unchanged.
+	for (int i = p_range.a_begin; i < p_range.a_end; i++) {
+		removed[i] = 1;
+	}
+	for (int j = p_range.b_begin; j < p_range.b_end; j++) {
+		added[j] = 1;
+	}
+	return;
+
+found:
+	DiffRange before = p_range;
+	before.a_end = p_range.a_begin + split_a;
+	before.b_end = p_range.b_begin + split_b;
+	before.myers = true;
+	DiffRange after = p_range;
+	after.a_begin = before.a_end;
+	after.b_begin = before.b_end;
+	after.myers = true;
+	stack.push_back(before);
+	stack.push_back(after);
+}
+
+void LineDiffer::run(const LocalVector<uint32_t> &p_a, const LocalVector<uint32_t> &p_b, uint32_t p_id_count, LocalVector<uint8_t> &r_removed, LocalVector<uint8_t> &r_added) {
+	r_removed.resize(p_a.size());
+	r_added.resize(p_b.size());
+	memset(r_removed.ptr(), 0, r_removed.size());
+	memset(r_added.ptr(), 0, r_added.size());
+	a = p_a.ptr();
+	b = p_b.ptr();
+	removed = r_removed.ptr();
+	added = r_added.ptr();
+
+	counts.resize(p_id_count);
+	memset(counts.ptr(), 0, counts.size() * sizeof(uint32_t));
+	heads.resize(p_id_count);
+	for (int &head : heads) {
+		head = -1;
+	}
+	next.resize(p_a.size());
+	const uint32_t v_size = p_a.size() + p_b.size() + 4;
+	forward.resize(v_size);
+	backward.resize(v_size);
+
+	DiffRange full;
+	full.a_end = p_a.size();
+	full.b_end = p_b.size();
+	stack.push_back(full);
+	while (!stack.is_empty()) {
+		DiffRange range = stack[stack.size() - 1];
+		stack.resize(stack.size() - 1);
+
+		while (range.a_begin < range.a_end && range.b_begin < range.b_end && a[range.a_begin] == b[range.b_begin]) {
+			range.a_begin++;
+			range.b_begin++;
+		}
+		while (range.a_begin < range.a_end && range.b_begin < range.b_end && a[range.a_end - 1] == b[range.b_end - 1]) {
+			range.a_end--;
+			range.b_end--;
+		}
+		if (range.a_begin == range.a_end || range.b_begin == range.b_end) {
+			for (int i = range.a_begin; i < range.a_end; i++) {
+				removed[i] = 1;
+			}
+			for (int j = range.b_begin; j < range.b_end; j++) {
+				added[j] = 1;
+			}
+			continue;
+		}
+		if (!range.myers && _split_histogram(range)) {
+			continue;
+		}
+		_split_myers(range);
+	}
+}
+
+Mutex diff_cache_mutex;
+
+LRUCache<DiffCacheKey, AITextDiff, DiffCacheKey> &_get_diff_cache() {
+	static LRUCache<DiffCacheKey, AITextDiff, DiffCacheKey> cache(DIFF_CACHE_CAPACITY);
+	return cache;
+}
+
+} // namespace
+
+void AITextDiff::_compute() {
+	old_lines = old_text.split("\n");
+	new_lines = new_text.split("\n");
+
+	// Intern lines so the differ only compares integers.
+	HashMap<String, uint32_t> ids;
+	LocalVector<uint32_t> a;
+	LocalVector<uint32_t> b;
+	a.resize(old_lines.size());
+	b.resize(new_lines.size());
+	for (int i = 0; i < old_lines.size(); i++) {
+		HashMap<String, uint32_t>::Iterator E = ids.find(old_lines[i]);
+		a[i] = E ? E->value : ids.insert(old_lines[i], ids.size())->value;
+	}
+	for (int i = 0; i < new_lines.size(); i++) {
+		HashMap<String, uint32_t>::Iterator E = ids.find(new_lines[i]);
+		b[i] = E ? E->value : ids.insert(new_lines[i], ids.size())->value;
+	}
+
+	LocalVector<uint8_t> removed;
+	LocalVector<uint8_t> added;
+	LineDiffer differ;
+	differ.run(a, b, ids.size(), removed, added);
+
+	// Deletions come before insertions inside each change block, as in
+	// unified diffs.
+	LocalVector<Line> result;
+	result.reserve(a.size() + b.size());
+	int i = 0;
+	int j = 0;
+	while (i < (int)a.size() || j < (int)b.size()) {
+		Line line;
+		if (i < (int)a.size() && removed[i]) {
+			line.op = OP_DELETE;
+			line.old_line = i++;
+			deleted_count++;
+		} else if (j < (int)b.size() && added[j]) {
+			line.op = OP_INSERT;
+			line.new_line = j++;
+			inserted_count++;
+		} else {
+			line.old_line = i++;
+			line.new_line = j++;
+		}
+		result.push_back(line);
+	}
+	lines.resize(result.size());
+	if (!result.is_empty()) {
+		memcpy(lines.ptrw(), result.ptr(), result.size() * sizeof(Line));
+	}
+}
+
+AITextDiff AITextDiff::compute(const String &p_old, const String &p_new) {
+	DiffCacheKey key;
+	key.old_hash = p_old.hash64();
+	key.new_hash = p_new.hash64();
+	{
+		MutexLock lock(diff_cache_mutex);
+		const AITextDiff *cached = _get_diff_cache().getptr(key);
+		if (cached && cached->old_text == p_old && cached->new_text == p_new) {
+			return *cached;
+		}
+	}
+
+	AITextDiff diff;
+	diff.old_text = p_old;
+	diff.new_text = p_new;
+	diff._compute();
+
+	MutexLock lock(diff_cache_mutex);
+	_get_diff_cache().insert(key, diff);
+	return diff;
+}
+
+void AITextDiff::clear_cache() {
+	MutexLock lock(diff_cache_mutex);
+	_get_diff_cache().clear();
+}
+
+Vector<AITextDiff::Hunk> AITextDiff::get_hunks(int p_context_lines) const {
+	Vector<Hunk> hunks;
+	const int context = MAX(0, p_context_lines);
+	const int count = lines.size();
+	const Line *ptr = lines.ptr();
+
+	int old_pos = 0; // Old and new lines before `index`.
+	int new_pos = 0;
+	int index = 0;
+	int previous_stop = 0; // Lines before this belong to the previous hunk.
+	while (index < count) {
+		if (ptr[index].op == OP_EQUAL) {
+			old_pos++;
+			new_pos++;
+			index++;
+			continue;
+		}
+
+		// Grow the hunk while the next change is within twice the context.
+		int change_end = index;
+		int scan = index;
+		while (scan < count) {
+			if (ptr[scan].op != OP_EQUAL) {
+				change_end = ++scan;
+				continue;
+			}
+			int run_end = scan;
+			while (run_end < count && ptr[run_end].op == OP_EQUAL) {
+				run_end++;
+			}
+			if (run_end == count || run_end - scan > 2 * context) {
+				break;
+			}
+			scan = run_end;
+		}
+
+		// Everything since the previous hunk is unchanged, so leading context
+		// moves both positions back by the same amount.
+		Hunk hunk;
+		hunk.first_line = index - MIN(context, index - previous_stop);
+		hunk.old_start = old_pos - (index - hunk.first_line);
+		hunk.new_start = new_pos - (index - hunk.first_line);
+		const int stop = MIN(count, change_end + context);
+		hunk.line_count = stop - hunk.first_line;
+		for (int k = index; k < stop; k++) {
+			if (ptr[k].op != OP_INSERT) {
+				old_pos++;
+			}
+			if (ptr[k].op != OP_DELETE) {
+				new_pos++;
+			}
+		}
+		hunk.old_count = old_pos - hunk.old_start;
+		hunk.new_count = new_pos - hunk.new_start;
+		hunks.push_back(hunk);
+		index = stop;
+		previous_stop = stop;
+	}
+	return hunks;
+}
+
+String AITextDiff::to_unified(const String &p_old_label, const String &p_new_label, int p_context_lines) const {
+	StringBuilder diff;
+	diff.append("--- " + p_old_label + "\n");
+	diff.append("+++ " + p_new_label + "\n");
+	const Vector<Hunk> hunks = get_hunks(p_context_lines);
+	for (const Hunk &hunk : hunks) {
+		// Empty ranges name the line before them, as in GNU diff.
+		diff.append("@@ -" + itos(hunk.old_count ? hunk.old_start + 1 : hunk.old_start) + "," + itos(hunk.old_count));
+		diff.append(" +" + itos(hunk.new_count ? hunk.new_start + 1 : hunk.new_start) + "," + itos(hunk.new_count) + " @@\n");
+		for (int i = hunk.first_line; i < hunk.first_line + hunk.line_count; i++) {
+			const Line &line = lines[i];
+			diff.append(line.op == OP_INSERT ? "+" : (line.op == OP_DELETE ? "-" : " "));
+			diff.append(get_line_text(line));
+			diff.append("\n");
+		}
+	}
+	return diff.as_string();
+}
+
+String AITextDiff::apply_hunks(const Vector<Hunk> &p_hunks, const Vector<bool> &p_accepted) const {
+	Vector<String> result;
+	int hunk = 0;
+	for (int i = 0; i < lines.size(); i++) {
+		while (hunk < p_hunks.size() && i >= p_hunks[hunk].first_line + p_hunks[hunk].line_count) {
+			hunk++;
+		}
+		const Line &line = lines[i];
+		if (line.op == OP_EQUAL) {
+			result.push_back(get_line_text(line));
+			continue;
+		}
+		bool accepted = true;
+		if (hunk < p_hunks.size() && i >= p_hunks[hunk].first_line && hunk < p_accepted.size()) {
+			accepted = p_accepted[hunk];
+		}
+		// Keep insertions of accepted hunks and deletions of rejected ones.
+		if ((line.op == OP_INSERT) == accepted) {
+			result.push_back(get_line_text(line));
+		}
+	}
+	return String("\n").join(result);
+}
@@ -0,0 +1,103 @@
+/**************************************************************************/
+/*  ai_text_diff.h                                                        */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+
+#pragma once
+
+#include "core/string/ustring.h"
+#include "core/templates/vector.h"
+
+// Line diff shared by apply_edit, the DiffViewer and the script editor preview.
+//
+// Lines are interned into integer IDs so the algorithms compare integers.
+// After trimming the common prefix and suffix, ranges are split around the
+// rarest common line (histogram diff), which keeps moved and repeated blocks
+// readable; ranges without a usable anchor fall back to a linear-space Myers
+// diff. Results are cached by the hashes of both texts and only hold
+// copy-on-write containers, so passing them around by value is cheap and the
+// rendering, unified text and hunk selection of one edit share a single run.
+class AITextDiff {
+public:
+	enum Operation : uint8_t {
+		OP_EQUAL,
+		OP_DELETE,
+		OP_INSERT,
+	};
+
+	struct Line {
+		Operation op = OP_EQUAL;
+		int old_line = -1; // 0-based; -1 for insertions.
+		int new_line = -1; // 0-based; -1 for deletions.
+	};
+
+	// Range of `get_lines()`, context included. Starts are 0-based.
+	struct Hunk {
+		int old_start = 0;
+		int old_count = 0;
+		int new_start = 0;
+		int new_count = 0;
+		int first_line = 0;
+		int line_count = 0;
+	};
+
+	static constexpr int DEFAULT_CONTEXT_LINES = 3;
+
+private:
+	String old_text;
+	String new_text;
+	Vector<String> old_lines;
+	Vector<String> new_lines;
+	Vector<Line> lines;
+	int deleted_count = 0;
+	int inserted_count = 0;
+
+	void _compute();
+
+public:
+	// Returns a cached result when the same pair was diffed recently. Safe
+	// to call from any thread.
+	static AITextDiff compute(const String &p_old, const String &p_new);
+	static void clear_cache();
+
+	const Vector<String> &get_old_lines() const { return old_lines; }
+	const Vector<String> &get_new_lines() const { return new_lines; }
+	const Vector<Line> &get_lines() const { return lines; }
+	const String &get_line_text(const Line &p_line) const { return p_line.op == OP_INSERT ? new_lines[p_line.new_line] : old_lines[p_line.old_line]; }
+	bool has_changes() const { return deleted_count > 0 || inserted_count > 0; }
+	int get_deleted_count() const { return deleted_count; }
+	int get_inserted_count() const { return inserted_count; }
+
+	// Changes closer than twice the context share a hunk.
+	Vector<Hunk> get_hunks(int p_context_lines = DEFAULT_CONTEXT_LINES) const;
+	String to_unified(const String &p_old_label, const String &p_new_label, int p_context_lines = DEFAULT_CONTEXT_LINES) const;
+	// Rebuilds the text keeping the new side of accepted hunks and the old
+	// side of the others. `p_accepted` is indexed like `get_hunks()`.
+	String apply_hunks(const Vector<Hunk> &p_hunks, const Vector<bool> &p_accepted) const;
+};
@@ -0,0 +1,181 @@
+/**************************************************************************/
+/*  ai_tool_cache.cpp                                                     */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ai_tool_cache.h"
+
+#include "ai_scene_snapshot.h"
+
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+#include "core/object/class_db.h"
+#include "core/os/mutex.h"
+#include "core/templates/lru.h"
+#include "core/templates/safe_refcount.h"
+#include "editor/editor_node.h"
+#include "editor/file_system/editor_file_system.h"
+
+static constexpr int CACHE_CAPACITY = 256;
+
+namespace {
+
+struct CacheEntry {
+	Dictionary result;
+	uint64_t class_version = 0;
+	uint64_t scene_version = 0;
+	uint64_t file_version = 0;
+	uint64_t path_modified_time = 0;
+	int64_t path_size = 0;
+};
+
+Mutex cache_mutex;
+SafeNumeric<uint64_t> file_version;
+SafeFlag tracking_files;
+
+LRUCache<String, CacheEntry> &_get_cache() {
+	static LRUCache<String, CacheEntry> cache(CACHE_CAPACITY);
+	return cache;
+}
+
+void _on_files_changed() {
+	file_version.increment();
+}
+
+void _on_resources_changed(const PackedStringArray &p_resources) {
+	file_version.increment();
+}
+
+void _on_sources_changed(bool p_exist) {
+	file_version.increment();
+}
+
+void _on_resource_saved(Object *p_resource) {
+	file_version.increment();
+}
+
+void _on_scene_saved(const String &p_path) {
+	file_version.increment();
+}
+
+} // namespace
+
+void AIToolCache::start() {
+	EditorFileSystem *efs = EditorFileSystem::get_singleton();
+	if (!efs || tracking_files.is_set()) {
+		return;
+	}
+	efs->connect("filesystem_changed", callable_mp_static(&_on_files_changed));
+	efs->connect("sources_changed", callable_mp_static(&_on_sources_changed));
+	efs->connect("resources_reimported", callable_mp_static(&_on_resources_changed));
+	efs->connect("resources_reload", callable_mp_static(&_on_resources_changed));
+	// Saves reach EditorFileSystem through a deferred rescan.
+	if (EditorNode *editor = EditorNode::get_singleton()) {
+		editor->connect("resource_saved", callable_mp_static(&_on_resource_saved));
+		editor->connect("scene_saved", callable_mp_static(&_on_scene_saved));
+	}
+	tracking_files.set();
+}
+
+void AIToolCache::stop() {
+	EditorFileSystem *efs = EditorFileSystem::get_singleton();
+	if (efs && tracking_files.is_set()) {
+		efs->disconnect("filesystem_changed", callable_mp_static(&_on_files_changed));
+		efs->disconnect("sources_changed", callable_mp_static(&_on_sources_changed));
+		efs->disconnect("resources_reimported", callable_mp_static(&_on_resources_changed));
+		efs->disconnect("resources_reload", callable_mp_static(&_on_resources_changed));
+	}
+	EditorNode *editor = EditorNode::get_singleton();
+	if (editor && editor->is_connected("resource_saved", callable_mp_static(&_on_resource_saved))) {
+		editor->disconnect("resource_saved", callable_mp_static(&_on_resource_saved));
+		editor->disconnect("scene_saved", callable_mp_static(&_on_scene_saved));
+	}
+	tracking_files.clear();
+	clear();
+}
+
+Dictionary AIToolCache::get_or_compute(const String &p_tool, const Dictionary &p_args, uint32_t p_dependencies, ToolFunction p_function) {
+	CacheEntry current;
+	if (p_dependencies & DEPENDS_ON_CLASSES) {
+		current.class_version = ClassDB::get_class_list_version();
+	}
+	if (p_dependencies & DEPENDS_ON_SCENE) {
+		AISceneSnapshot *snapshot = AISceneSnapshot::get_singleton();
+		if (!snapshot) {
+			return p_function(p_args);
+		}
+		current.scene_version = snapshot->get_version();
+	}
+	if (p_dependencies & DEPENDS_ON_FILES) {
+		if (!tracking_files.is_set()) {
+			return p_function(p_args);
+		}
+		current.file_version = file_version.get();
+	}
+	if (p_dependencies & DEPENDS_ON_PATH) {
+		const String path = p_args.get("path", String());
+		if (path.is_empty() || !FileAccess::exists(path)) {
+			return p_function(p_args);
+		}
+		current.path_modified_time = FileAccess::get_modified_time(path);
+		current.path_size = FileAccess::get_size(path);
+	}
+
+	const String key = p_tool + ":" + JSON::stringify(p_args, "", true);
+	{
+		MutexLock lock(cache_mutex);
+		const CacheEntry *entry = _get_cache().getptr(key);
+		if (entry && entry->class_version == current.class_version && entry->scene_version == current.scene_version && entry->file_version == current.file_version &&
+				entry->path_modified_time == current.path_modified_time && entry->path_size == current.path_size) {
+			// Callers may edit the result they get, so hand out a copy.
+			return entry->result.duplicate(true);
+		}
+	}
+
+	const Dictionary result = p_function(p_args);
+	// Failures are cheap to recompute and often transient (no scene open yet).
+	if (bool(result.get("success", false))) {
+		current.result = result.duplicate(true);
+		MutexLock lock(cache_mutex);
+		_get_cache().insert(key, current);
+	}
+	return result;
+}
+
+void AIToolCache::notify_files_changed() {
+	file_version.increment();
+}
+
+uint64_t AIToolCache::get_file_version() {
+	return file_version.get();
+}
+
+void AIToolCache::clear() {
+	MutexLock lock(cache_mutex);
+	_get_cache().clear();
+}
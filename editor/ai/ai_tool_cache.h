@@ -0,0 +1,80 @@
+/**************************************************************************/
+/*  ai_tool_cache.h                                                       */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/variant/dictionary.h"
+
+// Memoizes the results of idempotent editor tools.
+//
+// Entries are keyed by the tool name and its arguments as canonical
+// (sorted-key) JSON, and are stamped with the versions of what the tool
+// reads: the ClassDB class list, the structure of the edited scene
+// (AISceneSnapshot), the project file tree and the file named by the `path`
+// argument. An entry is only served while every version it depends on is
+// unchanged, so a hit never returns a result that a recomputation would not.
+// Tools with side effects outside these sources clear the cache.
+//
+// Property values can change without going through the snapshot (tool
+// scripts, animations, plugins), so tools that read them are not cached.
+//
+// Lookups are thread-safe; file-only tools run on worker threads.
+class AIToolCache {
+public:
+	enum Dependency {
+		DEPENDS_ON_CLASSES = 1 << 0,
+		DEPENDS_ON_SCENE = 1 << 1,
+		DEPENDS_ON_FILES = 1 << 2,
+		// Stamped with the modification time and size of the file at `path`,
+		// so edits from outside the editor and paths outside the project
+		// (user://, absolute) are seen as well. Modification times have a one
+		// second resolution, so combine with DEPENDS_ON_FILES to also see
+		// quick successive edits made by the editor.
+		DEPENDS_ON_PATH = 1 << 3,
+	};
+
+	typedef Dictionary (*ToolFunction)(const Dictionary &p_args);
+
+	// Tracks file changes through EditorFileSystem and editor saves. Until
+	// then, tools that depend on files are never cached.
+	static void start();
+	static void stop();
+
+	// Returns the cached result of `p_function` for these arguments, or runs it
+	// and caches successful results. Scene-dependent tools are only cached
+	// while an AISceneSnapshot exists and must be called on the main thread.
+	static Dictionary get_or_compute(const String &p_tool, const Dictionary &p_args, uint32_t p_dependencies, ToolFunction p_function);
+
+	// For writes that bypass EditorFileSystem or precede its deferred signal.
+	static void notify_files_changed();
+	// Bumped on every file change the cache sees, for other caches of file contents.
+	static uint64_t get_file_version();
+	static void clear();
+};
@@ -0,0 +1,64 @@
+/**************************************************************************/
+/*  ai_worker_jobs.cpp                                                    */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ai_worker_jobs.h"
+
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+
+static Mutex prune_mutex;
+
+void AIDiskCache::prune(const String &p_dir, int p_max_files) {
+	MutexLock lock(prune_mutex);
+
+	Ref<DirAccess> dir = DirAccess::open(p_dir);
+	if (dir.is_null()) {
+		return;
+	}
+	struct CachedFile {
+		uint64_t modified_time = 0;
+		String path;
+		bool operator<(const CachedFile &p_other) const { return modified_time < p_other.modified_time; }
+	};
+	Vector<CachedFile> files;
+	for (const String &name : dir->get_files()) {
+		CachedFile cached;
+		cached.path = p_dir.path_join(name);
+		cached.modified_time = FileAccess::get_modified_time(cached.path);
+		files.push_back(cached);
+	}
+	if (files.size() <= p_max_files) {
+		return;
+	}
+	files.sort();
+	for (int i = 0; i < files.size() - p_max_files; i++) {
+		DirAccess::remove_absolute(files[i].path);
+	}
+}
@@ -0,0 +1,87 @@
+/**************************************************************************/
+/*  ai_worker_jobs.h                                                      */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/worker_thread_pool.h"
+#include "core/os/mutex.h"
+#include "core/string/ustring.h"
+#include "core/templates/hash_map.h"
+
+// Bookkeeping shared by the AI pipelines that run jobs on the
+// WorkerThreadPool and keep their output in an editor cache directory.
+
+// Jobs in flight, keyed by id so that callbacks from other threads never hold
+// a pointer to a job that was already finished. `T` needs a `task` member.
+template <typename T>
+class AIJobRegistry {
+	Mutex mutex;
+	HashMap<uint64_t, T *> jobs;
+	uint64_t last_id = 0;
+
+public:
+	// Hold it while touching a registered job from another thread.
+	Mutex &get_mutex() { return mutex; }
+
+	uint64_t add(T *p_job) {
+		MutexLock lock(mutex);
+		const uint64_t id = ++last_id;
+		jobs.insert(id, p_job);
+		return id;
+	}
+
+	// Expects the mutex to be held.
+	T *find(uint64_t p_id) const {
+		T *const *job = jobs.getptr(p_id);
+		return job ? *job : nullptr;
+	}
+
+	// Unregisters the job and waits for its task, so the caller owns it.
+	T *take(uint64_t p_id) {
+		T *job = nullptr;
+		{
+			MutexLock lock(mutex);
+			T **found = jobs.getptr(p_id);
+			ERR_FAIL_NULL_V(found, nullptr);
+			job = *found;
+			jobs.erase(p_id);
+		}
+		if (job->task != WorkerThreadPool::INVALID_TASK_ID) {
+			WorkerThreadPool::get_singleton()->wait_for_task_completion(job->task);
+		}
+		return job;
+	}
+};
+
+class AIDiskCache {
+public:
+	// Removes the oldest files of `p_dir` until at most `p_max_files` are left.
+	static void prune(const String &p_dir, int p_max_files);
+};
@@ -1,18 +1,33 @@
 #include "editor_tools.h"
 
+#include "ai_file_query.h"
+#include "ai_project_index.h"
+#include "ai_scene_snapshot.h"
+#include "ai_screenshot_capture.h"
+#include "ai_script_validator.h"
+#include "ai_text_diff.h"
+#include "ai_tool_cache.h"
+
 #include "core/crypto/crypto.h"
 #include "core/io/dir_access.h"
 #include "core/io/file_access.h"
 #include "core/io/http_client.h"
+#include "core/io/http_connection_pool.h"
 #include "core/io/json.h"
 #include "core/io/resource_loader.h"
 #include "core/config/project_settings.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/mutex.h"
+#include "core/string/string_builder.h"
+#include "core/templates/lru.h"
 #include "editor/editor_data.h"
+#include "editor/file_system/editor_file_system.h"
 #include "editor/editor_interface.h"
 #include "editor/editor_node.h"
 #include "editor/settings/editor_settings.h"
 #include "core/variant/typed_array.h"
 #include "editor/editor_string_names.h"
+#include "editor/editor_undo_redo_manager.h"
 #include "editor/docks/scene_tree_dock.h"
 #include "editor/docks/ai_chat_dock.h"
 #include "editor/run/editor_run_bar.h"
@@ -20,17 +35,96 @@
 #include "editor/script/script_text_editor.h"
 #include "scene/main/node.h"
 #include "scene/main/window.h"
-#include "modules/gdscript/gdscript.h"
-#include "modules/gdscript/gdscript_parser.h"
-#include "modules/gdscript/gdscript_analyzer.h"
-#include "modules/gdscript/gdscript_compiler.h"
 
 #include <functional>
 #include <utility>
 // Static members for simple signal tracing
 EditorTools *EditorTools::tracer_instance = nullptr;
-Dictionary EditorTools::trace_registry;
-Dictionary EditorTools::property_watch_registry;
+EditorUndoRedoManager *EditorTools::batch_undo_redo = nullptr;
+bool EditorTools::batch_save_pending = false;
+
+// Fixed-capacity event log. Every event gets the next cursor value; once
+// full, the oldest event is overwritten, so recording is O(1) no matter how
+// noisy the source is. Readers fetch everything after a cursor.
+template <typename T>
+class EventRing {
+	LocalVector<T> slots;
+	uint64_t next_index = 0;
+
+public:
+	void set_capacity(int p_capacity) { slots.resize(MAX(1, p_capacity)); }
+	uint64_t get_next_index() const { return next_index; }
+	uint64_t get_first_index() const { return next_index > slots.size() ? next_index - slots.size() : 0; }
+
+	void push(T &p_event) {
+		p_event.index = next_index;
+		slots[next_index % slots.size()] = p_event;
+		next_index++;
+	}
+
+	void fetch_since(uint64_t p_since, LocalVector<T> &r_events) const {
+		for (uint64_t i = MAX(p_since, get_first_index()); i < next_index; i++) {
+			r_events.push_back(slots[i % slots.size()]);
+		}
+	}
+};
+
+struct TraceEvent {
+	uint64_t index = 0;
+	uint64_t time_ms = 0;
+	String source_path;
+	StringName signal;
+	Array args;
+};
+
+struct SignalTrace {
+	bool include_args = false;
+	Array connections; // Only touched on the main thread.
+	EventRing<TraceEvent> events;
+};
+
+struct WatchEvent {
+	uint64_t index = 0;
+	uint64_t time_ms = 0;
+	bool snapshot = false;
+	Dictionary values;
+};
+
+struct PropertyWatch {
+	ObjectID node_id;
+	Vector<StringName> variables;
+	Vector<Variant> last_values;
+	bool node_freed = false;
+	EventRing<WatchEvent> events;
+};
+
+// Signals may be emitted from physics or worker threads, so all traces and
+// watches are guarded by one mutex. Critical sections only touch the maps and
+// rings; values are captured before locking, since reading them can run
+// script getters or emit more traced signals.
+static Mutex trace_mutex;
+static HashMap<String, SignalTrace *> signal_traces;
+static HashMap<String, PropertyWatch *> property_watches;
+
+// Copies a value so later mutation of the source does not rewrite history,
+// and so recorded events do not keep objects alive.
+static Variant _capture_trace_value(const Variant &p_value) {
+	switch (p_value.get_type()) {
+		case Variant::ARRAY:
+		case Variant::DICTIONARY:
+			return p_value.duplicate(true);
+		case Variant::OBJECT: {
+			Object *object = p_value.get_validated_object();
+			if (!object) {
+				return Variant();
+			}
+			Node *node = Object::cast_to<Node>(object);
+			return node ? String(node->get_path()) : object->get_class() + ":" + itos(object->get_instance_id());
+		}
+		default:
+			return p_value;
+	}
+}
 
 EditorTools *EditorTools::ensure_tracer() {
     if (!tracer_instance) {
@@ -41,21 +135,115 @@ EditorTools *EditorTools::ensure_tracer() {
 }
 
 void EditorTools::_record_trace_event(const String &trace_id, const String &src_path, const String &sig_name, const Array &args) {
-    if (!trace_registry.has(trace_id)) return;
-    Dictionary reg = trace_registry[trace_id];
-    Array events = reg.get("events", Array());
-    int max_events = reg.get("max_events", 100);
-    int next_index = reg.get("next_index", 0);
-    Dictionary evt;
-    evt["i"] = next_index;
-    evt["time_ms"] = OS::get_singleton()->get_ticks_msec();
-    evt["source_path"] = src_path;
-    evt["signal"] = sig_name;
-    if (!args.is_empty()) evt["args"] = args;
-    events.push_back(evt);
-    while (events.size() > max_events) { events.remove_at(0); }
-    reg["events"] = events; reg["next_index"] = next_index + 1;
-    trace_registry[trace_id] = reg;
+    bool include_args = false;
+    {
+        MutexLock lock(trace_mutex);
+        SignalTrace **trace = signal_traces.getptr(trace_id);
+        if (!trace) {
+            return;
+        }
+        include_args = (*trace)->include_args;
+    }
+
+    TraceEvent event;
+    event.time_ms = OS::get_singleton()->get_ticks_msec();
+    event.source_path = src_path;
+    event.signal = sig_name;
+    if (include_args) {
+        for (int i = 0; i < args.size(); i++) {
+            event.args.push_back(_capture_trace_value(args[i]));
+        }
+    }
+
+    // The trace may have been stopped meanwhile.
+    MutexLock lock(trace_mutex);
+    SignalTrace **trace = signal_traces.getptr(trace_id);
+    if (trace) {
+        (*trace)->events.push(event);
+    }
+}
+
+void EditorTools::_sample_property_watches() {
+    struct Sample {
+        String watch_id;
+        ObjectID node_id;
+        Vector<StringName> variables;
+        Vector<Variant> values;
+        bool node_freed = false;
+    };
+
+    LocalVector<Sample> samples;
+    {
+        MutexLock lock(trace_mutex);
+        for (const KeyValue<String, PropertyWatch *> &E : property_watches) {
+            if (!E.value->node_freed) {
+                Sample sample;
+                sample.watch_id = E.key;
+                sample.node_id = E.value->node_id;
+                sample.variables = E.value->variables;
+                samples.push_back(sample);
+            }
+        }
+    }
+
+    for (Sample &sample : samples) {
+        Object *node = ObjectDB::get_instance(sample.node_id);
+        if (!node) {
+            sample.node_freed = true;
+            continue;
+        }
+        sample.values.resize(sample.variables.size());
+        for (int i = 0; i < sample.variables.size(); i++) {
+            // Compare captured forms so objects and containers compare by content.
+            sample.values.write[i] = _capture_trace_value(node->get(sample.variables[i]));
+        }
+    }
+
+    const uint64_t time_ms = OS::get_singleton()->get_ticks_msec();
+    MutexLock lock(trace_mutex);
+    for (const Sample &sample : samples) {
+        // The watch may have been stopped meanwhile.
+        PropertyWatch **watchp = property_watches.getptr(sample.watch_id);
+        if (!watchp) {
+            continue;
+        }
+        PropertyWatch *watch = *watchp;
+        WatchEvent event;
+        event.time_ms = time_ms;
+        if (sample.node_freed) {
+            watch->node_freed = true;
+            event.values["__node_freed"] = true;
+            watch->events.push(event);
+            continue;
+        }
+        for (int i = 0; i < sample.values.size(); i++) {
+            if (sample.values[i] != watch->last_values[i]) {
+                watch->last_values.write[i] = sample.values[i];
+                event.values[String(sample.variables[i])] = sample.values[i];
+            }
+        }
+        if (!event.values.is_empty()) {
+            watch->events.push(event);
+        }
+    }
+}
+
+void EditorTools::cleanup() {
+    MutexLock lock(trace_mutex);
+    for (KeyValue<String, SignalTrace *> &E : signal_traces) {
+        memdelete(E.value);
+    }
+    signal_traces.clear();
+    for (KeyValue<String, PropertyWatch *> &E : property_watches) {
+        memdelete(E.value);
+    }
+    property_watches.clear();
+
+    // Freeing the tracer also drops any signal connections still pointing at it.
+    if (tracer_instance) {
+        memdelete(tracer_instance);
+        tracer_instance = nullptr;
+    }
 }
 
 void EditorTools::_on_traced_signal_0(const String &p_trace_id, const String &p_source_path, const String &p_signal_name) {
@@ -212,7 +400,7 @@ Node *EditorTools::_get_node_from_path(const String &p_path, Dictionary &r_error
 
 Dictionary EditorTools::get_scene_info(const Dictionary &p_args) {
 	Dictionary result;
-	Node *root = EditorNode::get_singleton()->get_tree()->get_edited_scene_root();
+	Node *root = SceneTree::get_singleton()->get_edited_scene_root();
 	if (!root) {
 		result["success"] = false;
 		result["message"] = "No scene is currently being edited.";
@@ -232,25 +420,24 @@ Dictionary EditorTools::get_all_nodes(const Dictionary &p_args) {
 		result["message"] = "No scene is currently being edited.";
 		return result;
 	}
-	
-	Array nodes;
-	
-	// Helper lambda to recursively collect all nodes
-	std::function<void(Node*)> collect_nodes = [&](Node* node) {
-		if (node) {
-			nodes.push_back(_get_node_info(node));
-			// Recursively collect all children
-			for (int i = 0; i < node->get_child_count(); i++) {
-				collect_nodes(node->get_child(i));
-			}
-		}
-	};
-	
-	// Start collecting from the root
-	collect_nodes(root);
-	
+	AISceneSnapshot *snapshot = AISceneSnapshot::get_singleton();
+	if (!snapshot) {
+		result["success"] = false;
+		result["message"] = "Scene snapshot is not available.";
+		return result;
+	}
+
+	const uint32_t fields = AISceneSnapshot::parse_fields(p_args.get("fields", Variant()), AISceneSnapshot::FIELD_NAME | AISceneSnapshot::FIELD_TYPE | AISceneSnapshot::FIELD_PATH | AISceneSnapshot::FIELD_OWNER | AISceneSnapshot::FIELD_CHILD_COUNT);
+	const int offset = p_args.get("offset", 0);
+	const int limit = p_args.get("limit", NODE_PAGE_SIZE);
+
+	// With `since_version`, only the nodes that changed after it are returned.
+	if (p_args.has("since_version")) {
+		result = snapshot->get_changes(int64_t(p_args["since_version"]), offset, limit, fields);
+	} else {
+		result = snapshot->list_nodes(offset, limit, fields);
+	}
 	result["success"] = true;
-	result["nodes"] = nodes;
 	return result;
 }
 
@@ -381,18 +568,23 @@ Dictionary EditorTools::create_node(const Dictionary &p_args) {
 		}
 	}
 
-	Node *new_node = memnew(Node);
-	if (ClassDB::can_instantiate(type)) {
-		new_node = (Node *)ClassDB::instantiate(type);
-	} else {
+	Node *new_node = ClassDB::can_instantiate(type) ? Object::cast_to<Node>(ClassDB::instantiate(type)) : nullptr;
+	if (!new_node) {
 		result["success"] = false;
 		result["message"] = "Cannot instantiate node of type: " + type;
 		return result;
 	}
 
+	Node *owner = parent->get_owner() ? parent->get_owner() : parent;
 	new_node->set_name(name);
 	parent->add_child(new_node);
-	new_node->set_owner(parent->get_owner() ? parent->get_owner() : parent);
+	new_node->set_owner(owner);
+	if (batch_undo_redo) {
+		batch_undo_redo->add_do_method(parent, "add_child", new_node, true);
+		batch_undo_redo->add_do_method(new_node, "set_owner", owner);
+		batch_undo_redo->add_do_reference(new_node);
+		batch_undo_redo->add_undo_method(parent, "remove_child", new_node);
+	}
 
 	result["success"] = true;
 	result["node_path"] = new_node->get_path();
@@ -424,7 +616,29 @@ Dictionary EditorTools::delete_node(const Dictionary &p_args) {
 	if (!node) {
 		return result;
 	}
-	node->queue_free();
+	if (batch_undo_redo) {
+		// Detach instead of freeing so the deletion can be undone.
+		Node *parent = node->get_parent();
+		if (!parent || node == EditorNode::get_singleton()->get_edited_scene()) {
+			result["success"] = false;
+			result["message"] = "The scene root cannot be deleted.";
+			return result;
+		}
+		LocalVector<Node *> owned;
+		Node *owner = node->get_owner();
+		_collect_owned_nodes(node, owner, owned);
+		const int index = node->get_index();
+		parent->remove_child(node);
+		batch_undo_redo->add_do_method(parent, "remove_child", node);
+		batch_undo_redo->add_undo_method(parent, "add_child", node, true);
+		batch_undo_redo->add_undo_method(parent, "move_child", node, index);
+		for (Node *owned_node : owned) {
+			batch_undo_redo->add_undo_method(owned_node, "set_owner", owner);
+		}
+		batch_undo_redo->add_undo_reference(node);
+	} else {
+		node->queue_free();
+	}
 	result["success"] = true;
 	result["message"] = "Node deleted successfully.";
 	return result;
@@ -541,6 +755,7 @@ Dictionary EditorTools::set_node_property(const Dictionary &p_args) {
 		}
 	}
 	
+	const Variant old_value = node->get(prop);
 	bool valid = false;
 	node->set(prop, value, &valid);
     if (!valid) {
@@ -550,18 +765,46 @@ Dictionary EditorTools::set_node_property(const Dictionary &p_args) {
         return result;
     }
 	
+	AISceneSnapshot::notify_property_changed(node, prop);
+
+	if (batch_undo_redo) {
+		batch_undo_redo->add_do_property(node, prop, node->get(prop));
+		batch_undo_redo->add_undo_property(node, prop, old_value);
+		// The batch saves once after its last edit.
+		batch_save_pending = true;
+		result["success"] = true;
+		result["message"] = "Property set successfully.";
+		return result;
+	}
+
 	// Auto-save the scene after property changes so changes persist when running the game
-	String current_scene = EditorNode::get_singleton()->get_edited_scene()->get_scene_file_path();
+	_save_edited_scene();
+	
+	result["success"] = true;
+	result["message"] = "Property set successfully and scene saved.";
+	return result;
+}
+
+void EditorTools::_save_edited_scene() {
+	Node *edited_scene = EditorNode::get_singleton()->get_edited_scene();
+	String current_scene = edited_scene ? edited_scene->get_scene_file_path() : String();
 	if (!current_scene.is_empty()) {
 		EditorNode::get_singleton()->save_scene_if_open(current_scene);
 		print_line("SET_NODE_PROPERTY: Auto-saved scene after property change: " + current_scene);
 	} else {
 		print_line("SET_NODE_PROPERTY: Scene has no save path, cannot auto-save");
 	}
-	
-	result["success"] = true;
-	result["message"] = "Property set successfully and scene saved.";
-	return result;
+}
+
+void EditorTools::_collect_owned_nodes(Node *p_node, Node *p_owner, LocalVector<Node *> &r_nodes) {
+	// Removing a subtree clears owners that are no longer ancestors; these are
+	// the nodes whose owner has to be restored afterwards.
+	if (p_node->get_owner() == p_owner) {
+		r_nodes.push_back(p_node);
+	}
+	for (int i = 0; i < p_node->get_child_count(); i++) {
+		_collect_owned_nodes(p_node->get_child(i), p_owner, r_nodes);
+	}
 }
 
 Dictionary EditorTools::move_node(const Dictionary &p_args) {
@@ -579,8 +822,34 @@ Dictionary EditorTools::move_node(const Dictionary &p_args) {
 	if (!new_parent) {
 		return result;
 	}
-	node->get_parent()->remove_child(node);
+	Node *old_parent = node->get_parent();
+	if (!old_parent || node == EditorNode::get_singleton()->get_edited_scene() || new_parent == node || node->is_ancestor_of(new_parent)) {
+		result["success"] = false;
+		result["message"] = "Cannot move a node below itself or move the scene root.";
+		return result;
+	}
+	LocalVector<Node *> owned;
+	Node *owner = node->get_owner();
+	_collect_owned_nodes(node, owner, owned);
+	const int old_index = node->get_index();
+
+	old_parent->remove_child(node);
 	new_parent->add_child(node);
+	// Keep the subtree in the scene; reparenting drops owners otherwise.
+	for (Node *owned_node : owned) {
+		owned_node->set_owner(owner);
+	}
+	if (batch_undo_redo) {
+		batch_undo_redo->add_do_method(old_parent, "remove_child", node);
+		batch_undo_redo->add_do_method(new_parent, "add_child", node, true);
+		batch_undo_redo->add_undo_method(new_parent, "remove_child", node);
+		batch_undo_redo->add_undo_method(old_parent, "add_child", node, true);
+		batch_undo_redo->add_undo_method(old_parent, "move_child", node, old_index);
+		for (Node *owned_node : owned) {
+			batch_undo_redo->add_do_method(owned_node, "set_owner", owner);
+			batch_undo_redo->add_undo_method(owned_node, "set_owner", owner);
+		}
+	}
 	result["success"] = true;
 	result["message"] = "Node moved successfully.";
 	return result;
@@ -1033,40 +1302,79 @@ Dictionary EditorTools::generalnodeeditor(const Dictionary &p_args) {
 	return result;
 }
 
-Dictionary EditorTools::list_project_files(const Dictionary &p_args) {
+static Dictionary _file_query_to_dictionary(const AIFileQuery::Query &p_query, const AIFileQuery::Result &p_result, bool p_full_paths) {
 	Dictionary result;
-	String path = p_args.has("dir") ? p_args["dir"] : "res://";
-	String filter = p_args.has("filter") ? p_args["filter"] : "";
-
 	Array files;
 	Array dirs;
-	Ref<DirAccess> dir = DirAccess::open(path);
-	if (dir.is_valid()) {
-		dir->list_dir_begin();
-		String file_name = dir->get_next();
-		while (file_name != "") {
-			if (dir->current_is_dir()) {
-				if (file_name != "." && file_name != "..") {
-					dirs.push_back(file_name);
-				}
-			} else {
-				if (filter.is_empty() || file_name.match(filter)) {
-					files.push_back(file_name);
-				}
-			}
-			file_name = dir->get_next();
+	Array matches;
+	const String root = p_query.root.ends_with("/") ? p_query.root : p_query.root + "/";
+	for (const AIFileQuery::Entry &entry : p_result.entries) {
+		const String path = p_full_paths ? entry.path : entry.path.trim_prefix(root);
+		(entry.is_directory ? dirs : files).push_back(path);
+		for (const Variant &match_variant : entry.matches) {
+			Dictionary match = Dictionary(match_variant).duplicate();
+			match["path"] = path;
+			matches.push_back(match);
 		}
-	} else {
-		result["success"] = false;
-		result["message"] = "Could not open directory: " + path;
-		return result;
 	}
 	result["success"] = true;
 	result["files"] = files;
 	result["directories"] = dirs;
+	if (!p_query.content.is_empty()) {
+		result["matches"] = matches;
+	}
+	result["total"] = p_result.total;
+	if (p_result.total_is_lower_bound) {
+		result["total_is_lower_bound"] = true;
+	}
+	result["offset"] = p_query.offset;
+	result["has_more"] = p_result.has_more;
+	if (p_result.has_more) {
+		result["next_offset"] = p_query.offset + int(p_result.entries.size());
+	}
+	result["source"] = p_result.from_memory ? "editor_filesystem" : "disk";
 	return result;
 }
 
+Dictionary EditorTools::list_project_files(const Dictionary &p_args) {
+	AIFileQuery::Query query = AIFileQuery::parse_query(p_args);
+	query.recursive = p_args.get("recursive", false);
+	// A plain listing shows the subdirectories to navigate into.
+	query.include_directories = p_args.get("include_directories", !query.recursive);
+
+	AIFileQuery::Result query_result;
+	String error;
+	if (AIFileQuery::execute(query, query_result, error) != OK) {
+		Dictionary result;
+		result["success"] = false;
+		result["message"] = error;
+		return result;
+	}
+	return _file_query_to_dictionary(query, query_result, p_args.get("full_paths", true));
+}
+
+Dictionary EditorTools::search_project_files(const Dictionary &p_args) {
+	AIFileQuery::Query query = AIFileQuery::parse_query(p_args);
+	if (query.patterns.is_empty() && query.content.is_empty() && query.extensions.is_empty() && query.types.is_empty()) {
+		Dictionary result;
+		result["success"] = false;
+		result["message"] = "Provide a 'pattern', 'content', 'extensions' or 'types' to search for.";
+		return result;
+	}
+	query.recursive = true;
+	query.include_directories = p_args.get("include_directories", false);
+
+	AIFileQuery::Result query_result;
+	String error;
+	if (AIFileQuery::execute(query, query_result, error) != OK) {
+		Dictionary result;
+		result["success"] = false;
+		result["message"] = error;
+		return result;
+	}
+	return _file_query_to_dictionary(query, query_result, true);
+}
+
 Dictionary EditorTools::read_file_content(const Dictionary &p_args) {
 	Dictionary result;
 	if (!p_args.has("path")) {
@@ -1106,6 +1414,96 @@ Dictionary EditorTools::read_file_content(const Dictionary &p_args) {
     return result;
 }
 
+// Byte offsets of line starts, shared by read_file_advanced calls and
+// rebuilt when the file's modification time or size changes, when the editor
+// changes any file, or when a sampled line start no longer follows a newline.
+struct FileLineIndex {
+	uint64_t modified_time = 0;
+	uint64_t size = 0;
+	uint64_t file_version = 0;
+	Vector<uint64_t> line_starts;
+};
+
+static constexpr int LINE_INDEX_CACHE_CAPACITY = 64;
+static constexpr int LINE_INDEX_SAMPLES = 16;
+static constexpr uint64_t FILE_READ_CHUNK_SIZE = 1024 * 1024;
+
+static Mutex line_index_mutex;
+
+static LRUCache<String, FileLineIndex> &_get_line_index_cache() {
+	static LRUCache<String, FileLineIndex> cache(LINE_INDEX_CACHE_CAPACITY);
+	return cache;
+}
+
+// Catches same-size edits within the modification time's one second
+// resolution that went around the editor.
+static bool _is_line_index_valid(const Ref<FileAccess> &p_file, const FileLineIndex &p_index) {
+	const int count = p_index.line_starts.size();
+	const int step = MAX(1, count / LINE_INDEX_SAMPLES);
+	for (int i = 1; i < count; i += step) {
+		p_file->seek(p_index.line_starts[i] - 1);
+		if (p_file->get_8() != '\n') {
+			return false;
+		}
+	}
+	if (count > 1) {
+		p_file->seek(p_index.line_starts[count - 1] - 1);
+		return p_file->get_8() == '\n';
+	}
+	return true;
+}
+
+static void _get_file_line_index(const String &p_path, const Ref<FileAccess> &p_file, FileLineIndex &r_index) {
+	const uint64_t modified_time = FileAccess::get_modified_time(p_path);
+	const uint64_t size = p_file->get_length();
+	const uint64_t file_version = AIToolCache::get_file_version();
+	{
+		MutexLock lock(line_index_mutex);
+		const FileLineIndex *cached = _get_line_index_cache().getptr(p_path);
+		if (cached && cached->modified_time == modified_time && cached->size == size && cached->file_version == file_version) {
+			r_index = *cached;
+		}
+	}
+	if (!r_index.line_starts.is_empty() && _is_line_index_valid(p_file, r_index)) {
+		return;
+	}
+
+	LocalVector<uint64_t> starts;
+	starts.push_back(0);
+	LocalVector<uint8_t> buffer;
+	buffer.resize(MIN(size, FILE_READ_CHUNK_SIZE));
+	p_file->seek(0);
+	uint64_t position = 0;
+	while (position < size) {
+		const uint64_t read = p_file->get_buffer(buffer.ptr(), MIN(FILE_READ_CHUNK_SIZE, size - position));
+		if (read == 0) {
+			break;
+		}
+		const uint8_t *from = buffer.ptr();
+		const uint8_t *end = buffer.ptr() + read;
+		while (const uint8_t *newline = (const uint8_t *)memchr(from, '\n', end - from)) {
+			starts.push_back(position + (newline - buffer.ptr()) + 1);
+			from = newline + 1;
+		}
+		position += read;
+	}
+	// A trailing newline ends the last line rather than starting a new one.
+	if (starts[starts.size() - 1] >= size) {
+		starts.resize(starts.size() - 1);
+	}
+
+	r_index.modified_time = modified_time;
+	r_index.size = size;
+	r_index.file_version = file_version;
+	r_index.line_starts.resize(starts.size());
+	if (!starts.is_empty()) {
+		memcpy(r_index.line_starts.ptrw(), starts.ptr(), starts.size() * sizeof(uint64_t));
+	}
+
+	MutexLock lock(line_index_mutex);
+	_get_line_index_cache().insert(p_path, r_index);
+}
+
 Dictionary EditorTools::read_file_advanced(const Dictionary &p_args) {
 	Dictionary result;
 	if (!p_args.has("path")) {
@@ -1121,141 +1519,83 @@ Dictionary EditorTools::read_file_advanced(const Dictionary &p_args) {
 		return result;
 	}
 
-	int start_line = p_args.has("start_line") ? (int)p_args["start_line"] : 1;
+	// Seek straight to the requested range using the cached line offsets.
+	FileLineIndex index;
+	_get_file_line_index(path, file, index);
+	const int total_lines = index.line_starts.size();
+	const int start_line = MAX(1, p_args.has("start_line") ? (int)p_args["start_line"] : 1);
 	int end_line = p_args.has("end_line") ? (int)p_args["end_line"] : -1;
-	String content;
-	int current_line = 1;
-
-	while (!file->eof_reached() && (end_line == -1 || current_line <= end_line)) {
-		String line = file->get_line();
-		if (current_line >= start_line) {
-			content += line + "\n";
+	if (end_line < 0 || end_line > total_lines) {
+		end_line = total_lines;
+	}
+
+	StringBuilder content;
+	if (start_line <= end_line) {
+		const uint64_t from = index.line_starts[start_line - 1];
+		const uint64_t to = end_line < total_lines ? index.line_starts[end_line] : index.size;
+		LocalVector<uint8_t> bytes;
+		bytes.resize(to - from);
+		file->seek(from);
+		const uint64_t read = file->get_buffer(bytes.ptr(), bytes.size());
+		String text = String::utf8((const char *)bytes.ptr(), read);
+		if (text.contains_char('\r')) {
+			text = text.replace("\r\n", "\n");
+		}
+		content.append(text);
+		if (!text.ends_with("\n")) {
+			content.append("\n");
 		}
-		current_line++;
 	}
 
 	result["success"] = true;
-	result["content"] = content;
+	result["content"] = content.as_string();
+	result["start_line"] = start_line;
+	result["end_line"] = end_line;
+	result["total_lines"] = total_lines;
 	return result;
 }
 
+Error EditorTools::_post_backend_json(const String &p_url, const Dictionary &p_data, const Vector<String> &p_headers, int &r_code, String &r_body) {
+	HTTPConnectionPool::Request request;
+	request.url = p_url;
+	request.method = HTTPClient::METHOD_POST;
+	request.headers = p_headers;
+	request.headers.push_back("Content-Type: application/json");
+	request.body = JSON::stringify(p_data).to_utf8_buffer();
+	// Edits can take a while to generate, but a silent backend should not hang the caller forever.
+	request.timeout = 300.0;
+
+	HTTPConnectionPool::Response response;
+	Error err = HTTPConnectionPool::get_singleton()->request_blocking(request, response);
+	r_code = response.code;
+	r_body = String::utf8((const char *)response.body.ptr(), response.body.size());
+	return err;
+}
+
 Dictionary EditorTools::_predict_code_edit(const String &p_file_content, const String &p_prompt, const String &p_api_endpoint) {
 	Dictionary result;
-	HTTPClient *http_client = HTTPClient::create();
-
-	// Prepare request
-	String host = p_api_endpoint;
-	int port = 80;
-	bool use_ssl = false;
-
-	if (host.begins_with("https://")) {
-		host = host.trim_prefix("https://");
-		use_ssl = true;
-		port = 443;
-	} else if (host.begins_with("http://")) {
-		host = host.trim_prefix("http://");
-	}
-
-	String base_path = "/";
-	if (host.find("/") != -1) {
-		base_path = host.substr(host.find("/"), -1);
-		host = host.substr(0, host.find("/"));
-	}
 
-	if (host.find(":") != -1) {
-		port = host.substr(host.find(":") + 1, -1).to_int();
-		host = host.substr(0, host.find(":"));
-	}
-	
-	// Construct the full path by replacing /chat with /predict_code_edit
-	String predict_path = base_path.replace("/chat", "/predict_code_edit");
-
-	Error err = http_client->connect_to_host(host, port, use_ssl ? Ref<TLSOptions>() : Ref<TLSOptions>());
-	if (err != OK) {
-		result["success"] = false;
-		result["message"] = "Failed to connect to host: " + host;
-		memdelete(http_client);
-		return result;
-	}
-
-	// Wait for connection
-	while (http_client->get_status() == HTTPClient::STATUS_CONNECTING || http_client->get_status() == HTTPClient::STATUS_RESOLVING) {
-		http_client->poll();
-		OS::get_singleton()->delay_usec(1000);
-	}
-
-	if (http_client->get_status() != HTTPClient::STATUS_CONNECTED) {
-		result["success"] = false;
-		result["message"] = "Failed to connect to host after polling.";
-		memdelete(http_client);
-		return result;
-	}
-
-	// Prepare request body
 	Dictionary request_data;
 	request_data["file_content"] = p_file_content;
 	request_data["prompt"] = p_prompt;
 
-	Ref<JSON> json;
-	json.instantiate();
-	String request_body_str = json->stringify(request_data);
-	PackedByteArray request_body = request_body_str.to_utf8_buffer();
-
-	PackedStringArray headers;
-	headers.push_back("Content-Type: application/json");
-	headers.push_back("Content-Length: " + itos(request_body.size()));
-
-	err = http_client->request(HTTPClient::METHOD_POST, predict_path, headers, request_body.ptr(), request_body.size());
+	int response_code = 0;
+	String response_str;
+	Error err = _post_backend_json(p_api_endpoint.replace("/chat", "/predict_code_edit"), request_data, Vector<String>(), response_code, response_str);
 	if (err != OK) {
 		result["success"] = false;
-		result["message"] = "HTTPClient->request failed.";
-		memdelete(http_client);
-		return result;
-	}
-
-	// Wait for response
-	while (http_client->get_status() == HTTPClient::STATUS_REQUESTING) {
-		http_client->poll();
-		OS::get_singleton()->delay_usec(1000);
-	}
-
-	if (http_client->get_status() != HTTPClient::STATUS_BODY && http_client->get_status() != HTTPClient::STATUS_CONNECTED) {
-		result["success"] = false;
-		result["message"] = "Request failed after sending.";
-		memdelete(http_client);
+		result["message"] = "Request to prediction server failed: " + p_api_endpoint;
 		return result;
 	}
 
-	if (!http_client->has_response()) {
-		result["success"] = false;
-		result["message"] = "Request completed, but no response received.";
-		memdelete(http_client);
-		return result;
-	}
-
-	int response_code = http_client->get_response_code();
-	PackedByteArray body;
-
-	while (http_client->get_status() == HTTPClient::STATUS_BODY) {
-		http_client->poll();
-		PackedByteArray chunk = http_client->read_response_body_chunk();
-		if (chunk.size() == 0) {
-			OS::get_singleton()->delay_usec(1000);
-		} else {
-			body.append_array(chunk);
-		}
-	}
-
-	String response_str = String::utf8((const char *)body.ptr(), body.size());
-
-	memdelete(http_client);
-
 	if (response_code != 200) {
 		result["success"] = false;
 		result["message"] = "Prediction server returned error " + itos(response_code) + ": " + response_str;
 		return result;
 	}
 
+	Ref<JSON> json;
+	json.instantiate();
 	err = json->parse(response_str);
 	if (err != OK) {
 		result["success"] = false;
@@ -1270,55 +1610,6 @@ Dictionary EditorTools::_predict_code_edit(const String &p_file_content, const S
 
 Dictionary EditorTools::_call_apply_endpoint(const String &p_file_path, const String &p_file_content, const Dictionary &p_ai_args, const String &p_api_endpoint) {
 	Dictionary result;
-	HTTPClient *http_client = HTTPClient::create();
-
-	// Prepare request
-	String host = p_api_endpoint;
-	int port = 80;
-	bool use_ssl = false;
-
-	if (host.begins_with("https://")) {
-		host = host.trim_prefix("https://");
-		use_ssl = true;
-		port = 443;
-	} else if (host.begins_with("http://")) {
-		host = host.trim_prefix("http://");
-	}
-
-	String base_path = "/";
-	if (host.find("/") != -1) {
-		base_path = host.substr(host.find("/"), -1);
-		host = host.substr(0, host.find("/"));
-	}
-
-	if (host.find(":") != -1) {
-		port = host.substr(host.find(":") + 1, -1).to_int();
-		host = host.substr(0, host.find(":"));
-	}
-	
-	// Construct the apply endpoint path
-	String apply_path = base_path.replace("/chat", "/apply");
-
-	Error err = http_client->connect_to_host(host, port, use_ssl ? Ref<TLSOptions>() : Ref<TLSOptions>());
-	if (err != OK) {
-		result["success"] = false;
-		result["message"] = "Failed to connect to host: " + host;
-		memdelete(http_client);
-		return result;
-	}
-
-	// Wait for connection
-	while (http_client->get_status() == HTTPClient::STATUS_CONNECTING || http_client->get_status() == HTTPClient::STATUS_RESOLVING) {
-		http_client->poll();
-		OS::get_singleton()->delay_usec(1000);
-	}
-
-	if (http_client->get_status() != HTTPClient::STATUS_CONNECTED) {
-		result["success"] = false;
-		result["message"] = "Failed to connect to host after polling.";
-		memdelete(http_client);
-		return result;
-	}
 
 	// Prepare request body to match backend's expected format
 	Dictionary request_data;
@@ -1327,66 +1618,23 @@ Dictionary EditorTools::_call_apply_endpoint(const String &p_file_path, const St
 	request_data["prompt"] = p_ai_args.get("prompt", "");
 	request_data["tool_arguments"] = p_ai_args;
 
-	Ref<JSON> json;
-	json.instantiate();
-	String request_body_str = json->stringify(request_data);
-	PackedByteArray request_body = request_body_str.to_utf8_buffer();
-
-	PackedStringArray headers;
-	headers.push_back("Content-Type: application/json");
-	headers.push_back("Content-Length: " + itos(request_body.size()));
-
-	err = http_client->request(HTTPClient::METHOD_POST, apply_path, headers, request_body.ptr(), request_body.size());
+	int response_code = 0;
+	String response_str;
+	Error err = _post_backend_json(p_api_endpoint.replace("/chat", "/apply"), request_data, Vector<String>(), response_code, response_str);
 	if (err != OK) {
 		result["success"] = false;
-		result["message"] = "HTTPClient->request failed.";
-		memdelete(http_client);
-		return result;
-	}
-
-	// Wait for response
-	while (http_client->get_status() == HTTPClient::STATUS_REQUESTING) {
-		http_client->poll();
-		OS::get_singleton()->delay_usec(1000);
-	}
-
-	if (http_client->get_status() != HTTPClient::STATUS_BODY && http_client->get_status() != HTTPClient::STATUS_CONNECTED) {
-		result["success"] = false;
-		result["message"] = "Request failed after sending.";
-		memdelete(http_client);
+		result["message"] = "Request to apply server failed: " + p_api_endpoint;
 		return result;
 	}
 
-	if (!http_client->has_response()) {
-		result["success"] = false;
-		result["message"] = "Request completed, but no response received.";
-		memdelete(http_client);
-		return result;
-	}
-
-	int response_code = http_client->get_response_code();
-	PackedByteArray body;
-
-	while (http_client->get_status() == HTTPClient::STATUS_BODY) {
-		http_client->poll();
-		PackedByteArray chunk = http_client->read_response_body_chunk();
-		if (chunk.size() == 0) {
-			OS::get_singleton()->delay_usec(1000);
-		} else {
-			body.append_array(chunk);
-		}
-	}
-
-	String response_str = String::utf8((const char *)body.ptr(), body.size());
-
-	memdelete(http_client);
-
 	if (response_code != 200) {
 		result["success"] = false;
 		result["message"] = "Apply server returned error " + itos(response_code) + ": " + response_str;
 		return result;
 	}
 
+	Ref<JSON> json;
+	json.instantiate();
 	err = json->parse(response_str);
 	if (err != OK) {
 		result["success"] = false;
@@ -1433,21 +1681,15 @@ Dictionary EditorTools::apply_edit(const Dictionary &p_args) {
         print_line("APPLY_EDIT: Target file does not exist; will create new file: " + path);
     }
     
-    // Use OS system call to bypass Godot's broken HTTPClient
     Dictionary local_result;
     String edit_prompt = p_args.get("prompt", "");
-    
-    print_line("APPLY_EDIT: Using OS curl to call backend API - prompt: " + edit_prompt);
-    
-    // Create JSON request
+
+    print_line("APPLY_EDIT: Calling backend API - prompt: " + edit_prompt);
+
     Dictionary request_data;
     request_data["file_content"] = file_content;
     request_data["prompt"] = edit_prompt;
-    
-    Ref<JSON> json;
-    json.instantiate();
-    String request_json = json->stringify(request_data);
-    
+
     // Prepare auth/context headers to mirror chat/image generation
     String auth_token = String();
     String user_id = String();
@@ -1464,103 +1706,67 @@ Dictionary EditorTools::apply_edit(const Dictionary &p_args) {
     }
     String project_root = ProjectSettings::get_singleton()->globalize_path("res://");
 
-    // Write request to temporary file
-    String temp_request_path = OS::get_singleton()->get_user_data_dir() + "/temp_request.json";
-    String temp_response_path = OS::get_singleton()->get_user_data_dir() + "/temp_response.json";
-    
-    Ref<FileAccess> request_file = FileAccess::open(temp_request_path, FileAccess::WRITE);
-    if (request_file.is_valid()) {
-        request_file->store_string(request_json);
-        request_file->close();
-        
-        // Use curl via OS system call, mirroring headers used by chat/image gen
-        String base_url;
-        if (EditorSettings::get_singleton() && EditorSettings::get_singleton()->has_setting("ai_chat/base_url")) {
-            base_url = EditorSettings::get_singleton()->get_setting("ai_chat/base_url");
-        }
-        if (base_url.is_empty()) {
-            base_url = OS::get_singleton()->get_environment("AI_CHAT_CLOUD_URL");
-        }
-        if (base_url.is_empty()) {
-            base_url = "http://127.0.0.1:8000";
-        }
-        String curl_command = String("curl -X POST ") + base_url + String("/predict_code_edit ") +
-            "-H \"Content-Type: application/json\" " +
-            (auth_token.is_empty() ? String("") : String("-H \"Authorization: Bearer ") + auth_token + "\" ") +
-            (user_id.is_empty() ? String("") : String("-H \"X-User-ID: ") + user_id + "\" ") +
-            (machine_id.is_empty() ? String("") : String("-H \"X-Machine-ID: ") + machine_id + "\" ") +
-            (project_root.is_empty() ? String("") : String("-H \"X-Project-Root: ") + project_root + "\" ") +
-            String("-d @\"") + temp_request_path + String("\" -o \"") + temp_response_path + String("\" -s");
-        
-        print_line("APPLY_EDIT: Executing curl command to backend");
-        
-        List<String> args;
-        args.push_back("-c");
-        args.push_back(curl_command);
-        int exit_code;
-        Error exec_err = OS::get_singleton()->execute("sh", args, nullptr, &exit_code);
-        
-        if (exec_err == OK && exit_code == 0) {
-            // Read response from file
-            Error err;
-            String response_content = FileAccess::get_file_as_string(temp_response_path, &err);
-            
-            if (err == OK && response_content.length() > 0) {
-                Ref<JSON> response_json;
-                response_json.instantiate();
-                Error parse_err = response_json->parse(response_content);
-                
-                if (parse_err == OK) {
-                    Dictionary response_data = response_json->get_data();
-                    local_result["success"] = true;
-                    local_result["edited_content"] = response_data.get("edited_content", file_content);
-                    print_line("APPLY_EDIT: Successfully received response via curl (" + String::num_int64(String(local_result["edited_content"]).length()) + " chars)");
-                } else {
-                    local_result["success"] = false;
-                    local_result["message"] = "Failed to parse curl response JSON";
-                    print_line("APPLY_EDIT ERROR: JSON parse failed - " + response_content.substr(0, 200));
-                }
-            } else {
-                local_result["success"] = false;
-                local_result["message"] = "Failed to read curl response file";
-                print_line("APPLY_EDIT ERROR: Could not read response file");
-            }
-            
-            // Cleanup temp files
-            if (FileAccess::exists(temp_response_path)) {
-                OS::get_singleton()->move_to_trash(temp_response_path);
-            }
+    Vector<String> headers;
+    if (!auth_token.is_empty()) {
+        headers.push_back("Authorization: Bearer " + auth_token);
+    }
+    if (!user_id.is_empty()) {
+        headers.push_back("X-User-ID: " + user_id);
+    }
+    if (!machine_id.is_empty()) {
+        headers.push_back("X-Machine-ID: " + machine_id);
+    }
+    if (!project_root.is_empty()) {
+        headers.push_back("X-Project-Root: " + project_root);
+    }
+
+    String base_url;
+    if (EditorSettings::get_singleton() && EditorSettings::get_singleton()->has_setting("ai_chat/base_url")) {
+        base_url = EditorSettings::get_singleton()->get_setting("ai_chat/base_url");
+    }
+    if (base_url.is_empty()) {
+        base_url = OS::get_singleton()->get_environment("AI_CHAT_CLOUD_URL");
+    }
+    if (base_url.is_empty()) {
+        base_url = "http://127.0.0.1:8000";
+    }
+
+    // The pooled keep-alive connection is shared with the chat stream, so
+    // consecutive edits don't pay for a new TCP/TLS handshake each.
+    int response_code = 0;
+    String response_content;
+    Error request_err = _post_backend_json(base_url + "/predict_code_edit", request_data, headers, response_code, response_content);
+    if (request_err == OK && response_code == 200) {
+        Ref<JSON> response_json;
+        response_json.instantiate();
+        Error parse_err = response_json->parse(response_content);
+
+        if (parse_err == OK) {
+            Dictionary response_data = response_json->get_data();
+            local_result["success"] = true;
+            local_result["edited_content"] = response_data.get("edited_content", file_content);
+            print_line("APPLY_EDIT: Successfully received response (" + String::num_int64(String(local_result["edited_content"]).length()) + " chars)");
         } else {
             local_result["success"] = false;
-            local_result["message"] = "Curl command failed with exit code: " + String::num_int64(exit_code);
-            print_line("APPLY_EDIT ERROR: Curl failed - " + String(local_result["message"]));
-        }
-        
-        // Cleanup request file
-        if (FileAccess::exists(temp_request_path)) {
-            OS::get_singleton()->move_to_trash(temp_request_path);
+            local_result["message"] = "Failed to parse backend response JSON";
+            print_line("APPLY_EDIT ERROR: JSON parse failed - " + response_content.substr(0, 200));
         }
     } else {
         local_result["success"] = false;
-        local_result["message"] = "Failed to create temporary request file";
-        print_line("APPLY_EDIT ERROR: Could not create temp file");
+        local_result["message"] = request_err == OK ? "Backend returned error " + itos(response_code) + ": " + response_content.substr(0, 200) : String("Request to backend failed: ") + base_url;
+        print_line("APPLY_EDIT ERROR: " + String(local_result["message"]));
     }
-    // Dictionary local_result = _call_apply_endpoint(path, file_content, p_args, "");
     
     if (local_result.get("success", false)) {
         String new_content = local_result["edited_content"];
         String cleaned_content = _clean_backend_content(new_content);
 
-        // Generate a lightweight diff summary (UI will show proper diff using original/edited content)
-        String diff = "";
-        if (file_content.length() > 100000 || cleaned_content.length() > 100000) {
-            diff = "Diff skipped - file too large (original: " + String::num_int64(file_content.length()) + " chars, new: " + String::num_int64(cleaned_content.length()) + " chars)";
-        } else {
-            diff = "=== TEMPORARY SIMPLE DIFF ===\nOriginal length: " + String::num_int64(file_content.length()) + " chars\nNew length: " + String::num_int64(cleaned_content.length()) + " chars\n=== END DIFF ===";
-        }
+        // The diff is cached, so the preview built from original/edited content reuses it.
+        String diff = _generate_unified_diff(file_content, cleaned_content, path);
 
         // Check compilation/static errors against the edited content before previewing
-        Array comp_errors = _check_compilation_errors(path, cleaned_content);
+        Array broken_dependents;
+        Array comp_errors = _check_compilation_errors(path, cleaned_content, &broken_dependents);
         bool has_errors = comp_errors.size() > 0;
 
         // Do NOT write to disk here. Leave Accept/Reject to the UI layer.
@@ -1572,6 +1778,7 @@ Dictionary EditorTools::apply_edit(const Dictionary &p_args) {
         result["edited_content"] = cleaned_content;
         result["diff"] = diff;
         result["compilation_errors"] = comp_errors;
+        result["broken_dependents"] = broken_dependents;
         result["has_errors"] = has_errors;
         result["dynamic_approach"] = false;
         return result;
@@ -1719,166 +1926,25 @@ String EditorTools::_fix_malformed_content(const String &p_content) {
 }
 
 String EditorTools::_generate_unified_diff(const String &p_original, const String &p_modified, const String &p_file_path) {
-	Vector<String> original_lines = p_original.split("\n");
-	Vector<String> modified_lines = p_modified.split("\n");
-	
-	String diff = "--- " + p_file_path + " (original)\n";
-	diff += "+++ " + p_file_path + " (modified)\n";
-	
-	// Simple diff implementation - compare line by line
-	int original_line = 0;
-	int modified_line = 0;
-	int context_lines = 3;
-	
-	while (original_line < original_lines.size() || modified_line < modified_lines.size()) {
-		// Find changes
-		int change_start_orig = original_line;
-		int change_start_mod = modified_line;
-		
-		// Skip matching lines
-		while (original_line < original_lines.size() && 
-			   modified_line < modified_lines.size() && 
-			   original_lines[original_line] == modified_lines[modified_line]) {
-			original_line++;
-			modified_line++;
-		}
-		
-		if (original_line >= original_lines.size() && modified_line >= modified_lines.size()) {
-			break; // End of both files
-		}
-		
-		// Find end of change block
-		int change_end_orig = original_line;
-		int change_end_mod = modified_line;
-		
-		// Simple heuristic: advance until we find matching lines again or reach end
-		while ((change_end_orig < original_lines.size() || change_end_mod < modified_lines.size())) {
-			// Look ahead to see if we find a match
-			bool found_match = false;
-			int lookahead = 3; // Look ahead a few lines
-			
-			for (int i = 0; i < lookahead && !found_match; i++) {
-				if (change_end_orig + i < original_lines.size() && 
-					change_end_mod + i < modified_lines.size() &&
-					original_lines[change_end_orig + i] == modified_lines[change_end_mod + i]) {
-					found_match = true;
-					break;
-				}
-			}
-			
-			if (found_match) {
-				break;
-			}
-			
-			if (change_end_orig < original_lines.size()) change_end_orig++;
-			if (change_end_mod < modified_lines.size()) change_end_mod++;
-		}
-		
-		// Generate hunk header
-		int context_start_orig = MAX(0, change_start_orig - context_lines);
-		int context_start_mod = MAX(0, change_start_mod - context_lines);
-		int context_end_orig = MIN(original_lines.size(), change_end_orig + context_lines);
-		int context_end_mod = MIN(modified_lines.size(), change_end_mod + context_lines);
-		
-		int hunk_orig_lines = context_end_orig - context_start_orig;
-		int hunk_mod_lines = context_end_mod - context_start_mod;
-		
-		diff += "@@ -" + String::num_int64(context_start_orig + 1) + "," + String::num_int64(hunk_orig_lines) + 
-				" +" + String::num_int64(context_start_mod + 1) + "," + String::num_int64(hunk_mod_lines) + " @@\n";
-		
-		// Add context before change
-		for (int i = context_start_orig; i < change_start_orig; i++) {
-			diff += " " + original_lines[i] + "\n";
-		}
-		
-		// Add removed lines
-		for (int i = change_start_orig; i < change_end_orig && i < original_lines.size(); i++) {
-			diff += "-" + original_lines[i] + "\n";
-		}
-		
-		// Add added lines
-		for (int i = change_start_mod; i < change_end_mod && i < modified_lines.size(); i++) {
-			diff += "+" + modified_lines[i] + "\n";
-		}
-		
-		// Add context after change
-		for (int i = change_end_orig; i < context_end_orig; i++) {
-			diff += " " + original_lines[i] + "\n";
-		}
-		
-		original_line = change_end_orig;
-		modified_line = change_end_mod;
-	}
-	
-	return diff;
+	return AITextDiff::compute(p_original, p_modified).to_unified(p_file_path + " (original)", p_file_path + " (modified)");
 }
 
-Array EditorTools::_check_compilation_errors(const String &p_file_path, const String &p_content) {
+Array EditorTools::_check_compilation_errors(const String &p_file_path, const String &p_content, Array *r_broken_dependents) {
 	Array errors;
 	
 	// Get file extension to determine script type
 	String extension = p_file_path.get_extension();
 	
 	if (extension == "gd") {
-		// GDScript compilation check using parser/analyzer/compiler approach
-		GDScriptParser parser;
-		Error parse_err = parser.parse(p_content, p_file_path, false);
-		
-		// Get parser errors
-		const List<GDScriptParser::ParserError> &parser_errors = parser.get_errors();
-		for (const GDScriptParser::ParserError &error : parser_errors) {
-			Dictionary error_dict;
-			error_dict["type"] = "parser_error";
-			error_dict["line"] = error.line;
-			error_dict["column"] = error.column;
-			error_dict["message"] = error.message;
-			errors.push_back(error_dict);
-		}
-		
-		// Only continue to analysis if parsing succeeded
-		if (parse_err == OK) {
-			GDScriptAnalyzer analyzer(&parser);
-			Error analyze_err = analyzer.analyze();
-			
-			// Get analyzer errors (they're stored in the parser)
-			const List<GDScriptParser::ParserError> &analyzer_errors = parser.get_errors();
-			for (const GDScriptParser::ParserError &error : analyzer_errors) {
-				// Skip errors we already collected during parsing
-				bool already_collected = false;
-				for (const GDScriptParser::ParserError &parse_error : parser_errors) {
-					if (parse_error.line == error.line && parse_error.message == error.message) {
-						already_collected = true;
-						break;
-					}
-				}
-				if (!already_collected) {
-					Dictionary error_dict;
-					error_dict["type"] = "analyzer_error";
-					error_dict["line"] = error.line;
-					error_dict["column"] = error.column;
-					error_dict["message"] = error.message;
-					errors.push_back(error_dict);
-				}
-			}
-			
-			// Only continue to compilation if analysis succeeded
-			if (analyze_err == OK) {
-				// Create a temporary script for compilation
-				Ref<GDScript> temp_script;
-				temp_script.instantiate();
-				
-				GDScriptCompiler compiler;
-				Error compile_err = compiler.compile(&parser, temp_script.ptr(), false);
-				
-				if (compile_err != OK) {
-					Dictionary error_dict;
-					error_dict["type"] = "compiler_error";
-					error_dict["line"] = compiler.get_error_line();
-					error_dict["column"] = compiler.get_error_column();
-					error_dict["message"] = compiler.get_error();
-					errors.push_back(error_dict);
-				}
-			}
+		Vector<AIScriptValidator::Candidate> candidates;
+		AIScriptValidator::Candidate candidate;
+		candidate.path = p_file_path;
+		candidate.content = p_content;
+		candidates.push_back(candidate);
+		const Dictionary validation = AIScriptValidator::validate(candidates)[0];
+		errors = validation["errors"];
+		if (r_broken_dependents) {
+			*r_broken_dependents = validation["broken_dependents"];
 		}
 	} else if (extension == "cs") {
 		// C# compilation would require mono/dotnet integration
@@ -1890,116 +1956,107 @@ Array EditorTools::_check_compilation_errors(const String &p_file_path, const St
 		error_dict["message"] = "C# compilation checking not implemented yet";
 		errors.push_back(error_dict);
 	}
-	
-	print_line("COMPILATION CHECK: Found " + String::num_int64(errors.size()) + " errors for " + p_file_path);
-	
-	    return errors;
+
+	return errors;
 }
 
 Dictionary EditorTools::check_compilation_errors(const Dictionary &p_args) {
     Dictionary result;
+
+    // Accepts a single `path`, a `paths` array, or `files` with proposed
+    // {path, content} pairs. All of them are validated concurrently.
+    Vector<AIScriptValidator::Candidate> candidates;
+    Array read_errors;
+    PackedStringArray paths;
     String path = p_args.get("path", "");
-    
-    if (path.is_empty()) {
-        result["success"] = false;
-        result["message"] = "Path is required";
-        result["errors"] = Array();
-        return result;
+    if (!path.is_empty()) {
+        paths.push_back(path);
     }
-    
-    print_line("CHECK_COMPILATION_ERRORS: Checking file - " + path);
-    
-    // Simple approach: Try to reload the script and see if it fails
-    Array errors;
-    
-    if (path.get_extension() == "gd") {
-        // Read the file content and parse it directly
+    Array extra_paths = p_args.get("paths", Array());
+    for (int i = 0; i < extra_paths.size(); i++) {
+        paths.push_back(extra_paths[i]);
+    }
+    for (const String &file_path : paths) {
+        if (file_path.get_extension() == "cs") {
+            Dictionary info_dict;
+            info_dict["type"] = "info";
+            info_dict["line"] = 0;
+            info_dict["column"] = 0;
+            info_dict["message"] = "C# compilation checking not implemented";
+            info_dict["path"] = file_path;
+            read_errors.push_back(info_dict);
+            continue;
+        }
         Error file_err;
-        String file_content = FileAccess::get_file_as_string(path, &file_err);
-        
+        AIScriptValidator::Candidate candidate;
+        candidate.path = file_path;
+        candidate.content = FileAccess::get_file_as_string(file_path, &file_err);
         if (file_err != OK) {
             Dictionary error_dict;
             error_dict["type"] = "file_error";
             error_dict["line"] = 0;
             error_dict["column"] = 0;
-            error_dict["message"] = "Failed to read file: " + path;
+            error_dict["message"] = "Failed to read file: " + file_path;
+            error_dict["path"] = file_path;
+            read_errors.push_back(error_dict);
+            continue;
+        }
+        candidates.push_back(candidate);
+    }
+    Array files = p_args.get("files", Array());
+    for (int i = 0; i < files.size(); i++) {
+        Dictionary file = files[i];
+        AIScriptValidator::Candidate candidate;
+        candidate.path = file.get("path", "");
+        candidate.content = file.get("content", "");
+        if (!candidate.path.is_empty()) {
+            candidates.push_back(candidate);
+        }
+    }
+
+    if (candidates.is_empty() && read_errors.is_empty()) {
+        result["success"] = false;
+        result["message"] = "Path is required";
+        result["errors"] = Array();
+        return result;
+    }
+
+    const Array results = AIScriptValidator::validate(candidates);
+    Array errors = read_errors;
+    Array broken_dependents;
+    PackedStringArray resolved_from_disk;
+    for (int i = 0; i < results.size(); i++) {
+        const Dictionary file_result = results[i];
+        const Array file_errors = file_result["errors"];
+        for (int j = 0; j < file_errors.size(); j++) {
+            Dictionary error_dict = file_errors[j];
+            error_dict["path"] = file_result["path"];
             errors.push_back(error_dict);
-        } else {
-            // Parse the script directly to get detailed error information
-            GDScriptParser parser;
-            Error parse_err = parser.parse(file_content, path, false);
-            
-            // Get parser errors
-            const List<GDScriptParser::ParserError> &parser_errors = parser.get_errors();
-            for (const GDScriptParser::ParserError &error : parser_errors) {
-                Dictionary error_dict;
-                error_dict["type"] = "parser_error";
-                error_dict["line"] = error.line;
-                error_dict["column"] = error.column;
-                error_dict["message"] = error.message;
-                errors.push_back(error_dict);
-                print_line("CHECK_COMPILATION_ERRORS: Found parser error at line " + String::num_int64(error.line) + ": " + error.message);
-            }
-            
-            // Only continue to analysis if parsing succeeded
-            if (parse_err == OK && parser_errors.is_empty()) {
-                GDScriptAnalyzer analyzer(&parser);
-                Error analyze_err = analyzer.analyze();
-                
-                // Get analyzer errors (they're stored in the parser)
-                const List<GDScriptParser::ParserError> &analyzer_errors = parser.get_errors();
-                for (const GDScriptParser::ParserError &error : analyzer_errors) {
-                    // Skip errors we already collected during parsing
-                    bool already_collected = false;
-                    for (const GDScriptParser::ParserError &parse_error : parser_errors) {
-                        if (parse_error.line == error.line && parse_error.message == error.message) {
-                            already_collected = true;
-                            break;
-                        }
-                    }
-                    if (!already_collected) {
-                        Dictionary error_dict;
-                        error_dict["type"] = "analyzer_error";
-                        error_dict["line"] = error.line;
-                        error_dict["column"] = error.column;
-                        error_dict["message"] = error.message;
-                        errors.push_back(error_dict);
-                        print_line("CHECK_COMPILATION_ERRORS: Found analyzer error at line " + String::num_int64(error.line) + ": " + error.message);
-                    }
-                }
-                
-                if (analyze_err == OK && analyzer_errors.size() == parser_errors.size()) {
-                    print_line("CHECK_COMPILATION_ERRORS: Script parsed and analyzed successfully");
-                }
-            } else {
-                print_line("CHECK_COMPILATION_ERRORS: Parsing failed with " + String::num_int64(parser_errors.size()) + " errors");
+        }
+        broken_dependents.append_array(file_result["broken_dependents"]);
+        const Array file_resolved = file_result["resolved_from_disk"];
+        for (int j = 0; j < file_resolved.size(); j++) {
+            if (!resolved_from_disk.has(file_resolved[j])) {
+                resolved_from_disk.push_back(file_resolved[j]);
             }
         }
-    } else if (path.get_extension() == "cs") {
-        // For C# files, add placeholder check
-        Dictionary info_dict;
-        info_dict["type"] = "info";
-        info_dict["line"] = 0;
-        info_dict["column"] = 0;
-        info_dict["message"] = "C# compilation checking not implemented";
-        errors.push_back(info_dict);
-    } else {
-        Dictionary info_dict;
-        info_dict["type"] = "info";
-        info_dict["line"] = 0;
-        info_dict["column"] = 0;
-        info_dict["message"] = "Unsupported file type for compilation checking";
-        errors.push_back(info_dict);
     }
-    
+
     result["success"] = true;
-    result["path"] = path;
+    if (!path.is_empty()) {
+        result["path"] = path;
+    }
+    result["results"] = results;
     result["errors"] = errors;
     result["has_errors"] = errors.size() > 0;
     result["error_count"] = errors.size();
-    
-    print_line("CHECK_COMPILATION_ERRORS: Found " + String::num_int64(errors.size()) + " errors in " + path);
-    
+    result["broken_dependents"] = broken_dependents;
+    if (!resolved_from_disk.is_empty()) {
+        // The analyzer reads other scripts from disk, not from `files`.
+        result["resolved_from_disk"] = resolved_from_disk;
+        result["note"] = "Checked against the saved version of " + String(", ").join(resolved_from_disk) + ", not the proposed content. Errors involving their classes or members may go away once all files are written.";
+    }
+
     return result;
 }
 
@@ -2104,42 +2161,54 @@ Dictionary EditorTools::get_scene_tree_hierarchy(const Dictionary &p_args) {
 		result["message"] = "No scene is currently being edited.";
 		return result;
 	}
-	
+	AISceneSnapshot *snapshot = AISceneSnapshot::get_singleton();
+
+	uint32_t default_fields = AISceneSnapshot::FIELD_NAME | AISceneSnapshot::FIELD_TYPE | AISceneSnapshot::FIELD_PATH | AISceneSnapshot::FIELD_CHILD_COUNT;
+	if (include_properties) {
+		default_fields |= AISceneSnapshot::FIELD_PROPERTIES;
+	}
+	const uint32_t fields = AISceneSnapshot::parse_fields(p_args.get("fields", Variant()), default_fields);
+
+	// Deltas are flat: the paths place changed nodes in the hierarchy.
+	if (p_args.has("since_version") && snapshot) {
+		result = snapshot->get_changes(int64_t(p_args["since_version"]), p_args.get("offset", 0), p_args.get("limit", NODE_PAGE_SIZE), fields);
+		result["success"] = true;
+		return result;
+	}
+
+	Node *start = root;
+	if (p_args.has("path")) {
+		start = _get_node_from_path(p_args["path"], result);
+		if (!start) {
+			return result;
+		}
+	}
+	const int max_depth = p_args.get("max_depth", -1);
+
 	// Recursive function to build hierarchy
-	std::function<Dictionary(Node*)> build_hierarchy = [&](Node* node) -> Dictionary {
-		Dictionary node_dict;
-		if (!node) return node_dict;
-		
-		node_dict["name"] = node->get_name();
-		node_dict["type"] = node->get_class();
-		node_dict["path"] = root->get_path_to(node);
-		
-		if (include_properties) {
-			List<PropertyInfo> properties;
-			node->get_property_list(&properties);
-			Dictionary props_dict;
-			for (const PropertyInfo &prop_info : properties) {
-				if (prop_info.usage & PROPERTY_USAGE_EDITOR) {
-					props_dict[prop_info.name] = node->get(prop_info.name);
-				}
+	std::function<Dictionary(Node *, int)> build_hierarchy = [&](Node *node, int depth) -> Dictionary {
+		Dictionary node_dict = AISceneSnapshot::describe_node(root, node, fields);
+		if (max_depth >= 0 && depth >= max_depth) {
+			if (node->get_child_count() > 0) {
+				node_dict["children_truncated"] = true;
 			}
-			node_dict["properties"] = props_dict;
+			return node_dict;
 		}
-		
-		// Add children recursively
+
 		Array children;
 		for (int i = 0; i < node->get_child_count(); i++) {
-			children.push_back(build_hierarchy(node->get_child(i)));
+			children.push_back(build_hierarchy(node->get_child(i), depth + 1));
 		}
 		node_dict["children"] = children;
-		node_dict["child_count"] = node->get_child_count();
-		
 		return node_dict;
 	};
 	
 	result["success"] = true;
-	result["hierarchy"] = build_hierarchy(root);
+	result["hierarchy"] = build_hierarchy(start, 0);
 	result["include_properties"] = include_properties;
+	if (snapshot) {
+		result["version"] = snapshot->get_version();
+	}
 	return result;
 }
 
@@ -2258,41 +2327,9 @@ Dictionary EditorTools::get_camera_info(const Dictionary &p_args) {
 }
 
 Dictionary EditorTools::take_screenshot(const Dictionary &p_args) {
-	Dictionary result;
-	String filename = p_args.get("filename", "screenshot_debug.png");
-	
-	// Try to get the main viewport
-	Viewport *viewport = EditorNode::get_singleton()->get_viewport();
-	if (!viewport) {
-		result["success"] = false;
-		result["message"] = "Could not access viewport";
-		return result;
-	}
-	
-	// Take screenshot
-	Ref<Image> screenshot = viewport->get_texture()->get_image();
-	if (screenshot.is_null()) {
-		result["success"] = false;
-		result["message"] = "Failed to capture screenshot";
-		return result;
-	}
-	
-	// Save to project directory
-	String project_path = ProjectSettings::get_singleton()->globalize_path("res://");
-	String full_path = project_path + "/" + filename;
-	
-	Error save_result = screenshot->save_png(full_path);
-	if (save_result != OK) {
-		result["success"] = false;
-		result["message"] = "Failed to save screenshot: " + String::num_int64(save_result);
-		return result;
-	}
-	
-	result["success"] = true;
-	result["message"] = "Screenshot saved";
-	result["filename"] = filename;
-	result["path"] = full_path;
-	return result;
+	// The chat dock and the tool server use AIScreenshotCapture::capture_async();
+	// this blocking path is left for direct execute_tool() callers.
+	return AIScreenshotCapture::capture(p_args);
 }
 
 Dictionary EditorTools::check_node_in_scene_tree(const Dictionary &p_args) {
@@ -2477,76 +2514,72 @@ Dictionary EditorTools::search_across_project(const Dictionary &p_args) {
 	int max_results = p_args.get("max_results", 5);
 	String modality_filter = p_args.get("modality_filter", "");
 	
-	// Get project root path
-	String project_root = ProjectSettings::get_singleton()->get_resource_path();
-	
-	// Get authentication info from AIChatDock if available
-	AIChatDock *ai_chat_dock = nullptr;
-	// For now, we'll require dev mode or manual authentication
-	// TODO: Implement proper AIChatDock lookup when needed
-	
-	// For dev mode, use hardcoded values
-	String user_id = "106469680334583136136";  // Dev mode user
-	String machine_id = "dev_machine";
-	String auth_token = "dev_token";
-	
-	if (ai_chat_dock) {
-		// Get authentication details from AI chat dock
-		user_id = ai_chat_dock->get_current_user_id();
-		machine_id = ai_chat_dock->get_machine_id();
-		auth_token = ai_chat_dock->get_auth_token();
-	}
-	
-	// For now, allow dev mode fallback
-	if (user_id.is_empty()) {
-		user_id = "106469680334583136136";  // Dev fallback
-		machine_id = "dev_machine";
-		auth_token = "dev_token";
+	AIProjectIndex *index = AIProjectIndex::get_singleton();
+	if (!index) {
+		result["success"] = false;
+		result["error"] = "Project index is not available";
+		return result;
 	}
 	
-	// Prepare HTTP request to backend
-	HTTPRequest *http_request = memnew(HTTPRequest);
-	EditorNode::get_singleton()->add_child(http_request);
-	
-	// Prepare request data
-	Dictionary request_data;
-	request_data["query"] = query;
-	request_data["include_graph"] = include_graph;
-	request_data["max_results"] = max_results;
-	request_data["project_root"] = project_root;
-	request_data["user_id"] = user_id;
-	request_data["machine_id"] = machine_id;
-	
-	if (!modality_filter.is_empty()) {
-		request_data["modality_filter"] = modality_filter;
+	// Answered locally from the on-disk project index (.godot/ai_index).
+	Array similar_files = index->search(query, max_results, modality_filter);
+	
+	// Central files: dependencies shared by the matches, ranked by how many
+	// matches reference them.
+	Array central_files;
+	EditorFileSystem *efs = EditorFileSystem::get_singleton();
+	if (include_graph && efs) {
+		HashMap<String, int> dependency_counts;
+		for (int i = 0; i < similar_files.size(); i++) {
+			Dictionary match = similar_files[i];
+			String path = match["file_path"];
+			int file_idx = -1;
+			EditorFileSystemDirectory *dir = efs->find_file(path, &file_idx);
+			if (!dir || file_idx < 0) {
+				continue;
+			}
+			Vector<String> deps = dir->get_file_deps(file_idx);
+			for (const String &dep : deps) {
+				// Dependencies may be stored as "uid::path" pairs.
+				String dep_path = dep.get_slice("::", dep.get_slice_count("::") - 1);
+				dependency_counts[dep_path] += 1;
+			}
+		}
+		struct CentralFile {
+			String path;
+			int count = 0;
+		};
+		struct CentralFileComparator {
+			bool operator()(const CentralFile &p_a, const CentralFile &p_b) const {
+				return p_a.count != p_b.count ? p_a.count > p_b.count : p_a.path < p_b.path;
+			}
+		};
+		LocalVector<CentralFile> ranked;
+		for (const KeyValue<String, int> &E : dependency_counts) {
+			ranked.push_back({ E.key, E.value });
+		}
+		ranked.sort_custom<CentralFileComparator>();
+		for (const CentralFile &file : ranked) {
+			Dictionary central;
+			central["file_path"] = file.path;
+			central["referenced_by"] = file.count;
+			central_files.push_back(central);
+		}
 	}
 	
-	// Convert to JSON
-	Ref<JSON> json;
-	json.instantiate();
-	String json_string = json->stringify(request_data);
-	
-	// Prepare headers
-	PackedStringArray headers;
-	headers.push_back("Content-Type: application/json");
-	headers.push_back("Authorization: Bearer " + auth_token);
-	
-	// For now, return a mock response since we can't easily do HTTP requests from EditorTools
-	// This will be working once the authentication system is properly integrated
 	result["success"] = true;
 	result["query"] = query;
-	result["message"] = "Search functionality is available. Tool successfully integrated.";
-	result["note"] = "HTTP request to backend would be made here with proper authentication";
-	result["similar_files"] = Array();
-	result["central_files"] = Array();
-	result["file_count"] = 0;
+	result["similar_files"] = similar_files;
+	result["central_files"] = central_files;
+	result["file_count"] = similar_files.size();
 	result["include_graph"] = include_graph;
-	
-	// Clean up
-	http_request->queue_free();
+	result["index_stats"] = index->get_stats();
+	if (!index->is_ready()) {
+		result["message"] = "Project index is still being built; results may be incomplete.";
+	}
 	
 	return result;
-} 
+}
 
 // --- Multiplexed editor introspection/debug tool ---
 Dictionary EditorTools::editor_introspect(const Dictionary &p_args) {
@@ -2889,11 +2922,14 @@ Dictionary EditorTools::editor_introspect(const Dictionary &p_args) {
         }
 
         String trace_id = String::num_uint64((uint64_t)OS::get_singleton()->get_ticks_usec());
-        Dictionary reg;
-        reg["events"] = Array();
-        reg["include_args"] = include_args;
-        reg["max_events"] = max_events;
-        reg["next_index"] = 0;
+        SignalTrace *trace = memnew(SignalTrace);
+        trace->include_args = include_args;
+        trace->events.set_capacity(max_events);
+        {
+            // Register before connecting so no early emission is lost.
+            MutexLock lock(trace_mutex);
+            signal_traces.insert(trace_id, trace);
+        }
         Array connections; // store for cleanup
 
         Node *root = EditorNode::get_singleton()->get_tree()->get_edited_scene_root();
@@ -2937,8 +2973,7 @@ Dictionary EditorTools::editor_introspect(const Dictionary &p_args) {
             }
         }
 
-        reg["connections"] = connections;
-        trace_registry[trace_id] = reg;
+        trace->connections = connections;
         result["success"] = true;
         result["trace_id"] = trace_id;
         result["connected"] = connections.size();
@@ -2947,14 +2982,21 @@ Dictionary EditorTools::editor_introspect(const Dictionary &p_args) {
 
     if (operation == "stop_signal_trace") {
         String trace_id = p_args.get("trace_id", "");
-        if (!trace_registry.has(trace_id)) {
+        SignalTrace *trace = nullptr;
+        {
+            MutexLock lock(trace_mutex);
+            SignalTrace **found = signal_traces.getptr(trace_id);
+            if (found) {
+                trace = *found;
+                signal_traces.erase(trace_id);
+            }
+        }
+        if (!trace) {
             result["success"] = false;
             result["message"] = "Unknown trace_id";
             return result;
         }
-        Dictionary reg = trace_registry[trace_id];
-        Array connections = reg.get("connections", Array());
-        Node *root = EditorNode::get_singleton()->get_tree()->get_edited_scene_root();
+        Array connections = trace->connections;
         for (int i = 0; i < connections.size(); i++) {
             Dictionary c = connections[i];
             Dictionary err;
@@ -2964,10 +3006,12 @@ Dictionary EditorTools::editor_introspect(const Dictionary &p_args) {
             Variant callable_v = c.get("callable", Variant());
             if (callable_v.get_type() == Variant::CALLABLE) {
                 Callable cb = callable_v;
-                src->disconnect(sig, cb);
+                if (src->is_connected(sig, cb)) {
+                    src->disconnect(sig, cb);
+                }
             }
         }
-        trace_registry.erase(trace_id);
+        memdelete(trace);
         result["success"] = true;
         result["message"] = "Trace stopped";
         return result;
@@ -2975,22 +3019,37 @@ Dictionary EditorTools::editor_introspect(const Dictionary &p_args) {
 
     if (operation == "get_trace_events") {
         String trace_id = p_args.get("trace_id", "");
-        int since = p_args.get("since_index", 0);
-        if (!trace_registry.has(trace_id)) {
-            result["success"] = false;
-            result["message"] = "Unknown trace_id";
-            return result;
+        uint64_t since = MAX(0, (int64_t)p_args.get("since_index", 0));
+        LocalVector<TraceEvent> events;
+        uint64_t first_index = 0;
+        uint64_t next_index = 0;
+        {
+            MutexLock lock(trace_mutex);
+            SignalTrace **trace = signal_traces.getptr(trace_id);
+            if (!trace) {
+                result["success"] = false;
+                result["message"] = "Unknown trace_id";
+                return result;
+            }
+            (*trace)->events.fetch_since(since, events);
+            first_index = (*trace)->events.get_first_index();
+            next_index = (*trace)->events.get_next_index();
         }
-        Dictionary reg = trace_registry[trace_id];
-        Array events = reg.get("events", Array());
+        // Build the dictionaries outside the lock.
         Array out;
-        for (int i = 0; i < events.size(); i++) {
-            Dictionary e = events[i];
-            if ((int)e.get("i", 0) >= since) out.push_back(e);
+        for (const TraceEvent &event : events) {
+            Dictionary e;
+            e["i"] = event.index;
+            e["time_ms"] = event.time_ms;
+            e["source_path"] = event.source_path;
+            e["signal"] = event.signal;
+            if (!event.args.is_empty()) e["args"] = event.args;
+            out.push_back(e);
         }
         result["success"] = true;
         result["events"] = out;
-        result["next_index"] = reg.get("next_index", 0);
+        result["next_index"] = next_index;
+        result["dropped"] = since < first_index ? first_index - since : 0;
         return result;
     }
 
@@ -3008,30 +3067,36 @@ Dictionary EditorTools::editor_introspect(const Dictionary &p_args) {
         if (!node) return err;
 
         String watch_id = String::num_uint64((uint64_t)OS::get_singleton()->get_ticks_usec());
-        Dictionary reg;
-        reg["node_path"] = node_path;
-        reg["variables"] = variables;
-        reg["last_values"] = Dictionary();
-        reg["events"] = Array();
-        reg["next_index"] = 0;
-        reg["max_events"] = max_events;
-        property_watch_registry[watch_id] = reg;
+        PropertyWatch *watch = memnew(PropertyWatch);
+        watch->node_id = node->get_instance_id();
+        watch->events.set_capacity(max_events);
 
         // Initial snapshot
-        Dictionary ev;
-        ev["i"] = 0;
-        ev["time_ms"] = OS::get_singleton()->get_ticks_msec();
-        ev["snapshot"] = Dictionary();
-        Dictionary snap;
+        WatchEvent snapshot;
+        snapshot.time_ms = OS::get_singleton()->get_ticks_msec();
+        snapshot.snapshot = true;
         for (int i = 0; i < variables.size(); i++) {
             String v = variables[i];
-            snap[v] = node->get(v);
+            const Variant captured = _capture_trace_value(node->get(v));
+            watch->variables.push_back(v);
+            watch->last_values.push_back(captured);
+            snapshot.values[v] = captured;
+        }
+        watch->events.push(snapshot);
+
+        bool first_watch = false;
+        {
+            MutexLock lock(trace_mutex);
+            first_watch = property_watches.is_empty();
+            property_watches.insert(watch_id, watch);
+        }
+        // Changes are recorded as they happen, once per frame, instead of
+        // whenever the agent polls.
+        SceneTree *tree = EditorNode::get_singleton()->get_tree();
+        Callable sampler = callable_mp(ensure_tracer(), &EditorTools::_sample_property_watches);
+        if (first_watch && !tree->is_connected(SNAME("process_frame"), sampler)) {
+            tree->connect(SNAME("process_frame"), sampler);
         }
-        ev["snapshot"] = snap;
-        Array events = reg["events"]; events.push_back(ev);
-        reg["events"] = events; reg["next_index"] = 1;
-        reg["last_values"] = snap;
-        property_watch_registry[watch_id] = reg;
 
         result["success"] = true;
         result["watch_id"] = watch_id;
@@ -3040,55 +3105,54 @@ Dictionary EditorTools::editor_introspect(const Dictionary &p_args) {
 
     if (operation == "poll_property_watch") {
         String watch_id = p_args.get("watch_id", "");
-        int since = p_args.get("since_index", 0);
-        if (!property_watch_registry.has(watch_id)) {
-            result["success"] = false;
-            result["message"] = "Unknown watch_id";
-            return result;
-        }
-        Dictionary reg = property_watch_registry[watch_id];
-        String node_path = reg.get("node_path", String("."));
-        Array variables = reg.get("variables", Array());
-        Dictionary last = reg.get("last_values", Dictionary());
-        Array events = reg.get("events", Array());
-        int next_index = reg.get("next_index", 0);
-        int max_events = reg.get("max_events", 200);
-
-        Dictionary err; Node *node = _get_node_from_path(node_path, err);
-        if (!node) return err;
-
-        bool changed = false; Dictionary delta;
-        for (int i = 0; i < variables.size(); i++) {
-            String v = variables[i];
-            Variant value = node->get(v);
-            Variant last_v = last.get(v, Variant());
-            if (value != last_v) {
-                delta[v] = value; last[v] = value; changed = true;
+        uint64_t since = MAX(0, (int64_t)p_args.get("since_index", 0));
+        LocalVector<WatchEvent> events;
+        uint64_t first_index = 0;
+        uint64_t next_index = 0;
+        {
+            MutexLock lock(trace_mutex);
+            PropertyWatch **watch = property_watches.getptr(watch_id);
+            if (!watch) {
+                result["success"] = false;
+                result["message"] = "Unknown watch_id";
+                return result;
             }
+            (*watch)->events.fetch_since(since, events);
+            first_index = (*watch)->events.get_first_index();
+            next_index = (*watch)->events.get_next_index();
         }
-        if (changed) {
-            Dictionary ev;
-            ev["i"] = next_index;
-            ev["time_ms"] = OS::get_singleton()->get_ticks_msec();
-            ev["delta"] = delta;
-            events.push_back(ev);
-            while (events.size() > max_events) events.remove_at(0);
-            next_index += 1;
-        }
-        reg["events"] = events; reg["next_index"] = next_index; reg["last_values"] = last;
-        property_watch_registry[watch_id] = reg;
-
         Array out;
-        for (int i = 0; i < events.size(); i++) { Dictionary e = events[i]; if ((int)e.get("i", 0) >= since) out.push_back(e); }
+        for (const WatchEvent &event : events) {
+            Dictionary e;
+            e["i"] = event.index;
+            e["time_ms"] = event.time_ms;
+            e[event.snapshot ? "snapshot" : "delta"] = event.values;
+            out.push_back(e);
+        }
         result["success"] = true;
         result["events"] = out;
         result["next_index"] = next_index;
+        result["dropped"] = since < first_index ? first_index - since : 0;
         return result;
     }
 
     if (operation == "stop_property_watch") {
         String watch_id = p_args.get("watch_id", "");
-        property_watch_registry.erase(watch_id);
+        bool last_watch = false;
+        {
+            MutexLock lock(trace_mutex);
+            PropertyWatch **watch = property_watches.getptr(watch_id);
+            if (watch) {
+                memdelete(*watch);
+                property_watches.erase(watch_id);
+            }
+            last_watch = property_watches.is_empty();
+        }
+        SceneTree *tree = EditorNode::get_singleton()->get_tree();
+        Callable sampler = callable_mp(ensure_tracer(), &EditorTools::_sample_property_watches);
+        if (last_watch && tree->is_connected(SNAME("process_frame"), sampler)) {
+            tree->disconnect(SNAME("process_frame"), sampler);
+        }
         result["success"] = true;
         result["message"] = "Property watch stopped";
         return result;
@@ -3174,4 +3238,200 @@ Dictionary EditorTools::editor_introspect(const Dictionary &p_args) {
     result["success"] = false;
     result["message"] = String("Operation not implemented: ") + operation;
     return result;
-}
\ No newline at end of file
+}
+
+// Tool dispatch and batching.
+
+const HashMap<String, EditorTools::ToolInfo> &EditorTools::_get_tool_registry() {
+	static const HashMap<String, ToolInfo> registry = []() {
+		HashMap<String, ToolInfo> tools;
+		auto add = [&tools](const String &p_name, ToolFunction p_function, ToolKind p_kind, uint32_t p_cache_dependencies = 0) {
+			ToolInfo info;
+			info.function = p_function;
+			info.kind = p_kind;
+			info.cache_dependencies = p_cache_dependencies;
+			tools.insert(p_name, info);
+		};
+		// Results of these are memoized while what they read is unchanged.
+		const uint32_t CLASSES = AIToolCache::DEPENDS_ON_CLASSES;
+		const uint32_t SCENE = AIToolCache::DEPENDS_ON_SCENE;
+		const uint32_t FILES = AIToolCache::DEPENDS_ON_FILES;
+		const uint32_t PATH = AIToolCache::DEPENDS_ON_PATH;
+		// Modification times only have a one second resolution, so file reads
+		// also depend on the edits the editor itself makes.
+		add("read_file_content", &EditorTools::read_file_content, TOOL_KIND_PARALLEL_READ, PATH | FILES);
+		add("read_file_advanced", &EditorTools::read_file_advanced, TOOL_KIND_PARALLEL_READ, PATH | FILES);
+
+		// Walk the EditorFileSystem tree, which is only stable on the main thread.
+		add("search_across_project", &EditorTools::search_across_project, TOOL_KIND_READ);
+		add("list_project_files", &EditorTools::list_project_files, TOOL_KIND_READ, FILES);
+		add("search_project_files", &EditorTools::search_project_files, TOOL_KIND_READ, FILES);
+		add("get_scene_info", &EditorTools::get_scene_info, TOOL_KIND_READ, SCENE);
+		add("get_all_nodes", &EditorTools::get_all_nodes, TOOL_KIND_READ);
+		add("search_nodes_by_type", &EditorTools::search_nodes_by_type, TOOL_KIND_READ, SCENE);
+		add("get_editor_selection", &EditorTools::get_editor_selection, TOOL_KIND_READ);
+		add("get_node_properties", &EditorTools::get_node_properties, TOOL_KIND_READ);
+		add("get_available_classes", &EditorTools::get_available_classes, TOOL_KIND_READ, CLASSES);
+		add("get_node_script", &EditorTools::get_node_script, TOOL_KIND_READ);
+		add("check_compilation_errors", &EditorTools::check_compilation_errors, TOOL_KIND_READ);
+		add("get_scene_tree_hierarchy", &EditorTools::get_scene_tree_hierarchy, TOOL_KIND_READ);
+		add("inspect_physics_body", &EditorTools::inspect_physics_body, TOOL_KIND_READ);
+		add("get_camera_info", &EditorTools::get_camera_info, TOOL_KIND_READ);
+		add("check_node_in_scene_tree", &EditorTools::check_node_in_scene_tree, TOOL_KIND_READ);
+		add("inspect_animation_state", &EditorTools::inspect_animation_state, TOOL_KIND_READ);
+		add("get_layers_and_zindex", &EditorTools::get_layers_and_zindex, TOOL_KIND_READ);
+		add("take_screenshot", &EditorTools::take_screenshot, TOOL_KIND_READ);
+
+		add("set_node_property", &EditorTools::set_node_property, TOOL_KIND_UNDOABLE);
+		add("create_node", &EditorTools::create_node, TOOL_KIND_UNDOABLE);
+		add("delete_node", &EditorTools::delete_node, TOOL_KIND_UNDOABLE);
+		add("move_node", &EditorTools::move_node, TOOL_KIND_UNDOABLE);
+
+		add("save_scene", &EditorTools::save_scene, TOOL_KIND_OTHER);
+		add("call_node_method", &EditorTools::call_node_method, TOOL_KIND_OTHER);
+		add("attach_script", &EditorTools::attach_script, TOOL_KIND_OTHER);
+		add("manage_scene", &EditorTools::manage_scene, TOOL_KIND_OTHER);
+		add("add_collision_shape", &EditorTools::add_collision_shape, TOOL_KIND_OTHER);
+		add("run_scene", &EditorTools::run_scene, TOOL_KIND_OTHER);
+		add("editor_introspect", &EditorTools::editor_introspect, TOOL_KIND_OTHER);
+		return tools;
+	}();
+	return registry;
+}
+
+bool EditorTools::has_tool(const String &p_name) {
+	return _get_tool_registry().has(p_name);
+}
+
+EditorTools::ToolKind EditorTools::get_tool_kind(const String &p_name) {
+	const ToolInfo *info = _get_tool_registry().getptr(p_name);
+	return info ? info->kind : TOOL_KIND_OTHER;
+}
+
+Dictionary EditorTools::execute_tool(const String &p_name, const Dictionary &p_args) {
+	const ToolInfo *info = _get_tool_registry().getptr(p_name);
+	if (!info) {
+		Dictionary result;
+		result["success"] = false;
+		result["message"] = "Unknown tool: " + p_name;
+		return result;
+	}
+	if (info->cache_dependencies) {
+		return AIToolCache::get_or_compute(p_name, p_args, info->cache_dependencies, info->function);
+	}
+	if (info->kind == TOOL_KIND_OTHER) {
+		// Scripts, saves and method calls can change anything a cached tool read.
+		AIToolCache::clear();
+	}
+	return info->function(p_args);
+}
+
+struct EditorTools::BatchParallelRun {
+	const LocalVector<String> *names = nullptr;
+	const LocalVector<Dictionary> *args = nullptr;
+	LocalVector<Dictionary> *results = nullptr;
+	LocalVector<int> indices;
+	ToolResultCallback callback = nullptr;
+	void *userdata = nullptr;
+};
+
+void EditorTools::_run_batch_parallel_call(void *p_userdata, uint32_t p_element) {
+	BatchParallelRun *run = static_cast<BatchParallelRun *>(p_userdata);
+	const int index = run->indices[p_element];
+	// Each element writes only its own slot.
+	Dictionary &result = (*run->results)[index];
+	result = execute_tool((*run->names)[index], (*run->args)[index]);
+	if (run->callback) {
+		run->callback(run->userdata, index, result);
+	}
+}
+
+Array EditorTools::execute_tool_batch(const Array &p_calls, ToolResultCallback p_callback, void *p_userdata) {
+	ERR_FAIL_COND_V_MSG(!Thread::is_main_thread(), Array(), "Tool batches must be executed on the main thread.");
+	ERR_FAIL_COND_V_MSG(batch_undo_redo != nullptr, Array(), "Tool batches cannot be nested.");
+
+	const int count = p_calls.size();
+	LocalVector<String> names;
+	LocalVector<Dictionary> args;
+	LocalVector<Dictionary> results;
+	names.resize(count);
+	args.resize(count);
+	results.resize(count);
+
+	Ref<JSON> json;
+	json.instantiate();
+	for (int i = 0; i < count; i++) {
+		const Dictionary call = p_calls[i];
+		names[i] = call.has("function_name") ? call["function_name"] : call.get("name", "");
+		const Variant arguments = call.get("arguments", Dictionary());
+		if (arguments.get_type() == Variant::STRING) {
+			if (json->parse(arguments) == OK && json->get_data().get_type() == Variant::DICTIONARY) {
+				args[i] = json->get_data();
+			}
+		} else if (arguments.get_type() == Variant::DICTIONARY) {
+			args[i] = arguments;
+		}
+	}
+
+	BatchParallelRun run;
+	run.names = &names;
+	run.args = &args;
+	run.results = &results;
+	run.callback = p_callback;
+	run.userdata = p_userdata;
+
+	EditorUndoRedoManager *undo_redo = EditorUndoRedoManager::get_singleton();
+	auto commit_undo_action = [&]() {
+		if (batch_undo_redo) {
+			batch_undo_redo = nullptr;
+			// The tools already applied their changes.
+			undo_redo->commit_action(false);
+		}
+	};
+
+	int i = 0;
+	while (i < count) {
+		const ToolKind kind = has_tool(names[i]) ? get_tool_kind(names[i]) : TOOL_KIND_READ;
+
+		if (kind == TOOL_KIND_PARALLEL_READ) {
+			// Consecutive file reads don't depend on each other or on the scene.
+			run.indices.clear();
+			while (i < count && has_tool(names[i]) && get_tool_kind(names[i]) == TOOL_KIND_PARALLEL_READ) {
+				run.indices.push_back(i++);
+			}
+			if (run.indices.size() == 1) {
+				_run_batch_parallel_call(&run, 0);
+			} else {
+				WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_native_group_task(&EditorTools::_run_batch_parallel_call, &run, run.indices.size(), -1, true, SNAME("AIToolBatch"));
+				WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+			}
+			continue;
+		}
+
+		if (kind == TOOL_KIND_UNDOABLE && !batch_undo_redo) {
+			undo_redo->create_action("AI: Apply tool batch", UndoRedo::MERGE_DISABLE, EditorNode::get_singleton()->get_edited_scene());
+			batch_undo_redo = undo_redo;
+		} else if (kind == TOOL_KIND_OTHER) {
+			// Keep unrelated side effects out of the undo action.
+			commit_undo_action();
+		}
+		results[i] = execute_tool(names[i], args[i]);
+		if (p_callback) {
+			p_callback(p_userdata, i, results[i]);
+		}
+		i++;
+	}
+	commit_undo_action();
+
+	if (batch_save_pending) {
+		batch_save_pending = false;
+		_save_edited_scene();
+	}
+
+	Array result_array;
+	result_array.resize(count);
+	for (int j = 0; j < count; j++) {
+		result_array[j] = results[j];
+	}
+	return result_array;
+}
@@ -2,22 +2,59 @@
 
 #include "core/object/class_db.h"
 #include "core/object/object.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
 #include "core/variant/dictionary.h"
 
+class EditorUndoRedoManager;
 class Node;
 
 class EditorTools : public Object {
 	GDCLASS(EditorTools, Object);
 
+public:
+	enum ToolKind {
+		TOOL_KIND_PARALLEL_READ, // Reads files or thread-safe indices only; may run on worker threads.
+		TOOL_KIND_READ, // Reads the scene tree or editor state on the main thread.
+		TOOL_KIND_UNDOABLE, // Scene edit that joins the undo action of a batch.
+		TOOL_KIND_OTHER, // Any other side effect; runs on its own, outside the undo action.
+	};
+
+	// Called once per finished call of a batch. Parallel reads report from
+	// worker threads, everything else from the main thread.
+	typedef void (*ToolResultCallback)(void *p_userdata, int p_index, const Dictionary &p_result);
+
 private:
+	// Default page size of node listings; 10k-node scenes are several MB of JSON.
+	static constexpr int NODE_PAGE_SIZE = 1000;
+
+	typedef Dictionary (*ToolFunction)(const Dictionary &p_args);
+	struct ToolInfo {
+		ToolFunction function = nullptr;
+		ToolKind kind = TOOL_KIND_OTHER;
+		// AIToolCache::Dependency flags; 0 for tools that are not memoized.
+		uint32_t cache_dependencies = 0;
+	};
+	struct BatchParallelRun;
+
+	static const HashMap<String, ToolInfo> &_get_tool_registry();
+	static void _run_batch_parallel_call(void *p_userdata, uint32_t p_element);
+	// Non-null while execute_tool_batch() has an undo action open. Undoable
+	// tools record into it and leave saving the scene to the batch.
+	static EditorUndoRedoManager *batch_undo_redo;
+	static bool batch_save_pending;
+	static void _collect_owned_nodes(Node *p_node, Node *p_owner, LocalVector<Node *> &r_nodes);
+	static void _save_edited_scene();
+
 	static Dictionary _get_node_info(Node *p_node);
 	static Node *_get_node_from_path(const String &p_path, Dictionary &r_error_result);
     // Trace support
+    // Traces and watches live in lock-protected ring buffers in editor_tools.cpp.
     static EditorTools *tracer_instance;
-    static Dictionary trace_registry; // trace_id -> { events:Array, connections:Array, include_args:bool, max_events:int, next_index:int }
-    static Dictionary property_watch_registry; // watch_id -> { node_path:String, variables:Array, last_values:Dictionary, events:Array, next_index:int, max_events:int }
     static EditorTools *ensure_tracer();
     static void _record_trace_event(const String &p_trace_id, const String &p_source_path, const String &p_signal_name, const Array &p_args);
+    // Records changes of all property watches; connected to process_frame while any watch exists.
+    void _sample_property_watches();
     // Signal trace callbacks for 0..4 signal-args; bound extras follow after signal args
     void _on_traced_signal_0(const String &p_trace_id, const String &p_source_path, const String &p_signal_name);
     void _on_traced_signal_1(const Variant &a0, const String &p_trace_id, const String &p_source_path, const String &p_signal_name);
@@ -26,14 +63,18 @@ private:
     void _on_traced_signal_4(const Variant &a0, const Variant &a1, const Variant &a2, const Variant &a3, const String &p_trace_id, const String &p_source_path, const String &p_signal_name);
 
 public:
+	// Blocking JSON POST over the shared connection pool; safe on worker threads.
+	static Error _post_backend_json(const String &p_url, const Dictionary &p_data, const Vector<String> &p_headers, int &r_code, String &r_body);
     static Dictionary _predict_code_edit(const String &p_file_content, const String &p_prompt, const String &p_api_endpoint);
     	static Dictionary _call_apply_endpoint(const String &p_file_path, const String &p_file_content, const Dictionary &p_ai_args, const String &p_api_endpoint);
 	static String _clean_backend_content(const String &p_content);
 	static String _convert_javascript_to_gdscript(const String &p_content);
 	static String _fix_malformed_content(const String &p_content);
 	static String _generate_unified_diff(const String &p_original, const String &p_modified, const String &p_file_path);
-	static Array _check_compilation_errors(const String &p_file_path, const String &p_content);
+	static Array _check_compilation_errors(const String &p_file_path, const String &p_content, Array *r_broken_dependents = nullptr);
     static void set_api_endpoint(const String &p_endpoint);
+	// Frees all signal traces, property watches and the tracer. Called on editor shutdown.
+	static void cleanup();
 
 	// Individual Tool Methods (used by universal tools)
 	static Dictionary get_scene_info(const Dictionary &p_args);
@@ -78,4 +119,14 @@ public:
 
 	// Multiplexed introspection/debug tool
 	static Dictionary editor_introspect(const Dictionary &p_args);
+
+	// Dispatch by tool name. Batches take an ordered array of calls, each a
+	// Dictionary with `function_name` (or `name`) and `arguments` (a
+	// Dictionary or a JSON string), and return the results in call order.
+	// Consecutive parallel reads run on the WorkerThreadPool and undoable
+	// scene edits share one undo action. Must be called on the main thread.
+	static bool has_tool(const String &p_name);
+	static ToolKind get_tool_kind(const String &p_name);
+	static Dictionary execute_tool(const String &p_name, const Dictionary &p_args);
+	static Array execute_tool_batch(const Array &p_calls, ToolResultCallback p_callback = nullptr, void *p_userdata = nullptr);
 }; 
\ No newline at end of file
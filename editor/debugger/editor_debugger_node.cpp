@@ -31,6 +31,7 @@
 #include "editor_debugger_node.h"
 
 #include "core/object/undo_redo.h"
+#include "editor/ai/ai_scene_snapshot.h"
 #include "editor/debugger/editor_debugger_plugin.h"
 #include "editor/debugger/editor_debugger_tree.h"
 #include "editor/debugger/script_editor_debugger.h"
@@ -803,6 +804,8 @@ void EditorDebuggerNode::_breakpoints_cleared_in_tree(int p_debugger) {
 
 // Remote inspector/edit.
 void EditorDebuggerNode::_methods_changed(void *p_ud, Object *p_base, const StringName &p_name, const Variant **p_args, int p_argcount) {
+	// These are the only undo-redo notify hooks, so they also feed the AI scene snapshot.
+	AISceneSnapshot::notify_method_called(p_base, p_name);
 	if (!singleton) {
 		return;
 	}
@@ -812,6 +815,7 @@ void EditorDebuggerNode::_methods_changed(void *p_ud, Object *p_base, const Stri
 }
 
 void EditorDebuggerNode::_properties_changed(void *p_ud, Object *p_base, const StringName &p_property, const Variant &p_value) {
+	AISceneSnapshot::notify_property_changed(p_base, p_property);
 	if (!singleton) {
 		return;
 	}
@@ -38,7 +38,6 @@
 #include "scene/gui/texture_rect.h"
 #include "scene/gui/dialogs.h"
 #include "scene/gui/popup_menu.h"
-#include "scene/main/http_request.h"
 #include "scene/resources/style_box_flat.h"
 #include "ai_auth_helper.h"
 #include "scene/2d/node_2d.h"
@@ -48,7 +47,12 @@
 #include "scene/gui/popup.h"
 #include "scene/gui/control.h"
 
+#include "../ai/ai_project_index.h"
+#include "../ai/ai_scene_snapshot.h"
+#include "../ai/ai_screenshot_capture.h"
+#include "../ai/ai_tool_cache.h"
 #include "../ai/editor_tools.h"
+#include "ai_image_pipeline.h"
 #include "diff_viewer.h"
 
 void AIChatDock::_bind_methods() {
@@ -61,7 +65,6 @@ void AIChatDock::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("_on_edit_message_cancel_pressed"), &AIChatDock::_on_edit_message_cancel_pressed);
 	ClassDB::bind_method(D_METHOD("_on_edit_field_gui_input"), &AIChatDock::_on_edit_field_gui_input);
 	ClassDB::bind_method(D_METHOD("_process_send_request_async"), &AIChatDock::_process_send_request_async);
-	ClassDB::bind_method(D_METHOD("_save_conversations_async"), &AIChatDock::_save_conversations_async);
 	ClassDB::bind_method(D_METHOD("_on_input_text_changed"), &AIChatDock::_on_input_text_changed);
 	ClassDB::bind_method(D_METHOD("_update_at_mention_popup"), &AIChatDock::_update_at_mention_popup);
 	ClassDB::bind_method(D_METHOD("_populate_at_mention_tree"), &AIChatDock::_populate_at_mention_tree);
@@ -86,14 +89,11 @@ void AIChatDock::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("_on_save_image_pressed", "base64_data", "format"), &AIChatDock::_on_save_image_pressed);
 	ClassDB::bind_method(D_METHOD("_on_save_image_location_selected", "file_path"), &AIChatDock::_on_save_image_location_selected);
 
-	ClassDB::bind_method(D_METHOD("_save_conversations_to_disk"), &AIChatDock::_save_conversations_to_disk);
 	ClassDB::bind_method(D_METHOD("_process_image_attachment_async"), &AIChatDock::_process_image_attachment_async);
 	ClassDB::bind_method(D_METHOD("_send_chat_request_chunked"), &AIChatDock::_send_chat_request_chunked);
 	ClassDB::bind_method(D_METHOD("_apply_tool_result_deferred"), &AIChatDock::_apply_tool_result_deferred);
 	ClassDB::bind_method(D_METHOD("_create_assistant_message_with_tool_placeholder"), &AIChatDock::_create_assistant_message_with_tool_placeholder);
 	ClassDB::bind_method(D_METHOD("_finalize_chat_request"), &AIChatDock::_finalize_chat_request);
-	ClassDB::bind_method(D_METHOD("_save_conversations_chunked"), &AIChatDock::_save_conversations_chunked);
-	ClassDB::bind_method(D_METHOD("_finalize_conversations_save"), &AIChatDock::_finalize_conversations_save);
 	ClassDB::bind_method(D_METHOD("_execute_delayed_save"), &AIChatDock::_execute_delayed_save);
 	ClassDB::bind_method(D_METHOD("_display_generated_image_deferred", "base64_data", "id"), &AIChatDock::_display_generated_image_deferred);
     ClassDB::bind_method(D_METHOD("_on_apply_edit_thread_done"), &AIChatDock::_on_apply_edit_thread_done);
@@ -101,8 +101,6 @@ void AIChatDock::_bind_methods() {
 	// Embedding system methods
 	ClassDB::bind_method(D_METHOD("_initialize_embedding_system"), &AIChatDock::_initialize_embedding_system);
 	ClassDB::bind_method(D_METHOD("_perform_initial_indexing"), &AIChatDock::_perform_initial_indexing);
-	ClassDB::bind_method(D_METHOD("_scan_and_index_project_files"), &AIChatDock::_scan_and_index_project_files);
-	ClassDB::bind_method(D_METHOD("_send_file_batch"), &AIChatDock::_send_file_batch);
 	ClassDB::bind_method(D_METHOD("_on_embedding_request_completed"), &AIChatDock::_on_embedding_request_completed);
 	ClassDB::bind_method(D_METHOD("_on_embedding_status_tick"), &AIChatDock::_on_embedding_status_tick);
 }
@@ -269,6 +267,9 @@ void AIChatDock::_notification(int p_notification) {
 			chat_container = memnew(VBoxContainer);
 			chat_container->set_h_size_flags(Control::SIZE_EXPAND_FILL);
 			chat_scroll->add_child(chat_container);
+			chat_container->connect(SceneStringName(sort_children), callable_mp(this, &AIChatDock::_on_transcript_sorted));
+			chat_scroll->get_v_scroll_bar()->connect(SceneStringName(value_changed), callable_mp(this, &AIChatDock::_on_transcript_scrolled));
+			_clear_transcript_ui();
 
 			// Add a container for attachments just above the input field
 			VBoxContainer *bottom_panel = memnew(VBoxContainer);
@@ -450,59 +451,6 @@ void AIChatDock::_notification(int p_notification) {
 			
 			_update_conversation_dropdown();
 		} break;
-		case NOTIFICATION_PROCESS: {
-			if (http_client.is_valid()) {
-				http_client->poll();
-				HTTPClient::Status client_status = http_client->get_status();
-				if (http_status == STATUS_CONNECTING && client_status == HTTPClient::STATUS_CONNECTED) {
-					http_status = STATUS_REQUESTING;
-					Error err = http_client->request(HTTPClient::METHOD_POST, pending_request_path, pending_request_headers, pending_request_body.ptr(), pending_request_body.size());
-					if (err != OK) {
-						_add_message_to_chat("system", "Failed to send request to backend.");
-						is_waiting_for_response = false;
-						_update_ui_state();
-						http_status = STATUS_DONE;
-						return;
-					}
-				} else if (http_status == STATUS_REQUESTING && client_status == HTTPClient::STATUS_BODY) {
-					http_status = STATUS_BODY;
-				}
-
-				if (client_status == HTTPClient::STATUS_BODY) {
-					PackedByteArray chunk = http_client->read_response_body_chunk();
-					if (chunk.size() > 0) {
-						_handle_response_chunk(chunk);
-					}
-				}
-
-                if (client_status == HTTPClient::STATUS_DISCONNECTED || client_status == HTTPClient::STATUS_CONNECTION_ERROR || client_status == HTTPClient::STATUS_CANT_CONNECT) {
-                    if (stream_completed_successfully) {
-                        print_line("AI Chat: Stream completed successfully, server closed connection");
-                    } else {
-                        print_line("AI Chat: HTTP connection failed with status: " + String::num_int64(client_status));
-                        _add_message_to_chat("system", "Connection lost or failed (Status: " + String::num_int64(client_status) + ") - Try again please.");
-                    }
-
-                    // If we still have async tool tasks running (e.g., apply_edit), keep the UI in 'waiting' state
-                    bool has_async_work = pending_tool_tasks > 0;
-                    is_waiting_for_response = has_async_work ? true : false;
-                    // Clean up stop mechanism state
-                    stop_requested = false;
-                    current_request_id = "";
-                    _update_ui_state();
-                    http_status = STATUS_DONE;
-                    current_assistant_message_label = nullptr;
-                    // Stop HTTP polling; async tasks will resume the chat when done
-                    set_process(false);
-
-                    // CRITICAL: Save conversation when request completes to ensure no data loss
-                    if (current_conversation_index >= 0) {
-                        conversations.write[current_conversation_index].last_modified_timestamp = _get_timestamp();
-                        _queue_delayed_save();
-                    }
-                }
-			}
-		} break;
 		case NOTIFICATION_ENTER_TREE: {
     // Load API key from editor settings
 			if (EditorSettings::get_singleton()->has_setting("ai_chat/api_key")) {
@@ -536,11 +484,8 @@ void AIChatDock::_notification(int p_notification) {
 				if (save_timer) {
 					save_timer->stop();
 				}
-				if (save_thread_busy && save_thread) {
-					save_thread->wait_to_finish();
-					memdelete(save_thread);
-					save_thread = nullptr;
-					save_thread_busy = false;
+				if (save_thread_busy) {
+					_on_background_save_finished();
 				}
 				// Always perform a final synchronous save
 				_save_conversations();
@@ -630,7 +575,8 @@ void AIChatDock::_send_stop_request() {
 	}
 	
 	print_line("AI Chat: Sending stop request to: " + stop_endpoint);
-	stop_http_request->request(stop_endpoint, headers, HTTPClient::METHOD_POST, request_body);
+	HTTPConnectionPool::get_singleton()->cancel(stop_request);
+	stop_request = HTTPConnectionPool::get_singleton()->request(stop_endpoint, HTTPClient::METHOD_POST, headers, request_body, callable_mp(this, &AIChatDock::_on_stop_request_completed));
 }
 
 void AIChatDock::_on_stop_request_completed(int p_result, int p_code, const PackedStringArray &p_headers, const PackedByteArray &p_body) {
@@ -666,15 +612,11 @@ void AIChatDock::_on_edit_message_pressed(int p_message_index) {
     Node *node = chat_container->find_child("message_panel_" + String::num_int64(p_message_index), true, false);
     PanelContainer *old_panel = Object::cast_to<PanelContainer>(node);
     if (!old_panel) {
-        // Fallback to rebuild if we cannot find the targeted panel.
-        for (int i = 0; i < chat_container->get_child_count(); i++) {
-            Node *child = chat_container->get_child(i);
-            child->queue_free();
-        }
-        for (int i = 0; i < chat_history.size(); i++) {
-            if (i == p_message_index) {
-                _create_edit_message_bubble(chat_history[i], i);
-            } else {
+        // Fallback: the tail is rebuilt from the edited message onward.
+        _remove_message_bubbles_from(p_message_index);
+        _create_edit_message_bubble(chat_history[p_message_index], p_message_index);
+        for (int i = p_message_index + 1; i < chat_history.size(); i++) {
+            if (chat_history[i].role != "tool") {
                 _create_message_bubble(chat_history[i], i);
             }
         }
@@ -705,13 +647,15 @@ void AIChatDock::_create_edit_message_bubble(const AIChatDock::ChatMessage &p_me
 	PanelContainer *message_panel = memnew(PanelContainer);
 	
 	// Add spacing before each message for cleaner layout
-	if (chat_container->get_child_count() > 0) {
+	if (_has_message_controls()) {
 		Control *spacer = memnew(Control);
 		spacer->set_custom_minimum_size(Size2(0, 8)); // 8px gap between messages
+		spacer->set_meta("message_index", p_message_index);
 		chat_container->add_child(spacer);
 	}
 	
 	chat_container->add_child(message_panel);
+	message_panel->set_meta("message_index", p_message_index);
 	message_panel->set_visible(true);
 
 	// User message styling (editing mode)
@@ -773,6 +717,7 @@ PanelContainer *AIChatDock::_build_edit_message_panel(const AIChatDock::ChatMess
     if (p_message_index >= 0) {
         message_panel->set_name("message_panel_" + String::num_int64(p_message_index));
     }
+    message_panel->set_meta("message_index", p_message_index);
 
     Ref<StyleBoxFlat> panel_style = memnew(StyleBoxFlat);
     panel_style->set_content_margin_all(12);
@@ -852,6 +797,7 @@ void AIChatDock::_on_edit_message_send_pressed(int p_message_index, const String
 	// Update the message content
 	chat_history.write[p_message_index].content = trimmed_content;
 	chat_history.write[p_message_index].timestamp = _get_timestamp();
+	_mark_messages_changed(p_message_index);
 	
 	// Truncate conversation at this point (remove everything after this message)
 	chat_history.resize(p_message_index + 1);
@@ -861,12 +807,13 @@ void AIChatDock::_on_edit_message_send_pressed(int p_message_index, const String
 		conversations.write[current_conversation_index].last_modified_timestamp = _get_timestamp();
 	}
 	
-	// Rebuild UI with the updated conversation
-	for (int i = 0; i < chat_container->get_child_count(); i++) {
-		Node *child = chat_container->get_child(i);
-		child->queue_free();
+	// Only the edited message and what followed it changed; patch the tail
+	// instead of rebuilding the whole transcript.
+	_remove_message_bubbles_from(p_message_index);
+	_create_message_bubble(chat_history[p_message_index], p_message_index);
+	if (transcript_height_cache.size() > chat_history.size()) {
+		transcript_height_cache.resize(chat_history.size());
 	}
-	_rebuild_conversation_ui(chat_history);
 	
 	// Reset the assistant message label so streaming can create a new one
 	current_assistant_message_label = nullptr;
@@ -907,16 +854,35 @@ void AIChatDock::_on_edit_field_gui_input(const Ref<InputEvent> &p_event, Button
 void AIChatDock::_on_edit_message_cancel_pressed(int p_message_index) {
 	print_line("AI Chat: Cancelled editing message at index " + String::num(p_message_index));
 	
-	// Simply rebuild the UI without changes
 	Vector<AIChatDock::ChatMessage> &chat_history = _get_current_chat_history();
+	if (p_message_index < 0 || p_message_index >= chat_history.size() || !chat_container) {
+		return;
+	}
 	
-	for (int i = 0; i < chat_container->get_child_count(); i++) {
-		Node *child = chat_container->get_child(i);
-		child->queue_free();
+	// Swap the edit panel back for a regular bubble in place.
+	PanelContainer *edit_panel = Object::cast_to<PanelContainer>(chat_container->find_child("message_panel_" + String::num_int64(p_message_index), false, false));
+	if (!edit_panel) {
+		_rebuild_conversation_ui(chat_history);
+		return;
 	}
-	_rebuild_conversation_ui(chat_history);
+	const int panel_index = edit_panel->get_index();
+	const int child_count = chat_container->get_child_count();
+	chat_container->remove_child(edit_panel);
+	edit_panel->queue_free();
 	
-	call_deferred("_scroll_to_bottom");
+	RichTextLabel *saved_label = current_assistant_message_label;
+	_create_message_bubble(chat_history[p_message_index], p_message_index);
+	current_assistant_message_label = saved_label;
+	
+	// _create_message_bubble appended a gap spacer and the panel; keep the
+	// existing gap and move the panel into the old slot.
+	Node *new_panel = chat_container->get_child(chat_container->get_child_count() - 1);
+	if (chat_container->get_child_count() > child_count) {
+		Node *new_gap = chat_container->get_child(chat_container->get_child_count() - 2);
+		chat_container->remove_child(new_gap);
+		new_gap->queue_free();
+	}
+	chat_container->move_child(new_panel, panel_index);
 }
 
 // Embedding system code moved to ai_chat_dock_embeddings.cpp
@@ -942,16 +908,6 @@ void AIChatDock::_setup_authentication_ui() {
 	login_button->add_theme_icon_override("icon", get_theme_icon(SNAME("Key"), SNAME("EditorIcons")));
 	login_button->connect("pressed", callable_mp(this, &AIChatDock::_on_login_button_pressed));
 	auth_container->add_child(login_button);
-	
-	// Create HTTP request for authentication
-	auth_request = memnew(HTTPRequest);
-	add_child(auth_request);
-	auth_request->connect("request_completed", callable_mp(this, &AIChatDock::_on_auth_request_completed));
-
-	// Create HTTP request for providers discovery
-	auth_providers_request = memnew(HTTPRequest);
-	add_child(auth_providers_request);
-	auth_providers_request->connect("request_completed", callable_mp(this, &AIChatDock::_on_auth_providers_request_completed));
 }
 
 void AIChatDock::_on_login_button_pressed() {
@@ -964,8 +920,11 @@ void AIChatDock::_on_login_button_pressed() {
     // Show a menu of providers, anchored to the login button
     // Fetch provider availability from backend to hide unavailable options
     String providers_url = api_endpoint.replace("/chat", "/auth/providers");
-    Error perr = auth_providers_request->request(providers_url);
-    if (perr != OK) {
+    HTTPConnectionPool *pool = HTTPConnectionPool::get_singleton();
+    if (!pool->is_request_pending(auth_providers_request)) {
+        auth_providers_request = pool->request(providers_url, HTTPClient::METHOD_GET, Vector<String>(), String(), callable_mp(this, &AIChatDock::_on_auth_providers_request_completed));
+    }
+    if (auth_providers_request == HTTPConnectionPool::INVALID_REQUEST_ID) {
         print_line("AI Chat: Failed to fetch providers; defaulting to all options");
     }
     PopupMenu *providers = memnew(PopupMenu);
@@ -1056,9 +1015,14 @@ void AIChatDock::_check_authentication_status() {
     }
 	String json_data = JSON::stringify(data);
 	
-	Error err = auth_request->request(auth_check_url, headers, HTTPClient::METHOD_POST, json_data);
-	if (err != OK) {
-		print_line("AI Chat: Failed to check authentication status: " + String::num_int64(err));
+	HTTPConnectionPool *pool = HTTPConnectionPool::get_singleton();
+	if (pool->is_request_pending(auth_request)) {
+		// The previous check is still in flight.
+		return;
+	}
+	auth_request = pool->request(auth_check_url, HTTPClient::METHOD_POST, headers, json_data, callable_mp(this, &AIChatDock::_on_auth_request_completed));
+	if (auth_request == HTTPConnectionPool::INVALID_REQUEST_ID) {
+		print_line("AI Chat: Failed to check authentication status: " + auth_check_url);
 	}
 }
 
@@ -1113,6 +1077,7 @@ void AIChatDock::_on_auth_request_completed(int p_result, int p_code, const Pack
 		current_user_id = "";
 		current_user_name = "";
 		auth_token = "";
+		_abort_embedding_sync();
 		
 		// Remove invalid credentials from settings
 		if (EditorSettings::get_singleton()->has_setting("ai_chat/auth_token")) {
@@ -1145,9 +1110,12 @@ void AIChatDock::_logout_user() {
 	current_user_name = "";
 	auth_token = "";
 	
-	// Reset embedding system state
+	// Reset embedding system state; the manifest is per user
+	_abort_embedding_sync();
 	embedding_system_initialized = false;
 	initial_indexing_done = false;
+	embedding_manifest.clear();
+	embedding_manifest_loaded = false;
 	
 	// Remove from settings
 	EditorSettings::get_singleton()->erase("ai_chat/auth_token");
@@ -1260,8 +1228,12 @@ void AIChatDock::_ensure_project_indexing() {
 		_initialize_embedding_system();
 	} else {
 		print_line("AI Chat: 📝 Embedding system already initialized, forcing indexing...");
-		// Reset the flag to ensure fresh indexing
+		// Reset the flag and the manifest to force a fresh full upload
 		initial_indexing_done = false;
+		embedding_manifest.clear();
+		embedding_manifest_loaded = true;
+		embedding_manifest_dirty = true;
+		pending_fs_changes = true;
 		// Start indexing immediately
 		call_deferred("_perform_initial_indexing");
 	}
@@ -1284,154 +1256,205 @@ void AIChatDock::_process_send_request_async() {
 	_send_chat_request();
 }
 
-void AIChatDock::_save_conversations_async() {
-	// Start the async save to prevent UI blocking during file operations
-	call_deferred("_save_conversations_chunked", 0);
-}
-
-void AIChatDock::_save_conversations_to_disk(const String &p_json_data) {
-	// This runs in the next frame, preventing blocking of current frame
-    Error err;
-    // Safe write via temp + rename to avoid corruption
-    String final_path = conversations_file_path;
-    String base_dir = final_path.get_base_dir();
-    String final_name = final_path.get_file();
-    String temp_name = final_name + ".tmp";
-    String temp_path = base_dir.path_join(temp_name);
+// Conversation persistence. Saves only append what changed since the last
+// save to the conversation's journal (see AIConversationStore); the write
+// itself runs on a background thread.
+struct AIChatDock::ConversationSaveJob {
+	struct Splice {
+		String id;
+		int at = 0;
+		Array messages;
+	};
 
-    // Ensure destination directory exists
-    {
-        Ref<DirAccess> da_mk = DirAccess::create_for_path(base_dir);
-        if (da_mk.is_valid() && !da_mk->dir_exists(base_dir)) {
-            da_mk->make_dir_recursive(base_dir);
-        }
-    }
-    // Write to temp
-    {
-        Ref<FileAccess> tmp = FileAccess::open(temp_path, FileAccess::WRITE, &err);
-        if (err != OK) {
-            print_line("AI Chat: Failed to open temp file for save: " + String::num_int64(err));
-            return;
-        }
-        tmp->store_string(p_json_data);
-        tmp->close();
-    }
+	AIConversationStore *store = nullptr;
+	AIChatDock *instance = nullptr;
+	Array index;
+	Vector<Splice> splices;
+	Vector<String> failed_ids;
+	bool index_failed = false;
+
+	void write() {
+		for (const Splice &splice : splices) {
+			if (store->append(splice.id, splice.at, splice.messages) != OK) {
+				failed_ids.push_back(splice.id);
+			}
+		}
+		index_failed = store->save_index(index) != OK;
+	}
+};
 
-    // Rename temp to final
-    Ref<DirAccess> da = DirAccess::open(base_dir);
-    if (da.is_valid()) {
-        if (da->file_exists(final_name)) {
-            da->remove(final_name);
-        }
-        da->rename(temp_name, final_name);
-    } else {
-        // Fallback: write directly if Directory open failed
-        Ref<FileAccess> file = FileAccess::open(final_path, FileAccess::WRITE, &err);
-        if (err != OK) {
-            print_line("AI Chat: Failed to save conversations file: " + String::num_int64(err));
-            return;
-        }
-        file->store_string(p_json_data);
-        file->close();
-    }
-	// print_line("AI Chat: Conversations saved successfully");
+Dictionary AIChatDock::_message_to_dict(const ChatMessage &p_message) {
+	Dictionary msg_dict;
+	msg_dict["role"] = p_message.role;
+	msg_dict["content"] = p_message.content;
+	msg_dict["timestamp"] = p_message.timestamp;
+	// Deep copies, as the save job reads them on another thread.
+	msg_dict["tool_calls"] = p_message.tool_calls.duplicate(true);
+	msg_dict["tool_call_id"] = p_message.tool_call_id;
+	msg_dict["name"] = p_message.name;
+	msg_dict["tool_results"] = p_message.tool_results.duplicate(true);
+
+	Array attached_files_array;
+	for (const AttachedFile &file : p_message.attached_files) {
+		Dictionary file_dict;
+		file_dict["path"] = file.path;
+		file_dict["name"] = file.name;
+		file_dict["content"] = file.content;
+		file_dict["is_image"] = file.is_image;
+		file_dict["mime_type"] = file.mime_type;
+		file_dict["base64_data"] = file.base64_data;
+		Array original_size;
+		original_size.push_back(file.original_size.x);
+		original_size.push_back(file.original_size.y);
+		file_dict["original_size"] = original_size;
+		Array display_size;
+		display_size.push_back(file.display_size.x);
+		display_size.push_back(file.display_size.y);
+		file_dict["display_size"] = display_size;
+		file_dict["was_downsampled"] = file.was_downsampled;
+		file_dict["is_node"] = file.is_node;
+		file_dict["node_path"] = file.node_path;
+		file_dict["node_type"] = file.node_type;
+		attached_files_array.push_back(file_dict);
+	}
+	msg_dict["attached_files"] = attached_files_array;
+	return msg_dict;
+}
+
+AIChatDock::ChatMessage AIChatDock::_dict_to_message(const Dictionary &p_dict) {
+	ChatMessage msg;
+	msg.role = p_dict.get("role", "");
+	msg.content = p_dict.get("content", "");
+	msg.timestamp = p_dict.get("timestamp", "");
+	msg.tool_calls = p_dict.get("tool_calls", Array());
+	msg.tool_call_id = p_dict.get("tool_call_id", "");
+	msg.name = p_dict.get("name", "");
+	msg.tool_results = p_dict.get("tool_results", Array());
+
+	Array attached_files_array = p_dict.get("attached_files", Array());
+	for (int i = 0; i < attached_files_array.size(); i++) {
+		Dictionary file_dict = attached_files_array[i];
+		AttachedFile file;
+		file.path = file_dict.get("path", "");
+		file.name = file_dict.get("name", "");
+		file.content = file_dict.get("content", "");
+		file.is_image = file_dict.get("is_image", false);
+		file.mime_type = file_dict.get("mime_type", "");
+		file.base64_data = file_dict.get("base64_data", "");
+		// Support v2 array sizes and v1 x/y sizes.
+		if (file_dict.has("original_size")) {
+			Array os = file_dict.get("original_size", Array());
+			if (os.size() >= 2) {
+				file.original_size.x = int(os[0]);
+				file.original_size.y = int(os[1]);
+			}
+		} else {
+			file.original_size.x = file_dict.get("original_size_x", 0);
+			file.original_size.y = file_dict.get("original_size_y", 0);
+		}
+		if (file_dict.has("display_size")) {
+			Array ds = file_dict.get("display_size", Array());
+			if (ds.size() >= 2) {
+				file.display_size.x = int(ds[0]);
+				file.display_size.y = int(ds[1]);
+			}
+		} else {
+			file.display_size.x = file_dict.get("display_size_x", 0);
+			file.display_size.y = file_dict.get("display_size_y", 0);
+		}
+		file.was_downsampled = file_dict.get("was_downsampled", false);
+		file.is_node = file_dict.get("is_node", false);
+		file.node_path = file_dict.get("node_path", NodePath());
+		file.node_type = file_dict.get("node_type", "");
+		msg.attached_files.push_back(file);
+	}
+	return msg;
+}
+
+uint32_t AIChatDock::_get_message_fingerprint(const ChatMessage &p_message) {
+	// Covers everything that is persisted, so edits made in place to the last
+	// message (streaming, tool results filled in or replaced) are saved.
+	uint32_t h = hash_murmur3_one_32(p_message.content.hash());
+	h = hash_murmur3_one_32(p_message.content.length(), h);
+	h = hash_murmur3_one_32(p_message.role.hash(), h);
+	h = hash_murmur3_one_32(p_message.timestamp.hash(), h);
+	h = hash_murmur3_one_32(p_message.tool_calls.hash(), h);
+	h = hash_murmur3_one_32(p_message.tool_call_id.hash(), h);
+	h = hash_murmur3_one_32(p_message.name.hash(), h);
+	h = hash_murmur3_one_32(p_message.tool_results.hash(), h);
+	for (const AttachedFile &file : p_message.attached_files) {
+		h = hash_murmur3_one_32(file.path.hash(), h);
+		h = hash_murmur3_one_32(file.content.hash(), h);
+		h = hash_murmur3_one_32(file.base64_data.hash(), h);
+		h = hash_murmur3_one_32(file.node_path.hash(), h);
+	}
+	return hash_fmix32(h);
+}
+
+void AIChatDock::_mark_messages_changed(int p_from_index) {
+	if (current_conversation_index < 0 || current_conversation_index >= conversations.size()) {
+		return;
+	}
+	Conversation &conv = conversations.write[current_conversation_index];
+	conv.saved_count = MIN(conv.saved_count, MAX(p_from_index, 0));
 }
 
-void AIChatDock::_save_conversations_chunked(int p_start_index) {
-	// Process conversations in chunks of 5 to avoid blocking UI
-	const int CHUNK_SIZE = 5;
-	int end_index = MIN(p_start_index + CHUNK_SIZE, conversations.size());
-	
-	// If this is the first chunk, initialize the array
-	if (p_start_index == 0) {
-		_chunked_conversations_array.clear();
-	}
-	
-    // Process this chunk
-	for (int i = p_start_index; i < end_index; i++) {
-		const AIChatDock::Conversation &conv = conversations[i];
-		Dictionary conv_dict;
-		conv_dict["id"] = conv.id;
-		conv_dict["title"] = conv.title;
-		conv_dict["created_timestamp"] = conv.created_timestamp;
-		conv_dict["last_modified_timestamp"] = conv.last_modified_timestamp;
-		
-		Array messages_array;
-        for (int j = 0; j < conv.messages.size(); j++) {
-            const ChatMessage &msg = conv.messages[j];
-            Dictionary msg_dict;
-            msg_dict["role"] = msg.role;
-            msg_dict["content"] = msg.content;
-            msg_dict["timestamp"] = msg.timestamp;
-            msg_dict["tool_calls"] = msg.tool_calls;
-            msg_dict["tool_call_id"] = msg.tool_call_id;
-            msg_dict["name"] = msg.name;
-            msg_dict["tool_results"] = msg.tool_results;
-
-            // Attached files
-            Array attached_files_array;
-            for (int k = 0; k < msg.attached_files.size(); k++) {
-                const AttachedFile &file = msg.attached_files[k];
-                Dictionary file_dict;
-                file_dict["path"] = file.path;
-                file_dict["name"] = file.name;
-                file_dict["content"] = file.content;
-                file_dict["is_image"] = file.is_image;
-                file_dict["mime_type"] = file.mime_type;
-                file_dict["base64_data"] = file.base64_data;
-                // v2 array sizes
-                Array os;
-                os.push_back(file.original_size.x);
-                os.push_back(file.original_size.y);
-                file_dict["original_size"] = os;
-                Array ds;
-                ds.push_back(file.display_size.x);
-                ds.push_back(file.display_size.y);
-                file_dict["display_size"] = ds;
-                // v1 compatibility
-                file_dict["original_size_x"] = file.original_size.x;
-                file_dict["original_size_y"] = file.original_size.y;
-                file_dict["display_size_x"] = file.display_size.x;
-                file_dict["display_size_y"] = file.display_size.y;
-                file_dict["was_downsampled"] = file.was_downsampled;
-                file_dict["is_node"] = file.is_node;
-                file_dict["node_path"] = file.node_path;
-                file_dict["node_type"] = file.node_type;
-                attached_files_array.push_back(file_dict);
-            }
-            msg_dict["attached_files"] = attached_files_array;
+AIChatDock::ConversationSaveJob *AIChatDock::_build_save_job() {
+	ConversationSaveJob *job = memnew(ConversationSaveJob);
+	job->store = &conversation_store;
+	job->instance = this;
 
-            messages_array.push_back(msg_dict);
-        }
-		conv_dict["messages"] = messages_array;
-		_chunked_conversations_array.push_back(conv_dict);
-	}
-	
-	print_line("AI Chat: Processed conversation save chunk " + String::num_int64(p_start_index) + "-" + String::num_int64(end_index-1) + " of " + String::num_int64(conversations.size()));
-	
-	// If more chunks to process, defer the next chunk
-	if (end_index < conversations.size()) {
-		call_deferred("_save_conversations_chunked", end_index);
-		return;
+	for (int i = 0; i < conversations.size(); i++) {
+		Conversation &conv = conversations.write[i];
+		if (conv.loaded) {
+			const int size = conv.messages.size();
+			const uint32_t tail_hash = size > 0 ? _get_message_fingerprint(conv.messages[size - 1]) : 0;
+			int from = MIN(conv.saved_count, size);
+			if (from == size && size > 0 && tail_hash != conv.saved_tail_hash) {
+				from = size - 1; // The last message changed in place (streaming, tool results).
+			}
+			if (from < size || conv.saved_count > size) {
+				ConversationSaveJob::Splice splice;
+				splice.id = conv.id;
+				splice.at = from;
+				for (int j = from; j < size; j++) {
+					splice.messages.push_back(_message_to_dict(conv.messages[j]));
+				}
+				job->splices.push_back(splice);
+			}
+			// Assume success; _finish_save_job() rolls back failed conversations.
+			conv.saved_count = size;
+			conv.saved_tail_hash = tail_hash;
+			conv.stored_message_count = size;
+		}
+
+		Dictionary entry;
+		entry["id"] = conv.id;
+		entry["title"] = conv.title;
+		entry["created_timestamp"] = conv.created_timestamp;
+		entry["last_modified_timestamp"] = conv.last_modified_timestamp;
+		entry["message_count"] = conv.stored_message_count;
+		job->index.push_back(entry);
 	}
-	
-	// All chunks processed, now finalize the save
-	call_deferred("_finalize_conversations_save");
+	return job;
 }
 
-void AIChatDock::_finalize_conversations_save() {
-    Dictionary data;
-    data["version"] = 2;
-	data["conversations"] = _chunked_conversations_array;
-	
-	Ref<JSON> json;
-	json.instantiate();
-	String json_string = json->stringify(data, "  ");
-	
-	_save_conversations_to_disk(json_string);
-	
-	// Clear the chunked array to free memory
-	_chunked_conversations_array.clear();
+void AIChatDock::_finish_save_job(ConversationSaveJob *p_job) {
+	for (const String &id : p_job->failed_ids) {
+		print_line("AI Chat: Failed to save conversation " + id + ", will rewrite it");
+		for (int i = 0; i < conversations.size(); i++) {
+			if (conversations[i].id == id) {
+				// Rewrite the whole conversation; its journal state is unknown.
+				conversations.write[i].saved_count = 0;
+				break;
+			}
+		}
+	}
+	const bool retry = p_job->index_failed || !p_job->failed_ids.is_empty();
+	memdelete(p_job);
+	if (retry) {
+		_queue_delayed_save();
+	}
 }
 
 void AIChatDock::_queue_delayed_save() {
@@ -1465,154 +1488,16 @@ void AIChatDock::_execute_delayed_save() {
 	save_pending = false;
 	save_thread_busy = true;
 	
-	// Create a data structure to pass both the snapshot and the instance
-	struct SaveData {
-		Vector<Conversation> *snapshot;
-		AIChatDock *instance;
-		String file_path;
-	};
-	
-	SaveData *save_data = memnew(SaveData);
-	save_data->snapshot = memnew(Vector<Conversation>(conversations));
-	save_data->instance = this;
-	save_data->file_path = conversations_file_path;
-	
+	// Serializing only the changed messages is cheap enough for the main thread.
+	save_job = _build_save_job();
 	save_thread = memnew(Thread);
-	save_thread->start(_background_save, save_data);
-	
-	print_line("AI Chat: Started background conversation save");
+	save_thread->start(_background_save, save_job);
 }
 
-void AIChatDock::_background_save(void *p_data_ptr) {
-	struct SaveData {
-		Vector<Conversation> *snapshot;
-		AIChatDock *instance;
-		String file_path;
-	};
-	
-	SaveData *save_data = reinterpret_cast<SaveData*>(p_data_ptr);
-	Vector<Conversation> &snapshot = *save_data->snapshot;
-	
-    // Build the data structure (heavy JSON stringify)
-    Dictionary data;
-    data["version"] = 2; // schema version for future migrations
-	Array conv_array;
-	
-	for (const Conversation &conv : snapshot) {
-		Dictionary conv_dict;
-		conv_dict["id"] = conv.id;
-		conv_dict["title"] = conv.title;
-		conv_dict["created_timestamp"] = conv.created_timestamp;
-		conv_dict["last_modified_timestamp"] = conv.last_modified_timestamp;
-		
-		Array messages_array;
-		for (const ChatMessage &msg : conv.messages) {
-			Dictionary msg_dict;
-			msg_dict["role"] = msg.role;
-			msg_dict["content"] = msg.content;
-			msg_dict["timestamp"] = msg.timestamp;
-			msg_dict["tool_calls"] = msg.tool_calls;
-			msg_dict["tool_call_id"] = msg.tool_call_id;
-			msg_dict["name"] = msg.name;
-            msg_dict["tool_results"] = msg.tool_results;
-			
-            // Handle attached files
-			Array files_array;
-			for (const AttachedFile &file : msg.attached_files) {
-				Dictionary file_dict;
-				file_dict["path"] = file.path;
-				file_dict["name"] = file.name;
-				file_dict["content"] = file.content;
-				file_dict["is_image"] = file.is_image;
-				file_dict["mime_type"] = file.mime_type;
-				file_dict["base64_data"] = file.base64_data;
-                // Use array-based sizes for v2, loader supports both v1 (x/y) and v2 (arrays)
-                Array original_size_array;
-                original_size_array.push_back(file.original_size.x);
-                original_size_array.push_back(file.original_size.y);
-                file_dict["original_size"] = original_size_array;
-                Array display_size_array;
-                display_size_array.push_back(file.display_size.x);
-                display_size_array.push_back(file.display_size.y);
-                file_dict["display_size"] = display_size_array;
-                // Also include x/y keys for backward compatibility with older loaders
-                file_dict["original_size_x"] = file.original_size.x;
-                file_dict["original_size_y"] = file.original_size.y;
-                file_dict["display_size_x"] = file.display_size.x;
-                file_dict["display_size_y"] = file.display_size.y;
-				file_dict["was_downsampled"] = file.was_downsampled;
-				file_dict["is_node"] = file.is_node;
-				file_dict["node_path"] = file.node_path;
-				file_dict["node_type"] = file.node_type;
-				files_array.push_back(file_dict);
-			}
-			msg_dict["attached_files"] = files_array;
-			
-			messages_array.push_back(msg_dict);
-		}
-		conv_dict["messages"] = messages_array;
-		conv_array.push_back(conv_dict);
-	}
-	data["conversations"] = conv_array;
-	
-	// JSON stringify (heavy operation)
-	Ref<JSON> json;
-	json.instantiate();
-	String json_string = json->stringify(data, "  ");
-	
-    // File I/O (heavy operation) with safe write via temp + rename
-    Error err;
-    String final_path = save_data->file_path;
-    String base_dir = final_path.get_base_dir();
-    String final_name = final_path.get_file();
-    String temp_name = final_name + ".tmp";
-    String temp_path = base_dir.path_join(temp_name);
-
-    // Ensure destination directory exists
-    {
-        Ref<DirAccess> da_mk = DirAccess::create_for_path(base_dir);
-        if (da_mk.is_valid() && !da_mk->dir_exists(base_dir)) {
-            da_mk->make_dir_recursive(base_dir);
-        }
-    }
-    // Write to temp
-    {
-        Ref<FileAccess> tmp = FileAccess::open(temp_path, FileAccess::WRITE, &err);
-        if (err == OK) {
-            tmp->store_string(json_string);
-            tmp->close();
-        }
-    }
-    if (err == OK) {
-        // Rename temp to final (best-effort atomic within same dir)
-        Ref<DirAccess> da = DirAccess::open(base_dir);
-        if (da.is_valid()) {
-            // Remove existing file if present (rename should overwrite but be safe cross-platform)
-            if (da->file_exists(final_name)) {
-                da->remove(final_name);
-            }
-            da->rename(temp_name, final_name);
-        } else {
-            // Fallback: write directly if Directory open failed
-            Ref<FileAccess> file = FileAccess::open(final_path, FileAccess::WRITE, &err);
-            if (err == OK) {
-                file->store_string(json_string);
-                file->close();
-            }
-        }
-    }
-	
-	// Signal back to main thread
-	AIChatDock *instance = save_data->instance;
-	
-	// Clean up
-	memdelete(save_data->snapshot);
-	memdelete(save_data);
-	
-	// Signal completion to main thread
-	if (instance) {
-		instance->call_deferred("_on_background_save_finished");
-	}
+void AIChatDock::_background_save(void *p_userdata) {
+	ConversationSaveJob *job = static_cast<ConversationSaveJob *>(p_userdata);
+	job->write();
+	callable_mp(job->instance, &AIChatDock::_on_background_save_finished).call_deferred();
 }
 
 void AIChatDock::_on_background_save_finished() {
@@ -1622,7 +1507,11 @@ void AIChatDock::_on_background_save_finished() {
 		save_thread = nullptr;
 	}
 	save_thread_busy = false;
-	print_line("AI Chat: Background save finished");
+	if (save_job) {
+		ConversationSaveJob *job = save_job;
+		save_job = nullptr;
+		_finish_save_job(job);
+	}
     // If changes accumulated during the background save, schedule another save soon
     if (save_pending && save_timer) {
         save_timer->stop();
@@ -1631,10 +1520,13 @@ void AIChatDock::_on_background_save_finished() {
 }
 
 void AIChatDock::_process_image_attachment_async(const String &p_file_path, const String &p_name, const String &p_mime_type) {
-	// This runs in the next frame to prevent UI blocking during image processing
-	Ref<Image> image = Image::load_from_file(p_file_path);
-	if (image.is_null() || image->is_empty()) {
-		print_line("AI Chat: Failed to load image: " + p_file_path);
+	// Decoding, resizing and base64 encoding run on a worker thread.
+	AIImagePipeline::prepare_attachment(p_file_path, p_mime_type, MAX_ATTACHMENT_IMAGE_DIMENSION, callable_mp(this, &AIChatDock::_on_image_attachment_prepared).bind(p_file_path, p_name, p_mime_type));
+}
+
+void AIChatDock::_on_image_attachment_prepared(const Dictionary &p_result, const String &p_file_path, const String &p_name, const String &p_mime_type) {
+	if (!bool(p_result.get("success", false))) {
+		print_line("AI Chat: " + String(p_result.get("message", "Failed to process image: " + p_file_path)));
 		return;
 	}
 
@@ -1646,44 +1538,18 @@ void AIChatDock::_process_image_attachment_async(const String &p_file_path, cons
 	attached_file.name = "img_" + String::num_int64(OS::get_singleton()->get_ticks_msec()) + "_" + clean_name;
 	attached_file.is_image = true;
 	attached_file.mime_type = p_mime_type;
+	attached_file.original_size = p_result["original_size"];
+	attached_file.display_size = p_result["display_size"];
+	attached_file.was_downsampled = p_result["was_downsampled"];
+	attached_file.base64_data = p_result["base64_data"];
 
-	Vector2i original_size = Vector2i(image->get_width(), image->get_height());
-	attached_file.original_size = original_size;
-	
-	// Check if image needs to be downsampled (max 1024px on any side)
-	const int MAX_DIMENSION = 1024;
-	Vector2i target_size = _calculate_downsampled_size(original_size, MAX_DIMENSION);
-	
-	if (target_size != original_size) {
-		attached_file.was_downsampled = true;
-		image->resize(target_size.x, target_size.y, Image::INTERPOLATE_LANCZOS);
-		
-		// Show warning dialog - defer this to ensure UI is responsive
-		call_deferred("_show_image_warning_dialog", attached_file.name, original_size, target_size);
-	}
-	
-	attached_file.display_size = target_size;
-	
-	// Convert to base64 for API transmission
-	Vector<uint8_t> buffer;
-	if (attached_file.mime_type == "image/jpeg" || attached_file.mime_type == "image/jpg") {
-		buffer = image->save_jpg_to_buffer(0.85f); // Good quality JPEG
-	} else {
-		buffer = image->save_png_to_buffer();
-	}
-	
-	if (buffer.size() == 0) {
-		print_line("AI Chat: Failed to encode image: " + p_file_path);
-		return;
+	if (attached_file.was_downsampled) {
+		_show_image_warning_dialog(attached_file.name, attached_file.original_size, attached_file.display_size);
 	}
-	
-	// Encode to base64
-	attached_file.base64_data = CoreBind::Marshalls::get_singleton()->raw_to_base64(buffer);
-	
-	// Add to attached files and update display
+
 	current_attached_files.push_back(attached_file);
 	_update_attached_files_display();
-	
+
 	print_line("AI Chat: Successfully processed image: " + p_name + " -> ID: " + attached_file.name);
 }
 
@@ -2188,23 +2054,13 @@ void AIChatDock::_attach_external_files(const Vector<String> &p_files) {
 		if (!already_attached) {
 			AIChatDock::AttachedFile attached_file;
 			attached_file.path = file_path;
-			if (_is_image_file(file_path)) {
-				// Create unique image ID for images
-				String clean_name = file_path.get_file().get_basename().to_lower().replace(" ", "_");
-				attached_file.name = "img_" + String::num_int64(OS::get_singleton()->get_ticks_msec()) + "_" + clean_name;
-			} else {
-				attached_file.name = file_path.get_file();
-			}
+			attached_file.name = file_path.get_file();
 			attached_file.is_image = _is_image_file(file_path);
 			attached_file.mime_type = _get_mime_type_from_extension(file_path);
 			
 			if (attached_file.is_image) {
-				// Process image (resize if needed, convert to base64)
-				if (_process_image_attachment(attached_file)) {
-					current_attached_files.push_back(attached_file);
-				} else {
-					print_line("AI Chat: Failed to process external image: " + file_path);
-				}
+				// Resized and encoded off the main thread; attached (with a unique image ID) once ready.
+				_process_image_attachment_async(file_path, attached_file.name, attached_file.mime_type);
 			} else {
 				// Read text file content with safety limits to avoid blowing context
 				Error err = OK;
@@ -2359,12 +2215,12 @@ String AIChatDock::_get_file_type_icon(const AttachedFile &p_file) {
 }
 
 void AIChatDock::_handle_response_chunk(const PackedByteArray &p_chunk) {
-	response_buffer += String::utf8((const char *)p_chunk.ptr(), p_chunk.size());
+	// Lines are split on raw bytes and decoded only once complete, so UTF-8
+	// sequences split across chunks survive and nothing is recopied per line.
+	response_decoder.append(p_chunk.ptr(), p_chunk.size());
 
-	int newline_pos;
-	while ((newline_pos = response_buffer.find("\n")) != -1) {
-		String line = response_buffer.substr(0, newline_pos);
-		response_buffer = response_buffer.substr(newline_pos + 1);
+	String line;
+	while (response_decoder.next_line(line)) {
 		if (line.strip_edges().is_empty()) {
 			continue;
 		}
@@ -2372,16 +2228,79 @@ void AIChatDock::_handle_response_chunk(const PackedByteArray &p_chunk) {
 	}
 }
 
+void AIChatDock::_on_chat_stream_chunk(const PackedByteArray &p_chunk, uint64_t p_stream) {
+	if (p_stream != chat_stream) {
+		return;
+	}
+	_handle_response_chunk(p_chunk);
+}
+
+void AIChatDock::_on_chat_request_completed(int p_result, int p_code, const PackedStringArray &p_headers, const PackedByteArray &p_body, uint64_t p_stream) {
+	if (p_stream != chat_stream) {
+		return;
+	}
+	chat_request = HTTPConnectionPool::INVALID_REQUEST_ID;
+
+	// The last line may not be newline-terminated
+	String tail;
+	if (response_decoder.flush(tail) && !tail.strip_edges().is_empty()) {
+		_process_ndjson_line(tail);
+	}
+	{
+		const Vector<ChatMessage> &history = _get_current_chat_history();
+		const ChatMessage *last = history.is_empty() ? nullptr : &history[history.size() - 1];
+		_markdown_stream_finish(last && last->role == "assistant" ? last : nullptr);
+	}
+	if (stream_completed_successfully) {
+		print_line("AI Chat: Stream completed successfully");
+	} else {
+		print_line("AI Chat: HTTP request failed with result: " + String::num_int64(p_result) + ", code: " + String::num_int64(p_code));
+		_add_message_to_chat("system", "Connection lost or failed (Result: " + String::num_int64(p_result) + ") - Try again please.");
+	}
+
+	// If we still have async tool tasks running (e.g., apply_edit), keep the UI in 'waiting' state
+	bool has_async_work = pending_tool_tasks > 0;
+	is_waiting_for_response = has_async_work ? true : false;
+	// Clean up stop mechanism state
+	stop_requested = false;
+	current_request_id = "";
+	_update_ui_state();
+	current_assistant_message_label = nullptr;
+
+	// CRITICAL: Save conversation when request completes to ensure no data loss
+	if (current_conversation_index >= 0) {
+		conversations.write[current_conversation_index].last_modified_timestamp = _get_timestamp();
+		_queue_delayed_save();
+	}
+}
+
+void AIChatDock::_cancel_backend_requests() {
+	HTTPConnectionPool *pool = HTTPConnectionPool::get_singleton();
+	if (!pool) {
+		return;
+	}
+	pool->cancel(chat_request);
+	pool->cancel(stop_request);
+	pool->cancel(auth_request);
+	pool->cancel(auth_providers_request);
+	pool->cancel(embedding_request);
+	chat_request = HTTPConnectionPool::INVALID_REQUEST_ID;
+	chat_stream++;
+}
+
 void AIChatDock::_process_ndjson_line(const String &p_line) {
-	Ref<JSON> json;
-	json.instantiate();
-	Error err = json->parse(p_line);
+	if (ndjson_parser.is_null()) {
+		ndjson_parser.instantiate();
+	}
+	Error err = ndjson_parser->parse(p_line);
 	if (err != OK) {
-		_add_message_to_chat("system", "Error parsing streaming response: " + p_line);
+		_add_message_to_chat("system", "Error parsing streaming response: " + p_line.left(500));
 		return;
 	}
 
-	Dictionary data = json->get_data();
+	Dictionary data = ndjson_parser->get_data();
+	// Drop the parser's reference to the (possibly large) parsed value.
+	ndjson_parser->set_data(Variant());
 
 	if (data.has("error")) {
 		_add_message_to_chat("system", "Backend error: " + String(data["error"]));
@@ -2408,13 +2327,10 @@ void AIChatDock::_process_ndjson_line(const String &p_line) {
         }
         _update_ui_state();
         
-        // Ensure the HTTP connection is closed so the poll loop exits promptly.
-        if (http_client.is_valid()) {
-            http_client->close();
-        }
-        http_status = STATUS_DONE;
+        // Ignore the rest of this stream; the connection drains back into the pool.
+        chat_request = HTTPConnectionPool::INVALID_REQUEST_ID;
+        chat_stream++;
         current_assistant_message_label = nullptr;
-        set_process(false);
         return;
     }
 
@@ -2581,14 +2497,8 @@ void AIChatDock::_process_ndjson_line(const String &p_line) {
 					conversations.write[current_conversation_index].last_modified_timestamp = _get_timestamp();
 				}
 				
-				// Safety check: ensure content is valid before processing
-				if (!last_msg.content.is_empty()) {
-					String bbcode_content = _markdown_to_bbcode(last_msg.content);
-					// Additional safety check for the converted content
-					if (!bbcode_content.is_empty()) {
-						label->set_text(bbcode_content);
-					}
-				}
+				// Only the newly completed lines are converted and appended.
+				_markdown_stream_update(label, last_msg.content);
 				
 				// Note: We don't save during streaming to avoid performance issues
 				// Saving happens when the message is complete or stopped
@@ -2627,6 +2537,7 @@ void AIChatDock::_process_ndjson_line(const String &p_line) {
 			ChatMessage &last_msg = chat_history.write[chat_history.size() - 1];
 			if (last_msg.role == "assistant") {
 				// Update the content in history and then render from history.
+				const bool matches_stream = last_msg.content == final_content;
 				last_msg.content = final_content;
 				
 				// Update conversation timestamp for final content
@@ -2634,10 +2545,17 @@ void AIChatDock::_process_ndjson_line(const String &p_line) {
 					conversations.write[current_conversation_index].last_modified_timestamp = _get_timestamp();
 				}
 				
-				if (!last_msg.content.is_empty()) {
-					String bbcode_content = _markdown_to_bbcode(last_msg.content);
-					if (!bbcode_content.is_empty()) {
-						label->set_text(bbcode_content);
+				if (matches_stream && markdown_stream.label_id == label->get_instance_id()) {
+					// Already rendered incrementally; just commit the last line.
+					_markdown_stream_update(label, last_msg.content);
+					_markdown_stream_finish(&last_msg);
+				} else {
+					_markdown_stream_finish(nullptr);
+					if (!last_msg.content.is_empty()) {
+						const String &bbcode_content = _get_message_bbcode(last_msg);
+						if (!bbcode_content.is_empty()) {
+							label->set_text(bbcode_content);
+						}
 					}
 				}
 				
@@ -2728,8 +2646,31 @@ RichTextLabel *AIChatDock::_get_or_create_current_assistant_message_label() {
 }
 
 void AIChatDock::_execute_tool_calls(const Array &p_tool_calls) {
-    // Ensure counter is sane at the start of a batch
-    if (pending_tool_tasks < 0) pending_tool_tasks = 0;
+	// Ensure counter is sane at the start of a batch
+	if (pending_tool_tasks < 0) {
+		pending_tool_tasks = 0;
+	}
+
+	// Consecutive calls to EditorTools run as one batch: file reads run in
+	// parallel and scene edits share a single undo action. Results are still
+	// added to the chat in call order.
+	Array batch_calls;
+	Vector<String> batch_ids;
+	Vector<Dictionary> batch_args;
+	auto flush_batch = [&]() {
+		if (batch_calls.is_empty()) {
+			return;
+		}
+		const Array results = EditorTools::execute_tool_batch(batch_calls);
+		for (int j = 0; j < batch_calls.size(); j++) {
+			const Dictionary call = batch_calls[j];
+			_add_tool_response_to_chat(batch_ids[j], call["function_name"], batch_args[j], results[j]);
+		}
+		batch_calls.clear();
+		batch_ids.clear();
+		batch_args.clear();
+	};
+
 	for (int i = 0; i < p_tool_calls.size(); i++) {
 		Dictionary tool_call = p_tool_calls[i];
 		String tool_call_id = tool_call.get("id", "");
@@ -2751,128 +2692,80 @@ void AIChatDock::_execute_tool_calls(const Array &p_tool_calls) {
 			args = json->get_data();
 		}
 
+		if (function_name == "take_screenshot") {
+			// Readback and encoding finish on later frames; the result is added
+			// from _on_screenshot_captured().
+			pending_tool_tasks++;
+			_update_tool_placeholder_status(tool_call_id, function_name, "running");
+			AIScreenshotCapture::capture_async(args, callable_mp(this, &AIChatDock::_on_screenshot_captured).bind(tool_call_id, args));
+			continue;
+		}
+
+		if (EditorTools::has_tool(function_name)) {
+			Dictionary call;
+			call["function_name"] = function_name;
+			call["arguments"] = args;
+			batch_calls.push_back(call);
+			batch_ids.push_back(tool_call_id);
+			batch_args.push_back(args);
+			continue;
+		}
+		flush_batch();
+
 		Dictionary result;
 
-		// Execute the tool
-		if (function_name == "get_scene_info") {
-			result = EditorTools::get_scene_info(args);
-		} else if (function_name == "get_all_nodes") {
-			result = EditorTools::get_all_nodes(args);
-		} else if (function_name == "search_nodes_by_type") {
-			result = EditorTools::search_nodes_by_type(args);
-		} else if (function_name == "get_editor_selection") {
-			result = EditorTools::get_editor_selection(args);
-		} else if (function_name == "get_node_properties") {
-			result = EditorTools::get_node_properties(args);
-		} else if (function_name == "save_scene") {
-			result = EditorTools::save_scene(args);
-		} else if (function_name == "get_available_classes") {
-			result = EditorTools::get_available_classes(args);
-		} else if (function_name == "create_node") {
-			result = EditorTools::create_node(args);
-		} else if (function_name == "delete_node") {
-			result = EditorTools::delete_node(args);
-		} else if (function_name == "set_node_property") {
-			result = EditorTools::set_node_property(args);
-		} else if (function_name == "move_node") {
-			result = EditorTools::move_node(args);
-		} else if (function_name == "call_node_method") {
-			result = EditorTools::call_node_method(args);
-		} else if (function_name == "get_node_script") {
-			result = EditorTools::get_node_script(args);
-		} else if (function_name == "attach_script") {
-			result = EditorTools::attach_script(args);
-		} else if (function_name == "manage_scene") {
-			result = EditorTools::manage_scene(args);
-		} else if (function_name == "add_collision_shape") {
-			result = EditorTools::add_collision_shape(args);
-		} else if (function_name == "list_project_files") {
-			result = EditorTools::list_project_files(args);
-		} else if (function_name == "search_project_files") {
-			// search_project_files was renamed to list_project_files
-			result = EditorTools::list_project_files(args);
-		} else if (function_name == "read_file_content") {
-			result = EditorTools::read_file_content(args);
-    } else if (function_name == "read_file_advanced") {
-            result = EditorTools::read_file_advanced(args);
-        } else if (function_name == "apply_edit") {
-            // Run apply_edit asynchronously to avoid blocking the UI (curl/OS execute can freeze main thread)
-            pending_tool_tasks++;
-            _update_tool_placeholder_status(tool_call_id, function_name, "running");
-            _execute_apply_edit_async(tool_call_id, args);
-            // Skip immediate result handling; it will be added when the thread completes
-            continue;
-		} else if (function_name == "check_compilation_errors") {
-			result = EditorTools::check_compilation_errors(args);
-		} else if (function_name == "run_scene") {
-			result = EditorTools::run_scene(args);
-		} else if (function_name == "get_scene_tree_hierarchy") {
-			result = EditorTools::get_scene_tree_hierarchy(args);
-		} else if (function_name == "inspect_physics_body") {
-			result = EditorTools::inspect_physics_body(args);
-		} else if (function_name == "get_camera_info") {
-			result = EditorTools::get_camera_info(args);
-		} else if (function_name == "take_screenshot") {
-			result = EditorTools::take_screenshot(args);
-		} else if (function_name == "check_node_in_scene_tree") {
-			result = EditorTools::check_node_in_scene_tree(args);
-		} else if (function_name == "inspect_animation_state") {
-			result = EditorTools::inspect_animation_state(args);
-		} else if (function_name == "get_layers_and_zindex") {
-			result = EditorTools::get_layers_and_zindex(args);
-        } else if (function_name == "create_script_file") {
-            // Map deprecated create_script_file to apply_edit for forward compatibility
-            // Expect args: { path, description, script_type?, node_type? }
-            String target_path = String(args.get("path", ""));
-            String description = String(args.get("description", ""));
-            String script_type = String(args.get("script_type", ""));
-            String node_type = String(args.get("node_type", ""));
-
-            Dictionary apply_args;
-            apply_args["path"] = target_path;
-            // Craft a prompt for file creation when using apply_edit
-            String composed_prompt;
-            composed_prompt += "Create or overwrite this file with a valid Godot 4.x script.\n";
-            if (!script_type.is_empty()) composed_prompt += "Script type: " + script_type + "\n";
-            if (!node_type.is_empty()) composed_prompt += "Node type: " + node_type + "\n";
-            if (!description.is_empty()) composed_prompt += "Requirements: " + description + "\n";
-            composed_prompt += "Return only the complete file content.";
-            apply_args["prompt"] = composed_prompt;
-
-            result = EditorTools::apply_edit(apply_args);
+		if (function_name == "apply_edit") {
+			// Run apply_edit asynchronously to avoid blocking the UI (curl/OS execute can freeze main thread)
+			pending_tool_tasks++;
+			_update_tool_placeholder_status(tool_call_id, function_name, "running");
+			_execute_apply_edit_async(tool_call_id, args);
+			// Skip immediate result handling; it will be added when the thread completes
+			continue;
+		} else if (function_name == "create_script_file") {
+			// Map deprecated create_script_file to apply_edit for forward compatibility
+			// Expect args: { path, description, script_type?, node_type? }
+			String target_path = String(args.get("path", ""));
+			String description = String(args.get("description", ""));
+			String script_type = String(args.get("script_type", ""));
+			String node_type = String(args.get("node_type", ""));
+
+			Dictionary apply_args;
+			apply_args["path"] = target_path;
+			// Craft a prompt for file creation when using apply_edit
+			String composed_prompt;
+			composed_prompt += "Create or overwrite this file with a valid Godot 4.x script.\n";
+			if (!script_type.is_empty()) composed_prompt += "Script type: " + script_type + "\n";
+			if (!node_type.is_empty()) composed_prompt += "Node type: " + node_type + "\n";
+			if (!description.is_empty()) composed_prompt += "Requirements: " + description + "\n";
+			composed_prompt += "Return only the complete file content.";
+			apply_args["prompt"] = composed_prompt;
+
+			result = EditorTools::apply_edit(apply_args);
 		} else if (function_name == "delete_file_safe") {
 			// delete_file_safe method no longer exists
 			result["success"] = false;
 			result["message"] = "delete_file_safe is no longer available";
-        } else if (function_name == "edit_file_with_diff") {
-            // Deprecated tool removed from backend; return a hard error instructing the model to switch.
-            result["success"] = false;
-            result["message"] = "Tool 'edit_file_with_diff' has been removed. Use 'apply_edit' instead.";
+		} else if (function_name == "edit_file_with_diff") {
+			// Deprecated tool removed from backend; return a hard error instructing the model to switch.
+			result["success"] = false;
+			result["message"] = "Tool 'edit_file_with_diff' has been removed. Use 'apply_edit' instead.";
 		} else if (function_name == "image_operation") {
 			// This tool should be handled by the backend, not the frontend
 			// If we receive it here, it means something went wrong in the backend filtering
 			result["success"] = false;
 			result["message"] = "Image generation should be handled by backend, not frontend";
 			print_line("AI Chat: Received image_operation tool in frontend - this should be handled by backend");
-        } else if (function_name == "editor_introspect") {
-            // Execute multiplexed introspection/debug tool
-            result = EditorTools::editor_introspect(args);
 		} else {
 			result["success"] = false;
 			result["message"] = "Unknown tool: " + function_name;
 		}
 
-        // Add a proper, separate tool bubble for the output.
-        _add_tool_response_to_chat(tool_call_id, function_name, args, result);
+		// Add a proper, separate tool bubble for the output.
+		_add_tool_response_to_chat(tool_call_id, function_name, args, result);
 
-        // Note: Do not inject unsolicited tool results here. The model must request tools.
-		
-		// Don't add system messages - they break OpenAI format!
-		// bool success = result.get("success", false);
-		// String message = result.get("message", "");
-		// String status_icon = success ? "✅" : "❌";
-		// _add_message_to_chat("system", status_icon + " " + function_name + ": " + message);
+		// Note: Do not inject unsolicited tool results here. The model must request tools.
 	}
+	flush_batch();
 
     // If there are async tool tasks running, defer finalization until they complete.
     if (pending_tool_tasks > 0) {
@@ -2953,6 +2846,17 @@ void AIChatDock::_on_apply_edit_thread_done() {
     }
 }
 
+void AIChatDock::_on_screenshot_captured(const Dictionary &p_result, const String &p_tool_call_id, const Dictionary &p_args) {
+	pending_tool_tasks = MAX(0, pending_tool_tasks - 1);
+	_update_tool_placeholder_status(p_tool_call_id, "take_screenshot", "completed");
+	_add_tool_response_to_chat(p_tool_call_id, "take_screenshot", p_args, p_result);
+
+	if (pending_tool_tasks == 0) {
+		current_assistant_message_label = nullptr;
+		_send_chat_request();
+	}
+}
+
 void AIChatDock::_add_message_to_chat(const String &p_role, const String &p_content, const Array &p_tool_calls) {
 	AIChatDock::ChatMessage msg;
 	msg.role = p_role;
@@ -3179,9 +3083,10 @@ void AIChatDock::_create_message_bubble(const AIChatDock::ChatMessage &p_message
 	PanelContainer *message_panel = memnew(PanelContainer);
 	
 	// Add spacing before each message for cleaner layout
-	if (chat_container->get_child_count() > 0) {
+	if (_has_message_controls()) {
 		Control *spacer = memnew(Control);
 		spacer->set_custom_minimum_size(Size2(0, 8)); // 8px gap between messages
+		spacer->set_meta("message_index", p_message_index);
 		chat_container->add_child(spacer);
 	}
 	
@@ -3190,6 +3095,8 @@ void AIChatDock::_create_message_bubble(const AIChatDock::ChatMessage &p_message
     if (p_message_index >= 0) {
         message_panel->set_name("message_panel_" + String::num_int64(p_message_index));
     }
+    // Tag so the transcript window can measure, recycle and patch by message.
+    message_panel->set_meta("message_index", p_message_index);
 
 	// Default to invisible. We'll show it only if it has content.
 	message_panel->set_visible(false);
@@ -3254,7 +3161,7 @@ void AIChatDock::_create_message_bubble(const AIChatDock::ChatMessage &p_message
 	}
 
 	if (!p_message.content.strip_edges().is_empty()) {
-		String bbcode_content = _markdown_to_bbcode(p_message.content);
+		const String &bbcode_content = _get_message_bbcode(p_message);
 		if (!bbcode_content.is_empty()) {
 			content_label->set_text(bbcode_content);
 		}
@@ -3538,7 +3445,7 @@ void AIChatDock::_create_tool_specific_ui(VBoxContainer *p_content_vbox, const S
 
 		Array files = p_result.get("files", Array());
 		for (int i = 0; i < files.size(); i++) {
-			String file_path = files[i];
+			String file_path = String(files[i]).trim_prefix("res://");
 			Vector<String> parts = file_path.split("/");
 			TreeItem *current_item = root;
 			String current_path = "";
@@ -3870,7 +3777,7 @@ void AIChatDock::_create_tool_specific_ui(VBoxContainer *p_content_vbox, const S
 		p_content_vbox->add_child(search_files_vbox);
 
 		Array files = p_result.get("files", Array());
-		String search_term = p_args.get("search_term", "");
+		String search_term = p_args.get("content", p_args.get("pattern", ""));
 		
 		Label *count_label = memnew(Label);
 		count_label->set_text("Found " + String::num_int64(files.size()) + " files matching: " + search_term);
@@ -3911,6 +3818,7 @@ void AIChatDock::_create_tool_specific_ui(VBoxContainer *p_content_vbox, const S
                 if (f.is_valid()) {
                     f->store_string(original_content);
                     f->close();
+                    AIToolCache::notify_files_changed();
                 }
             }
 
@@ -4477,69 +4385,346 @@ void AIChatDock::_create_tool_specific_ui(VBoxContainer *p_content_vbox, const S
 }
 
 void AIChatDock::_rebuild_conversation_ui(const Vector<ChatMessage> &p_messages) {
-	// Build a mapping of tool call IDs to their results for efficient lookup
-	HashMap<String, ChatMessage> tool_results;
-	for (int i = 0; i < p_messages.size(); i++) {
-		const ChatMessage &msg = p_messages[i];
-		if (msg.role == "tool" && !msg.tool_call_id.is_empty()) {
-			tool_results[msg.tool_call_id] = msg;
-		}
+	_clear_transcript_ui();
+	if (chat_container == nullptr) {
+		return;
 	}
-	
-	// First pass: Create all non-tool messages (this includes assistant messages with tool_calls)
-	for (int i = 0; i < p_messages.size(); i++) {
-		const ChatMessage &msg = p_messages[i];
-		if (msg.role != "tool") {
-			_create_message_bubble(msg, i);
-		}
+
+	transcript_height_cache.resize(p_messages.size());
+	transcript_height_cache.fill(0.0f);
+
+	// Only build enough of the tail to fill the view plus overscan; the rest is
+	// materialized on demand as the user scrolls up.
+	float viewport_height = chat_scroll ? chat_scroll->get_size().y : 0.0f;
+	if (viewport_height <= 0.0f) {
+		viewport_height = 600.0f;
 	}
-	
-	// Second pass: Apply tool results to their corresponding placeholders
-	for (int i = 0; i < p_messages.size(); i++) {
-		const ChatMessage &msg = p_messages[i];
-		if (msg.role == "tool" && !msg.tool_call_id.is_empty()) {
-			// Use a small delay to ensure the UI has been updated from the first pass
-			call_deferred("_apply_tool_result_deferred", msg.tool_call_id, msg.name, msg.content, msg.tool_results);
-		}
+	const float budget = viewport_height * (1.0f + TRANSCRIPT_OVERSCAN_SCREENS);
+	int first = p_messages.size();
+	float accumulated = 0.0f;
+	while (first > 0 && accumulated < budget) {
+		first--;
+		accumulated += _get_message_height(p_messages, first);
 	}
+	first = _get_transcript_unit_start(p_messages, first);
+
+	_build_transcript_range(p_messages, first, p_messages.size(), false);
+	transcript_first_built = first;
+	_update_transcript_spacer();
 }
 
-void AIChatDock::_apply_tool_result_deferred(const String &p_tool_call_id, const String &p_tool_name, const String &p_content, const Array &p_tool_results) {
-	// Find the placeholder for this tool call ID
+void AIChatDock::_clear_transcript_ui() {
+	transcript_top_spacer = nullptr;
+	transcript_first_built = 0;
+	transcript_height_cache.clear();
+	transcript_scroll_anchor = ObjectID();
 	if (chat_container == nullptr) {
 		return;
 	}
-	
-	PanelContainer *placeholder = Object::cast_to<PanelContainer>(chat_container->find_child("tool_placeholder_" + p_tool_call_id, true, false));
-	if (!placeholder) {
-		print_line("AI Chat: Warning - Could not find tool placeholder for ID: " + p_tool_call_id);
-		return;
+	// Detach right away so index-based bookkeeping never sees dying nodes.
+	for (int i = chat_container->get_child_count() - 1; i >= 0; i--) {
+		Node *child = chat_container->get_child(i);
+		chat_container->remove_child(child);
+		child->queue_free();
 	}
+	transcript_top_spacer = memnew(Control);
+	transcript_top_spacer->set_mouse_filter(Control::MOUSE_FILTER_IGNORE);
+	chat_container->add_child(transcript_top_spacer);
+}
 
-	// Clear the "loading" text or any existing content immediately
-	while (placeholder->get_child_count() > 0) {
-		Node *child = placeholder->get_child(0);
-		placeholder->remove_child(child);
-		child->queue_free();
+bool AIChatDock::_has_message_controls() const {
+	// The top spacer is always there and doesn't need a gap after it.
+	const int first = transcript_top_spacer ? transcript_top_spacer->get_index() + 1 : 0;
+	return chat_container->get_child_count() > first;
+}
+
+int AIChatDock::_get_transcript_unit_start(const Vector<ChatMessage> &p_messages, int p_index) const {
+	// Tool results render inside the assistant bubble that requested them, so
+	// an assistant message and its tool messages are built and freed together.
+	while (p_index > 0 && p_index < p_messages.size() && p_messages[p_index].role == "tool") {
+		p_index--;
 	}
+	return p_index;
+}
 
-	// Parse the tool result from JSON content
-	Ref<JSON> json;
-	json.instantiate();
-	Error err = json->parse(p_content);
-	Dictionary result;
-	if (err == OK) {
-		result = json->get_data();
-	} else {
-		// Fallback if JSON parsing fails
-		result["success"] = false;
-		result["message"] = "Failed to parse tool result: " + p_content;
+float AIChatDock::_get_message_height(const Vector<ChatMessage> &p_messages, int p_index) const {
+	if (p_index < transcript_height_cache.size() && transcript_height_cache[p_index] > 0.0f) {
+		return transcript_height_cache[p_index];
 	}
+	// Rough estimate for messages that were never on screen.
+	const ChatMessage &msg = p_messages[p_index];
+	if (msg.role == "tool") {
+		return 80.0f;
+	}
+	float height = 56.0f;
+	height += 20.0f * (msg.content.count("\n") + 1 + msg.content.length() / 100);
+	height += 40.0f * msg.tool_calls.size();
+	for (const AttachedFile &file : msg.attached_files) {
+		height += file.is_image ? 240.0f : 48.0f;
+	}
+	return height;
+}
 
-	// Extract arguments if they were stored
-	Dictionary args;
-	if (p_tool_results.size() > 1) {
-		args = p_tool_results[1]; // Args are stored as second element
+void AIChatDock::_build_transcript_range(const Vector<ChatMessage> &p_messages, int p_from, int p_to, bool p_prepend) {
+	if (chat_container == nullptr || p_from >= p_to) {
+		return;
+	}
+	const int insert_at = chat_container->get_child_count();
+	// Building older messages must not steal the label streaming is writing to.
+	RichTextLabel *saved_label = current_assistant_message_label;
+
+	for (int i = p_from; i < p_to; i++) {
+		if (p_messages[i].role != "tool") {
+			_create_message_bubble(p_messages[i], i);
+		}
+	}
+	// Apply tool results to their placeholders once the bubbles exist.
+	for (int i = p_from; i < p_to; i++) {
+		const ChatMessage &msg = p_messages[i];
+		if (msg.role == "tool" && !msg.tool_call_id.is_empty()) {
+			call_deferred("_apply_tool_result_deferred", msg.tool_call_id, msg.name, msg.content, msg.tool_results);
+		}
+	}
+
+	if (p_prepend) {
+		current_assistant_message_label = saved_label;
+		const int added = chat_container->get_child_count() - insert_at;
+		const int target = transcript_top_spacer ? transcript_top_spacer->get_index() + 1 : 0;
+		for (int i = 0; i < added; i++) {
+			chat_container->move_child(chat_container->get_child(insert_at + i), target + i);
+		}
+	}
+}
+
+void AIChatDock::_remove_message_bubbles_from(int p_message_index) {
+	if (chat_container == nullptr) {
+		return;
+	}
+	for (int i = chat_container->get_child_count() - 1; i >= 0; i--) {
+		Node *child = chat_container->get_child(i);
+		if (child == transcript_top_spacer) {
+			break;
+		}
+		if (int(child->get_meta("message_index", -1)) < p_message_index) {
+			break;
+		}
+		chat_container->remove_child(child);
+		child->queue_free();
+	}
+	if (transcript_first_built > p_message_index) {
+		transcript_first_built = p_message_index;
+		_update_transcript_spacer();
+	}
+}
+
+void AIChatDock::_measure_transcript() {
+	if (chat_container == nullptr) {
+		return;
+	}
+	const Vector<ChatMessage> &messages = _get_current_chat_history();
+	if (transcript_height_cache.size() < messages.size()) {
+		const int old_size = transcript_height_cache.size();
+		transcript_height_cache.resize(messages.size());
+		for (int i = old_size; i < messages.size(); i++) {
+			transcript_height_cache.write[i] = 0.0f;
+		}
+	}
+	const float separation = chat_container->get_theme_constant(SNAME("separation"));
+	int last_index = -1;
+	for (int i = 0; i < chat_container->get_child_count(); i++) {
+		Control *child = Object::cast_to<Control>(chat_container->get_child(i));
+		if (!child || child == transcript_top_spacer) {
+			continue;
+		}
+		const int index = child->get_meta("message_index", -1);
+		if (index < 0 || index >= transcript_height_cache.size()) {
+			continue;
+		}
+		if (index != last_index) {
+			transcript_height_cache.write[index] = 0.0f;
+			last_index = index;
+		}
+		if (child->is_visible()) {
+			transcript_height_cache.write[index] += child->get_size().y + separation;
+		}
+	}
+}
+
+void AIChatDock::_update_transcript_spacer() {
+	if (!transcript_top_spacer) {
+		return;
+	}
+	const Vector<ChatMessage> &messages = _get_current_chat_history();
+	float height = 0.0f;
+	for (int i = 0; i < transcript_first_built && i < messages.size(); i++) {
+		height += _get_message_height(messages, i);
+	}
+	transcript_top_spacer->set_custom_minimum_size(Size2(0, height));
+	transcript_top_spacer->set_visible(height > 0.0f);
+}
+
+void AIChatDock::_on_transcript_scrolled(double p_value) {
+	if (transcript_update_queued) {
+		return;
+	}
+	transcript_update_queued = true;
+	callable_mp(this, &AIChatDock::_update_transcript_window).call_deferred();
+}
+
+void AIChatDock::_update_transcript_window() {
+	transcript_update_queued = false;
+	if (!chat_scroll || !chat_container || !transcript_top_spacer) {
+		return;
+	}
+	const Vector<ChatMessage> &messages = _get_current_chat_history();
+	if (transcript_first_built > messages.size()) {
+		_rebuild_conversation_ui(messages);
+		return;
+	}
+
+	_measure_transcript();
+
+	const float scroll = chat_scroll->get_v_scroll_bar()->get_value();
+	const float viewport_height = MAX(1.0f, chat_scroll->get_size().y);
+	const float overscan = viewport_height * TRANSCRIPT_OVERSCAN_SCREENS;
+	const float spacer_height = transcript_top_spacer->get_custom_minimum_size().y;
+
+	// Keep whatever is currently at the top of the built range in place while
+	// controls above it are added or removed.
+	Control *anchor = nullptr;
+	for (int i = transcript_top_spacer->get_index() + 1; i < chat_container->get_child_count(); i++) {
+		anchor = Object::cast_to<Control>(chat_container->get_child(i));
+		if (anchor) {
+			break;
+		}
+	}
+
+	if (transcript_first_built > 0 && scroll < spacer_height + overscan) {
+		// Scrolling up into the unbuilt region: materialize a page of history.
+		const float needed = MAX(viewport_height, spacer_height + overscan - scroll);
+		int first = transcript_first_built;
+		float accumulated = 0.0f;
+		while (first > 0 && accumulated < needed) {
+			first--;
+			accumulated += _get_message_height(messages, first);
+		}
+		first = _get_transcript_unit_start(messages, first);
+
+		if (anchor) {
+			transcript_scroll_anchor = anchor->get_instance_id();
+			transcript_scroll_anchor_y = anchor->get_position().y;
+		}
+		_build_transcript_range(messages, first, transcript_first_built, true);
+		transcript_first_built = first;
+		_update_transcript_spacer();
+		return;
+	}
+
+	// Far below the top of the built range: free bubbles well above the view.
+	const float recycle_limit = scroll - overscan * 2.0f;
+	if (recycle_limit <= spacer_height) {
+		return;
+	}
+	int new_first = transcript_first_built;
+	float freed_bottom = 0.0f;
+	for (int i = transcript_top_spacer->get_index() + 1; i < chat_container->get_child_count(); i++) {
+		Control *child = Object::cast_to<Control>(chat_container->get_child(i));
+		if (!child) {
+			continue;
+		}
+		const int index = child->get_meta("message_index", -1);
+		if (index < 0) {
+			break;
+		}
+		if (child->get_position().y + child->get_size().y > recycle_limit) {
+			// This message is (partially) near the view; stop before it.
+			new_first = index;
+			break;
+		}
+		freed_bottom = child->get_position().y + child->get_size().y;
+		new_first = index + 1;
+	}
+	new_first = _get_transcript_unit_start(messages, MIN(new_first, messages.size() - 1));
+	if (new_first <= transcript_first_built || freed_bottom <= 0.0f) {
+		return;
+	}
+
+	while (transcript_top_spacer->get_index() + 1 < chat_container->get_child_count()) {
+		Node *child = chat_container->get_child(transcript_top_spacer->get_index() + 1);
+		if (int(child->get_meta("message_index", -1)) >= new_first) {
+			break;
+		}
+		chat_container->remove_child(child);
+		child->queue_free();
+	}
+	for (int i = transcript_top_spacer->get_index() + 1; i < chat_container->get_child_count(); i++) {
+		Control *child = Object::cast_to<Control>(chat_container->get_child(i));
+		if (child) {
+			transcript_scroll_anchor = child->get_instance_id();
+			transcript_scroll_anchor_y = child->get_position().y;
+			break;
+		}
+	}
+	transcript_first_built = new_first;
+	_update_transcript_spacer();
+}
+
+void AIChatDock::_on_transcript_sorted() {
+	if (transcript_scroll_anchor.is_valid()) {
+		// The scroll container updates its range after this sort; apply once it has.
+		callable_mp(this, &AIChatDock::_apply_transcript_scroll_anchor).call_deferred();
+	}
+}
+
+void AIChatDock::_apply_transcript_scroll_anchor() {
+	Control *anchor = ObjectDB::get_instance<Control>(transcript_scroll_anchor);
+	transcript_scroll_anchor = ObjectID();
+	if (!anchor || !chat_scroll || anchor->get_parent() != chat_container) {
+		return;
+	}
+	const float delta = anchor->get_position().y - transcript_scroll_anchor_y;
+	if (!Math::is_zero_approx(delta)) {
+		VScrollBar *vbar = chat_scroll->get_v_scroll_bar();
+		vbar->set_value(vbar->get_value() + delta);
+	}
+}
+
+void AIChatDock::_apply_tool_result_deferred(const String &p_tool_call_id, const String &p_tool_name, const String &p_content, const Array &p_tool_results) {
+	// Find the placeholder for this tool call ID
+	if (chat_container == nullptr) {
+		return;
+	}
+	
+	PanelContainer *placeholder = Object::cast_to<PanelContainer>(chat_container->find_child("tool_placeholder_" + p_tool_call_id, true, false));
+	if (!placeholder) {
+		print_line("AI Chat: Warning - Could not find tool placeholder for ID: " + p_tool_call_id);
+		return;
+	}
+
+	// Clear the "loading" text or any existing content immediately
+	while (placeholder->get_child_count() > 0) {
+		Node *child = placeholder->get_child(0);
+		placeholder->remove_child(child);
+		child->queue_free();
+	}
+
+	// Parse the tool result from JSON content
+	Ref<JSON> json;
+	json.instantiate();
+	Error err = json->parse(p_content);
+	Dictionary result;
+	if (err == OK) {
+		result = json->get_data();
+	} else {
+		// Fallback if JSON parsing fails
+		result["success"] = false;
+		result["message"] = "Failed to parse tool result: " + p_content;
+	}
+
+	// Extract arguments if they were stored
+	Dictionary args;
+	if (p_tool_results.size() > 1) {
+		args = p_tool_results[1]; // Args are stored as second element
 	}
 
 	// Create the tool result UI
@@ -4613,168 +4798,8 @@ void AIChatDock::_send_chat_request() {
 	
 	// Build the messages array for the API
 	Array messages;
-	messages.resize(chat_history.size());
-	
-	// Process messages efficiently for smaller conversations
 	for (int i = 0; i < chat_history.size(); i++) {
-		const ChatMessage &msg = chat_history[i];
-		Dictionary api_msg;
-		api_msg["role"] = msg.role;
-		
-		// For user messages with attached files, handle images and text differently
-		if (msg.role == "user" && !msg.attached_files.is_empty()) {
-			// Check if we have any images
-			bool has_images = false;
-			for (const AttachedFile &file : msg.attached_files) {
-				if (file.is_image) {
-					has_images = true;
-					break;
-				}
-			}
-			
-			if (has_images) {
-				// Use the new multi-modal format for images
-				Array content_array;
-				
-				// Add text content
-				if (!msg.content.is_empty()) {
-					Dictionary text_part;
-					text_part["type"] = "text";
-					text_part["text"] = msg.content;
-					content_array.push_back(text_part);
-				}
-				
-							// Add images and text files
-			for (const AttachedFile &file : msg.attached_files) {
-				if (file.is_image) {
-					Dictionary image_part;
-					image_part["type"] = "image_url";
-					Dictionary image_url;
-					image_url["url"] = "data:" + file.mime_type + ";base64," + file.base64_data;
-					image_part["image_url"] = image_url;
-					content_array.push_back(image_part);
-					
-            // Add image ID marker; and promote to top-level 'images' for backend tool context
-            Dictionary text_part;
-            text_part["type"] = "text";
-            text_part["text"] = "\n*[Image ID: " + file.name + "]*";
-            content_array.push_back(text_part);
-				} else {
-					// Add text files as text content
-					Dictionary text_part;
-					text_part["type"] = "text";
-					text_part["text"] = "\n\n**File: " + file.name + " (" + file.path + ")**\n```\n" + file.content + "\n```\n";
-					content_array.push_back(text_part);
-				}
-			}
-				
-				api_msg["content"] = content_array;
-			} else {
-				// Legacy format for text-only attachments
-				String combined_content = msg.content;
-				combined_content += "\n\n**Attached Files:**\n";
-				
-				for (const AttachedFile &file : msg.attached_files) {
-					combined_content += "\n### " + file.name + " (" + file.path + ")\n";
-					combined_content += "```\n" + file.content + "\n```\n";
-				}
-				
-				api_msg["content"] = combined_content;
-			}
-		} else {
-			// Handle assistant messages with attached files (like generated images)
-			if (msg.role == "assistant" && !msg.attached_files.is_empty()) {
-				// Check if we have any images  
-				bool has_images = false;
-				for (const AttachedFile &file : msg.attached_files) {
-					if (file.is_image) {
-						has_images = true;
-						break;
-					}
-				}
-				
-				if (has_images) {
-								// For assistant messages with images, we need to structure them for OpenAI
-			// Since OpenAI doesn't support assistant messages with image content,
-			// we'll include the images as a special marker in the content
-			String content_with_images = msg.content;
-			content_with_images += "\n\n**Generated Images:**";
-			
-			for (const AttachedFile &file : msg.attached_files) {
-				if (file.is_image) {
-					content_with_images += "\n- Image ID: `" + file.name + "`";
-				}
-			}
-					
-					api_msg["content"] = content_with_images;
-					
-                    // Include generated image data for backend-only image editing context.
-                    // This is NOT sent to OpenAI by the backend; it's only used by /chat tool execution.
-                    Array images_data;
-                    for (const AttachedFile &file : msg.attached_files) {
-                        if (file.is_image) {
-                            Dictionary image_info;
-                            image_info["name"] = file.name;
-                            image_info["mime_type"] = file.mime_type;
-                            image_info["base64_data"] = file.base64_data;
-                            image_info["original_size"] = Vector2(file.original_size.x, file.original_size.y);
-                            images_data.push_back(image_info);
-                        }
-                    }
-                    if (!images_data.is_empty()) {
-                        api_msg["images"] = images_data;
-                    }
-				} else {
-					api_msg["content"] = msg.content;
-				}
-			} else {
-				api_msg["content"] = msg.content;
-			}
-		}
-		
-        if (msg.role == "assistant" && !msg.tool_calls.is_empty()) {
-			api_msg["tool_calls"] = msg.tool_calls;
-		}
-        if (msg.role == "tool") {
-            api_msg["tool_call_id"] = msg.tool_call_id;
-            api_msg["name"] = msg.name;
-            // Only strip image_data for image_operation; keep full content for other tools
-            if (msg.name == "image_operation") {
-                Dictionary raw;
-                if (!msg.tool_results.is_empty()) {
-                    raw = msg.tool_results[0];
-                } else {
-                    Ref<JSON> json_tool;
-                    json_tool.instantiate();
-                    if (json_tool->parse(msg.content) == OK) {
-                        raw = json_tool->get_data();
-                    }
-                }
-                // Promote assistant images to top-level 'images' so backend edits can find them
-                Array images_data;
-                for (const AttachedFile &file : msg.attached_files) {
-                    if (file.is_image) {
-                        Dictionary image_info;
-                        image_info["name"] = file.name;
-                        image_info["mime_type"] = file.mime_type;
-                        image_info["base64_data"] = file.base64_data;
-                        image_info["original_size"] = Vector2(file.original_size.x, file.original_size.y);
-                        images_data.push_back(image_info);
-                    }
-                }
-                if (!images_data.is_empty()) {
-                    api_msg["images"] = images_data;
-                }
-                raw.erase("image_data");
-                Ref<JSON> json_min;
-                json_min.instantiate();
-                api_msg["content"] = json_min->stringify(raw);
-            } else {
-                // Non-image tools: pass original content
-                api_msg["content"] = msg.content;
-            }
-        }
-		messages.push_back(api_msg);
+		messages.push_back(_build_api_message(chat_history[i]));
 	}
 
 	// Store messages and route to finalize method
@@ -4842,7 +4867,7 @@ Dictionary AIChatDock::_build_api_message(const ChatMessage &p_msg) {
 				content_array.push_back(text_part);
 			}
 			
-					// Add images and text files
+					// Add images; text files follow from `attached_files`
 		for (const AttachedFile &file : p_msg.attached_files) {
 			if (file.is_image) {
 				Dictionary image_part;
@@ -4857,28 +4882,15 @@ Dictionary AIChatDock::_build_api_message(const ChatMessage &p_msg) {
 				text_part["type"] = "text";
 				text_part["text"] = "\n*[Image ID: " + file.name + "]*";
 				content_array.push_back(text_part);
-			} else {
-				// Add text files as text content
-				Dictionary text_part;
-				text_part["type"] = "text";
-				text_part["text"] = "\n\n**File: " + file.name + " (" + file.path + ")**\n```\n" + file.content + "\n```\n";
-				content_array.push_back(text_part);
 			}
 		}
 			
 			api_msg["content"] = content_array;
 		} else {
-			// Legacy format for text-only attachments
-			String combined_content = p_msg.content;
-			combined_content += "\n\n**Attached Files:**\n";
-			
-			for (const AttachedFile &file : p_msg.attached_files) {
-				combined_content += "\n### " + file.name + " (" + file.path + ")\n";
-				combined_content += "```\n" + file.content + "\n```\n";
-			}
-			
-			api_msg["content"] = combined_content;
+			api_msg["content"] = p_msg.content;
 		}
+		// Text files are inlined by AIContextPacker from `attached_files`,
+		// after files attached again in later turns are deduplicated.
 	} else {
 		// Handle assistant messages with attached files (like generated images)
 		if (p_msg.role == "assistant" && !p_msg.attached_files.is_empty()) {
@@ -4989,8 +5001,17 @@ Dictionary AIChatDock::_build_api_message(const ChatMessage &p_msg) {
 
 void AIChatDock::_finalize_chat_request() {
 	// Build final request data
+	context_packer.set_token_budget(_get_context_token_budget());
+	Array packed_messages = context_packer.pack(_chunked_messages);
+	const AIContextPacker::Stats &pack_stats = context_packer.get_last_stats();
+	if (pack_stats.input_tokens != pack_stats.output_tokens) {
+		print_line(vformat("AI Chat: Packed context from ~%d to ~%d tokens (budget %d; %d duplicate files, %d tool outputs stubbed, %d messages summarized, %d truncated)",
+				pack_stats.input_tokens, pack_stats.output_tokens, context_packer.get_token_budget(), pack_stats.deduplicated_files,
+				pack_stats.stubbed_tool_outputs, pack_stats.summarized_messages, pack_stats.truncated_messages));
+	}
+
 	Dictionary request_data;
-	request_data["messages"] = _chunked_messages;
+	request_data["messages"] = packed_messages;
 	request_data["model"] = model;
 
 	// Debug logs for OpenAI messages have been quieted to reduce console noise.
@@ -5011,57 +5032,31 @@ void AIChatDock::_finalize_chat_request() {
     // Always pass current project root to ensure backend targets the right project
     headers.push_back("X-Project-Root: " + ProjectSettings::get_singleton()->globalize_path("res://"));
 
-	// Setup HTTPClient for streaming
-	http_client->set_read_chunk_size(4096); // 4kb chunk size
-
-	// Extract host and port from endpoint
-	String host = api_endpoint;
-	int port = 80;
-	bool use_ssl = false;
-
-	if (host.begins_with("https://")) {
-		host = host.trim_prefix("https://");
-		use_ssl = true;
-		port = 443;
-	} else if (host.begins_with("http://")) {
-		host = host.trim_prefix("http://");
-	}
+	// Stream the response over a pooled keep-alive connection, so follow-up
+	// requests (tool results, stop, embeddings) skip the TCP/TLS handshake.
+	HTTPConnectionPool::Request request;
+	request.url = api_endpoint;
+	request.method = HTTPClient::METHOD_POST;
+	request.headers = headers;
+	request.body = request_body.to_utf8_buffer();
+	request.read_chunk_size = 4096; // 4kb chunk size
 
-	String path = "/";
-	if (host.find("/") != -1) {
-		path = host.substr(host.find("/"), -1);
-		host = host.substr(0, host.find("/"));
-	}
+	// Clear response buffer for new request
+	response_decoder.clear();
 
-	if (host.find(":") != -1) {
-		port = host.substr(host.find(":") + 1, -1).to_int();
-		host = host.substr(0, host.find(":"));
-	}
+	HTTPConnectionPool::get_singleton()->cancel(chat_request);
+	chat_stream++;
+	request.on_chunk = callable_mp(this, &AIChatDock::_on_chat_stream_chunk).bind(chat_stream);
+	request.on_completed = callable_mp(this, &AIChatDock::_on_chat_request_completed).bind(chat_stream);
 
-    PackedByteArray request_body_data = request_body.to_utf8_buffer();
-    print_line("AI Chat: Attempting to connect to " + host + ":" + String::num_int64(port) + path);
-    Ref<TLSOptions> tls_options;
-    if (use_ssl) {
-        // Use default platform CA and standard hostname verification.
-        tls_options = TLSOptions::client();
-    }
-    Error err = http_client->connect_to_host(host, port, tls_options);
-	if (err != OK) {
-		_add_message_to_chat("system", "Failed to connect to backend: " + host + ":" + String::num_int64(port) + " (Error: " + String::num_int64(err) + ")");
+	print_line("AI Chat: Sending chat request to " + api_endpoint);
+	chat_request = HTTPConnectionPool::get_singleton()->request(request);
+	if (chat_request == HTTPConnectionPool::INVALID_REQUEST_ID) {
+		_add_message_to_chat("system", "Failed to connect to backend: " + api_endpoint);
 		is_waiting_for_response = false;
 		_update_ui_state();
 		return;
 	}
-
-	http_status = STATUS_CONNECTING;
-	pending_request_path = path;
-	pending_request_headers = headers;
-	pending_request_body = request_body_data;
-
-	// Clear response buffer for new request
-	response_buffer.clear();
-
-	set_process(true);
 	
 	// Clear the chunked messages to free memory
 	_chunked_messages.clear();
@@ -5199,6 +5194,43 @@ String AIChatDock::_process_inline_markdown(String p_line) {
 	return line;
 }
 
+String AIChatDock::_markdown_line_to_bbcode(const String &p_line, bool &r_in_code_block) {
+	if (p_line.strip_edges().begins_with("```")) {
+		r_in_code_block = !r_in_code_block;
+		return r_in_code_block ? "[code]" : "[/code]";
+	}
+	if (r_in_code_block) {
+		return p_line.xml_escape(); // Escape to prevent BBCode parsing inside code blocks.
+	}
+	if (p_line.strip_edges().is_empty()) {
+		// Preserve blank lines between paragraphs.
+		return String();
+	}
+
+	String trimmed_line = p_line.lstrip(" \t");
+
+	// Headers
+	if (trimmed_line.begins_with("#")) {
+		int header_level = 0;
+		while (header_level < trimmed_line.length() && trimmed_line[header_level] == '#') {
+			header_level++;
+		}
+		String header_content = trimmed_line.substr(header_level).strip_edges();
+		if (!header_content.is_empty()) {
+			int font_size = 22 - (header_level * 2);
+			return "[font_size=" + String::num_int64(font_size) + "][b]" + _process_inline_markdown(header_content) + "[/b][/font_size]";
+		}
+		return p_line;
+	}
+	// Lists
+	if (trimmed_line.begins_with("- ") || trimmed_line.begins_with("* ")) {
+		String item_content = trimmed_line.substr(trimmed_line.find(" ") + 1);
+		return "[indent]* " + _process_inline_markdown(item_content) + "[/indent]";
+	}
+	// Regular paragraph
+	return _process_inline_markdown(p_line);
+}
+
 String AIChatDock::_markdown_to_bbcode(const String &p_markdown) {
 	// Safety check for empty strings
 	if (p_markdown.is_empty()) {
@@ -5210,71 +5242,130 @@ String AIChatDock::_markdown_to_bbcode(const String &p_markdown) {
 	bool in_code_block = false;
 
 	for (int i = 0; i < lines.size(); i++) {
-		String line = lines[i];
+		result += _markdown_line_to_bbcode(lines[i], in_code_block);
+		if (i < lines.size() - 1) {
+			result += "\n";
+		}
+	}
 
-		if (line.strip_edges().begins_with("```")) {
-			in_code_block = !in_code_block;
-			if (in_code_block) {
-				result += "[code]";
-			} else {
-				result += "[/code]";
-			}
-		} else if (in_code_block) {
-			result += line.xml_escape(); // Escape to prevent BBCode parsing inside code blocks.
-		} else {
-			if (line.strip_edges().is_empty()) {
-				// Preserve blank lines between paragraphs.
-				result += "";
-			} else {
-				String processed_line = line;
-				String trimmed_line = processed_line.lstrip(" \t");
-
-				// Headers
-				if (trimmed_line.begins_with("#")) {
-					int header_level = 0;
-					while (header_level < trimmed_line.length() && trimmed_line[header_level] == '#') {
-						header_level++;
-					}
-					String header_content = trimmed_line.substr(header_level).strip_edges();
-					if (!header_content.is_empty()) {
-						int font_size = 22 - (header_level * 2);
-						processed_line = "[font_size=" + String::num_int64(font_size) + "][b]" + _process_inline_markdown(header_content) + "[/b][/font_size]";
-					}
-					// Lists
-				} else if (trimmed_line.begins_with("- ") || trimmed_line.begins_with("* ")) {
-					String item_content = trimmed_line.substr(trimmed_line.find(" ") + 1);
-					processed_line = "[indent]* " + _process_inline_markdown(item_content) + "[/indent]";
-				} else {
-					// Regular paragraph
-					processed_line = _process_inline_markdown(processed_line);
-				}
-				result += processed_line;
+	return result;
+}
+
+const String &AIChatDock::_get_message_bbcode(const ChatMessage &p_message) {
+	// Hashing is linear but far cheaper than converting again.
+	const uint32_t content_hash = p_message.content.hash();
+	if (p_message.bbcode_cache_length != p_message.content.length() || p_message.bbcode_cache_hash != content_hash) {
+		p_message.bbcode_cache = _markdown_to_bbcode(p_message.content);
+		p_message.bbcode_cache_hash = content_hash;
+		p_message.bbcode_cache_length = p_message.content.length();
+	}
+	return p_message.bbcode_cache;
+}
+
+void AIChatDock::_markdown_stream_update(RichTextLabel *p_label, const String &p_content) {
+	ERR_FAIL_NULL(p_label);
+
+	if (markdown_stream.label_id != p_label->get_instance_id() || p_content.length() < markdown_stream.source_length) {
+		// New message (or content rewritten): start over from what is in history.
+		_markdown_stream_finish(nullptr);
+		markdown_stream.label_id = p_label->get_instance_id();
+		p_label->clear();
+	}
+	markdown_stream.source_length = p_content.length();
+
+	// Convert and append every line completed since the last delta.
+	const int last_break = p_content.rfind_char('\n');
+	if (last_break >= markdown_stream.consumed) {
+		String chunk;
+		int line_start = markdown_stream.consumed;
+		while (line_start <= last_break) {
+			const int line_end = p_content.find_char('\n', line_start);
+			if (markdown_stream.has_lines) {
+				chunk += "\n";
 			}
+			chunk += _markdown_line_to_bbcode(p_content.substr(line_start, line_end - line_start), markdown_stream.in_code_block);
+			markdown_stream.has_lines = true;
+			line_start = line_end + 1;
 		}
+		markdown_stream.consumed = last_break + 1;
+		markdown_stream.committed_bbcode += chunk;
+		p_label->append_text(chunk);
+	}
 
-		if (i < lines.size() - 1) {
-			result += "\n";
+	// Re-render only the unfinished last line.
+	const String tail = p_content.substr(markdown_stream.consumed);
+	markdown_stream.tail_bbcode = String();
+	if (!tail.is_empty()) {
+		bool in_code_block = markdown_stream.in_code_block;
+		markdown_stream.tail_bbcode = _markdown_line_to_bbcode(tail, in_code_block);
+	}
+
+	RichTextLabel *tail_label = ObjectDB::get_instance<RichTextLabel>(markdown_stream.tail_label_id);
+	// A half-typed fence only toggles state; there is nothing to show yet.
+	if (markdown_stream.tail_bbcode.is_empty() || tail.strip_edges().begins_with("```")) {
+		if (tail_label) {
+			tail_label->hide();
 		}
+		return;
 	}
+	if (!tail_label) {
+		Node *parent = p_label->get_parent();
+		ERR_FAIL_NULL(parent);
+		tail_label = memnew(RichTextLabel);
+		tail_label->set_fit_content(true);
+		tail_label->set_selection_enabled(true);
+		tail_label->set_use_bbcode(true);
+		tail_label->set_h_size_flags(Control::SIZE_EXPAND_FILL);
+		parent->add_child(tail_label);
+		parent->move_child(tail_label, p_label->get_index() + 1);
+		markdown_stream.tail_label_id = tail_label->get_instance_id();
+	}
+	// The committed label keeps an open [code] tag for the running block.
+	if (markdown_stream.in_code_block) {
+		tail_label->set_text("[code]" + markdown_stream.tail_bbcode + "[/code]");
+	} else {
+		tail_label->set_text(markdown_stream.tail_bbcode);
+	}
+	tail_label->show();
+}
 
-	return result;
+void AIChatDock::_markdown_stream_finish(const ChatMessage *p_message) {
+	RichTextLabel *label = ObjectDB::get_instance<RichTextLabel>(markdown_stream.label_id);
+	RichTextLabel *tail_label = ObjectDB::get_instance<RichTextLabel>(markdown_stream.tail_label_id);
+
+	if (label) {
+		// The last line is committed even when empty so the result matches
+		// _markdown_to_bbcode(), which joins every line with a line break.
+		String chunk = markdown_stream.has_lines ? "\n" + markdown_stream.tail_bbcode : markdown_stream.tail_bbcode;
+		if (!chunk.is_empty()) {
+			markdown_stream.committed_bbcode += chunk;
+			label->append_text(chunk);
+		}
+	}
+	if (tail_label) {
+		tail_label->queue_free();
+	}
+	if (label && p_message && p_message->content.length() == markdown_stream.source_length) {
+		// Seed the per-message cache so re-renders skip the converter.
+		p_message->bbcode_cache = markdown_stream.committed_bbcode;
+		p_message->bbcode_cache_hash = p_message->content.hash();
+		p_message->bbcode_cache_length = p_message->content.length();
+	}
+	markdown_stream = MarkdownStream();
 }
 
 void AIChatDock::clear_chat_history() {
+	if (save_thread_busy) {
+		_on_background_save_finished();
+	}
 	conversations.clear();
 	current_conversation_index = -1;
+	conversation_store.clear();
 	_queue_delayed_save();
 	_update_conversation_dropdown();
 
 	// Clear UI
-	if (chat_container != nullptr) {
-		for (int i = chat_container->get_child_count() - 1; i >= 0; i--) {
-			Node *child = chat_container->get_child(i);
-			if (child != nullptr) {
-				child->queue_free();
-			}
-		}
-	}
+	_clear_transcript_ui();
 }
 
 void AIChatDock::clear_current_conversation() {
@@ -5287,14 +5378,7 @@ void AIChatDock::clear_current_conversation() {
 		_queue_delayed_save();
 
 		// Clear UI
-		if (chat_container != nullptr) {
-			for (int i = chat_container->get_child_count() - 1; i >= 0; i--) {
-				Node *child = chat_container->get_child(i);
-				if (child != nullptr) {
-					child->queue_free();
-				}
-			}
-		}
+		_clear_transcript_ui();
 	}
 }
 
@@ -5312,6 +5396,23 @@ void AIChatDock::set_model(const String &p_model) {
 	model = p_model;
 }
 
+int AIChatDock::_get_context_token_budget() const {
+	// `ai_chat/context_token_budgets` maps model names to budgets and wins over
+	// the single `ai_chat/context_token_budget`; otherwise the model's context
+	// window minus room for the response is used.
+	EditorSettings *settings = EditorSettings::get_singleton();
+	if (settings && settings->has_setting("ai_chat/context_token_budgets")) {
+		Dictionary budgets = settings->get_setting("ai_chat/context_token_budgets");
+		if (budgets.has(model)) {
+			return budgets[model];
+		}
+	}
+	if (settings && settings->has_setting("ai_chat/context_token_budget")) {
+		return settings->get_setting("ai_chat/context_token_budget");
+	}
+	return AIContextPacker::get_model_context_window(model) - AIContextPacker::DEFAULT_RESPONSE_RESERVE;
+}
+
 void AIChatDock::_save_layout_to_config(Ref<ConfigFile> p_layout, const String &p_section) const {
     // Force saving local endpoint during development
     // Persist the resolved endpoint for UX; will be recalculated next session as well
@@ -5345,257 +5446,141 @@ void AIChatDock::_load_layout_from_config(Ref<ConfigFile> p_layout, const String
 
 // Conversation management methods
 void AIChatDock::_load_conversations() {
-    // Recover from temp file if present and final missing
-    String final_path = conversations_file_path;
-    String base_dir = final_path.get_base_dir();
-    String final_name = final_path.get_file();
-    String temp_name = final_name + ".tmp";
-    String temp_path = base_dir.path_join(temp_name);
-
-    // Fallback: also check project settings dir (some distributions differ)
-    String alt_final_path = final_path;
-    if (EditorPaths::get_singleton() && EditorPaths::get_singleton()->are_paths_valid()) {
-        alt_final_path = EditorPaths::get_singleton()->get_project_settings_dir().path_join("ai_chat_conversations.simplifine");
-    }
+	conversations.clear();
+	conversation_store.set_root(conversations_file_path.get_base_dir().path_join("ai_chat_conversations"));
+
+	if (!conversation_store.has_index()) {
+		// Import the legacy single-file store once, then keep it as a backup.
+		if (_load_legacy_conversations(conversations_file_path)) {
+			_save_conversations();
+			if (conversation_store.has_index()) {
+				DirAccess::rename_absolute(conversations_file_path, conversations_file_path + ".migrated");
+				print_line("AI Chat: Migrated " + itos(conversations.size()) + " conversations to " + conversation_store.get_root());
+			}
+		}
+		return;
+	}
 
-    if (!FileAccess::exists(final_path) && FileAccess::exists(temp_path)) {
-        Ref<DirAccess> da = DirAccess::open(base_dir);
-        if (da.is_valid()) {
-            da->rename(temp_name, final_name);
-        }
-    }
+	// Only the index is read here; messages are loaded when a conversation is opened.
+	Array index;
+	if (conversation_store.load_index(index) == OK) {
+		for (int i = 0; i < index.size(); i++) {
+			const Dictionary entry = index[i];
+			Conversation conv;
+			conv.id = entry.get("id", "");
+			conv.title = entry.get("title", "");
+			conv.created_timestamp = entry.get("created_timestamp", "");
+			conv.last_modified_timestamp = entry.get("last_modified_timestamp", "");
+			conv.stored_message_count = entry.get("message_count", 0);
+			conv.loaded = false;
+			conversations.push_back(conv);
+		}
+	} else {
+		// Keep the journals reachable even if the index is unreadable.
+		const PackedStringArray logs = DirAccess::get_files_at(conversation_store.get_root().path_join("logs"));
+		for (const String &log : logs) {
+			if (log.get_extension() != "log") {
+				continue;
+			}
+			Conversation conv;
+			conv.id = log.get_basename();
+			conv.title = "Recovered Conversation";
+			conv.loaded = false;
+			conversations.push_back(conv);
+		}
+		print_line("AI Chat: Failed to read conversation index, recovered " + itos(conversations.size()) + " conversations");
+	}
+	print_line("AI Chat: Loaded conversation index: " + itos(conversations.size()) + " from: " + conversation_store.get_root());
+}
 
-    if (!FileAccess::exists(final_path)) {
-        if (FileAccess::exists(alt_final_path)) {
-            final_path = alt_final_path; // load from alternative location
-            base_dir = final_path.get_base_dir();
-            final_name = final_path.get_file();
-            temp_name = final_name + ".tmp";
-            temp_path = base_dir.path_join(temp_name);
-        } else {
-            print_line("AI Chat: Conversations file not found at: " + conversations_file_path);
-            return;
-        }
-    }
+bool AIChatDock::_load_legacy_conversations(const String &p_path) {
+	// Recover from temp file if present and final missing
+	const String temp_path = p_path + ".tmp";
+	if (!FileAccess::exists(p_path) && FileAccess::exists(temp_path)) {
+		DirAccess::rename_absolute(temp_path, p_path);
+	}
+	if (!FileAccess::exists(p_path)) {
+		return false;
+	}
 
-    Error err;
-    String file_content = FileAccess::get_file_as_string(final_path, &err);
-    if (err != OK) {
-        print_line("AI Chat: Failed to load conversations file");
-        return;
-    }
+	auto parse_json_file = [](const String &p_file, Dictionary &r_out) -> bool {
+		Error err;
+		const String text = FileAccess::get_file_as_string(p_file, &err);
+		if (err != OK) {
+			return false;
+		}
+		Ref<JSON> json;
+		json.instantiate();
+		if (json->parse(text) != OK || json->get_data().get_type() != Variant::DICTIONARY) {
+			return false;
+		}
+		r_out = json->get_data();
+		return true;
+	};
 
-    auto parse_json_string = [](const String &p_json, Dictionary &r_out) -> bool {
-        Ref<JSON> json;
-        json.instantiate();
-        Error perr = json->parse(p_json);
-        if (perr != OK) {
-            return false;
-        }
-        r_out = json->get_data();
-        return true;
-    };
-
-    Dictionary data;
-    bool parsed = parse_json_string(file_content, data);
-    if (!parsed && FileAccess::exists(temp_path)) {
-        // Try temp as fallback
-        String tmp_content = FileAccess::get_file_as_string(temp_path, &err);
-        if (err == OK) {
-            parsed = parse_json_string(tmp_content, data);
-        }
-    }
-    if (!parsed) {
-        print_line("AI Chat: Failed to parse conversations file (and temp fallback)");
-        return;
-    }
+	Dictionary data;
+	if (!parse_json_file(p_path, data) && !(FileAccess::exists(temp_path) && parse_json_file(temp_path, data))) {
+		print_line("AI Chat: Failed to parse conversations file (and temp fallback)");
+		return false;
+	}
+	if (!data.has("conversations")) {
+		print_line("AI Chat: Conversations key missing in file: " + p_path);
+		return false;
+	}
 
-    if (!data.has("conversations")) {
-        print_line("AI Chat: Conversations key missing in file: " + final_path);
-        return;
-    }
+	Array conversations_array = data["conversations"];
+	for (int i = 0; i < conversations_array.size(); i++) {
+		Dictionary conv_dict = conversations_array[i];
+		Conversation conv;
+		conv.id = conv_dict.get("id", "");
+		conv.title = conv_dict.get("title", "");
+		conv.created_timestamp = conv_dict.get("created_timestamp", "");
+		conv.last_modified_timestamp = conv_dict.get("last_modified_timestamp", "");
 
-    Array conversations_array = data["conversations"];
-    conversations.clear();
-
-    for (int i = 0; i < conversations_array.size(); i++) {
-        Dictionary conv_dict = conversations_array[i];
-        AIChatDock::Conversation conv;
-        conv.id = conv_dict.get("id", "");
-        conv.title = conv_dict.get("title", "");
-        conv.created_timestamp = conv_dict.get("created_timestamp", "");
-        conv.last_modified_timestamp = conv_dict.get("last_modified_timestamp", "");
-
-        Array messages_array = conv_dict.get("messages", Array());
-        for (int j = 0; j < messages_array.size(); j++) {
-            Dictionary msg_dict = messages_array[j];
-            AIChatDock::ChatMessage msg;
-            msg.role = msg_dict.get("role", "");
-            msg.content = msg_dict.get("content", "");
-            msg.timestamp = msg_dict.get("timestamp", "");
-            msg.tool_calls = msg_dict.get("tool_calls", Array());
-            msg.tool_call_id = msg_dict.get("tool_call_id", "");
-            msg.name = msg_dict.get("name", "");
-
-            // Load attached files
-            Array attached_files_array = msg_dict.get("attached_files", Array());
-            for (int k = 0; k < attached_files_array.size(); k++) {
-                Dictionary file_dict = attached_files_array[k];
-                AIChatDock::AttachedFile file;
-                file.path = file_dict.get("path", "");
-                file.name = file_dict.get("name", "");
-                file.content = file_dict.get("content", "");
-                file.is_image = file_dict.get("is_image", false);
-                file.mime_type = file_dict.get("mime_type", "");
-                file.base64_data = file_dict.get("base64_data", "");
-                // Support v2 array sizes and v1 x/y sizes
-                if (file_dict.has("original_size")) {
-                    Array os = file_dict.get("original_size", Array());
-                    if (os.size() >= 2) {
-                        file.original_size.x = int(os[0]);
-                        file.original_size.y = int(os[1]);
-                    }
-                } else {
-                    file.original_size.x = file_dict.get("original_size_x", 0);
-                    file.original_size.y = file_dict.get("original_size_y", 0);
-                }
-                if (file_dict.has("display_size")) {
-                    Array ds = file_dict.get("display_size", Array());
-                    if (ds.size() >= 2) {
-                        file.display_size.x = int(ds[0]);
-                        file.display_size.y = int(ds[1]);
-                    }
-                } else {
-                    file.display_size.x = file_dict.get("display_size_x", 0);
-                    file.display_size.y = file_dict.get("display_size_y", 0);
-                }
-                file.was_downsampled = file_dict.get("was_downsampled", false);
-                file.is_node = file_dict.get("is_node", false);
-                file.node_path = file_dict.get("node_path", NodePath());
-                file.node_type = file_dict.get("node_type", "");
-                msg.attached_files.push_back(file);
-            }
+		Array messages_array = conv_dict.get("messages", Array());
+		for (int j = 0; j < messages_array.size(); j++) {
+			conv.messages.push_back(_dict_to_message(messages_array[j]));
+		}
+		conversations.push_back(conv);
+	}
+	print_line("AI Chat: Loaded conversations: " + itos(conversations.size()) + " from: " + p_path);
+	return !conversations.is_empty();
+}
 
-            // Load tool results
-            msg.tool_results = msg_dict.get("tool_results", Array());
+bool AIChatDock::_ensure_conversation_loaded(int p_index) {
+	if (p_index < 0 || p_index >= conversations.size()) {
+		return false;
+	}
+	if (conversations[p_index].loaded) {
+		return true;
+	}
 
-            conv.messages.push_back(msg);
-        }
-        conversations.push_back(conv);
-    }
-    print_line("AI Chat: Loaded conversations: " + itos(conversations.size()) + " from: " + final_path);
+	Conversation &conv = conversations.write[p_index];
+	Array stored;
+	const Error err = conversation_store.load_messages(conv.id, stored);
+	if (err != OK) {
+		print_line("AI Chat: Failed to load conversation " + conv.id + ": " + itos(err));
+	}
+	conv.messages.clear();
+	conv.messages.resize(stored.size());
+	for (int i = 0; i < stored.size(); i++) {
+		conv.messages.write[i] = _dict_to_message(stored[i]);
+	}
+	conv.loaded = true;
+	conv.saved_count = conv.messages.size();
+	conv.saved_tail_hash = conv.messages.is_empty() ? 0 : _get_message_fingerprint(conv.messages[conv.messages.size() - 1]);
+	conv.stored_message_count = conv.messages.size();
+	return err == OK;
 }
 
 void AIChatDock::_save_conversations() {
-    Dictionary data;
-    data["version"] = 2;
-    Array conversations_array;
-
-    for (int i = 0; i < conversations.size(); i++) {
-        const AIChatDock::Conversation &conv = conversations[i];
-        Dictionary conv_dict;
-        conv_dict["id"] = conv.id;
-        conv_dict["title"] = conv.title;
-        conv_dict["created_timestamp"] = conv.created_timestamp;
-        conv_dict["last_modified_timestamp"] = conv.last_modified_timestamp;
-
-        Array messages_array;
-        for (int j = 0; j < conv.messages.size(); j++) {
-            const ChatMessage &msg = conv.messages[j];
-            Dictionary msg_dict;
-            msg_dict["role"] = msg.role;
-            msg_dict["content"] = msg.content;
-            msg_dict["timestamp"] = msg.timestamp;
-            msg_dict["tool_calls"] = msg.tool_calls;
-            msg_dict["tool_call_id"] = msg.tool_call_id;
-            msg_dict["name"] = msg.name;
-            msg_dict["tool_results"] = msg.tool_results;
-
-            // Save attached files
-            Array attached_files_array;
-            for (int k = 0; k < msg.attached_files.size(); k++) {
-                const AttachedFile &file = msg.attached_files[k];
-                Dictionary file_dict;
-                file_dict["path"] = file.path;
-                file_dict["name"] = file.name;
-                file_dict["content"] = file.content;
-                file_dict["is_image"] = file.is_image;
-                file_dict["mime_type"] = file.mime_type;
-                file_dict["base64_data"] = file.base64_data;
-                // v2 array sizes + v1 compatibility keys
-                Array os;
-                os.push_back(file.original_size.x);
-                os.push_back(file.original_size.y);
-                file_dict["original_size"] = os;
-                Array ds;
-                ds.push_back(file.display_size.x);
-                ds.push_back(file.display_size.y);
-                file_dict["display_size"] = ds;
-                file_dict["original_size_x"] = file.original_size.x;
-                file_dict["original_size_y"] = file.original_size.y;
-                file_dict["display_size_x"] = file.display_size.x;
-                file_dict["display_size_y"] = file.display_size.y;
-                file_dict["was_downsampled"] = file.was_downsampled;
-                file_dict["is_node"] = file.is_node;
-                file_dict["node_path"] = file.node_path;
-                file_dict["node_type"] = file.node_type;
-                attached_files_array.push_back(file_dict);
-            }
-            msg_dict["attached_files"] = attached_files_array;
-
-            messages_array.push_back(msg_dict);
-        }
-        conv_dict["messages"] = messages_array;
-        conversations_array.push_back(conv_dict);
-    }
-
-    data["conversations"] = conversations_array;
-
-    Ref<JSON> json;
-    json.instantiate();
-    String json_string = json->stringify(data, "  ");
-
-    // Safe write via temp + rename
-    Error err;
-    String final_path = conversations_file_path;
-    String base_dir = final_path.get_base_dir();
-    String final_name = final_path.get_file();
-    String temp_name = final_name + ".tmp";
-    String temp_path = base_dir.path_join(temp_name);
-
-    // Ensure destination directory exists
-    {
-        Ref<DirAccess> da_mk = DirAccess::create_for_path(base_dir);
-        if (da_mk.is_valid() && !da_mk->dir_exists(base_dir)) {
-            da_mk->make_dir_recursive(base_dir);
-        }
-    }
-
-    {
-        Ref<FileAccess> tmp = FileAccess::open(temp_path, FileAccess::WRITE, &err);
-        if (err != OK) {
-            print_line("AI Chat: Failed to open temp file for save");
-            return;
-        }
-        tmp->store_string(json_string);
-        tmp->close();
-    }
-
-    Ref<DirAccess> da = DirAccess::open(base_dir);
-    if (da.is_valid()) {
-        if (da->file_exists(final_name)) {
-            da->remove(final_name);
-        }
-        da->rename(temp_name, final_name);
-    } else {
-        Ref<FileAccess> file = FileAccess::open(final_path, FileAccess::WRITE, &err);
-        if (err != OK) {
-            print_line("AI Chat: Failed to save conversations file");
-            return;
-        }
-        file->store_string(json_string);
-        file->close();
-    }
+	// Synchronous variant, used on exit and for migration.
+	if (conversation_store.get_root().is_empty()) {
+		return;
+	}
+	ConversationSaveJob *job = _build_save_job();
+	job->write();
+	_finish_save_job(job);
 }
 
 void AIChatDock::_create_new_conversation() {
@@ -5610,14 +5595,7 @@ void AIChatDock::_create_new_conversation() {
 	// Don't save immediately - defer for better UI responsiveness
 	
 	// Clear UI for new conversation
-	if (chat_container != nullptr) {
-		for (int i = chat_container->get_child_count() - 1; i >= 0; i--) {
-			Node *child = chat_container->get_child(i);
-			if (child != nullptr) {
-				child->queue_free();
-			}
-		}
-	}
+	_clear_transcript_ui();
 }
 
 void AIChatDock::_create_new_conversation_instant() {
@@ -5633,14 +5611,7 @@ void AIChatDock::_create_new_conversation_instant() {
 	// Note: Save is deferred in caller
 	
 	// Clear UI for new conversation
-	if (chat_container != nullptr) {
-		for (int i = chat_container->get_child_count() - 1; i >= 0; i--) {
-			Node *child = chat_container->get_child(i);
-			if (child != nullptr) {
-				child->queue_free();
-			}
-		}
-	}
+	_clear_transcript_ui();
 }
 
 void AIChatDock::_switch_to_conversation(int p_index) {
@@ -5649,16 +5620,10 @@ void AIChatDock::_switch_to_conversation(int p_index) {
 	}
 	
 	current_conversation_index = p_index;
+	_ensure_conversation_loaded(p_index);
 	
 	// Clear current UI
-	if (chat_container != nullptr) {
-		for (int i = chat_container->get_child_count() - 1; i >= 0; i--) {
-			Node *child = chat_container->get_child(i);
-			if (child != nullptr) {
-				child->queue_free();
-			}
-		}
-	}
+	_clear_transcript_ui();
 	
 	// Rebuild UI from conversation messages with proper tool call handling
 	const Vector<AIChatDock::ChatMessage> &messages = conversations[p_index].messages;
@@ -5710,6 +5675,7 @@ String AIChatDock::_generate_conversation_title(const Vector<AIChatDock::ChatMes
 Vector<AIChatDock::ChatMessage> &AIChatDock::_get_current_chat_history() {
 	static Vector<AIChatDock::ChatMessage> empty_history;
 	if (current_conversation_index >= 0 && current_conversation_index < conversations.size()) {
+		_ensure_conversation_loaded(current_conversation_index);
 		return conversations.write[current_conversation_index].messages;
 	}
 	return empty_history;
@@ -5762,9 +5728,6 @@ AIChatDock::AIChatDock() {
 	// Enable drag and drop for the dock
 	set_drag_forwarding(Callable(), callable_mp(this, &AIChatDock::can_drop_data_fw), callable_mp(this, &AIChatDock::drop_data_fw));
 
-	// HTTP client for streaming API calls
-	http_client = HTTPClient::create();
-	
 	// Timer for deferred saving
 	save_timer = memnew(Timer);
 	save_timer->set_one_shot(true);
@@ -5774,11 +5737,6 @@ AIChatDock::AIChatDock() {
 	// Initialize mutex for background saving
 	save_mutex = memnew(Mutex);
 	
-	// HTTP request for stop requests (non-streaming)
-	stop_http_request = memnew(HTTPRequest);
-	add_child(stop_http_request);
-	stop_http_request->connect("request_completed", callable_mp(this, &AIChatDock::_on_stop_request_completed));
-
 	diff_viewer = memnew(DiffViewer);
 	add_child(diff_viewer);
 	diff_viewer->connect("diff_accepted", callable_mp(this, &AIChatDock::_on_diff_accepted));
@@ -5792,6 +5750,14 @@ AIChatDock::AIChatDock() {
 		print_line("AI Chat Dock: Failed to start tool server on port 8001");
 	}
 	
+	// Local project index used by search_across_project; started once the
+	// editor filesystem is available.
+	project_index = memnew(AIProjectIndex);
+
+	// Versioned view of the edited scene used by the node listing tools.
+	scene_snapshot = memnew(AISceneSnapshot);
+	scene_snapshot->start();
+
 	// Initialize embedding system
 	call_deferred("_initialize_embedding_system");
 }
@@ -5838,68 +5804,6 @@ String AIChatDock::_get_mime_type_from_extension(const String &p_path) {
 	return "text/plain";
 }
 
-bool AIChatDock::_process_image_attachment(AttachedFile &p_file) {
-	Ref<Image> image = Image::load_from_file(p_file.path);
-	if (image.is_null() || image->is_empty()) {
-		return false;
-	}
-
-	Vector2i original_size = Vector2i(image->get_width(), image->get_height());
-	p_file.original_size = original_size;
-	
-	// Check if image needs to be downsampled (max 1024px on any side)
-	const int MAX_DIMENSION = 1024;
-	Vector2i target_size = _calculate_downsampled_size(original_size, MAX_DIMENSION);
-	
-	if (target_size != original_size) {
-		p_file.was_downsampled = true;
-		image->resize(target_size.x, target_size.y, Image::INTERPOLATE_LANCZOS);
-		
-		// Show warning dialog
-		call_deferred("_show_image_warning_dialog", p_file.name, original_size, target_size);
-	}
-	
-	p_file.display_size = target_size;
-	
-	// Convert to base64 for API transmission
-	Vector<uint8_t> png_buffer;
-	if (p_file.mime_type == "image/jpeg" || p_file.mime_type == "image/jpg") {
-		png_buffer = image->save_jpg_to_buffer(0.85f); // Good quality JPEG
-	} else {
-		png_buffer = image->save_png_to_buffer();
-	}
-	
-	if (png_buffer.size() == 0) {
-		return false;
-	}
-	
-	// Encode to base64
-	p_file.base64_data = CoreBind::Marshalls::get_singleton()->raw_to_base64(png_buffer);
-	
-	return true;
-}
-
-Vector2i AIChatDock::_calculate_downsampled_size(const Vector2i &p_original, int p_max_dimension) {
-	if (p_original.x <= p_max_dimension && p_original.y <= p_max_dimension) {
-		return p_original;
-	}
-	
-	float aspect_ratio = (float)p_original.x / (float)p_original.y;
-	Vector2i new_size;
-	
-	if (p_original.x > p_original.y) {
-		// Landscape
-		new_size.x = p_max_dimension;
-		new_size.y = (int)(p_max_dimension / aspect_ratio);
-	} else {
-		// Portrait or square
-		new_size.y = p_max_dimension;
-		new_size.x = (int)(p_max_dimension * aspect_ratio);
-	}
-	
-	return new_size;
-}
-
 void AIChatDock::_show_image_warning_dialog(const String &p_filename, const Vector2i &p_original, const Vector2i &p_new_size) {
 	if (!image_warning_dialog) {
 		return;
@@ -5926,30 +5830,6 @@ void AIChatDock::_handle_generated_image(const String &p_base64_data, const Stri
 }
 
 void AIChatDock::_display_generated_image_deferred(const String &p_base64_data, const String &p_id) {
-	// Decode base64 to image
-	Vector<uint8_t> image_data = CoreBind::Marshalls::get_singleton()->base64_to_raw(p_base64_data);
-	if (image_data.size() == 0) {
-		print_line("AI Chat: Failed to decode generated image data");
-		return;
-	}
-	
-	// Create image from data
-	Ref<Image> generated_image = memnew(Image);
-	Error err = generated_image->load_png_from_buffer(image_data);
-	if (err != OK) {
-		// Try JPEG if PNG fails
-		err = generated_image->load_jpg_from_buffer(image_data);
-		if (err != OK) {
-			print_line("AI Chat: Failed to load generated image");
-			return;
-		}
-	}
-	
-	if (generated_image->is_empty()) {
-		print_line("AI Chat: Generated image is empty");
-		return;
-	}
-	
 	// Safely find the last assistant message bubble without creating new ones
 	PanelContainer *bubble_panel = nullptr;
 	if (chat_container) {
@@ -6062,22 +5942,10 @@ void AIChatDock::_display_generated_image_deferred(const String &p_base64_data,
 	header_label->add_theme_color_override("font_color", get_theme_color(SNAME("accent_color"), SNAME("Editor")));
 	image_container->add_child(header_label);
 	
-	// Resize image for display (max 512px to keep it reasonable)
-	Vector2i original_size = Vector2i(generated_image->get_width(), generated_image->get_height());
-	Vector2i display_size = _calculate_downsampled_size(original_size, 512);
-	
-	if (display_size != original_size) {
-		generated_image->resize(display_size.x, display_size.y, Image::INTERPOLATE_LANCZOS);
-	}
-	
-	// Create texture and display
-	Ref<ImageTexture> generated_texture = ImageTexture::create_from_image(generated_image);
-	
+	// Decoded and downsampled off the main thread (max 512px to keep it reasonable)
 	TextureRect *image_display = memnew(TextureRect);
-	image_display->set_texture(generated_texture);
 	image_display->set_expand_mode(TextureRect::EXPAND_FIT_WIDTH_PROPORTIONAL);
 	image_display->set_stretch_mode(TextureRect::STRETCH_KEEP_ASPECT_CENTERED);
-	image_display->set_custom_minimum_size(Size2(display_size.x, display_size.y));
 	image_container->add_child(image_display);
 	
     // Add image info
@@ -6085,7 +5953,6 @@ void AIChatDock::_display_generated_image_deferred(const String &p_base64_data,
 	image_container->add_child(info_container);
 	
 	Label *size_label = memnew(Label);
-	size_label->set_text(String::num_int64(original_size.x) + "x" + String::num_int64(original_size.y));
 	size_label->add_theme_font_size_override("font_size", 10);
 	size_label->add_theme_color_override("font_color", get_theme_color(SNAME("font_color"), SNAME("Editor")) * Color(1, 1, 1, 0.7));
 	info_container->add_child(size_label);
@@ -6107,6 +5974,7 @@ void AIChatDock::_display_generated_image_deferred(const String &p_base64_data,
 	info_container->add_child(save_button);
 	
 	// Store the generated image in the current message
+	String generated_attachment_name;
 	Vector<AIChatDock::ChatMessage> &chat_history = _get_current_chat_history();
 	print_line("AI Chat: Attempting to save image to chat history, total messages: " + String::num_int64(chat_history.size()));
 	
@@ -6116,18 +5984,17 @@ void AIChatDock::_display_generated_image_deferred(const String &p_base64_data,
 		print_line("AI Chat: Last message current attached files count: " + String::num_int64(last_msg.attached_files.size()));
 		
 		if (last_msg.role == "assistant") {
-					// Add the generated image as an attachment for persistence
-		AIChatDock::AttachedFile generated_file;
-		generated_file.path = "generated://" + p_id;
-		// Create proper unique ID for generated images
-		generated_file.name = "gen_img_" + String::num_int64(OS::get_singleton()->get_ticks_msec());
-		generated_file.is_image = true;
-		generated_file.mime_type = "image/png";
+			// Add the generated image as an attachment for persistence; its sizes
+			// are filled in once the thumbnail has been decoded.
+			AIChatDock::AttachedFile generated_file;
+			generated_file.path = "generated://" + p_id;
+			// Create proper unique ID for generated images
+			generated_file.name = "gen_img_" + String::num_int64(OS::get_singleton()->get_ticks_msec());
+			generated_file.is_image = true;
+			generated_file.mime_type = "image/png";
 			generated_file.base64_data = p_base64_data;
-			generated_file.original_size = original_size;
-			generated_file.display_size = display_size;
-			generated_file.was_downsampled = (display_size != original_size);
-					last_msg.attached_files.push_back(generated_file);
+			generated_attachment_name = generated_file.name;
+			last_msg.attached_files.push_back(generated_file);
 		print_line("AI Chat: Successfully added generated image ID: " + generated_file.name + " to assistant message");
 		} else {
 			print_line("AI Chat: Cannot save image - last message is not from assistant (role: " + last_msg.role + ")");
@@ -6136,6 +6003,8 @@ void AIChatDock::_display_generated_image_deferred(const String &p_base64_data,
 		print_line("AI Chat: Cannot save image - chat history is empty");
 	}
 	
+	_request_image_thumbnail(image_display, size_label, p_base64_data, 512, generated_attachment_name);
+	
 	// Update conversation and scroll
 	if (current_conversation_index >= 0) {
 		conversations.write[current_conversation_index].last_modified_timestamp = _get_timestamp();
@@ -6166,30 +6035,6 @@ void AIChatDock::_display_generated_image_in_tool_result(VBoxContainer *p_contai
 		return;
 	}
 	
-	// Decode base64 to image
-	Vector<uint8_t> image_data = CoreBind::Marshalls::get_singleton()->base64_to_raw(p_base64_data);
-	if (image_data.size() == 0) {
-		print_line("AI Chat: Failed to decode generated image data from tool result");
-		return;
-	}
-	
-	// Create image from data
-	Ref<Image> generated_image = memnew(Image);
-	Error err = generated_image->load_png_from_buffer(image_data);
-	if (err != OK) {
-		// Try JPEG if PNG fails
-		err = generated_image->load_jpg_from_buffer(image_data);
-		if (err != OK) {
-			print_line("AI Chat: Failed to load generated image from tool result");
-			return;
-		}
-	}
-	
-	if (generated_image->is_empty()) {
-		print_line("AI Chat: Generated image from tool result is empty");
-		return;
-	}
-	
 	// Create image display container
 	VBoxContainer *image_container = memnew(VBoxContainer);
 	p_container->add_child(image_container);
@@ -6215,22 +6060,10 @@ void AIChatDock::_display_generated_image_in_tool_result(VBoxContainer *p_contai
     prompt_label->set_custom_minimum_size(Size2(0, 0));
 	prompt_container->add_child(prompt_label);
 	
-	// Resize image for display (max 200px in tool results to keep them compact)
-	Vector2i original_size = Vector2i(generated_image->get_width(), generated_image->get_height());
-	Vector2i display_size = _calculate_downsampled_size(original_size, 200);
-	
-	if (display_size != original_size) {
-		generated_image->resize(display_size.x, display_size.y, Image::INTERPOLATE_LANCZOS);
-	}
-	
-	// Create texture and display
-	Ref<ImageTexture> generated_texture = ImageTexture::create_from_image(generated_image);
-	
+	// Decoded and downsampled off the main thread (max 200px in tool results to keep them compact)
 	TextureRect *image_display = memnew(TextureRect);
-	image_display->set_texture(generated_texture);
 	image_display->set_expand_mode(TextureRect::EXPAND_FIT_WIDTH_PROPORTIONAL);
 	image_display->set_stretch_mode(TextureRect::STRETCH_KEEP_ASPECT_CENTERED);
-	image_display->set_custom_minimum_size(Size2(display_size.x, display_size.y));
 	image_container->add_child(image_display);
 	
 	// Add technical details and save button
@@ -6238,10 +6071,10 @@ void AIChatDock::_display_generated_image_in_tool_result(VBoxContainer *p_contai
 	image_container->add_child(tech_container);
 	
 	Label *size_label = memnew(Label);
-	size_label->set_text(String::num_int64(original_size.x) + "x" + String::num_int64(original_size.y));
 	size_label->add_theme_font_size_override("font_size", 10);
 	size_label->add_theme_color_override("font_color", get_theme_color(SNAME("font_color"), SNAME("Editor")) * Color(1, 1, 1, 0.7));
 	tech_container->add_child(size_label);
+	_request_image_thumbnail(image_display, size_label, p_base64_data, 200);
 	
 	Label *model_label = memnew(Label);
 	String model = p_data.get("model", "DALL-E");
@@ -6267,32 +6100,56 @@ void AIChatDock::_display_generated_image_in_tool_result(VBoxContainer *p_contai
 	tech_container->add_child(save_button);
 }
 
-void AIChatDock::_display_image_unified(VBoxContainer *p_container, const String &p_base64_data, const Dictionary &p_metadata) {
-	if (!p_container || p_base64_data.is_empty()) {
+void AIChatDock::_request_image_thumbnail(TextureRect *p_display, Label *p_size_label, const String &p_base64_data, int p_max_size, const String &p_attachment_name) {
+	// Reserve a square slot so the bubble does not jump much when the texture arrives.
+	p_display->set_custom_minimum_size(Size2(p_max_size, p_max_size) * 0.5);
+	p_size_label->set_text(TTR("Loading image..."));
+	AIImagePipeline::request_thumbnail(p_base64_data, p_max_size, callable_mp(this, &AIChatDock::_on_image_thumbnail_ready).bind(p_display->get_instance_id(), p_size_label->get_instance_id(), p_attachment_name));
+}
+
+void AIChatDock::_on_image_thumbnail_ready(const Dictionary &p_result, ObjectID p_display, ObjectID p_size_label, const String &p_attachment_name) {
+	// The bubble may have been rebuilt or freed while the image was decoding.
+	TextureRect *image_display = ObjectDB::get_instance<TextureRect>(p_display);
+	Label *size_label = ObjectDB::get_instance<Label>(p_size_label);
+	if (!bool(p_result.get("success", false))) {
+		print_line("AI Chat: " + String(p_result.get("message", "Failed to load image")));
+		if (size_label) {
+			size_label->set_text(TTR("Failed to load image"));
+		}
 		return;
 	}
-	
-	// Decode base64 to image
-	Vector<uint8_t> image_data = CoreBind::Marshalls::get_singleton()->base64_to_raw(p_base64_data);
-	if (image_data.size() == 0) {
-		print_line("AI Chat: Failed to decode image data");
+
+	const Vector2i original_size = p_result["original_size"];
+	const Vector2i display_size = p_result["display_size"];
+	if (image_display) {
+		image_display->set_texture(p_result["texture"]);
+		image_display->set_custom_minimum_size(Size2(display_size.x, display_size.y));
+	}
+	if (size_label) {
+		size_label->set_text(String::num_int64(original_size.x) + "x" + String::num_int64(original_size.y));
+	}
+
+	if (p_attachment_name.is_empty()) {
 		return;
 	}
-	
-	// Create image from data
-	Ref<Image> display_image = memnew(Image);
-	Error err = display_image->load_png_from_buffer(image_data);
-	if (err != OK) {
-		// Try JPEG if PNG fails
-		err = display_image->load_jpg_from_buffer(image_data);
-		if (err != OK) {
-			print_line("AI Chat: Failed to load image");
+	Vector<AIChatDock::ChatMessage> &chat_history = _get_current_chat_history();
+	for (int i = chat_history.size() - 1; i >= 0; i--) {
+		for (int j = 0; j < chat_history[i].attached_files.size(); j++) {
+			if (chat_history[i].attached_files[j].name != p_attachment_name) {
+				continue;
+			}
+			AttachedFile &file = chat_history.write[i].attached_files.write[j];
+			file.original_size = original_size;
+			file.display_size = display_size;
+			file.was_downsampled = display_size != original_size;
+			_queue_delayed_save();
 			return;
 		}
 	}
-	
-	if (display_image->is_empty()) {
-		print_line("AI Chat: Image is empty");
+}
+
+void AIChatDock::_display_image_unified(VBoxContainer *p_container, const String &p_base64_data, const Dictionary &p_metadata) {
+	if (!p_container || p_base64_data.is_empty()) {
 		return;
 	}
 	
@@ -6330,22 +6187,10 @@ void AIChatDock::_display_image_unified(VBoxContainer *p_container, const String
     title_label->add_theme_color_override("font_color", get_theme_color(SNAME("accent_color"), SNAME("Editor")));
     title_vbox->add_child(title_label);
 	
-	// Resize image for display
-	Vector2i original_size = Vector2i(display_image->get_width(), display_image->get_height());
-	Vector2i display_size = _calculate_downsampled_size(original_size, max_display_size);
-	
-	if (display_size != original_size) {
-		display_image->resize(display_size.x, display_size.y, Image::INTERPOLATE_LANCZOS);
-	}
-	
-	// Create texture and display
-	Ref<ImageTexture> image_texture = ImageTexture::create_from_image(display_image);
-	
+	// Decoded and downsampled off the main thread; rebuilt transcripts hit the thumbnail cache
 	TextureRect *image_display = memnew(TextureRect);
-	image_display->set_texture(image_texture);
 	image_display->set_expand_mode(TextureRect::EXPAND_FIT_WIDTH_PROPORTIONAL);
 	image_display->set_stretch_mode(TextureRect::STRETCH_KEEP_ASPECT_CENTERED);
-	image_display->set_custom_minimum_size(Size2(display_size.x, display_size.y));
 	image_container->add_child(image_display);
 	
 	// Add technical details and controls
@@ -6354,10 +6199,10 @@ void AIChatDock::_display_image_unified(VBoxContainer *p_container, const String
 	
 	// Size info
 	Label *size_label = memnew(Label);
-	size_label->set_text(String::num_int64(original_size.x) + "x" + String::num_int64(original_size.y));
 	size_label->add_theme_font_size_override("font_size", 10);
 	size_label->add_theme_color_override("font_color", get_theme_color(SNAME("font_color"), SNAME("Editor")) * Color(1, 1, 1, 0.7));
 	details_container->add_child(size_label);
+	_request_image_thumbnail(image_display, size_label, p_base64_data, max_display_size);
 	
 	// Model info (for generated images)
 	if (!model.is_empty()) {
@@ -6434,6 +6279,7 @@ void AIChatDock::_on_save_image_location_selected(const String &p_file_path) {
 	
 	file->store_buffer(image_data);
 	file->close();
+	AIToolCache::notify_files_changed();
 	
 	print_line("AI Chat: Image saved successfully to: " + save_path);
 	
@@ -6790,606 +6636,28 @@ String AIChatDock::get_machine_id() const {
 	return machine_id;
 }
 
-// ========== EMBEDDING SYSTEM IMPLEMENTATION ==========
-
-void AIChatDock::_initialize_embedding_system() {
-    print_line("AI Chat: 🔧 Initializing cloud-based embedding system");
-
-    // Connect to editor file system signals for automatic reindexing
-    // This connection does not require authentication; it only sets up callbacks.
-    if (EditorFileSystem::get_singleton()) {
-        if (!EditorFileSystem::get_singleton()->is_connected("filesystem_changed", callable_mp(this, &AIChatDock::_on_filesystem_changed))) {
-            EditorFileSystem::get_singleton()->connect("filesystem_changed", callable_mp(this, &AIChatDock::_on_filesystem_changed));
-        }
-        if (!EditorFileSystem::get_singleton()->is_connected("sources_changed", callable_mp(this, &AIChatDock::_on_sources_changed))) {
-            EditorFileSystem::get_singleton()->connect("sources_changed", callable_mp(this, &AIChatDock::_on_sources_changed));
-        }
-        print_line("AI Chat: 🔗 Connected to EditorFileSystem change signals (filesystem_changed, sources_changed)");
-    } else {
-        print_line("AI Chat: ⚠️ EditorFileSystem not ready; change signals not connected");
-    }
-
-    // Connect to precise save signals from EditorNode to index only changed files
-    if (EditorNode::get_singleton()) {
-        if (!EditorNode::get_singleton()->is_connected("resource_saved", callable_mp(this, &AIChatDock::_on_editor_resource_saved))) {
-            EditorNode::get_singleton()->connect("resource_saved", callable_mp(this, &AIChatDock::_on_editor_resource_saved), CONNECT_DEFERRED);
-        }
-        if (!EditorNode::get_singleton()->is_connected("scene_saved", callable_mp(this, &AIChatDock::_on_editor_scene_saved))) {
-            EditorNode::get_singleton()->connect("scene_saved", callable_mp(this, &AIChatDock::_on_editor_scene_saved), CONNECT_DEFERRED);
-        }
-        print_line("AI Chat: 🔗 Connected to EditorNode save signals (resource_saved, scene_saved)");
-    }
-
-    // Create HTTPRequest for embedding API calls
-    if (!embedding_request) {
-        embedding_request = memnew(HTTPRequest);
-        add_child(embedding_request);
-        embedding_request->connect("request_completed", callable_mp(this, &AIChatDock::_on_embedding_request_completed));
-    }
-
-    // Setup status timer for animated dots
-    if (!embedding_status_timer) {
-        embedding_status_timer = memnew(Timer);
-        embedding_status_timer->set_wait_time(0.5);
-        embedding_status_timer->set_one_shot(false);
-        embedding_status_timer->connect("timeout", callable_mp(this, &AIChatDock::_on_embedding_status_tick));
-        add_child(embedding_status_timer);
-    }
-
-    // Setup periodic poll timer for background indexing
-    if (!embedding_poll_timer) {
-        embedding_poll_timer = memnew(Timer);
-        embedding_poll_timer->set_wait_time(embedding_poll_seconds);
-        embedding_poll_timer->set_one_shot(false);
-        embedding_poll_timer->connect("timeout", callable_mp(this, &AIChatDock::_on_embedding_poll_tick));
-        add_child(embedding_poll_timer);
-        embedding_poll_timer->start();
-        print_line("AI Chat: ⏱️ Enabled periodic indexing poll every " + String::num_int64(embedding_poll_seconds) + "s");
-    }
-
-    embedding_system_initialized = true;
-    _set_embedding_status("Ready to index", false);
-
-    if (!_is_user_authenticated()) {
-        print_line("AI Chat: ℹ️ Embedding system ready, but user not authenticated (login to enable indexing)");
-        return;
-    }
-
-    // Defer status/indexing to avoid overlapping requests right after init
-    print_line("AI Chat: ✅ Embedding system initialized successfully");
-}
-
-void AIChatDock::_perform_initial_indexing() {
-	print_line("AI Chat: 📚 Starting project indexing...");
-	
-	if (!embedding_system_initialized || !_is_user_authenticated()) {
-        print_line("AI Chat: ❌ Cannot start indexing - system not ready (initialized=" + String(embedding_system_initialized ? "true" : "false") + ", authed=" + String(_is_user_authenticated() ? "true" : "false") + ")");
-		return;
-	}
-	
-	if (embedding_in_progress) {
-		print_line("AI Chat: ⏳ Indexing already in progress");
-		return;
-	}
-	
-	_set_embedding_status("Scanning files", true);
-	
-	// Scan project files and read their contents
-	call_deferred("_scan_and_index_project_files");
-}
-
-void AIChatDock::_send_embedding_request(const String &p_action, const Dictionary &p_data) {
-	if (!embedding_request || embedding_request_busy) {
-		print_line("AI Chat: ❌ Cannot send embedding request - busy or not initialized");
-		return;
-	}
-	
-	String embed_url = _get_embed_base_url() + "/embed";
-	
-	Dictionary request_data;
-	request_data["action"] = p_action;
-	
-	// Always include project_root for all embedding requests
-	request_data["project_root"] = _get_project_root_path();
-	
-	if (!p_data.is_empty()) {
-		for (const Variant *key = p_data.next(); key; key = p_data.next(key)) {
-			request_data[*key] = p_data[*key];
-		}
-	}
-	
-	Ref<JSON> json;
-	json.instantiate();
-	String request_body = json->stringify(request_data);
-	
-	PackedStringArray headers;
-	headers.push_back("Content-Type: application/json");
-	
-	// Add authentication headers
-	if (!auth_token.is_empty()) {
-		headers.push_back("Authorization: Bearer " + auth_token);
-	}
-	headers.push_back("X-User-ID: " + current_user_id);
-	headers.push_back("X-Machine-ID: " + get_machine_id());
-	
-    print_line("AI Chat: 📡 Sending embedding request: " + p_action + " to " + embed_url +
-        " (project_root=" + _get_project_root_path() + ")");
-	
-	embedding_request_busy = true;
-	Error err = embedding_request->request(embed_url, headers, HTTPClient::METHOD_POST, request_body);
-	
-	if (err != OK) {
-		print_line("AI Chat: ❌ Failed to send embedding request: " + String::num_int64(err));
-		embedding_request_busy = false;
-		_set_embedding_status("Request failed", false);
-	}
-}
-
-void AIChatDock::_on_embedding_request_completed(int p_result, int p_code, const PackedStringArray &p_headers, const PackedByteArray &p_body) {
-	embedding_request_busy = false;
-	
-	print_line("AI Chat: 📨 Embedding request completed - Result: " + String::num_int64(p_result) + ", Code: " + String::num_int64(p_code));
-	
-	if (p_result != HTTPRequest::RESULT_SUCCESS || p_code != 200) {
-		String error_msg = "Request failed (" + String::num_int64(p_code) + ")";
-		print_line("AI Chat: ❌ " + error_msg);
-		_set_embedding_status(error_msg, false);
-		return;
-	}
-	
-	String response_text = String::utf8((const char *)p_body.ptr(), p_body.size());
-	
-	Ref<JSON> json;
-	json.instantiate();
-	Error parse_err = json->parse(response_text);
-	
-	if (parse_err != OK) {
-		print_line("AI Chat: ❌ Failed to parse embedding response");
-		_set_embedding_status("Parse error", false);
-		return;
-	}
-	
-	Dictionary response = json->get_data();
-	bool success = response.get("success", false);
-	String action = response.get("action", "");
-	
-	if (!success) {
-		String error = response.get("error", "Unknown error");
-		print_line("AI Chat: ❌ Embedding request failed: " + error);
-		_set_embedding_status("Error: " + error, false);
-		return;
-	}
-	
-	print_line("AI Chat: ✅ Embedding action '" + action + "' completed successfully");
-	
-	if (action == "index_project") {
-		Dictionary stats = response.get("stats", Dictionary());
-		int total = stats.get("total", 0);
-		int indexed = stats.get("indexed", 0);
-		int skipped = stats.get("skipped", 0);
-		
-		String status_text = "Indexed " + String::num_int64(indexed) + "/" + String::num_int64(total) + " files";
-		if (skipped > 0) {
-			status_text += " (" + String::num_int64(skipped) + " skipped)";
-		}
-		
-		_set_embedding_status(status_text, false);
-		initial_indexing_done = true;
-		
-		print_line("AI Chat: 🎉 Project indexing completed - " + status_text);
-		
-	} else if (action == "index_files") {
-		// Handle batch processing response
-		Dictionary stats = response.get("stats", Dictionary());
-		int batch_indexed = stats.get("indexed", 0);
-		int batch_skipped = stats.get("skipped", 0);
-		int batch_failed = stats.get("failed", 0);
-		
-		print_line("AI Chat: ✅ Batch completed - indexed: " + String::num_int64(batch_indexed) + ", skipped: " + String::num_int64(batch_skipped) + ", failed: " + String::num_int64(batch_failed));
-		
-		// Check if we need to send more batches
-		if (current_batch_info.has("current_batch") && current_batch_info.has("total_batches")) {
-			int current_batch = current_batch_info["current_batch"];
-			int total_batches = current_batch_info["total_batches"];
-			
-			if (current_batch < total_batches) {
-				// Send next batch
-				int next_batch = current_batch + 1;
-				int start_index = current_batch_info["start_index"];
-				int batch_size = current_batch_info["batch_size"];
-				Array all_files = current_batch_info["all_files"];
-				
-				int next_start_index = start_index + batch_size;
-				
-				_set_embedding_status("Indexing files (batch " + String::num_int64(next_batch) + "/" + String::num_int64(total_batches) + ")", true);
-				call_deferred("_send_file_batch", all_files, next_start_index, batch_size, next_batch, total_batches);
-			} else {
-				// All batches completed
-				_set_embedding_status("All files indexed successfully", false);
-				initial_indexing_done = true;
-				print_line("AI Chat: 🎉 All file batches completed successfully");
-			}
-		}
-		
-	} else if (action == "status") {
-		Dictionary stats = response.get("stats", Dictionary());
-		int files_indexed = stats.get("files_indexed", 0);
-		int total_chunks = stats.get("total_chunks", 0);
-		
-		if (files_indexed > 0) {
-			String status_text = String::num_int64(files_indexed) + " files indexed (" + String::num_int64(total_chunks) + " chunks)";
-			_set_embedding_status(status_text, false);
-			initial_indexing_done = true;
-		} else {
-			_set_embedding_status("No files indexed", false);
-			initial_indexing_done = false;
-		}
-		
-	} else if (action == "clear") {
-		_set_embedding_status("Index cleared", false);
-		initial_indexing_done = false;
-	}
-}
-
-String AIChatDock::_get_project_root_path() {
-	return ProjectSettings::get_singleton()->globalize_path("res://");
-}
-
-String AIChatDock::_get_embed_base_url() {
-	// Use same endpoint as chat but for embedding operations
-	String base_url = api_endpoint;
-	
-	// Remove /chat suffix if present and replace with embedding endpoint
-	if (base_url.ends_with("/chat")) {
-		base_url = base_url.substr(0, base_url.length() - 5);
-	}
-	
-	return base_url;
-}
-
-void AIChatDock::_set_embedding_status(const String &p_text, bool p_busy) {
-	if (!embedding_status_label) {
-		return;
-	}
-	
-	embedding_in_progress = p_busy;
-	embedding_status_base = p_text;
-	embedding_status_dots = 0;
-	
-	if (p_busy) {
-		embedding_status_label->set_text(p_text + "...");
-		embedding_status_label->set_modulate(Color(1.0, 0.8, 0.0)); // Yellow for in-progress
-		if (embedding_status_timer) {
-			embedding_status_timer->start();
-		}
-	} else {
-		embedding_status_label->set_text(p_text);
-		embedding_status_label->set_modulate(Color(0.7, 0.7, 0.7)); // Gray for idle
-		if (embedding_status_timer) {
-			embedding_status_timer->stop();
-		}
-	}
-}
-
-void AIChatDock::_on_embedding_status_tick() {
-	if (!embedding_in_progress || !embedding_status_label) {
-		return;
-	}
-	
-	embedding_status_dots = (embedding_status_dots + 1) % 4;
-	String dots = "";
-	for (int i = 0; i < embedding_status_dots; i++) {
-		dots += ".";
-	}
-	
-	embedding_status_label->set_text(embedding_status_base + dots);
-}
-
-bool AIChatDock::_should_index_file(const String &p_file_path) {
-	// Use same logic as the cloud vector manager
-	String ext = p_file_path.get_extension().to_lower();
-	
-	// Skip binary files
-	PackedStringArray binary_exts = PackedStringArray();
-	binary_exts.push_back("png");
-	binary_exts.push_back("jpg");
-	binary_exts.push_back("jpeg");
-	binary_exts.push_back("gif");
-	binary_exts.push_back("bmp");
-	binary_exts.push_back("webp");
-	binary_exts.push_back("mp3");
-	binary_exts.push_back("wav");
-	binary_exts.push_back("ogg");
-	binary_exts.push_back("mp4");
-	binary_exts.push_back("avi");
-	binary_exts.push_back("mov");
-	binary_exts.push_back("exe");
-	binary_exts.push_back("dll");
-	binary_exts.push_back("so");
-	binary_exts.push_back("dylib");
-	
-	if (binary_exts.has(ext)) {
-		return false;
-	}
-	
-	// Skip hidden files and system directories
-	String filename = p_file_path.get_file();
-	if (filename.begins_with(".")) {
-		return false;
-	}
-	
-	return true;
-}
-
-void AIChatDock::_update_file_embedding(const String &p_file_path) {
-	if (!embedding_system_initialized || !_should_index_file(p_file_path)) {
-		return;
-	}
-	
-	Dictionary payload;
-	payload["file_path"] = p_file_path;
-	payload["project_root"] = _get_project_root_path();
-	
-	_send_embedding_request("index_file", payload);
-}
-
-void AIChatDock::_remove_file_embedding(const String &p_file_path) {
-	if (!embedding_system_initialized) {
-		return;
-	}
-	
-	Dictionary payload;
-	payload["file_path"] = p_file_path;
-	payload["project_root"] = _get_project_root_path();
-	
-	_send_embedding_request("remove_file", payload);
-}
-
-void AIChatDock::_on_filesystem_changed() {
-    print_line("AI Chat: 📁 filesystem_changed signal received");
-    // Only rely on per-file saved signals for accuracy; skip project-wide reindex on generic FS changes.
-    pending_fs_changes = true;
-}
-
-void AIChatDock::_on_sources_changed(bool p_exist) {
-    // Called when source files change
-    print_line("AI Chat: 📝 sources_changed signal received (exist=" + String(p_exist ? "true" : "false") + ")");
-    // Do nothing here; precise per-file handlers will trigger indexing.
-}
-
-void AIChatDock::_on_editor_resource_saved(Object *p_res) {
-    if (!p_res) {
-        return;
-    }
-    Ref<Resource> res = Ref<Resource>(Object::cast_to<Resource>(p_res));
-    if (res.is_null()) {
-        return;
-    }
-    String path = res->get_path();
-    if (path.is_empty()) {
-        return;
-    }
-    print_line("AI Chat: 💾 resource_saved -> " + path);
-    // Always queue for periodic batch to avoid immediate requests
-    String abs_path_res = ProjectSettings::get_singleton()->globalize_path(path);
-    if (_should_index_file(abs_path_res)) {
-        pending_changed_files.insert(abs_path_res);
-        pending_fs_changes = true;
-        // Optional: surface status as queued (non-blocking)
-        _set_embedding_status("Queued file for indexing", false);
-    }
-}
-
-void AIChatDock::_on_editor_scene_saved(const String &p_path) {
-    print_line("AI Chat: 💾 scene_saved -> " + p_path);
-    // Always queue for periodic batch to avoid immediate requests
-    String abs_path = ProjectSettings::get_singleton()->globalize_path(p_path);
-    if (_should_index_file(abs_path)) {
-        pending_changed_files.insert(abs_path);
-        pending_fs_changes = true;
-        _set_embedding_status("Queued file for indexing", false);
-    }
-}
-
-void AIChatDock::_on_embedding_poll_tick() {
-    if (!embedding_system_initialized || !_is_user_authenticated() || embedding_request_busy) {
-        return;
-    }
-    // Prefer batching changed files; otherwise do lightweight incremental project scan
-    if (!pending_changed_files.is_empty()) {
-        // Batch changed files using cloud-ready endpoint to minimize requests
-        Array files_arr;
-        for (const String &abs_path : pending_changed_files) {
-            // Read file contents and hash (same as bulk flow)
-            Dictionary file_data = _read_file_for_indexing(abs_path, _get_project_root_path());
-            if (!file_data.is_empty()) {
-                files_arr.push_back(file_data);
-            }
-        }
-        pending_changed_files.clear();
-        if (!files_arr.is_empty()) {
-            Dictionary payload;
-            payload["files"] = files_arr;
-            Dictionary batch_info;
-            batch_info["current"] = 1;
-            batch_info["total"] = 1;
-            batch_info["files_in_batch"] = files_arr.size();
-            payload["batch_info"] = batch_info;
-            _set_embedding_status("Indexing changed files", true);
-            _send_embedding_request("index_files", payload);
-            last_index_request_ms = OS::get_singleton()->get_ticks_msec();
-            return;
-        }
-    }
-    // If there were FS changes but nothing queued, do an incremental project index
-    if (pending_fs_changes) {
-        Dictionary payload;
-        payload["project_root"] = _get_project_root_path();
-        payload["force_reindex"] = false;
-        _set_embedding_status("Indexing changes", true);
-        _send_embedding_request("index_project", payload);
-        last_index_request_ms = OS::get_singleton()->get_ticks_msec();
-        pending_fs_changes = false;
-    }
-}
-
-void AIChatDock::_suggest_relevant_files(const String &p_query) {
-	// TODO: Implement smart file suggestions based on embedding similarity
-	print_line("AI Chat: 🔍 Smart file suggestions not implemented yet for query: " + p_query);
-}
-
-void AIChatDock::_auto_attach_relevant_context() {
-	// TODO: Implement automatic context attachment based on message content
-	print_line("AI Chat: 🤖 Auto context attachment not implemented yet");
-}
-
-void AIChatDock::_scan_and_index_project_files() {
-	print_line("AI Chat: 📁 Scanning project files for indexing...");
-	
-	String project_root = _get_project_root_path();
-	Array file_contents = Array();
-	int files_processed = 0;
-	int files_skipped = 0;
-	
-	// Get all files in project recursively
-	_scan_directory_recursive(project_root, project_root, file_contents, files_processed, files_skipped);
-	
-	print_line("AI Chat: 📊 Scan complete - " + String::num_int64(files_processed) + " files to index, " + String::num_int64(files_skipped) + " skipped");
-	
-	if (file_contents.size() == 0) {
-		_set_embedding_status("No files to index", false);
-		return;
-	}
-	
-	// Send files in batches to avoid huge HTTP requests
-	int batch_size = 20; // Process 20 files at a time
-	int total_batches = (file_contents.size() + batch_size - 1) / batch_size;
-	
-	_set_embedding_status("Indexing files (batch 1/" + String::num_int64(total_batches) + ")", true);
-	_send_file_batch(file_contents, 0, batch_size, 1, total_batches);
-}
-
-void AIChatDock::_scan_directory_recursive(const String &p_dir_path, const String &p_project_root, Array &p_file_contents, int &p_files_processed, int &p_files_skipped) {
-	Ref<DirAccess> dir = DirAccess::open(p_dir_path);
-	if (dir.is_null()) {
-		print_line("AI Chat: ❌ Cannot access directory: " + p_dir_path);
-		return;
-	}
-	
-	dir->list_dir_begin();
-	String file_name = dir->get_next();
-	
-	while (!file_name.is_empty()) {
-		String full_path = p_dir_path.path_join(file_name);
-		
-		if (dir->current_is_dir()) {
-			// Skip hidden directories and common build/cache dirs
-			if (!file_name.begins_with(".") && 
-				file_name != "build" && 
-				file_name != "bin" && 
-				file_name != "obj" && 
-				file_name != "__pycache__") {
-				_scan_directory_recursive(full_path, p_project_root, p_file_contents, p_files_processed, p_files_skipped);
-			} else {
-				p_files_skipped++;
-			}
-		} else {
-			// Check if we should index this file
-			if (_should_index_file(full_path)) {
-				Dictionary file_data = _read_file_for_indexing(full_path, p_project_root);
-				if (!file_data.is_empty()) {
-					p_file_contents.push_back(file_data);
-					p_files_processed++;
-				} else {
-					p_files_skipped++;
-				}
-			} else {
-				p_files_skipped++;
-			}
-		}
-		
-		file_name = dir->get_next();
-	}
-	
-	dir->list_dir_end();
-}
-
-Dictionary AIChatDock::_read_file_for_indexing(const String &p_file_path, const String &p_project_root) {
-	Ref<FileAccess> file = FileAccess::open(p_file_path, FileAccess::READ);
-	if (file.is_null()) {
-		print_line("AI Chat: ❌ Cannot read file: " + p_file_path);
-		return Dictionary();
-	}
-	
-	String content = file->get_as_text(true); // Skip BOM if present
-	file->close();
-	
-	// Skip empty files or files with only whitespace
-	if (content.strip_edges().is_empty()) {
-		return Dictionary();
-	}
-	
-	// Get relative path from project root
-	String relative_path = p_file_path.replace(p_project_root, "");
-	if (relative_path.begins_with("/") || relative_path.begins_with("\\")) {
-		relative_path = relative_path.substr(1);
+AIChatDock::~AIChatDock() {
+	if (project_index) {
+		memdelete(project_index);
+		project_index = nullptr;
 	}
-	
-	// Calculate content hash for change detection
-	String content_hash = _calculate_content_hash(content);
-	
-	Dictionary file_data;
-	file_data["path"] = relative_path;
-	file_data["content"] = content;
-	file_data["hash"] = content_hash;
-	file_data["size"] = content.length();
-	
-	return file_data;
-}
-
-String AIChatDock::_calculate_content_hash(const String &p_content) {
-	// Simple hash calculation using Godot's built-in hash function
-	uint32_t hash_value = p_content.hash();
-	return String::num_uint64(hash_value, 16);
-}
-
-void AIChatDock::_send_file_batch(const Array &p_all_files, int p_start_index, int p_batch_size, int p_current_batch, int p_total_batches) {
-	Array batch_files = Array();
-	int end_index = MIN(p_start_index + p_batch_size, p_all_files.size());
-	
-	// Create batch
-	for (int i = p_start_index; i < end_index; i++) {
-		batch_files.push_back(p_all_files[i]);
+	if (scene_snapshot) {
+		memdelete(scene_snapshot);
+		scene_snapshot = nullptr;
 	}
-	
-	// Prepare request data
-	Dictionary batch_info_dict;
-	batch_info_dict["current"] = p_current_batch;
-	batch_info_dict["total"] = p_total_batches;
-	batch_info_dict["files_in_batch"] = batch_files.size();
-	
-	Dictionary payload;
-	payload["files"] = batch_files;
-	payload["batch_info"] = batch_info_dict;
-	
-	// Store batch info for handling response
-	current_batch_info["start_index"] = p_start_index;
-	current_batch_info["batch_size"] = p_batch_size;
-	current_batch_info["current_batch"] = p_current_batch;
-	current_batch_info["total_batches"] = p_total_batches;
-	current_batch_info["all_files"] = p_all_files;
-	
-	print_line("AI Chat: 📤 Sending batch " + String::num_int64(p_current_batch) + "/" + String::num_int64(p_total_batches) + " (" + String::num_int64(batch_files.size()) + " files)");
-	
-	_send_embedding_request("index_files", payload);
-}
+	AIToolCache::stop();
+	_cancel_backend_requests();
+	// Cached thumbnails hold textures, which must go before the renderer does.
+	AIImagePipeline::clear_memory_cache();
 
-AIChatDock::~AIChatDock() {
 	// Wait for any background save to complete
 	if (save_thread_busy && save_thread) {
 		save_thread->wait_to_finish();
 		memdelete(save_thread);
 	}
+	if (save_job) {
+		memdelete(save_job);
+	}
 	
 	// Clean up mutex
 	if (save_mutex) {
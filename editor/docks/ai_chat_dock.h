@@ -30,16 +30,22 @@
 
 #pragma once
 
+#include "ai_context_packer.h"
+#include "ai_conversation_store.h"
+#include "ai_ndjson_decoder.h"
 #include "ai_tool_server.h"
 #include "common.h"
 #include "core/io/http_client.h"
+#include "core/io/http_connection_pool.h"
 #include "core/io/image.h"
+#include "core/io/json.h"
 #include "diff_viewer.h"
 #include "scene/gui/box_container.h"
 #include "scene/gui/dialogs.h"
 #include "scene/gui/texture_rect.h"
-#include "scene/main/http_request.h"
 
+class AIProjectIndex;
+class AISceneSnapshot;
 class Button;
 class MenuButton;
 class ConfigFile;
@@ -47,7 +53,6 @@ class EditorFileDialog;
 class EditorFileSystemDirectory;
 class EditorTools;
 class HTTPClient;
-class HTTPRequest;
 class Node;
 class OptionButton;
 class RichTextLabel;
@@ -65,10 +70,13 @@ class HFlowContainer;
 
 class AIChatDock : public VBoxContainer {
 	GDCLASS(AIChatDock, VBoxContainer);
+	friend class TestAIChatDockAccessor;
 
 private:
 	DiffViewer *diff_viewer;
 	Ref<AIToolServer> tool_server;
+	AIProjectIndex *project_index = nullptr;
+	AISceneSnapshot *scene_snapshot = nullptr;
 	// Helper to find RichTextLabel recursively.
 	static RichTextLabel *find_rich_text_label_in_children(Node *p_node) {
 		if (!p_node) {
@@ -116,6 +124,10 @@ private:
 		Vector<AttachedFile> attached_files;
 		// For storing tool execution results (like generated images)
 		Array tool_results;
+		// Converted BBCode for `content`, reused across re-renders. Not persisted.
+		mutable String bbcode_cache;
+		mutable uint32_t bbcode_cache_hash = 0;
+		mutable int bbcode_cache_length = -1;
 	};
 
 	struct Conversation {
@@ -124,11 +136,18 @@ private:
 		String created_timestamp;
 		String last_modified_timestamp;
 		Vector<ChatMessage> messages;
+		// Journal bookkeeping. Conversations read from the index stay
+		// unloaded, with empty `messages`, until they are opened.
+		bool loaded = true;
+		int stored_message_count = 0;
+		int saved_count = 0; // Leading messages already in the journal.
+		uint32_t saved_tail_hash = 0; // Fingerprint of the last saved message.
 	};
 
 	// Attachment safety limits to protect model context
 	static const int64_t MAX_TEXT_ATTACHMENT_PREVIEW_BYTES = 64 * 1024; // Read at most 64 KiB from disk
 	static const int MAX_TEXT_ATTACHMENT_PREVIEW_CHARS = 20000; // And cap decoded text length
+	static const int MAX_ATTACHMENT_IMAGE_DIMENSION = 1024; // Attached images are downsampled to this
 
 	ScrollContainer *chat_scroll = nullptr;
 	VBoxContainer *chat_container = nullptr;
@@ -146,7 +165,7 @@ private:
 	AcceptDialog *image_warning_dialog = nullptr;
 
 	// Embedding system state
-	HTTPRequest *embedding_request = nullptr;
+	HTTPConnectionPool::RequestID embedding_request = HTTPConnectionPool::INVALID_REQUEST_ID;
 	bool embedding_system_initialized = false;
 	bool initial_indexing_done = false;
 	bool embedding_request_busy = false;
@@ -155,19 +174,45 @@ private:
 	int embedding_poll_seconds = 120; // 2 minutes
 	uint64_t last_index_request_ms = 0;
 	bool pending_fs_changes = false;
-	// Accumulate changed files for periodic batching
+	// Coalesced dirty set (res:// paths), drained in bounded batches
 	HashSet<String> pending_changed_files;
+	HashSet<String> pending_removed_files;
+	Timer *embedding_debounce_timer = nullptr;
+	Timer *embedding_retry_timer = nullptr;
+
+	// What the backend has acknowledged, persisted across editor sessions so
+	// only changed files are re-sent.
+	struct EmbeddingManifestEntry {
+		uint64_t modified_time = 0;
+		uint64_t size = 0;
+		String hash;
+	};
+	HashMap<String, EmbeddingManifestEntry> embedding_manifest;
+	bool embedding_manifest_loaded = false;
+	bool embedding_manifest_dirty = false;
+
+	// Current sync run and the batch in flight.
+	static constexpr int EMBEDDING_BATCH_MAX_FILES = 20;
+	static constexpr int EMBEDDING_BATCH_MAX_BYTES = 512 * 1024;
+	static constexpr int EMBEDDING_MAX_RETRIES = 5;
+	static constexpr double EMBEDDING_DEBOUNCE_SECONDS = 2.0;
+	Vector<String> embedding_upload_queue;
+	Vector<String> embedding_removal_queue;
+	String embedding_batch_action;
+	Dictionary embedding_batch_payload;
+	Vector<String> embedding_batch_paths;
+	Vector<EmbeddingManifestEntry> embedding_batch_entries;
+	int embedding_batch_attempts = 0;
 	// Embedding progress UI
 	Label *embedding_status_label = nullptr;
 	Timer *embedding_status_timer = nullptr;
 	bool embedding_in_progress = false;
 	int embedding_status_dots = 0;
 	String embedding_status_base;
-	Dictionary current_batch_info;
 
 	// User authentication
-	HTTPRequest *auth_request = nullptr;
-	HTTPRequest *auth_providers_request = nullptr;
+	HTTPConnectionPool::RequestID auth_request = HTTPConnectionPool::INVALID_REQUEST_ID;
+	HTTPConnectionPool::RequestID auth_providers_request = HTTPConnectionPool::INVALID_REQUEST_ID;
 	Button *login_button = nullptr;
 	Label *user_status_label = nullptr;
 	String current_user_id;
@@ -203,32 +248,54 @@ private:
   Mutex *apply_edit_mutex = nullptr;
   Vector<void *> apply_edit_done; // stores ApplyEditTaskData* as opaque pointers
 
-	// Streaming HTTP client (replaces HTTPRequest for streaming support)
-	Ref<HTTPClient> http_client;
-	// Separate HTTP request for stop requests (non-streaming)
-	HTTPRequest *stop_http_request = nullptr;
-	enum HTTPStatus {
-		STATUS_IDLE,
-		STATUS_CONNECTING,
-		STATUS_REQUESTING,
-		STATUS_BODY,
-		STATUS_DONE
-	};
-	HTTPStatus http_status = STATUS_IDLE;
-	String pending_request_path;
-	PackedStringArray pending_request_headers;
-	PackedByteArray pending_request_body;
+	// Backend requests go through the shared keep-alive connection pool.
+	// The chat response is streamed chunk by chunk.
+	HTTPConnectionPool::RequestID chat_request = HTTPConnectionPool::INVALID_REQUEST_ID;
+	// Bumped per chat request and when the server signals the end of the
+	// stream, so callbacks of a stream that is already handled are ignored
+	// while its connection drains back into the pool.
+	uint64_t chat_stream = 0;
+	HTTPConnectionPool::RequestID stop_request = HTTPConnectionPool::INVALID_REQUEST_ID;
 
 	RichTextLabel *current_assistant_message_label = nullptr;
-	String response_buffer;
+
+	// Incremental markdown rendering of the message being streamed. Complete
+	// lines are converted once and appended to the label; the unfinished last
+	// line is shown in a small tail label that is re-rendered per delta.
+	struct MarkdownStream {
+		ObjectID label_id;
+		ObjectID tail_label_id;
+		int consumed = 0; // Source characters committed, up to the last line break.
+		int source_length = 0;
+		bool in_code_block = false;
+		bool has_lines = false;
+		String committed_bbcode;
+		String tail_bbcode;
+	};
+	MarkdownStream markdown_stream;
+
+	// Virtualized transcript. Only messages from transcript_first_built onward
+	// have controls; a spacer at the top of chat_container stands in for the
+	// rest, sized from measured heights (or estimates for messages never shown).
+	static constexpr float TRANSCRIPT_OVERSCAN_SCREENS = 1.0f;
+	Control *transcript_top_spacer = nullptr;
+	int transcript_first_built = 0;
+	Vector<float> transcript_height_cache; // Per message index, 0 when unmeasured.
+	bool transcript_update_queued = false;
+	ObjectID transcript_scroll_anchor;
+	float transcript_scroll_anchor_y = 0.0f;
+	AINDJSONDecoder response_decoder;
+	Ref<JSON> ndjson_parser; // Reused for every streamed line.
 	Array _chunked_messages; // For processing large conversations in chunks
-	Array _chunked_conversations_array; // For async saving
-	int _chunked_save_index = 0;
 
 	Vector<Conversation> conversations;
 	int current_conversation_index = -1;
 	Vector<AttachedFile> current_attached_files;
-	String conversations_file_path;
+	String conversations_file_path; // Legacy single-file JSON store, migrated on load.
+	AIConversationStore conversation_store;
+	AIContextPacker context_packer;
+	struct ConversationSaveJob;
+	ConversationSaveJob *save_job = nullptr;
 	String api_key;
     // Default API endpoint; will be overridden at runtime based on IS_DEV env
     String api_endpoint = "http://127.0.0.1:8000/chat";
@@ -260,7 +327,6 @@ private:
   // adding spacers or attaching it to the chat container.
   PanelContainer *_build_edit_message_panel(const ChatMessage &p_message, int p_message_index);
 	void _create_edit_message_bubble(const ChatMessage &p_message, int p_message_index);
-	void _save_conversations_async();
 	void _on_input_text_changed();
 	void _on_input_field_gui_input(const Ref<InputEvent> &p_event);
 	void _update_at_mention_popup();
@@ -284,20 +350,38 @@ private:
 	void _on_new_conversation_pressed();
 	void _on_save_image_pressed(const String &p_base64_data, const String &p_format);
 	void _on_save_image_location_selected(const String &p_file_path);
-	void _save_conversations_to_disk(const String &p_json_data);
 	void _process_image_attachment_async(const String &p_file_path, const String &p_name, const String &p_mime_type);
+	void _on_image_attachment_prepared(const Dictionary &p_result, const String &p_file_path, const String &p_name, const String &p_mime_type);
 	void _handle_response_chunk(const PackedByteArray &p_chunk);
+	void _on_chat_stream_chunk(const PackedByteArray &p_chunk, uint64_t p_stream);
+	void _on_chat_request_completed(int p_result, int p_code, const PackedStringArray &p_headers, const PackedByteArray &p_body, uint64_t p_stream);
+	void _cancel_backend_requests();
 	void _process_ndjson_line(const String &p_line);
 	void _execute_tool_calls(const Array &p_tool_calls);
   // Async apply_edit helpers
   void _execute_apply_edit_async(const String &p_tool_call_id, const Dictionary &p_args);
   static void _apply_edit_thread(void *p_userdata);
   void _on_apply_edit_thread_done();
+	void _on_screenshot_captured(const Dictionary &p_result, const String &p_tool_call_id, const Dictionary &p_args);
 	RichTextLabel *_get_or_create_current_assistant_message_label();
 	void _create_tool_call_bubbles(const Array &p_tool_calls);
 	void _update_tool_placeholder_with_result(const ChatMessage &p_tool_message);
 	void _create_tool_specific_ui(VBoxContainer *p_content_vbox, const String &p_tool_name, const Dictionary &p_result, bool p_success, const Dictionary &p_args = Dictionary());
 	void _rebuild_conversation_ui(const Vector<ChatMessage> &p_messages);
+
+	// Transcript virtualization
+	void _clear_transcript_ui();
+	void _build_transcript_range(const Vector<ChatMessage> &p_messages, int p_from, int p_to, bool p_prepend);
+	void _remove_message_bubbles_from(int p_message_index);
+	int _get_transcript_unit_start(const Vector<ChatMessage> &p_messages, int p_index) const;
+	bool _has_message_controls() const;
+	float _get_message_height(const Vector<ChatMessage> &p_messages, int p_index) const;
+	void _measure_transcript();
+	void _update_transcript_spacer();
+	void _update_transcript_window();
+	void _on_transcript_scrolled(double p_value);
+	void _on_transcript_sorted();
+	void _apply_transcript_scroll_anchor();
 	void _apply_tool_result_deferred(const String &p_tool_call_id, const String &p_tool_name, const String &p_content, const Array &p_tool_results);
 	void _build_hierarchy_tree_item(Tree *p_tree, TreeItem *p_parent, const Dictionary &p_node_data);
 
@@ -306,6 +390,7 @@ private:
 	void _send_chat_request();
 	void _send_chat_request_chunked(int p_start_index);
 	Dictionary _build_api_message(const ChatMessage &p_msg);
+	int _get_context_token_budget() const;
 	void _finalize_chat_request();
 	void _update_ui_state();
 	void _create_message_bubble(const AIChatDock::ChatMessage &p_message, int p_message_index = -1);
@@ -319,9 +404,15 @@ private:
 
 	// Conversation management
 	void _load_conversations();
+	bool _load_legacy_conversations(const String &p_path);
+	bool _ensure_conversation_loaded(int p_index);
+	void _mark_messages_changed(int p_from_index);
+	static Dictionary _message_to_dict(const ChatMessage &p_message);
+	static ChatMessage _dict_to_message(const Dictionary &p_dict);
+	static uint32_t _get_message_fingerprint(const ChatMessage &p_message);
+	ConversationSaveJob *_build_save_job();
+	void _finish_save_job(ConversationSaveJob *p_job);
 	void _save_conversations();
-	void _save_conversations_chunked(int p_start_index);
-	void _finalize_conversations_save();
 	void _queue_delayed_save();
 	void _execute_delayed_save();
 	static void _background_save(void *p_userdata);
@@ -340,16 +431,18 @@ private:
 	void _load_layout_from_config(Ref<ConfigFile> p_layout, const String &p_section);
 
 	// Markdown to BBCode conversion
-	String _markdown_to_bbcode(const String &p_markdown);
-	String _process_inline_markdown(String p_line);
+	static String _markdown_to_bbcode(const String &p_markdown);
+	static String _markdown_line_to_bbcode(const String &p_line, bool &r_in_code_block);
+	static String _process_inline_markdown(String p_line);
+	const String &_get_message_bbcode(const ChatMessage &p_message);
+	void _markdown_stream_update(RichTextLabel *p_label, const String &p_content);
+	void _markdown_stream_finish(const ChatMessage *p_message);
 
 	void _on_diff_accepted(const String &p_path, const String &p_content);
 
 	// Image processing methods
 	bool _is_image_file(const String &p_path);
 	String _get_mime_type_from_extension(const String &p_path);
-	bool _process_image_attachment(AttachedFile &p_file);
-	Vector2i _calculate_downsampled_size(const Vector2i &p_original, int p_max_dimension = 1024);
 
 	// UI validation helpers
 	bool _is_label_descendant_of_node(Node *p_label, Node *p_node);
@@ -362,6 +455,8 @@ private:
 
 	// Unified image display method for all image types
 	void _display_image_unified(VBoxContainer *p_container, const String &p_base64_data, const Dictionary &p_metadata = Dictionary());
+	void _request_image_thumbnail(TextureRect *p_display, Label *p_size_label, const String &p_base64_data, int p_max_size, const String &p_attachment_name = String());
+	void _on_image_thumbnail_ready(const Dictionary &p_result, ObjectID p_display, ObjectID p_size_label, const String &p_attachment_name);
 
 	// Drag and drop support
 	bool can_drop_data_fw(const Point2 &p_point, const Variant &p_data, Control *p_from) const;
@@ -392,7 +487,7 @@ private:
 	void _on_sources_changed(bool p_exist);
 	void _update_file_embedding(const String &p_file_path);
 	void _remove_file_embedding(const String &p_file_path);
-	void _send_embedding_request(const String &p_action, const Dictionary &p_data = Dictionary());
+	Error _send_embedding_request(const String &p_action, const Dictionary &p_data = Dictionary());
 	void _on_embedding_request_completed(int p_result, int p_code, const PackedStringArray &p_headers, const PackedByteArray &p_body);
 	bool _should_index_file(const String &p_file_path);
 	String _get_project_root_path();
@@ -401,12 +496,22 @@ private:
 	void _on_embedding_status_tick();
 	void _on_embedding_poll_tick();
 
-	// Cloud-ready file indexing methods
-	void _scan_and_index_project_files();
-	void _scan_directory_recursive(const String &p_dir_path, const String &p_project_root, Array &p_file_contents, int &p_files_processed, int &p_files_skipped);
-	Dictionary _read_file_for_indexing(const String &p_file_path, const String &p_project_root);
-	String _calculate_content_hash(const String &p_content);
-	void _send_file_batch(const Array &p_all_files, int p_start_index, int p_batch_size, int p_current_batch, int p_total_batches);
+	void _on_resources_reimported(const PackedStringArray &p_resources);
+
+	// Incremental, manifest-driven sync with the embedding backend
+	String _get_embedding_manifest_path() const;
+	void _load_embedding_manifest();
+	void _save_embedding_manifest();
+	void _collect_embedding_changes(EditorFileSystemDirectory *p_dir, HashSet<String> &r_seen);
+	void _queue_embedding_sync();
+	void _flush_embedding_changes();
+	void _send_next_embedding_batch();
+	void _finish_embedding_batch(bool p_success, const String &p_error);
+	void _on_embedding_retry_timeout();
+	void _requeue_embedding_batch();
+	void _abort_embedding_sync();
+	Dictionary _read_file_for_indexing(const String &p_path, EmbeddingManifestEntry &r_entry);
+	String _calculate_content_hash(const PackedByteArray &p_content);
 	
 	// Smart context attachment based on embeddings
 	void _suggest_relevant_files(const String &p_query);
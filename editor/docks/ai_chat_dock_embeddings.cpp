@@ -4,297 +4,790 @@
 
 #include "ai_chat_dock.h"
 
+#include "../ai/ai_project_index.h"
+#include "../ai/ai_tool_cache.h"
 #include "core/config/project_settings.h"
+#include "core/crypto/crypto_core.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
 #include "core/io/json.h"
+#include "editor/editor_node.h"
 #include "editor/file_system/editor_file_system.h"
-#include "editor/settings/editor_settings.h"
+#include "editor/file_system/editor_paths.h"
+#include "scene/gui/label.h"
+#include "scene/main/timer.h"
 
-// Helper: derive backend base URL from chat endpoint
-static String _get_backend_base_url(const String &p_chat_endpoint) {
-    // Expect .../chat; strip trailing "/chat" if present
-    if (p_chat_endpoint.ends_with("/chat")) {
-        return p_chat_endpoint.substr(0, p_chat_endpoint.length() - 5);
-    }
-    return p_chat_endpoint;
-}
+// The backend keeps the authoritative embeddings; the editor only tracks what
+// it has successfully sent. Change signals feed a coalescing dirty set, a short
+// debounce timer drains it, and the manifest (mtime, size, content hash per
+// file) decides which files actually need to be re-sent. Uploads go out in
+// bounded batches, one request at a time, and failed batches are retried with
+// exponential backoff before being put back into the dirty set.
 
-String AIChatDock::_get_embed_base_url() {
-    // Resolve base URL with priority: EditorSettings -> env AI_CHAT_CLOUD_URL -> localhost
-    String base_url;
-    if (EditorSettings::get_singleton() && EditorSettings::get_singleton()->has_setting("ai_chat/base_url")) {
-        base_url = EditorSettings::get_singleton()->get_setting("ai_chat/base_url");
-    }
-    if (base_url.is_empty()) {
-        base_url = OS::get_singleton()->get_environment("AI_CHAT_CLOUD_URL");
+static constexpr int EMBEDDING_MANIFEST_VERSION = 1;
+
+void AIChatDock::_initialize_embedding_system() {
+    print_line("AI Chat: 🔧 Initializing cloud-based embedding system");
+
+    // Connect to editor file system signals for automatic reindexing
+    // This connection does not require authentication; it only sets up callbacks.
+    if (EditorFileSystem::get_singleton()) {
+        if (!EditorFileSystem::get_singleton()->is_connected("filesystem_changed", callable_mp(this, &AIChatDock::_on_filesystem_changed))) {
+            EditorFileSystem::get_singleton()->connect("filesystem_changed", callable_mp(this, &AIChatDock::_on_filesystem_changed));
+        }
+        if (!EditorFileSystem::get_singleton()->is_connected("sources_changed", callable_mp(this, &AIChatDock::_on_sources_changed))) {
+            EditorFileSystem::get_singleton()->connect("sources_changed", callable_mp(this, &AIChatDock::_on_sources_changed));
+        }
+        if (!EditorFileSystem::get_singleton()->is_connected("resources_reimported", callable_mp(this, &AIChatDock::_on_resources_reimported))) {
+            EditorFileSystem::get_singleton()->connect("resources_reimported", callable_mp(this, &AIChatDock::_on_resources_reimported));
+        }
+        print_line("AI Chat: 🔗 Connected to EditorFileSystem change signals (filesystem_changed, sources_changed, resources_reimported)");
+        if (project_index) {
+            project_index->start();
+        }
+        AIToolCache::start();
+    } else {
+        print_line("AI Chat: ⚠️ EditorFileSystem not ready; change signals not connected");
     }
-    if (base_url.is_empty()) {
-        base_url = "http://127.0.0.1:8000";
+
+    // Connect to precise save signals from EditorNode to index only changed files
+    if (EditorNode::get_singleton()) {
+        if (!EditorNode::get_singleton()->is_connected("resource_saved", callable_mp(this, &AIChatDock::_on_editor_resource_saved))) {
+            EditorNode::get_singleton()->connect("resource_saved", callable_mp(this, &AIChatDock::_on_editor_resource_saved), CONNECT_DEFERRED);
+        }
+        if (!EditorNode::get_singleton()->is_connected("scene_saved", callable_mp(this, &AIChatDock::_on_editor_scene_saved))) {
+            EditorNode::get_singleton()->connect("scene_saved", callable_mp(this, &AIChatDock::_on_editor_scene_saved), CONNECT_DEFERRED);
+        }
+        print_line("AI Chat: 🔗 Connected to EditorNode save signals (resource_saved, scene_saved)");
     }
-    // Normalize: strip trailing slash
-    if (base_url.ends_with("/")) {
-        base_url = base_url.substr(0, base_url.length() - 1);
+
+    // Setup status timer for animated dots
+    if (!embedding_status_timer) {
+        embedding_status_timer = memnew(Timer);
+        embedding_status_timer->set_wait_time(0.5);
+        embedding_status_timer->set_one_shot(false);
+        embedding_status_timer->connect("timeout", callable_mp(this, &AIChatDock::_on_embedding_status_tick));
+        add_child(embedding_status_timer);
     }
-    return base_url;
-}
 
-void AIChatDock::_initialize_embedding_system() {
-    if (embedding_system_initialized) {
-        return;
+    // Bursts of change signals (e.g. a bulk import) collapse into one sync
+    if (!embedding_debounce_timer) {
+        embedding_debounce_timer = memnew(Timer);
+        embedding_debounce_timer->set_wait_time(EMBEDDING_DEBOUNCE_SECONDS);
+        embedding_debounce_timer->set_one_shot(true);
+        embedding_debounce_timer->connect("timeout", callable_mp(this, &AIChatDock::_flush_embedding_changes));
+        add_child(embedding_debounce_timer);
     }
 
-    // Create HTTPRequest for embedding ops
-    if (!embedding_request) {
-        embedding_request = memnew(HTTPRequest);
-        add_child(embedding_request);
-        embedding_request->connect("request_completed", callable_mp(this, &AIChatDock::_on_embedding_request_completed));
+    if (!embedding_retry_timer) {
+        embedding_retry_timer = memnew(Timer);
+        embedding_retry_timer->set_one_shot(true);
+        embedding_retry_timer->connect("timeout", callable_mp(this, &AIChatDock::_on_embedding_retry_timeout));
+        add_child(embedding_retry_timer);
     }
 
-    // Connect to editor file system signals for automatic reindexing
-    if (EditorFileSystem::get_singleton()) {
-        EditorFileSystem::get_singleton()->connect("filesystem_changed", callable_mp(this, &AIChatDock::_on_filesystem_changed));
-        EditorFileSystem::get_singleton()->connect("sources_changed", callable_mp(this, &AIChatDock::_on_sources_changed));
-        print_line("AI Chat: 🔗 Connected to EditorFileSystem change signals (filesystem_changed, sources_changed)");
+    // Setup periodic poll timer as a safety net for changes made while logged out
+    if (!embedding_poll_timer) {
+        embedding_poll_timer = memnew(Timer);
+        embedding_poll_timer->set_wait_time(embedding_poll_seconds);
+        embedding_poll_timer->set_one_shot(false);
+        embedding_poll_timer->connect("timeout", callable_mp(this, &AIChatDock::_on_embedding_poll_tick));
+        add_child(embedding_poll_timer);
+        embedding_poll_timer->start();
+        print_line("AI Chat: ⏱️ Enabled periodic indexing poll every " + String::num_int64(embedding_poll_seconds) + "s");
     }
 
     embedding_system_initialized = true;
-    // Kick off initial indexing
+    _set_embedding_status("Ready to index", false);
+
+    if (!_is_user_authenticated()) {
+        print_line("AI Chat: ℹ️ Embedding system ready, but user not authenticated (login to enable indexing)");
+        return;
+    }
+
+    // With the manifest in place this only sends what changed since last session
+    print_line("AI Chat: ✅ Embedding system initialized successfully");
     call_deferred("_perform_initial_indexing");
 }
 
 void AIChatDock::_perform_initial_indexing() {
-    if (initial_indexing_done || embedding_request_busy) {
+    print_line("AI Chat: 📚 Starting project indexing...");
+
+    if (!embedding_system_initialized || !_is_user_authenticated()) {
+        print_line("AI Chat: ❌ Cannot start indexing - system not ready (initialized=" + String(embedding_system_initialized ? "true" : "false") + ", authed=" + String(_is_user_authenticated() ? "true" : "false") + ")");
         return;
     }
-    Dictionary payload;
-    payload["project_root"] = _get_project_root_path();
-    payload["force_reindex"] = false;
-    // Optional: pass project_id if you have a stable id; backend can derive one otherwise
-    // payload["project_id"] = String();
-    _set_embedding_status("Indexing project", true);
-    _send_embedding_request("index_project", payload);
+
+    // A full delta scan against the manifest; unchanged files are not re-sent
+    pending_fs_changes = true;
+    _flush_embedding_changes();
 }
 
-void AIChatDock::_on_filesystem_changed() {
-    print_line("AI Chat: 📁 filesystem_changed signal received");
-    // Debounced: simply request a lightweight re-index of project
-    if (!embedding_system_initialized) {
-        print_line("AI Chat: 🚫 Skipping indexing - system not initialized");
+Error AIChatDock::_send_embedding_request(const String &p_action, const Dictionary &p_data) {
+    if (embedding_request_busy) {
+        print_line("AI Chat: ❌ Cannot send embedding request - busy or not initialized");
+        return ERR_BUSY;
+    }
+
+    String embed_url = _get_embed_base_url() + "/embed";
+
+    Dictionary request_data;
+    request_data["action"] = p_action;
+
+    // Always include project_root for all embedding requests
+    request_data["project_root"] = _get_project_root_path();
+
+    if (!p_data.is_empty()) {
+        for (const Variant *key = p_data.next(); key; key = p_data.next(key)) {
+            request_data[*key] = p_data[*key];
+        }
+    }
+
+    String request_body = JSON::stringify(request_data);
+
+    PackedStringArray headers;
+    headers.push_back("Content-Type: application/json");
+
+    // Add authentication headers
+    if (!auth_token.is_empty()) {
+        headers.push_back("Authorization: Bearer " + auth_token);
+    }
+    headers.push_back("X-User-ID: " + current_user_id);
+    headers.push_back("X-Machine-ID: " + get_machine_id());
+
+    print_line("AI Chat: 📡 Sending embedding request: " + p_action + " to " + embed_url +
+        " (project_root=" + _get_project_root_path() + ")");
+
+    embedding_request_busy = true;
+    last_index_request_ms = OS::get_singleton()->get_ticks_msec();
+    embedding_request = HTTPConnectionPool::get_singleton()->request(embed_url, HTTPClient::METHOD_POST, headers, request_body, callable_mp(this, &AIChatDock::_on_embedding_request_completed));
+
+    if (embedding_request == HTTPConnectionPool::INVALID_REQUEST_ID) {
+        print_line("AI Chat: ❌ Failed to send embedding request: " + embed_url);
+        embedding_request_busy = false;
+        return ERR_INVALID_PARAMETER;
+    }
+    return OK;
+}
+
+void AIChatDock::_on_embedding_request_completed(int p_result, int p_code, const PackedStringArray &p_headers, const PackedByteArray &p_body) {
+    embedding_request_busy = false;
+
+    print_line("AI Chat: 📨 Embedding request completed - Result: " + String::num_int64(p_result) + ", Code: " + String::num_int64(p_code));
+
+    const bool sync_batch = !embedding_batch_action.is_empty();
+
+    if (p_result != HTTPConnectionPool::RESULT_SUCCESS || p_code != 200) {
+        String error_msg = "Request failed (" + String::num_int64(p_code) + ")";
+        print_line("AI Chat: ❌ " + error_msg);
+        if (sync_batch && (p_code == 401 || p_code == 403)) {
+            // Retrying with the same credentials can't succeed
+            _abort_embedding_sync();
+            _set_embedding_status("Indexing paused: not authorized", false);
+        } else if (sync_batch) {
+            _finish_embedding_batch(false, error_msg);
+        } else {
+            _set_embedding_status(error_msg, false);
+        }
         return;
     }
-    if (!_is_user_authenticated()) {
-        print_line("AI Chat: 🚫 Skipping indexing - user not authenticated");
+
+    String response_text = String::utf8((const char *)p_body.ptr(), p_body.size());
+
+    Ref<JSON> json;
+    json.instantiate();
+    Error parse_err = json->parse(response_text);
+
+    if (parse_err != OK || json->get_data().get_type() != Variant::DICTIONARY) {
+        print_line("AI Chat: ❌ Failed to parse embedding response");
+        if (sync_batch) {
+            _finish_embedding_batch(false, "Parse error");
+        } else {
+            _set_embedding_status("Parse error", false);
+        }
         return;
     }
-    if (embedding_request_busy) {
-        print_line("AI Chat: ⏳ Skipping indexing - previous embedding request still in flight");
+
+    Dictionary response = json->get_data();
+    bool success = response.get("success", false);
+    String action = response.get("action", "");
+
+    if (!success) {
+        String error = response.get("error", "Unknown error");
+        print_line("AI Chat: ❌ Embedding request failed: " + error);
+        if (sync_batch) {
+            _finish_embedding_batch(false, error);
+        } else {
+            _set_embedding_status("Error: " + error, false);
+        }
         return;
     }
 
-    Dictionary payload;
-    payload["project_root"] = _get_project_root_path();
-    payload["force_reindex"] = false; // backend is incremental
-    _set_embedding_status("Indexing changes", true);
-    _send_embedding_request("index_project", payload);
+    print_line("AI Chat: ✅ Embedding action '" + action + "' completed successfully");
+
+    if (sync_batch) {
+        if (embedding_batch_action == "index_files") {
+            Dictionary stats = response.get("stats", Dictionary());
+            print_line("AI Chat: ✅ Batch completed - indexed: " + String::num_int64(int(stats.get("indexed", 0))) + ", skipped: " + String::num_int64(int(stats.get("skipped", 0))) + ", failed: " + String::num_int64(int(stats.get("failed", 0))));
+        }
+        _finish_embedding_batch(true, String());
+        return;
+    }
+
+    if (action == "index_project") {
+        Dictionary stats = response.get("stats", Dictionary());
+        int total = stats.get("total", 0);
+        int indexed = stats.get("indexed", 0);
+        int skipped = stats.get("skipped", 0);
+
+        String status_text = "Indexed " + String::num_int64(indexed) + "/" + String::num_int64(total) + " files";
+        if (skipped > 0) {
+            status_text += " (" + String::num_int64(skipped) + " skipped)";
+        }
+
+        _set_embedding_status(status_text, false);
+        initial_indexing_done = true;
+
+        print_line("AI Chat: 🎉 Project indexing completed - " + status_text);
+
+    } else if (action == "status") {
+        Dictionary stats = response.get("stats", Dictionary());
+        int files_indexed = stats.get("files_indexed", 0);
+        int total_chunks = stats.get("total_chunks", 0);
+
+        if (files_indexed > 0) {
+            String status_text = String::num_int64(files_indexed) + " files indexed (" + String::num_int64(total_chunks) + " chunks)";
+            _set_embedding_status(status_text, false);
+            initial_indexing_done = true;
+        } else {
+            _set_embedding_status("No files indexed", false);
+            initial_indexing_done = false;
+        }
+
+    } else if (action == "clear") {
+        _set_embedding_status("Index cleared", false);
+        initial_indexing_done = false;
+        embedding_manifest.clear();
+        embedding_manifest_dirty = true;
+        _save_embedding_manifest();
+    }
 }
 
-void AIChatDock::_on_sources_changed(bool p_exist) {
-    print_line("AI Chat: 📝 sources_changed signal received (exist=" + String(p_exist ? "true" : "false") + ")");
-    // Sources changed; treat same as filesystem_changed for indexing purposes
-    _on_filesystem_changed();
+String AIChatDock::_get_project_root_path() {
+    return ProjectSettings::get_singleton()->globalize_path("res://");
+}
+
+String AIChatDock::_get_embed_base_url() {
+    // Use same endpoint as chat but for embedding operations
+    String base_url = api_endpoint;
+
+    // Remove /chat suffix if present and replace with embedding endpoint
+    if (base_url.ends_with("/chat")) {
+        base_url = base_url.substr(0, base_url.length() - 5);
+    }
+
+    return base_url;
+}
+
+void AIChatDock::_set_embedding_status(const String &p_text, bool p_busy) {
+    if (!embedding_status_label) {
+        return;
+    }
+
+    embedding_in_progress = p_busy;
+    embedding_status_base = p_text;
+    embedding_status_dots = 0;
+
+    if (p_busy) {
+        embedding_status_label->set_text(p_text + "...");
+        embedding_status_label->set_modulate(Color(1.0, 0.8, 0.0)); // Yellow for in-progress
+        if (embedding_status_timer) {
+            embedding_status_timer->start();
+        }
+    } else {
+        embedding_status_label->set_text(p_text);
+        embedding_status_label->set_modulate(Color(0.7, 0.7, 0.7)); // Gray for idle
+        if (embedding_status_timer) {
+            embedding_status_timer->stop();
+        }
+    }
+}
+
+void AIChatDock::_on_embedding_status_tick() {
+    if (!embedding_in_progress || !embedding_status_label) {
+        return;
+    }
+
+    embedding_status_dots = (embedding_status_dots + 1) % 4;
+    String dots = "";
+    for (int i = 0; i < embedding_status_dots; i++) {
+        dots += ".";
+    }
+
+    embedding_status_label->set_text(embedding_status_base + dots);
+}
+
+bool AIChatDock::_should_index_file(const String &p_file_path) {
+    // Use same logic as the cloud vector manager
+    String ext = p_file_path.get_extension().to_lower();
+
+    // Skip binary files
+    static const HashSet<String> binary_exts = {
+        "png", "jpg", "jpeg", "gif", "bmp", "webp",
+        "mp3", "wav", "ogg", "mp4", "avi", "mov",
+        "exe", "dll", "so", "dylib"
+    };
+    if (binary_exts.has(ext)) {
+        return false;
+    }
+
+    // Skip hidden files, built-in sub-resources and the project data dir
+    if (p_file_path.get_file().begins_with(".") || p_file_path.contains("::") || p_file_path.begins_with("res://.godot/")) {
+        return false;
+    }
+
+    return true;
 }
 
 void AIChatDock::_update_file_embedding(const String &p_file_path) {
-    if (!embedding_system_initialized || !_is_user_authenticated() || embedding_request_busy) {
+    if (!embedding_system_initialized || !_should_index_file(p_file_path)) {
         return;
     }
-    Dictionary payload;
-    payload["project_root"] = _get_project_root_path();
-    payload["file_path"] = p_file_path;
-    _set_embedding_status("Updating file", true);
-    _send_embedding_request("update_file", payload);
+    pending_changed_files.insert(p_file_path);
+    _queue_embedding_sync();
 }
 
 void AIChatDock::_remove_file_embedding(const String &p_file_path) {
-    if (!embedding_system_initialized || !_is_user_authenticated() || embedding_request_busy) {
+    if (!embedding_system_initialized) {
         return;
     }
-    Dictionary payload;
-    payload["project_root"] = _get_project_root_path();
-    payload["file_path"] = p_file_path;
-    _set_embedding_status("Removing file", true);
-    _send_embedding_request("remove_file", payload);
+    pending_changed_files.erase(p_file_path);
+    pending_removed_files.insert(p_file_path);
+    _queue_embedding_sync();
 }
 
-void AIChatDock::_send_embedding_request(const String &p_action, const Dictionary &p_data) {
-    if (!embedding_request) {
-        return;
+void AIChatDock::_on_filesystem_changed() {
+    // Adds, moves and deletes are only visible as a tree-wide change; the delta
+    // scan against the manifest figures out which files are actually affected.
+    pending_fs_changes = true;
+    _queue_embedding_sync();
+}
+
+void AIChatDock::_on_sources_changed(bool p_exist) {
+    if (p_exist) {
+        pending_fs_changes = true;
+        _queue_embedding_sync();
     }
+}
 
-    String base = _get_embed_base_url();
-    // Always use /embed; action is provided in body
-    String url = base + "/embed";
+void AIChatDock::_on_resources_reimported(const PackedStringArray &p_resources) {
+    for (const String &path : p_resources) {
+        if (_should_index_file(path)) {
+            pending_changed_files.insert(path);
+        }
+    }
+    _queue_embedding_sync();
+}
 
-    PackedStringArray headers;
-    headers.push_back("Content-Type: application/json");
-    String machine_id = get_machine_id();
-    if (machine_id != String()) {
-        headers.push_back("X-Machine-ID: " + machine_id);
+void AIChatDock::_on_editor_resource_saved(Object *p_res) {
+    if (!p_res) {
+        return;
     }
-    if (auth_token != String()) {
-        headers.push_back("Authorization: Bearer " + auth_token);
+    Ref<Resource> res = Ref<Resource>(Object::cast_to<Resource>(p_res));
+    if (res.is_null()) {
+        return;
+    }
+    String path = res->get_path();
+    if (path.is_empty()) {
+        return;
+    }
+    print_line("AI Chat: 💾 resource_saved -> " + path);
+    // EditorFileSystem reports the save a frame later.
+    AIToolCache::notify_files_changed();
+    if (project_index) {
+        project_index->mark_file_dirty(path);
     }
-    if (current_user_id != String()) {
-        headers.push_back("X-User-ID: " + current_user_id);
+    if (_should_index_file(path)) {
+        pending_changed_files.insert(path);
+        _queue_embedding_sync();
     }
+}
 
-    // Include action and machine/project context in body
-    Dictionary body = p_data;
-    body["action"] = p_action;
-    if (!body.has("project_root")) {
-        body["project_root"] = _get_project_root_path();
+void AIChatDock::_on_editor_scene_saved(const String &p_path) {
+    print_line("AI Chat: 💾 scene_saved -> " + p_path);
+    AIToolCache::notify_files_changed();
+    if (project_index) {
+        project_index->mark_file_dirty(p_path);
     }
-    if (!body.has("machine_id")) {
-        body["machine_id"] = machine_id;
+    if (_should_index_file(p_path)) {
+        pending_changed_files.insert(p_path);
+        _queue_embedding_sync();
     }
+}
 
-    String json = JSON::stringify(body);
-    print_line(vformat("AI Chat: 📤 Embedding request %s -> %s", p_action, url));
-    print_line(vformat("AI Chat: 📁 project_root=%s", body.get("project_root", "")));
-    embedding_request_busy = true;
-    Error err = embedding_request->request(url, headers, HTTPClient::METHOD_POST, json);
-    if (err != OK) {
-        print_line("AI Chat: ❌ Embedding request failed to start: " + itos(err));
-        embedding_request_busy = false;
+void AIChatDock::_on_embedding_poll_tick() {
+    // Picks up changes queued while logged out or after a batch gave up
+    if (pending_fs_changes || !pending_changed_files.is_empty() || !pending_removed_files.is_empty()) {
+        _flush_embedding_changes();
     }
 }
 
-void AIChatDock::_on_embedding_request_completed(int p_result, int p_code, const PackedStringArray &p_headers, const PackedByteArray &p_body) {
-    String body_str = String::utf8((const char *)p_body.ptr(), p_body.size());
+void AIChatDock::_suggest_relevant_files(const String &p_query) {
+    // TODO: Implement smart file suggestions based on embedding similarity
+    print_line("AI Chat: 🔍 Smart file suggestions not implemented yet for query: " + p_query);
+}
 
-    if (p_code < 200 || p_code >= 300) {
-        print_line("AI Chat: ❌ Embedding API error: HTTP " + itos(p_code) + " body: " + body_str);
-        _set_embedding_status("Indexing failed", false);
-        embedding_request_busy = false;
+void AIChatDock::_auto_attach_relevant_context() {
+    // TODO: Implement automatic context attachment based on message content
+    print_line("AI Chat: 🤖 Auto context attachment not implemented yet");
+}
+
+// ========== MANIFEST ==========
+
+String AIChatDock::_get_embedding_manifest_path() const {
+    return EditorPaths::get_singleton()->get_project_data_dir().path_join("ai_index").path_join("embedding_manifest.json");
+}
+
+void AIChatDock::_load_embedding_manifest() {
+    embedding_manifest_loaded = true;
+    embedding_manifest.clear();
+    embedding_manifest_dirty = false;
+
+    const String path = _get_embedding_manifest_path();
+    if (!FileAccess::exists(path)) {
         return;
     }
 
     JSON json;
-    Error perr = json.parse(body_str);
-    if (perr != OK || json.get_data().get_type() != Variant::DICTIONARY) {
-        print_line("AI Chat: ⚠️ Unexpected embedding response: " + body_str);
+    if (json.parse(FileAccess::get_file_as_string(path)) != OK || json.get_data().get_type() != Variant::DICTIONARY) {
+        print_line("AI Chat: ⚠️ Ignoring unreadable embedding manifest, project will be re-sent");
         return;
     }
 
-    Dictionary resp = json.get_data();
-    bool success = resp.get("success", false);
-    if (!success) {
-        print_line("AI Chat: ⚠️ Embedding operation unsuccessful: " + body_str);
-        _set_embedding_status("Indexing failed", false);
-        embedding_request_busy = false;
+    Dictionary root = json.get_data();
+    // The backend index is per user; a manifest written for someone else
+    // says nothing about what this user's index contains.
+    if (int(root.get("version", 0)) != EMBEDDING_MANIFEST_VERSION || String(root.get("user_id", "")) != current_user_id) {
         return;
     }
 
-    String action = resp.get("action", String());
-    if (action == "index_project") {
-        initial_indexing_done = true;
-        int indexed = 0;
-        int skipped = 0;
-        if (resp.has("stats")) {
-            Dictionary stats = resp["stats"];
-            indexed = int(stats.get("indexed", 0));
-            skipped = int(stats.get("skipped", 0));
-        }
-        print_line(vformat("AI Chat: ✅ Project indexed. indexed=%d skipped=%d", indexed, skipped));
-        _set_embedding_status(vformat("Indexed (new %d, skipped %d)", indexed, skipped), false);
-    } else if (action == "update_file") {
-        print_line("AI Chat: ✅ File embedding updated");
-        _set_embedding_status("File updated", false);
-    } else if (action == "remove_file") {
-        print_line("AI Chat: ✅ File embedding removed");
-        _set_embedding_status("File removed", false);
-    } else if (action == "search" || action == "search_with_graph") {
-        // Suggestion results
-        // This path is used by _suggest_relevant_files when querying suggestions
-        Array similar = Array();
-        if (resp.has("results")) {
-            Dictionary results = resp["results"];
-            if (results.has("similar_files")) {
-                similar = results["similar_files"];
-            }
+    Dictionary files = root.get("files", Dictionary());
+    for (const Variant *key = files.next(); key; key = files.next(key)) {
+        Array fields = files[*key];
+        if (fields.size() != 3) {
+            continue;
         }
-        int count = similar.size();
-        print_line(vformat("AI Chat: 🔎 Suggested relevant files: %d", count));
+        EmbeddingManifestEntry entry;
+        entry.modified_time = uint64_t(fields[0]);
+        entry.size = uint64_t(fields[1]);
+        entry.hash = fields[2];
+        embedding_manifest.insert(*key, entry);
     }
-    embedding_request_busy = false;
+    print_line("AI Chat: 📒 Loaded embedding manifest with " + String::num_int64(embedding_manifest.size()) + " files");
 }
 
-bool AIChatDock::_should_index_file(const String &p_file_path) {
-    // Basic client-side filter; backend has authoritative filter
-    String ext = p_file_path.get_extension().to_lower();
-    static const HashSet<String> allowed_ext = {
-        "gd", "cs", "js", "tscn", "scn", "tres", "res", "json", "cfg", "md", "txt",
-        "png", "jpg", "jpeg", "gif", "bmp", "webp", "svg", "tga", "exr",
-        "wav", "ogg", "mp3", "aac", "flac",
-        "mp4", "mov", "avi", "webm"
-    };
-    return allowed_ext.has(ext);
+void AIChatDock::_save_embedding_manifest() {
+    if (!embedding_manifest_dirty) {
+        return;
+    }
+
+    Dictionary files;
+    for (const KeyValue<String, EmbeddingManifestEntry> &E : embedding_manifest) {
+        Array fields;
+        fields.push_back(E.value.modified_time);
+        fields.push_back(E.value.size);
+        fields.push_back(E.value.hash);
+        files[E.key] = fields;
+    }
+
+    Dictionary root;
+    root["version"] = EMBEDDING_MANIFEST_VERSION;
+    root["user_id"] = current_user_id;
+    root["files"] = files;
+
+    const String path = _get_embedding_manifest_path();
+    DirAccess::make_dir_recursive_absolute(path.get_base_dir());
+    Ref<FileAccess> f = FileAccess::open(path, FileAccess::WRITE);
+    if (f.is_null()) {
+        print_line("AI Chat: ❌ Cannot write embedding manifest: " + path);
+        return;
+    }
+    f->store_string(JSON::stringify(root));
+    embedding_manifest_dirty = false;
 }
 
-String AIChatDock::_get_project_root_path() {
-    String res = "res://";
-    return ProjectSettings::get_singleton()->globalize_path(res);
+// ========== INCREMENTAL SYNC ==========
+
+void AIChatDock::_collect_embedding_changes(EditorFileSystemDirectory *p_dir, HashSet<String> &r_seen) {
+    if (!p_dir) {
+        return;
+    }
+    for (int i = 0; i < p_dir->get_file_count(); i++) {
+        const String path = p_dir->get_file_path(i);
+        if (!_should_index_file(path)) {
+            continue;
+        }
+        r_seen.insert(path);
+        const EmbeddingManifestEntry *entry = embedding_manifest.getptr(path);
+        if (!entry || entry->modified_time != p_dir->get_file_modified_time(i)) {
+            pending_changed_files.insert(path);
+        }
+    }
+    for (int i = 0; i < p_dir->get_subdir_count(); i++) {
+        _collect_embedding_changes(p_dir->get_subdir(i), r_seen);
+    }
 }
 
-void AIChatDock::_set_embedding_status(const String &p_text, bool p_busy) {
-    if (!embedding_status_label) return;
-    embedding_status_base = p_text;
-    embedding_status_label->set_text(embedding_status_base);
-    embedding_in_progress = p_busy;
-    if (p_busy) {
-        if (!embedding_status_timer) {
-            embedding_status_timer = memnew(Timer);
-            add_child(embedding_status_timer);
-            embedding_status_timer->connect("timeout", callable_mp(this, &AIChatDock::_on_embedding_status_tick));
-            embedding_status_timer->set_wait_time(0.5);
-            embedding_status_timer->set_one_shot(false);
+void AIChatDock::_queue_embedding_sync() {
+    if (embedding_debounce_timer) {
+        // Restarting keeps pushing the flush back while a burst is ongoing
+        embedding_debounce_timer->start();
+    }
+}
+
+void AIChatDock::_flush_embedding_changes() {
+    if (!embedding_system_initialized || !_is_user_authenticated()) {
+        // Keep everything queued; the next flush after login sends it
+        return;
+    }
+    if (embedding_request_busy || !embedding_batch_action.is_empty() || !embedding_upload_queue.is_empty() || !embedding_removal_queue.is_empty()) {
+        // A sync is already running; it re-flushes once drained
+        return;
+    }
+
+    if (!embedding_manifest_loaded) {
+        _load_embedding_manifest();
+    }
+
+    if (pending_fs_changes) {
+        EditorFileSystem *efs = EditorFileSystem::get_singleton();
+        if (!efs || efs->is_scanning()) {
+            // filesystem_changed fires again when the scan completes
+            return;
         }
-        embedding_status_dots = 0;
-        if (embedding_status_timer && !embedding_status_timer->is_stopped()) embedding_status_timer->stop();
-        embedding_status_timer->start();
+        HashSet<String> seen;
+        _collect_embedding_changes(efs->get_filesystem(), seen);
+        for (const KeyValue<String, EmbeddingManifestEntry> &E : embedding_manifest) {
+            if (!seen.has(E.key)) {
+                pending_removed_files.insert(E.key);
+            }
+        }
+        pending_fs_changes = false;
+    }
+
+    for (const String &path : pending_changed_files) {
+        embedding_upload_queue.push_back(path);
+    }
+    for (const String &path : pending_removed_files) {
+        if (embedding_manifest.has(path)) {
+            embedding_removal_queue.push_back(path);
+        }
+    }
+    pending_changed_files.clear();
+    pending_removed_files.clear();
+
+    if (embedding_upload_queue.is_empty() && embedding_removal_queue.is_empty()) {
+        initial_indexing_done = true;
+        return;
+    }
+
+    print_line(vformat("AI Chat: 🔄 Embedding sync: %d changed, %d removed", embedding_upload_queue.size(), embedding_removal_queue.size()));
+    _send_next_embedding_batch();
+}
+
+void AIChatDock::_send_next_embedding_batch() {
+    embedding_batch_action = String();
+    embedding_batch_payload = Dictionary();
+    embedding_batch_paths.clear();
+    embedding_batch_entries.clear();
+    embedding_batch_attempts = 0;
+
+    if (!embedding_removal_queue.is_empty()) {
+        const String path = embedding_removal_queue[embedding_removal_queue.size() - 1];
+        embedding_removal_queue.resize(embedding_removal_queue.size() - 1);
+
+        embedding_batch_action = "remove_file";
+        embedding_batch_payload["file_path"] = path.trim_prefix("res://");
+        embedding_batch_paths.push_back(path);
+        _set_embedding_status("Removing deleted files", true);
     } else {
-        if (embedding_status_timer) embedding_status_timer->stop();
+        // Fill one batch, bounded by file count and payload size. Files whose
+        // content hash matches the manifest are only touched, never sent.
+        Array files_arr;
+        int batch_bytes = 0;
+        while (!embedding_upload_queue.is_empty() && files_arr.size() < EMBEDDING_BATCH_MAX_FILES && batch_bytes < EMBEDDING_BATCH_MAX_BYTES) {
+            const String path = embedding_upload_queue[embedding_upload_queue.size() - 1];
+            embedding_upload_queue.resize(embedding_upload_queue.size() - 1);
+
+            EmbeddingManifestEntry entry;
+            Dictionary file_data = _read_file_for_indexing(path, entry);
+            EmbeddingManifestEntry *known = embedding_manifest.getptr(path);
+            if (file_data.is_empty()) {
+                if (!FileAccess::exists(path) && known) {
+                    embedding_removal_queue.push_back(path);
+                }
+                continue;
+            }
+            if (known && known->hash == entry.hash && known->size == entry.size) {
+                known->modified_time = entry.modified_time;
+                embedding_manifest_dirty = true;
+                continue;
+            }
+            batch_bytes += entry.size;
+            files_arr.push_back(file_data);
+            embedding_batch_paths.push_back(path);
+            embedding_batch_entries.push_back(entry);
+        }
+
+        if (files_arr.is_empty()) {
+            if (!embedding_removal_queue.is_empty() || !embedding_upload_queue.is_empty()) {
+                _send_next_embedding_batch();
+                return;
+            }
+            // Drained
+            _save_embedding_manifest();
+            initial_indexing_done = true;
+            _set_embedding_status("Index up to date", false);
+            if (pending_fs_changes || !pending_changed_files.is_empty() || !pending_removed_files.is_empty()) {
+                _queue_embedding_sync();
+            }
+            return;
+        }
+
+        Dictionary batch_info;
+        batch_info["current"] = 1;
+        batch_info["total"] = 1;
+        batch_info["files_in_batch"] = files_arr.size();
+        embedding_batch_action = "index_files";
+        embedding_batch_payload["files"] = files_arr;
+        embedding_batch_payload["batch_info"] = batch_info;
+        _set_embedding_status(vformat("Indexing %d changed files (%d left)", files_arr.size(), embedding_upload_queue.size()), true);
+    }
+
+    if (_send_embedding_request(embedding_batch_action, embedding_batch_payload) != OK) {
+        _finish_embedding_batch(false, "Request could not be started");
     }
 }
 
-void AIChatDock::_on_embedding_status_tick() {
-    if (!embedding_in_progress || !embedding_status_label) return;
-    embedding_status_dots = (embedding_status_dots + 1) % 4;
-    String dots;
-    for (int i = 0; i < embedding_status_dots; i++) dots += ".";
-    embedding_status_label->set_text(embedding_status_base + dots);
+void AIChatDock::_finish_embedding_batch(bool p_success, const String &p_error) {
+    if (p_success) {
+        if (embedding_batch_action == "remove_file") {
+            for (const String &path : embedding_batch_paths) {
+                embedding_manifest.erase(path);
+            }
+        } else {
+            for (int i = 0; i < embedding_batch_paths.size(); i++) {
+                embedding_manifest[embedding_batch_paths[i]] = embedding_batch_entries[i];
+            }
+        }
+        embedding_manifest_dirty = true;
+        callable_mp(this, &AIChatDock::_send_next_embedding_batch).call_deferred();
+        return;
+    }
+
+    embedding_batch_attempts++;
+    if (embedding_batch_attempts <= EMBEDDING_MAX_RETRIES && embedding_retry_timer) {
+        const double delay = MIN(60.0, double(1 << embedding_batch_attempts));
+        print_line(vformat("AI Chat: 🔁 Embedding batch failed (%s), retry %d/%d in %ds", p_error, embedding_batch_attempts, EMBEDDING_MAX_RETRIES, int(delay)));
+        _set_embedding_status("Indexing retry " + itos(embedding_batch_attempts), true);
+        embedding_retry_timer->start(delay);
+        return;
+    }
+
+    // Give up for now; the next flush (poll tick or change signal) picks it up again
+    print_line("AI Chat: ❌ Embedding sync paused after repeated failures: " + p_error);
+    _requeue_embedding_batch();
+    _save_embedding_manifest();
+    _set_embedding_status("Indexing failed: " + p_error, false);
 }
 
-void AIChatDock::_suggest_relevant_files(const String &p_query) {
+void AIChatDock::_requeue_embedding_batch() {
+    // Everything not yet acknowledged goes back into the dirty sets
+    HashSet<String> &target = embedding_batch_action == "remove_file" ? pending_removed_files : pending_changed_files;
+    for (const String &path : embedding_batch_paths) {
+        target.insert(path);
+    }
+    for (const String &path : embedding_upload_queue) {
+        pending_changed_files.insert(path);
+    }
+    for (const String &path : embedding_removal_queue) {
+        pending_removed_files.insert(path);
+    }
+    embedding_upload_queue.clear();
+    embedding_removal_queue.clear();
+    embedding_batch_action = String();
+    embedding_batch_payload = Dictionary();
+    embedding_batch_paths.clear();
+    embedding_batch_entries.clear();
+    embedding_batch_attempts = 0;
+}
+
+void AIChatDock::_abort_embedding_sync() {
+    // Used when the credentials go away; a pending batch or retry would
+    // otherwise keep later flushes from starting.
+    if (embedding_retry_timer) {
+        embedding_retry_timer->stop();
+    }
+    if (embedding_request_busy) {
+        HTTPConnectionPool::get_singleton()->cancel(embedding_request);
+        embedding_request = HTTPConnectionPool::INVALID_REQUEST_ID;
+        embedding_request_busy = false;
+    }
+    _requeue_embedding_batch();
+}
+
+void AIChatDock::_on_embedding_retry_timeout() {
+    if (embedding_batch_action.is_empty()) {
+        return;
+    }
     if (!_is_user_authenticated()) {
+        _abort_embedding_sync();
         return;
     }
-    Dictionary payload;
-    payload["project_root"] = _get_project_root_path();
-    payload["query"] = p_query;
-    payload["k"] = 5;
-    payload["include_graph"] = true;
-    _send_embedding_request("search", payload);
+    if (_send_embedding_request(embedding_batch_action, embedding_batch_payload) != OK) {
+        _finish_embedding_batch(false, "Request could not be started");
+    }
 }
 
-void AIChatDock::_auto_attach_relevant_context() {
-    // Heuristic: suggest based on last user message
-    Vector<ChatMessage> &msgs = _get_current_chat_history();
-    for (int i = msgs.size() - 1; i >= 0; i--) {
-        if (msgs[i].role == "user" && !msgs[i].content.is_empty()) {
-            _suggest_relevant_files(msgs[i].content);
-            break;
-        }
+Dictionary AIChatDock::_read_file_for_indexing(const String &p_path, EmbeddingManifestEntry &r_entry) {
+    Ref<FileAccess> file = FileAccess::open(p_path, FileAccess::READ);
+    if (file.is_null()) {
+        return Dictionary();
+    }
+
+    PackedByteArray bytes = file->get_buffer(file->get_length());
+    file.unref();
+
+    String content;
+    if (content.append_utf8((const char *)bytes.ptr(), bytes.size()) != OK) {
+        return Dictionary();
+    }
+    // Skip BOM if present
+    if (content.length() > 0 && content[0] == 0xFEFF) {
+        content = content.substr(1);
+    }
+
+    // Skip empty files or files with only whitespace
+    if (content.strip_edges().is_empty()) {
+        return Dictionary();
     }
-}
 
+    r_entry.modified_time = FileAccess::get_modified_time(p_path);
+    r_entry.size = bytes.size();
+    r_entry.hash = _calculate_content_hash(bytes);
 
+    Dictionary file_data;
+    file_data["path"] = p_path.trim_prefix("res://");
+    file_data["content"] = content;
+    file_data["hash"] = r_entry.hash;
+    file_data["size"] = content.length();
+
+    return file_data;
+}
+
+String AIChatDock::_calculate_content_hash(const PackedByteArray &p_content) {
+    // Content-addressed: identical bytes always give the same hash, across sessions
+    unsigned char digest[32];
+    CryptoCore::sha256(p_content.ptr(), p_content.size(), digest);
+    return String::hex_encode_buffer(digest, 32);
+}
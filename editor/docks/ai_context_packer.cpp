@@ -0,0 +1,475 @@
+/**************************************************************************/
+/*  ai_context_packer.cpp                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ai_context_packer.h"
+
+#include "core/templates/hash_set.h"
+#include "core/templates/hashfuncs.h"
+#include "core/variant/variant.h"
+
+int AIContextPacker::estimate_tokens(const String &p_text) {
+	// About four characters per token for English text and source code.
+	return (p_text.length() + 3) / 4;
+}
+
+int AIContextPacker::estimate_message_tokens(const Dictionary &p_message) {
+	int tokens = MESSAGE_OVERHEAD_TOKENS;
+
+	const Variant content = p_message.get("content", Variant());
+	if (content.get_type() == Variant::STRING) {
+		tokens += estimate_tokens(content);
+	} else if (content.get_type() == Variant::ARRAY) {
+		const Array parts = content;
+		for (int i = 0; i < parts.size(); i++) {
+			const Dictionary part = parts[i];
+			if (String(part.get("type", "")) == "image_url") {
+				tokens += IMAGE_TOKENS;
+			} else {
+				tokens += estimate_tokens(part.get("text", ""));
+			}
+		}
+	}
+
+	const Array tool_calls = p_message.get("tool_calls", Array());
+	for (int i = 0; i < tool_calls.size(); i++) {
+		const Dictionary call = tool_calls[i];
+		const Dictionary function = call.get("function", Dictionary());
+		tokens += MESSAGE_OVERHEAD_TOKENS + estimate_tokens(function.get("name", "")) + estimate_tokens(function.get("arguments", ""));
+	}
+
+	if (p_message.has("name")) {
+		tokens += estimate_tokens(p_message["name"]);
+	}
+
+	// Payloads sent along with the message, which the backend forwards.
+	const Array files = p_message.get("attached_files", Array());
+	for (int i = 0; i < files.size(); i++) {
+		const Dictionary file = files[i];
+		if (bool(file.get("is_image", false)) || !String(file.get("base64_data", "")).is_empty()) {
+			tokens += IMAGE_TOKENS;
+		}
+		tokens += estimate_tokens(file.get("content", ""));
+	}
+	const Array images = p_message.get("images", Array());
+	tokens += images.size() * IMAGE_TOKENS;
+	if (p_message.has("tool_results")) {
+		tokens += _estimate_payload_tokens(p_message["tool_results"]);
+	}
+	return tokens;
+}
+
+int AIContextPacker::_estimate_payload_tokens(const Variant &p_value) {
+	switch (p_value.get_type()) {
+		case Variant::STRING:
+			return estimate_tokens(p_value);
+		case Variant::ARRAY: {
+			const Array array = p_value;
+			int tokens = 0;
+			for (int i = 0; i < array.size(); i++) {
+				tokens += _estimate_payload_tokens(array[i]);
+			}
+			return tokens;
+		}
+		case Variant::DICTIONARY: {
+			const Dictionary dict = p_value;
+			int tokens = 0;
+			for (const KeyValue<Variant, Variant> &kv : dict) {
+				const String key = kv.key;
+				if ((key == "image_data" || key == "base64_data") && !String(kv.value).is_empty()) {
+					tokens += IMAGE_TOKENS;
+				} else {
+					tokens += estimate_tokens(key) + _estimate_payload_tokens(kv.value);
+				}
+			}
+			return tokens;
+		}
+		default:
+			return 1;
+	}
+}
+
+int AIContextPacker::get_model_context_window(const String &p_model) {
+	const String model = p_model.to_lower();
+	if (model.begins_with("gpt-4o") || model.begins_with("gpt-4-turbo") || model.begins_with("gpt-4.1") || model.begins_with("o1") || model.begins_with("o3") || model.begins_with("o4")) {
+		return 128000;
+	}
+	if (model.begins_with("gpt-4-32k")) {
+		return 32768;
+	}
+	if (model.begins_with("gpt-4")) {
+		return 8192;
+	}
+	if (model.begins_with("gpt-3.5-turbo")) {
+		return 16385;
+	}
+	if (model.begins_with("claude")) {
+		return 200000;
+	}
+	return DEFAULT_TOKEN_BUDGET;
+}
+
+String AIContextPacker::_format_attachment(const Dictionary &p_file, bool p_duplicate) {
+	const String header = "\n\n**File: " + String(p_file.get("name", "")) + " (" + String(p_file.get("path", "")) + ")**";
+	if (p_duplicate) {
+		return header + " - same content as attached again in a later message.\n";
+	}
+	return header + "\n```\n" + String(p_file.get("content", "")) + "\n```\n";
+}
+
+void AIContextPacker::_inline_attachments(Dictionary &p_message) {
+	if (String(p_message.get("role", "")) != "user" || !p_message.has("attached_files")) {
+		return;
+	}
+
+	// The message is a shallow copy, so the content parts and attachments
+	// still belong to the caller until they are copied here.
+	Array files = Array(p_message["attached_files"]).duplicate();
+	Variant content = p_message.get("content", String());
+	if (content.get_type() == Variant::ARRAY) {
+		content = Array(content).duplicate();
+	}
+	for (int i = 0; i < files.size(); i++) {
+		Dictionary file = files[i];
+		if (bool(file.get("is_image", false))) {
+			continue;
+		}
+		const bool duplicate = file.get("duplicate", false);
+		if (!duplicate && String(file.get("content", "")).is_empty()) {
+			continue;
+		}
+
+		const String text = _format_attachment(file, duplicate);
+		if (content.get_type() == Variant::ARRAY) {
+			Array parts = content;
+			Dictionary part;
+			part["type"] = "text";
+			part["text"] = text;
+			parts.push_back(part);
+		} else {
+			content = String(content) + text;
+		}
+
+		// Sent once, as part of `content`.
+		file = file.duplicate();
+		file.erase("content");
+		files[i] = file;
+	}
+	p_message["content"] = content;
+	p_message["attached_files"] = files;
+}
+
+String AIContextPacker::_summarize_message(const Dictionary &p_message) {
+	String text;
+	const Variant content = p_message.get("content", Variant());
+	if (content.get_type() == Variant::ARRAY) {
+		const Array parts = content;
+		for (int i = 0; i < parts.size(); i++) {
+			const Dictionary part = parts[i];
+			if (part.has("text")) {
+				text += String(part["text"]) + " ";
+			}
+		}
+	} else {
+		text = content;
+	}
+	text = text.strip_edges().replace("\r", "").replace("\n", " ");
+	if (text.length() > SUMMARY_LINE_CHARS) {
+		text = text.substr(0, SUMMARY_LINE_CHARS) + "...";
+	}
+
+	const String role = p_message.get("role", "");
+	String line;
+	if (role == "tool") {
+		line = "- Tool " + String(p_message.get("name", "")) + ": " + text;
+	} else {
+		line = "- " + role.capitalize() + ": " + text;
+	}
+
+	const Array files = p_message.get("attached_files", Array());
+	if (!files.is_empty()) {
+		PackedStringArray names;
+		for (int i = 0; i < files.size(); i++) {
+			names.push_back(Dictionary(files[i]).get("name", ""));
+		}
+		line += " [attached: " + String(", ").join(names) + "]";
+	}
+
+	const Array tool_calls = p_message.get("tool_calls", Array());
+	if (!tool_calls.is_empty()) {
+		PackedStringArray names;
+		for (int i = 0; i < tool_calls.size(); i++) {
+			const Dictionary function = Dictionary(tool_calls[i]).get("function", Dictionary());
+			names.push_back(function.get("name", ""));
+		}
+		line += " [called: " + String(", ").join(names) + "]";
+	}
+	return line;
+}
+
+String AIContextPacker::_truncate_to_tokens(const String &p_text, int p_tokens) {
+	const int max_chars = MAX(p_tokens, 0) * 4;
+	if (p_text.length() <= max_chars) {
+		return p_text;
+	}
+	// Keep both ends: the head usually holds the question or file header and
+	// the tail the most recent output.
+	const int head = max_chars * 2 / 3;
+	const int tail = max_chars - head;
+	return p_text.substr(0, head) + vformat("\n[... %d characters omitted ...]\n", p_text.length() - max_chars) + p_text.substr(p_text.length() - tail);
+}
+
+Array AIContextPacker::pack(const Array &p_messages) {
+	last_stats = Stats();
+	const int count = p_messages.size();
+
+	LocalVector<Dictionary> messages;
+	LocalVector<int> turns;
+	messages.resize(count);
+	turns.resize(count);
+	int turn_count = 0;
+	for (int i = 0; i < count; i++) {
+		messages[i] = Dictionary(p_messages[i]).duplicate();
+		if (String(messages[i].get("role", "")) == "user") {
+			turn_count++;
+		}
+		turns[i] = turn_count;
+	}
+
+	// Files attached again in a later turn keep only their newest copy.
+	HashSet<uint64_t> seen_files;
+	for (int i = count - 1; i >= 0; i--) {
+		Dictionary &msg = messages[i];
+		if (String(msg.get("role", "")) != "user" || !msg.has("attached_files")) {
+			continue;
+		}
+		Array files = Array(msg["attached_files"]).duplicate();
+		bool changed = false;
+		for (int j = 0; j < files.size(); j++) {
+			Dictionary file = files[j];
+			const String content = file.get("content", "");
+			if (bool(file.get("is_image", false)) || content.is_empty()) {
+				continue;
+			}
+			const uint64_t hash = content.hash64();
+			if (!seen_files.has(hash)) {
+				seen_files.insert(hash);
+				continue;
+			}
+			file = file.duplicate();
+			file["content"] = String();
+			file["duplicate"] = true;
+			files[j] = file;
+			changed = true;
+			last_stats.deduplicated_files++;
+		}
+		if (changed) {
+			msg["attached_files"] = files;
+		}
+	}
+
+	LocalVector<int> tokens;
+	tokens.resize(count);
+	int total = 0;
+	for (int i = 0; i < count; i++) {
+		_inline_attachments(messages[i]);
+		tokens[i] = estimate_message_tokens(messages[i]);
+		total += tokens[i];
+	}
+	last_stats.input_tokens = total;
+
+	// Stale tool outputs go first, oldest first.
+	const int first_recent_turn = MAX(turn_count - keep_recent_turns + 1, 1);
+	for (int i = 0; i < count && total > token_budget; i++) {
+		Dictionary &msg = messages[i];
+		if (turns[i] >= first_recent_turn || String(msg.get("role", "")) != "tool" || tokens[i] <= 64) {
+			continue;
+		}
+		msg["content"] = vformat("[Output of %s omitted from context (~%d tokens). Call the tool again if it is still needed.]", msg.get("name", "tool"), tokens[i]);
+		msg.erase("tool_results");
+		msg.erase("attached_files");
+		msg.erase("images");
+		const int stub_tokens = estimate_message_tokens(msg);
+		total += stub_tokens - tokens[i];
+		tokens[i] = stub_tokens;
+		last_stats.stubbed_tool_outputs++;
+	}
+
+	// Messages before the first user message (system prompts, project
+	// context) are pinned and never folded into the summary.
+	int pinned = 0;
+	while (pinned < count && turns[pinned] == 0) {
+		pinned++;
+	}
+
+	// Fold leading turns after the pinned messages into the summary. Cuts
+	// only happen at user messages so assistant tool calls stay next to their
+	// results. Messages in [pinned, cut) are summarized; summary lines are
+	// indexed from `pinned`.
+	int cut = pinned;
+	String summary;
+	if (total > token_budget && turn_count > 1) {
+		uint64_t chain = HASH_MURMUR3_SEED;
+		uint32_t valid = 0;
+		int summary_tokens = 0;
+		int kept_tokens = total;
+		const int summary_cap = token_budget / 8;
+		for (int i = pinned; i < count; i++) {
+			if (turns[i] == turn_count) {
+				break;
+			}
+			const int line = i - pinned;
+			chain = hash_djb2_one_64(p_messages[i].hash(), chain);
+			if (valid == uint32_t(line) && line < int(summary_chain.size()) && summary_chain[line] == chain) {
+				valid++;
+			} else {
+				summary_chain.resize(line);
+				summary_lines.resize(line);
+				summary_chain.push_back(chain);
+				summary_lines.push_back(_summarize_message(p_messages[i]));
+				valid = line + 1;
+			}
+			summary_tokens += estimate_tokens(summary_lines[line]) + 1;
+			kept_tokens -= tokens[i];
+
+			const bool at_turn_end = turns[i + 1] != turns[i];
+			if (at_turn_end && kept_tokens + MIN(summary_tokens, summary_cap) + MESSAGE_OVERHEAD_TOKENS <= token_budget) {
+				cut = i + 1;
+				break;
+			}
+			if (at_turn_end) {
+				cut = i + 1;
+			}
+		}
+
+		if (cut > pinned) {
+			const int lines = cut - pinned;
+			// Oldest lines give way first when the summary outgrows its share.
+			int first_line = 0;
+			int lines_tokens = 0;
+			for (int i = lines - 1; i >= 0; i--) {
+				const int line_tokens = estimate_tokens(summary_lines[i]) + 1;
+				if (lines_tokens + line_tokens > summary_cap) {
+					first_line = i + 1;
+					break;
+				}
+				lines_tokens += line_tokens;
+			}
+
+			summary = vformat("Summary of the earlier conversation (%d messages not included):\n", lines);
+			if (first_line > 0) {
+				summary += vformat("- (%d older messages)\n", first_line);
+			}
+			for (int i = first_line; i < lines; i++) {
+				summary += summary_lines[i] + "\n";
+			}
+			for (int i = pinned; i < cut; i++) {
+				total -= tokens[i];
+			}
+			total += estimate_tokens(summary) + MESSAGE_OVERHEAD_TOKENS;
+			last_stats.summarized_messages = lines;
+		}
+	}
+
+	// Last resort: the remaining turns alone exceed the budget, so shorten
+	// their largest text blocks.
+	while (total > token_budget) {
+		int largest = -1;
+		int largest_part = -1;
+		int largest_tokens = 256;
+		for (int i = 0; i < count; i++) {
+			if (i >= pinned && i < cut) {
+				continue; // Summarized.
+			}
+			const Variant content = messages[i].get("content", Variant());
+			if (content.get_type() == Variant::STRING) {
+				const int t = estimate_tokens(content);
+				if (t > largest_tokens) {
+					largest = i;
+					largest_part = -1;
+					largest_tokens = t;
+				}
+			} else if (content.get_type() == Variant::ARRAY) {
+				const Array parts = content;
+				for (int j = 0; j < parts.size(); j++) {
+					const int t = estimate_tokens(Dictionary(parts[j]).get("text", ""));
+					if (t > largest_tokens) {
+						largest = i;
+						largest_part = j;
+						largest_tokens = t;
+					}
+				}
+			}
+		}
+		if (largest == -1) {
+			break;
+		}
+
+		const int target = MAX(largest_tokens - (total - token_budget), 256);
+		Dictionary &msg = messages[largest];
+		if (largest_part == -1) {
+			msg["content"] = _truncate_to_tokens(msg["content"], target);
+		} else {
+			Array parts = Array(msg["content"]).duplicate();
+			Dictionary part = Dictionary(parts[largest_part]).duplicate();
+			part["text"] = _truncate_to_tokens(part["text"], target);
+			parts[largest_part] = part;
+			msg["content"] = parts;
+		}
+		const int new_tokens = estimate_message_tokens(msg);
+		if (new_tokens >= tokens[largest]) {
+			break;
+		}
+		total += new_tokens - tokens[largest];
+		tokens[largest] = new_tokens;
+		last_stats.truncated_messages++;
+	}
+
+	Array result;
+	for (int i = 0; i < pinned; i++) {
+		result.push_back(messages[i]);
+	}
+	if (cut > pinned) {
+		Dictionary summary_message;
+		summary_message["role"] = "system";
+		summary_message["content"] = summary;
+		result.push_back(summary_message);
+	}
+	for (int i = cut; i < count; i++) {
+		result.push_back(messages[i]);
+	}
+	last_stats.output_tokens = total;
+	return result;
+}
+
+void AIContextPacker::clear() {
+	summary_chain.clear();
+	summary_lines.clear();
+	last_stats = Stats();
+}
@@ -0,0 +1,105 @@
+/**************************************************************************/
+/*  ai_context_packer.h                                                   */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/string/ustring.h"
+#include "core/templates/local_vector.h"
+#include "core/variant/array.h"
+#include "core/variant/dictionary.h"
+
+// Fits a /chat request into a per-model token budget.
+//
+// Messages are the dictionaries built by AIChatDock::_build_api_message.
+// Text attachments of user messages are listed in `attached_files` and are
+// only inlined into `content` here, after files attached again in a later
+// turn (same content hash) have been replaced by a short reference.
+//
+// When the estimate is still over budget, outputs of tool calls older than
+// the most recent turns are replaced by stubs, then whole leading turns are
+// folded into a rolling summary message. Messages before the first user
+// message (system prompts) are always kept. Summary lines are cached per
+// message, keyed by a hash chain over the history prefix, so a growing
+// conversation only summarizes the messages that newly fell out of the
+// window.
+class AIContextPacker {
+public:
+	static constexpr int DEFAULT_TOKEN_BUDGET = 32000;
+	static constexpr int DEFAULT_RESPONSE_RESERVE = 4096;
+	static constexpr int DEFAULT_KEEP_RECENT_TURNS = 2;
+
+	struct Stats {
+		int input_tokens = 0;
+		int output_tokens = 0;
+		int deduplicated_files = 0;
+		int stubbed_tool_outputs = 0;
+		int summarized_messages = 0;
+		int truncated_messages = 0;
+	};
+
+private:
+	// Rough cost of an image part; providers bill by tile, not by bytes.
+	static constexpr int IMAGE_TOKENS = 800;
+	static constexpr int MESSAGE_OVERHEAD_TOKENS = 4;
+	static constexpr int SUMMARY_LINE_CHARS = 160;
+
+	int token_budget = DEFAULT_TOKEN_BUDGET;
+	int keep_recent_turns = DEFAULT_KEEP_RECENT_TURNS;
+
+	// Rolling summary: one line per summarized message, valid while the
+	// message hash chain up to that index is unchanged.
+	LocalVector<uint64_t> summary_chain;
+	LocalVector<String> summary_lines;
+
+	Stats last_stats;
+
+	static int _estimate_payload_tokens(const Variant &p_value);
+	static String _format_attachment(const Dictionary &p_file, bool p_duplicate);
+	static void _inline_attachments(Dictionary &p_message);
+	static String _summarize_message(const Dictionary &p_message);
+	static String _truncate_to_tokens(const String &p_text, int p_tokens);
+
+public:
+	static int estimate_tokens(const String &p_text);
+	static int estimate_message_tokens(const Dictionary &p_message);
+
+	// Context window of known models; unknown models get a conservative size.
+	static int get_model_context_window(const String &p_model);
+
+	void set_token_budget(int p_tokens) { token_budget = MAX(p_tokens, 1024); }
+	int get_token_budget() const { return token_budget; }
+	void set_keep_recent_turns(int p_turns) { keep_recent_turns = MAX(p_turns, 1); }
+
+	// Returns a packed copy of `p_messages`; the input is not modified.
+	Array pack(const Array &p_messages);
+	const Stats &get_last_stats() const { return last_stats; }
+
+	void clear();
+};
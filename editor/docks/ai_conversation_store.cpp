@@ -0,0 +1,364 @@
+/**************************************************************************/
+/*  ai_conversation_store.cpp                                             */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ai_conversation_store.h"
+
+#include "core/crypto/crypto_core.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+
+static const char *BLOB_KEY_SUFFIX = "@blob";
+
+String AIConversationStore::_get_log_path(const String &p_id) const {
+	return root.path_join("logs").path_join(p_id.validate_filename() + ".log");
+}
+
+String AIConversationStore::_get_blob_path(const String &p_hash) const {
+	return root.path_join("blobs").path_join(p_hash.substr(0, 2)).path_join(p_hash);
+}
+
+bool AIConversationStore::_is_blob_key(const String &p_key) {
+	// Attached images and generated images in tool results.
+	return p_key == "base64_data" || p_key == "image_data";
+}
+
+String AIConversationStore::_store_blob(const String &p_base64) {
+	const CharString ascii = p_base64.ascii();
+	Vector<uint8_t> bytes;
+	bytes.resize(ascii.length() / 4 * 3 + 3);
+	size_t decoded_size = 0;
+	if (CryptoCore::b64_decode(bytes.ptrw(), bytes.size(), &decoded_size, (const uint8_t *)ascii.get_data(), ascii.length()) != OK) {
+		return String(); // Not plain base64 (e.g. a data URL); keep it inline.
+	}
+	bytes.resize(decoded_size);
+
+	unsigned char digest[32];
+	if (CryptoCore::sha256(bytes.ptr(), bytes.size(), digest) != OK) {
+		return String();
+	}
+	const String hash = String::hex_encode_buffer(digest, 32);
+
+	{
+		MutexLock lock(mutex);
+		if (known_blobs.has(hash)) {
+			return hash;
+		}
+	}
+
+	const String path = _get_blob_path(hash);
+	if (!FileAccess::exists(path)) {
+		DirAccess::make_dir_recursive_absolute(path.get_base_dir());
+		const String temp_path = path + ".tmp";
+		Error err;
+		Ref<FileAccess> file = FileAccess::open(temp_path, FileAccess::WRITE, &err);
+		ERR_FAIL_COND_V_MSG(file.is_null(), String(), "Cannot write conversation blob: " + temp_path);
+		const bool stored = file->store_buffer(bytes);
+		file->close();
+		if (!stored || DirAccess::rename_absolute(temp_path, path) != OK) {
+			DirAccess::remove_absolute(temp_path);
+			return String();
+		}
+	}
+
+	MutexLock lock(mutex);
+	known_blobs.insert(hash);
+	return hash;
+}
+
+Variant AIConversationStore::_externalize_blobs(const Variant &p_value) {
+	// Builds a copy so the caller's containers are never modified.
+	switch (p_value.get_type()) {
+		case Variant::DICTIONARY: {
+			const Dictionary source = p_value;
+			Dictionary result;
+			for (const KeyValue<Variant, Variant> &kv : source) {
+				if (kv.key.get_type() == Variant::STRING && kv.value.get_type() == Variant::STRING && _is_blob_key(kv.key)) {
+					const String data = kv.value;
+					if (data.length() >= BLOB_MIN_SIZE) {
+						const String hash = _store_blob(data);
+						if (!hash.is_empty()) {
+							result[kv.key] = String();
+							result[String(kv.key) + BLOB_KEY_SUFFIX] = hash;
+							continue;
+						}
+					}
+				}
+				result[kv.key] = _externalize_blobs(kv.value);
+			}
+			return result;
+		}
+		case Variant::ARRAY: {
+			const Array source = p_value;
+			Array result;
+			result.resize(source.size());
+			for (int i = 0; i < source.size(); i++) {
+				result[i] = _externalize_blobs(source[i]);
+			}
+			return result;
+		}
+		default:
+			return p_value;
+	}
+}
+
+void AIConversationStore::_resolve_blobs(Variant &r_value) const {
+	// Values come straight from the JSON parser, so they are resolved in place.
+	if (r_value.get_type() == Variant::ARRAY) {
+		Array array = r_value;
+		for (int i = 0; i < array.size(); i++) {
+			Variant element = array[i];
+			_resolve_blobs(element);
+		}
+		return;
+	}
+	if (r_value.get_type() != Variant::DICTIONARY) {
+		return;
+	}
+
+	Dictionary dict = r_value;
+	const Array keys = dict.keys();
+	for (int i = 0; i < keys.size(); i++) {
+		const String key = keys[i];
+		if (!key.ends_with(BLOB_KEY_SUFFIX)) {
+			Variant value = dict[keys[i]];
+			_resolve_blobs(value);
+			continue;
+		}
+		const String hash = dict[key];
+		dict.erase(key);
+		const Vector<uint8_t> bytes = FileAccess::get_file_as_bytes(_get_blob_path(hash));
+		if (bytes.is_empty()) {
+			WARN_PRINT("Missing conversation blob: " + hash);
+			continue;
+		}
+		dict[key.trim_suffix(BLOB_KEY_SUFFIX)] = CryptoCore::b64_encode_str(bytes.ptr(), bytes.size());
+	}
+}
+
+Error AIConversationStore::_replay(const String &p_id, Array &r_messages, int &r_written) const {
+	r_messages.clear();
+	r_written = 0;
+
+	const String path = _get_log_path(p_id);
+	if (!FileAccess::exists(path)) {
+		return OK;
+	}
+	Error err;
+	Ref<FileAccess> file = FileAccess::open(path, FileAccess::READ, &err);
+	ERR_FAIL_COND_V_MSG(file.is_null(), err, "Cannot open conversation journal: " + path);
+
+	Ref<JSON> json;
+	json.instantiate();
+	while (!file->eof_reached()) {
+		const String line = file->get_line();
+		if (line.is_empty()) {
+			continue;
+		}
+		if (json->parse(line) != OK || json->get_data().get_type() != Variant::DICTIONARY) {
+			// A record torn by an interrupted write. append() starts the next
+			// record on its own line, so later records are still replayed.
+			WARN_PRINT("Ignoring unreadable record in conversation journal: " + path);
+			continue;
+		}
+		const Dictionary record = json->get_data();
+		const int at = record.get("at", -1);
+		if (at < 0 || at > r_messages.size()) {
+			WARN_PRINT("Ignoring out of range record in conversation journal: " + path);
+			continue;
+		}
+		const Array messages = record.get("messages", Array());
+		r_messages.resize(at);
+		r_messages.append_array(messages);
+		r_written += messages.size();
+	}
+	return OK;
+}
+
+Error AIConversationStore::_write_file_atomic(const String &p_path, const String &p_data) const {
+	DirAccess::make_dir_recursive_absolute(p_path.get_base_dir());
+	const String temp_path = p_path + ".tmp";
+	Error err;
+	{
+		Ref<FileAccess> file = FileAccess::open(temp_path, FileAccess::WRITE, &err);
+		ERR_FAIL_COND_V_MSG(file.is_null(), err, "Cannot write file: " + temp_path);
+		if (!file->store_string(p_data)) {
+			return ERR_FILE_CANT_WRITE;
+		}
+	}
+	if (FileAccess::exists(p_path)) {
+		DirAccess::remove_absolute(p_path);
+	}
+	return DirAccess::rename_absolute(temp_path, p_path);
+}
+
+Error AIConversationStore::_compact(const String &p_id) {
+	Array messages;
+	int written = 0;
+	Error err = _replay(p_id, messages, written);
+	if (err != OK) {
+		return err;
+	}
+
+	Dictionary record;
+	record["at"] = 0;
+	record["messages"] = messages;
+	err = _write_file_atomic(_get_log_path(p_id), JSON::stringify(record, "", false) + "\n");
+	if (err != OK) {
+		return err;
+	}
+
+	MutexLock lock(mutex);
+	JournalStats &journal = stats[p_id];
+	journal.live = messages.size();
+	journal.written = messages.size();
+	return OK;
+}
+
+void AIConversationStore::set_root(const String &p_root) {
+	MutexLock lock(mutex);
+	root = p_root;
+	stats.clear();
+	known_blobs.clear();
+}
+
+bool AIConversationStore::has_index() const {
+	return FileAccess::exists(root.path_join("index.json"));
+}
+
+Error AIConversationStore::load_index(Array &r_conversations) const {
+	Error err;
+	const String text = FileAccess::get_file_as_string(root.path_join("index.json"), &err);
+	if (err != OK) {
+		return err;
+	}
+	Ref<JSON> json;
+	json.instantiate();
+	err = json->parse(text);
+	ERR_FAIL_COND_V_MSG(err != OK || json->get_data().get_type() != Variant::DICTIONARY, ERR_PARSE_ERROR, "Cannot parse conversation index.");
+
+	const Dictionary data = json->get_data();
+	ERR_FAIL_COND_V_MSG(int(data.get("version", 0)) > FORMAT_VERSION, ERR_FILE_UNRECOGNIZED, "Conversation index was written by a newer version.");
+	r_conversations = data.get("conversations", Array());
+	return OK;
+}
+
+Error AIConversationStore::save_index(const Array &p_conversations) {
+	Dictionary data;
+	data["version"] = FORMAT_VERSION;
+	data["conversations"] = p_conversations;
+	return _write_file_atomic(root.path_join("index.json"), JSON::stringify(data, "", false));
+}
+
+Error AIConversationStore::load_messages(const String &p_id, Array &r_messages) {
+	int written = 0;
+	const Error err = _replay(p_id, r_messages, written);
+	if (err != OK) {
+		return err;
+	}
+	for (int i = 0; i < r_messages.size(); i++) {
+		Variant message = r_messages[i];
+		_resolve_blobs(message);
+	}
+
+	MutexLock lock(mutex);
+	JournalStats &journal = stats[p_id];
+	journal.live = r_messages.size();
+	journal.written = written;
+	return OK;
+}
+
+Error AIConversationStore::append(const String &p_id, int p_at, const Array &p_messages) {
+	ERR_FAIL_COND_V(p_at < 0, ERR_INVALID_PARAMETER);
+
+	Array messages;
+	messages.resize(p_messages.size());
+	for (int i = 0; i < p_messages.size(); i++) {
+		messages[i] = _externalize_blobs(p_messages[i]);
+	}
+	Dictionary record;
+	record["at"] = p_at;
+	record["messages"] = messages;
+	const CharString line = (JSON::stringify(record, "", false) + "\n").utf8();
+
+	const String path = _get_log_path(p_id);
+	Error err;
+	Ref<FileAccess> file;
+	if (FileAccess::exists(path)) {
+		file = FileAccess::open(path, FileAccess::READ_WRITE, &err);
+		ERR_FAIL_COND_V_MSG(file.is_null(), err, "Cannot open conversation journal: " + path);
+		const uint64_t length = file->get_length();
+		if (length > 0) {
+			// Terminate a record torn by an earlier interrupted write so the
+			// new one starts on its own line.
+			file->seek(length - 1);
+			const bool needs_break = file->get_8() != '\n';
+			file->seek_end();
+			if (needs_break) {
+				file->store_8('\n');
+			}
+		}
+	} else {
+		DirAccess::make_dir_recursive_absolute(path.get_base_dir());
+		file = FileAccess::open(path, FileAccess::WRITE, &err);
+		ERR_FAIL_COND_V_MSG(file.is_null(), err, "Cannot create conversation journal: " + path);
+	}
+	if (!file->store_buffer((const uint8_t *)line.get_data(), line.length())) {
+		return ERR_FILE_CANT_WRITE;
+	}
+	file->close();
+
+	bool needs_compaction = false;
+	{
+		MutexLock lock(mutex);
+		JournalStats &journal = stats[p_id];
+		journal.live = p_at + p_messages.size();
+		journal.written += p_messages.size();
+		needs_compaction = journal.written > journal.live * 2 + COMPACT_SLACK;
+	}
+	if (needs_compaction) {
+		// The record is already durable; a failed compaction only costs space.
+		_compact(p_id);
+	}
+	return OK;
+}
+
+Error AIConversationStore::clear() {
+	{
+		MutexLock lock(mutex);
+		stats.clear();
+		known_blobs.clear();
+	}
+	Ref<DirAccess> dir = DirAccess::open(root);
+	if (dir.is_null()) {
+		return OK; // Nothing stored yet.
+	}
+	return dir->erase_contents_recursive();
+}
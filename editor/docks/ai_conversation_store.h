@@ -0,0 +1,99 @@
+/**************************************************************************/
+/*  ai_conversation_store.h                                               */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/os/mutex.h"
+#include "core/string/ustring.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/hash_set.h"
+#include "core/variant/array.h"
+
+// On-disk conversation history for the AI chat dock.
+//
+// Layout under the root directory:
+//   index.json        Small list of conversation metadata, rewritten per save.
+//   logs/<id>.log     Append-only journal, one JSON record per line. A record
+//                     `{"at": N, "messages": [...]}` truncates the conversation
+//                     to N messages and appends the given ones, which covers
+//                     new messages, an updated last message and edits alike.
+//   blobs/xx/<sha256> Image payloads, stored once by content hash. Records
+//                     reference them instead of embedding base64 text.
+//
+// A journal is compacted into a single record once it holds much more
+// history than live messages. Methods other than set_root() may be called
+// from a background thread; calls for the same conversation must not overlap.
+class AIConversationStore {
+	static constexpr int FORMAT_VERSION = 3;
+	static constexpr int COMPACT_SLACK = 32; // Extra records tolerated before compaction.
+	static constexpr int BLOB_MIN_SIZE = 1024; // Smaller payloads stay inline.
+
+	struct JournalStats {
+		int live = 0; // Messages after replaying the journal.
+		int written = 0; // Messages written across all records.
+	};
+
+	String root;
+	Mutex mutex;
+	HashMap<String, JournalStats> stats;
+	HashSet<String> known_blobs;
+
+	String _get_log_path(const String &p_id) const;
+	String _get_blob_path(const String &p_hash) const;
+
+	static bool _is_blob_key(const String &p_key);
+	Variant _externalize_blobs(const Variant &p_value);
+	void _resolve_blobs(Variant &r_value) const;
+	String _store_blob(const String &p_base64);
+
+	Error _replay(const String &p_id, Array &r_messages, int &r_written) const;
+	Error _write_file_atomic(const String &p_path, const String &p_data) const;
+	Error _compact(const String &p_id);
+
+public:
+	void set_root(const String &p_root);
+	const String &get_root() const { return root; }
+	bool has_index() const;
+
+	// Each entry is a Dictionary with `id`, `title`, `created_timestamp`,
+	// `last_modified_timestamp` and `message_count`.
+	Error load_index(Array &r_conversations) const;
+	Error save_index(const Array &p_conversations);
+
+	// Replays the journal of a conversation; a missing journal is empty.
+	Error load_messages(const String &p_id, Array &r_messages);
+
+	// Truncates the stored conversation to `p_at` messages and appends
+	// `p_messages` (message Dictionaries, which are not modified).
+	Error append(const String &p_id, int p_at, const Array &p_messages);
+
+	// Deletes every journal, blob and the index.
+	Error clear();
+};
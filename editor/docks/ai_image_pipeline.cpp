@@ -0,0 +1,317 @@
+/**************************************************************************/
+/*  ai_image_pipeline.cpp                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ai_image_pipeline.h"
+
+#include "core/crypto/crypto_core.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/image.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/mutex.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/hashfuncs.h"
+#include "core/templates/lru.h"
+#include "editor/ai/ai_worker_jobs.h"
+#include "editor/file_system/editor_paths.h"
+#include "scene/resources/image_texture.h"
+
+static constexpr int MEMORY_CACHE_CAPACITY = 128;
+static constexpr int MAX_DISK_THUMBNAILS = 512;
+static constexpr uint32_t THUMBNAIL_FILE_MAGIC = 0x48544941; // "AITH"
+
+namespace {
+
+struct ImageJob {
+	uint64_t id = 0;
+	bool thumbnail = false;
+	String path;
+	String mime_type;
+	String base64_data;
+	int max_size = 0;
+	String cache_dir;
+	Callable callback;
+
+	Dictionary result;
+	// Thumbnail decoded on the worker, uploaded to a texture on the main thread.
+	Ref<Image> image;
+	uint64_t key = 0;
+	WorkerThreadPool::TaskID task = WorkerThreadPool::INVALID_TASK_ID;
+};
+
+struct CachedThumbnail {
+	Ref<ImageTexture> texture;
+	Vector2i original_size;
+	Vector2i display_size;
+};
+
+AIJobRegistry<ImageJob> jobs;
+
+Mutex cache_mutex;
+uint32_t disk_writes = 0;
+
+LRUCache<uint64_t, CachedThumbnail> &_get_memory_cache() {
+	static LRUCache<uint64_t, CachedThumbnail> cache(MEMORY_CACHE_CAPACITY);
+	return cache;
+}
+
+Ref<Image> _decode_image(const Vector<uint8_t> &p_bytes) {
+	Ref<Image> image;
+	image.instantiate();
+	const uint8_t *data = p_bytes.ptr();
+	const int size = p_bytes.size();
+	Error err = ERR_FILE_UNRECOGNIZED;
+	if (size >= 4 && data[0] == 0x89 && data[1] == 'P' && data[2] == 'N' && data[3] == 'G') {
+		err = image->load_png_from_buffer(p_bytes);
+	} else if (size >= 2 && data[0] == 0xFF && data[1] == 0xD8) {
+		err = image->load_jpg_from_buffer(p_bytes);
+	} else if (size >= 12 && memcmp(data, "RIFF", 4) == 0 && memcmp(data + 8, "WEBP", 4) == 0) {
+		err = image->load_webp_from_buffer(p_bytes);
+	} else {
+		err = image->load_png_from_buffer(p_bytes);
+		if (err != OK) {
+			err = image->load_jpg_from_buffer(p_bytes);
+		}
+	}
+	if (err != OK || image->is_empty()) {
+		return Ref<Image>();
+	}
+	return image;
+}
+
+Vector<uint8_t> _decode_base64(const String &p_data) {
+	const CharString ascii = p_data.ascii();
+	Vector<uint8_t> bytes;
+	bytes.resize(ascii.length() / 4 * 3 + 1);
+	size_t length = 0;
+	if (CryptoCore::b64_decode(bytes.ptrw(), bytes.size(), &length, (const uint8_t *)ascii.get_data(), ascii.length()) != OK) {
+		return Vector<uint8_t>();
+	}
+	bytes.resize(length);
+	return bytes;
+}
+
+String _get_thumbnail_path(const ImageJob *p_job) {
+	return p_job->cache_dir.path_join(String::num_uint64(p_job->key, 16).lpad(16, "0") + ".thumb");
+}
+
+// Thumbnail files store the original size next to the PNG data, which is
+// all a chat bubble needs.
+bool _load_thumbnail(ImageJob *p_job) {
+	Ref<FileAccess> file = FileAccess::open(_get_thumbnail_path(p_job), FileAccess::READ);
+	if (file.is_null() || file->get_32() != THUMBNAIL_FILE_MAGIC) {
+		return false;
+	}
+	const Vector2i original_size(file->get_32(), file->get_32());
+	const Vector<uint8_t> png = file->get_buffer(file->get_32());
+	Ref<Image> image;
+	image.instantiate();
+	if (file->get_error() != OK || image->load_png_from_buffer(png) != OK || image->is_empty()) {
+		return false;
+	}
+	p_job->image = image;
+	p_job->result["original_size"] = original_size;
+	p_job->result["display_size"] = image->get_size();
+	return true;
+}
+
+void _store_thumbnail(const ImageJob *p_job, const Vector2i &p_original_size) {
+	const Vector<uint8_t> png = p_job->image->save_png_to_buffer();
+	if (png.is_empty()) {
+		return;
+	}
+	DirAccess::make_dir_recursive_absolute(p_job->cache_dir);
+	Ref<FileAccess> file = FileAccess::open(_get_thumbnail_path(p_job), FileAccess::WRITE);
+	if (file.is_null()) {
+		return;
+	}
+	file->store_32(THUMBNAIL_FILE_MAGIC);
+	file->store_32(p_original_size.x);
+	file->store_32(p_original_size.y);
+	file->store_32(png.size());
+	file->store_buffer(png);
+	file.unref();
+
+	bool prune = false;
+	{
+		MutexLock lock(cache_mutex);
+		prune = (++disk_writes % 32) == 0;
+	}
+	if (prune) {
+		AIDiskCache::prune(p_job->cache_dir, MAX_DISK_THUMBNAILS);
+	}
+}
+
+void _run_thumbnail(ImageJob *p_job) {
+	p_job->key = hash_djb2_one_64(uint64_t(p_job->max_size), p_job->base64_data.hash64());
+	{
+		MutexLock lock(cache_mutex);
+		const CachedThumbnail *cached = _get_memory_cache().getptr(p_job->key);
+		if (cached) {
+			p_job->result["success"] = true;
+			p_job->result["texture"] = cached->texture;
+			p_job->result["original_size"] = cached->original_size;
+			p_job->result["display_size"] = cached->display_size;
+			return;
+		}
+	}
+	if (_load_thumbnail(p_job)) {
+		p_job->result["success"] = true;
+		return;
+	}
+
+	Ref<Image> image = _decode_image(_decode_base64(p_job->base64_data));
+	if (image.is_null()) {
+		p_job->result["success"] = false;
+		p_job->result["message"] = "Failed to decode image data";
+		return;
+	}
+	const Vector2i original_size = image->get_size();
+	const Vector2i display_size = AIImagePipeline::fit_size(original_size, p_job->max_size);
+	if (image->is_compressed()) {
+		image->decompress();
+	}
+	if (display_size != original_size) {
+		image->resize(display_size.x, display_size.y, Image::INTERPOLATE_LANCZOS);
+	}
+	p_job->image = image;
+	_store_thumbnail(p_job, original_size);
+
+	p_job->result["success"] = true;
+	p_job->result["original_size"] = original_size;
+	p_job->result["display_size"] = display_size;
+}
+
+void _run_attachment(ImageJob *p_job) {
+	Ref<Image> image = Image::load_from_file(p_job->path);
+	if (image.is_null() || image->is_empty()) {
+		p_job->result["success"] = false;
+		p_job->result["message"] = "Failed to load image: " + p_job->path;
+		return;
+	}
+
+	const Vector2i original_size = image->get_size();
+	const Vector2i display_size = AIImagePipeline::fit_size(original_size, p_job->max_size);
+	if (display_size != original_size) {
+		image->resize(display_size.x, display_size.y, Image::INTERPOLATE_LANCZOS);
+	}
+
+	Vector<uint8_t> buffer;
+	if (p_job->mime_type == "image/jpeg" || p_job->mime_type == "image/jpg") {
+		buffer = image->save_jpg_to_buffer(0.85f);
+	} else {
+		buffer = image->save_png_to_buffer();
+	}
+	if (buffer.is_empty()) {
+		p_job->result["success"] = false;
+		p_job->result["message"] = "Failed to encode image: " + p_job->path;
+		return;
+	}
+
+	p_job->result["success"] = true;
+	p_job->result["base64_data"] = CryptoCore::b64_encode_str(buffer.ptr(), buffer.size());
+	p_job->result["original_size"] = original_size;
+	p_job->result["display_size"] = display_size;
+	p_job->result["was_downsampled"] = display_size != original_size;
+}
+
+void _finish_job(uint64_t p_id) {
+	ImageJob *job = jobs.take(p_id);
+	ERR_FAIL_NULL(job);
+
+	if (job->image.is_valid()) {
+		// Textures are created here so the upload stays on the main thread.
+		CachedThumbnail cached;
+		cached.texture = ImageTexture::create_from_image(job->image);
+		cached.original_size = job->result["original_size"];
+		cached.display_size = job->result["display_size"];
+		{
+			MutexLock lock(cache_mutex);
+			_get_memory_cache().insert(job->key, cached);
+		}
+		job->result["texture"] = cached.texture;
+	}
+	job->callback.call(job->result);
+	memdelete(job);
+}
+
+void _run_job(void *p_userdata) {
+	ImageJob *job = static_cast<ImageJob *>(p_userdata);
+	if (job->thumbnail) {
+		_run_thumbnail(job);
+	} else {
+		_run_attachment(job);
+	}
+	callable_mp_static(&_finish_job).call_deferred(job->id);
+}
+
+void _start_job(ImageJob *p_job) {
+	// The job can't be finished before its task is known.
+	MutexLock lock(jobs.get_mutex());
+	p_job->id = jobs.add(p_job);
+	p_job->task = WorkerThreadPool::get_singleton()->add_native_task(&_run_job, p_job, false, p_job->thumbnail ? "AI image thumbnail" : "AI image attachment");
+}
+
+} // namespace
+
+Vector2i AIImagePipeline::fit_size(const Vector2i &p_size, int p_max_dimension) {
+	if (p_size.x <= p_max_dimension && p_size.y <= p_max_dimension) {
+		return p_size;
+	}
+	const float aspect_ratio = (float)p_size.x / (float)p_size.y;
+	if (p_size.x > p_size.y) {
+		return Vector2i(p_max_dimension, MAX((int)(p_max_dimension / aspect_ratio), 1));
+	}
+	return Vector2i(MAX((int)(p_max_dimension * aspect_ratio), 1), p_max_dimension);
+}
+
+void AIImagePipeline::prepare_attachment(const String &p_path, const String &p_mime_type, int p_max_dimension, const Callable &p_callback) {
+	ImageJob *job = memnew(ImageJob);
+	job->path = p_path;
+	job->mime_type = p_mime_type;
+	job->max_size = p_max_dimension;
+	job->callback = p_callback;
+	_start_job(job);
+}
+
+void AIImagePipeline::request_thumbnail(const String &p_base64_data, int p_max_size, const Callable &p_callback) {
+	ImageJob *job = memnew(ImageJob);
+	job->thumbnail = true;
+	job->base64_data = p_base64_data;
+	job->max_size = p_max_size;
+	job->cache_dir = EditorPaths::get_singleton()->get_cache_dir().path_join("ai_thumbnails");
+	job->callback = p_callback;
+	_start_job(job);
+}
+
+void AIImagePipeline::clear_memory_cache() {
+	MutexLock lock(cache_mutex);
+	_get_memory_cache().clear();
+}
@@ -0,0 +1,62 @@
+/**************************************************************************/
+/*  ai_image_pipeline.h                                                   */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/math/vector2i.h"
+#include "core/variant/callable.h"
+#include "core/variant/dictionary.h"
+
+// Decodes, resizes and encodes chat images on the WorkerThreadPool.
+//
+// Attachments are loaded, downsampled and base64-encoded off the main
+// thread. Chat bubbles request thumbnails by the image's base64 data; they
+// are content-addressed (hash of the data and the requested size) and kept
+// both as textures in a memory LRU and as small PNGs in the editor cache
+// directory, so rebuilding a transcript does not decode its images again.
+//
+// Callbacks always run on the main thread.
+class AIImagePipeline {
+public:
+	// Calls `p_callback` with `success`, `message`, `base64_data`,
+	// `original_size`, `display_size` and `was_downsampled`. JPEG sources are
+	// re-encoded as JPEG, everything else as PNG.
+	static void prepare_attachment(const String &p_path, const String &p_mime_type, int p_max_dimension, const Callable &p_callback);
+
+	// Calls `p_callback` with `success`, `texture` (an ImageTexture whose
+	// longest side is at most `p_max_size`), `original_size` and
+	// `display_size`.
+	static void request_thumbnail(const String &p_base64_data, int p_max_size, const Callable &p_callback);
+
+	static Vector2i fit_size(const Vector2i &p_size, int p_max_dimension);
+
+	// Releases the cached textures; call before the renderer shuts down.
+	static void clear_memory_cache();
+};
@@ -0,0 +1,99 @@
+/**************************************************************************/
+/*  ai_ndjson_decoder.cpp                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ai_ndjson_decoder.h"
+
+#include <cstring>
+
+void AINDJSONDecoder::_compact() {
+	// Amortized: only move the tail once the consumed prefix dominates.
+	if (read_pos == 0 || read_pos < buffer.size() / 2) {
+		return;
+	}
+	const uint32_t remaining = buffer.size() - read_pos;
+	if (remaining > 0) {
+		memmove(buffer.ptr(), buffer.ptr() + read_pos, remaining);
+	}
+	buffer.resize(remaining);
+	scan_pos -= read_pos;
+	read_pos = 0;
+}
+
+void AINDJSONDecoder::append(const uint8_t *p_data, int p_size) {
+	if (p_size <= 0) {
+		return;
+	}
+	_compact();
+	const uint32_t old_size = buffer.size();
+	buffer.resize(old_size + p_size);
+	memcpy(buffer.ptr() + old_size, p_data, p_size);
+}
+
+bool AINDJSONDecoder::next_line(String &r_line) {
+	const uint32_t size = buffer.size();
+	if (scan_pos >= size) {
+		return false;
+	}
+	const uint8_t *newline = (const uint8_t *)memchr(buffer.ptr() + scan_pos, '\n', size - scan_pos);
+	if (!newline) {
+		scan_pos = size;
+		return false;
+	}
+
+	const uint32_t line_end = newline - buffer.ptr();
+	uint32_t content_end = line_end;
+	if (content_end > read_pos && buffer[content_end - 1] == '\r') {
+		content_end--;
+	}
+
+	r_line = String();
+	if (content_end > read_pos) {
+		r_line.append_utf8((const char *)buffer.ptr() + read_pos, content_end - read_pos);
+	}
+	read_pos = line_end + 1;
+	scan_pos = read_pos;
+	return true;
+}
+
+bool AINDJSONDecoder::flush(String &r_line) {
+	const bool has_data = read_pos < buffer.size();
+	r_line = String();
+	if (has_data) {
+		r_line.append_utf8((const char *)buffer.ptr() + read_pos, buffer.size() - read_pos, true);
+	}
+	clear();
+	return has_data;
+}
+
+void AINDJSONDecoder::clear() {
+	buffer.clear();
+	read_pos = 0;
+	scan_pos = 0;
+}
@@ -0,0 +1,63 @@
+/**************************************************************************/
+/*  ai_ndjson_decoder.h                                                   */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/string/ustring.h"
+#include "core/templates/local_vector.h"
+
+// Splits a streamed NDJSON body into lines at the byte level.
+//
+// Incoming chunks are appended to a single byte buffer that is scanned once
+// for newlines; consumed bytes are only reclaimed when they make up most of
+// the buffer, so a long line arriving in many chunks is never recopied per
+// chunk. Only complete lines are decoded as UTF-8, which keeps multibyte
+// characters that straddle chunk boundaries intact.
+class AINDJSONDecoder {
+	LocalVector<uint8_t> buffer;
+	uint32_t read_pos = 0; // Start of the first unconsumed line.
+	uint32_t scan_pos = 0; // Bytes before this are known not to contain '\n'.
+
+	void _compact();
+
+public:
+	void append(const uint8_t *p_data, int p_size);
+
+	// Decodes the next complete line into `r_line`, without the line break.
+	// Returns false when no complete line is buffered.
+	bool next_line(String &r_line);
+
+	// Returns whatever is left after the last line break (for a stream that
+	// ended without a trailing newline) and resets the decoder.
+	bool flush(String &r_line);
+
+	uint32_t get_pending_size() const { return buffer.size() - read_pos; }
+	void clear();
+};
@@ -1,8 +1,10 @@
 #include "ai_tool_server.h"
+#include "editor/ai/ai_screenshot_capture.h"
 #include "editor/ai/editor_tools.h"
 #include "core/io/json.h"
 #include "core/string/string_builder.h"
 #include "core/config/project_settings.h"
+#include "core/os/os.h"
 
 void AIToolServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("listen", "port"), &AIToolServer::listen, DEFVAL(8001));
@@ -10,23 +12,22 @@ void AIToolServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("is_listening"), &AIToolServer::is_listening);
 }
 
-void AIToolServer::_server_thread_poll(void *data) {
-	AIToolServer *server = static_cast<AIToolServer *>(data);
-	server->_poll();
-}
-
-void AIToolServer::_clear_client() {
-	peer.unref();
-	tcp.unref();
-	req_pos = 0;
-	memset(req_buf, 0, sizeof(req_buf));
-}
-
-void AIToolServer::_send_response() {
-	// This will be populated by _handle_tool_request
+void AIToolServer::_normalize_tool_args(const String &p_function_name, Dictionary &r_args) {
+	if (p_function_name == "search_across_project") {
+		// Normalize defaults for agent and inject project root
+		if (!r_args.has("max_results")) {
+			r_args["max_results"] = 5;
+		}
+		if (!r_args.has("include_graph")) {
+			r_args["include_graph"] = true;
+		}
+		// Always include the project root to avoid backend defaulting to old projects
+		String project_root = ProjectSettings::get_singleton()->globalize_path("res://");
+		r_args["project_root"] = project_root;
+	}
 }
 
-Dictionary AIToolServer::_handle_tool_request(const String &p_method, const String &p_path, const String &p_body) {
+Dictionary AIToolServer::_handle_tool_request(const String &p_method, const String &p_path, const Dictionary &p_request) {
 	Dictionary result;
 	
 	if (p_method != "POST") {
@@ -34,62 +35,12 @@ Dictionary AIToolServer::_handle_tool_request(const String &p_method, const Stri
 		return result;
 	}
 	
-	// Parse JSON body
-	Ref<JSON> json;
-	json.instantiate();
-	Error err = json->parse(p_body);
-	if (err != OK) {
-		result["error"] = "Invalid JSON";
-		return result;
-	}
-	
-	Dictionary request_data = json->get_data();
-	String function_name = request_data.get("function_name", "");
-	Dictionary args = request_data.get("arguments", Dictionary());
+	String function_name = p_request.get("function_name", "");
+	Dictionary args = p_request.get("arguments", Dictionary());
 	
 	// Handle tool execution
 	// NOTE: apply_edit is now handled in the backend, not here
-	if (function_name == "list_project_files") {
-		result = EditorTools::list_project_files(args);
-	} else if (function_name == "read_file_content") {
-		result = EditorTools::read_file_content(args);
-	} else if (function_name == "read_file_advanced") {
-		result = EditorTools::read_file_advanced(args);
-	} else if (function_name == "get_scene_info") {
-		result = EditorTools::get_scene_info(args);
-	} else if (function_name == "get_all_nodes") {
-		result = EditorTools::get_all_nodes(args);
-	} else if (function_name == "search_nodes_by_type") {
-		result = EditorTools::search_nodes_by_type(args);
-	} else if (function_name == "get_editor_selection") {
-		result = EditorTools::get_editor_selection(args);
-	} else if (function_name == "get_node_properties") {
-		result = EditorTools::get_node_properties(args);
-	} else if (function_name == "save_scene") {
-		result = EditorTools::save_scene(args);
-	} else if (function_name == "create_node") {
-		result = EditorTools::create_node(args);
-	} else if (function_name == "delete_node") {
-		result = EditorTools::delete_node(args);
-	} else if (function_name == "set_node_property") {
-		result = EditorTools::set_node_property(args);
-	} else if (function_name == "move_node") {
-		result = EditorTools::move_node(args);
-	} else if (function_name == "call_node_method") {
-		result = EditorTools::call_node_method(args);
-	} else if (function_name == "get_available_classes") {
-		result = EditorTools::get_available_classes(args);
-	} else if (function_name == "get_node_script") {
-		result = EditorTools::get_node_script(args);
-	} else if (function_name == "attach_script") {
-		result = EditorTools::attach_script(args);
-	} else if (function_name == "manage_scene") {
-		result = EditorTools::manage_scene(args);
-	} else if (function_name == "add_collision_shape") {
-		result = EditorTools::add_collision_shape(args);
-	} else if (function_name == "check_compilation_errors") {
-		result = EditorTools::check_compilation_errors(args);
-	} else if (function_name == "test_diff_and_errors") {
+	if (function_name == "test_diff_and_errors") {
 		// Test endpoint that simulates an edit to test diff and compilation error functionality
 		String path = args.get("path", "");
 		String mock_edit = args.get("mock_edit", "");
@@ -129,37 +80,9 @@ Dictionary AIToolServer::_handle_tool_request(const String &p_method, const Stri
 				result["has_errors"] = compilation_errors.size() > 0;
 			}
 		}
-	} else if (function_name == "run_scene") {
-		result = EditorTools::run_scene(args);
-	} else if (function_name == "get_scene_tree_hierarchy") {
-		result = EditorTools::get_scene_tree_hierarchy(args);
-	} else if (function_name == "inspect_physics_body") {
-		result = EditorTools::inspect_physics_body(args);
-	} else if (function_name == "get_camera_info") {
-		result = EditorTools::get_camera_info(args);
-	} else if (function_name == "take_screenshot") {
-		result = EditorTools::take_screenshot(args);
-	} else if (function_name == "check_node_in_scene_tree") {
-		result = EditorTools::check_node_in_scene_tree(args);
-	} else if (function_name == "inspect_animation_state") {
-		result = EditorTools::inspect_animation_state(args);
-    } else if (function_name == "get_layers_and_zindex") {
-		result = EditorTools::get_layers_and_zindex(args);
-    } else if (function_name == "search_across_project") {
-        // Normalize defaults for agent and inject project root
-        if (!args.has("max_results")) {
-            args["max_results"] = 5;
-        }
-        if (!args.has("include_graph")) {
-            args["include_graph"] = true;
-        }
-        // Always include the project root to avoid backend defaulting to old projects
-        String project_root = ProjectSettings::get_singleton()->globalize_path("res://");
-        args["project_root"] = project_root;
-        print_line("AI Tool Server: search_across_project invoking with project_root=" + project_root);
-		result = EditorTools::search_across_project(args);
-	} else if (function_name == "editor_introspect") {
-		result = EditorTools::editor_introspect(args);
+	} else if (EditorTools::has_tool(function_name)) {
+		_normalize_tool_args(function_name, args);
+		result = EditorTools::execute_tool(function_name, args);
 	} else {
 		result["error"] = "Unknown function: " + function_name;
 	}
@@ -167,126 +90,539 @@ Dictionary AIToolServer::_handle_tool_request(const String &p_method, const Stri
 	return result;
 }
 
-void AIToolServer::_poll() {
+void AIToolServer::_accept_thread_func(void *p_userdata) {
+	static_cast<AIToolServer *>(p_userdata)->_accept_loop();
+}
+
+void AIToolServer::_connection_thread_func(void *p_userdata) {
+	Connection *connection = static_cast<Connection *>(p_userdata);
+	connection->owner->_connection_loop(connection);
+	connection->tcp->disconnect_from_host();
+	connection->finished.set();
+}
+
+void AIToolServer::_accept_loop() {
 	while (!server_quit.is_set()) {
-		if (!server->is_listening()) {
-			OS::get_singleton()->delay_usec(100000); // 100ms
+		_reap_connections(false);
+
+		// Blocks until a client connects; the timeout only bounds shutdown latency.
+		if (listen_socket->poll(NetSocket::POLL_TYPE_IN, WAIT_SLICE_MSEC) != OK) {
 			continue;
 		}
-		
-		if (tcp.is_null()) {
-			if (!server->is_connection_available()) {
-				OS::get_singleton()->delay_usec(10000); // 10ms delay
-				continue;
-			}
-			tcp = server->take_connection();
-			peer = tcp;
-			time = OS::get_singleton()->get_ticks_msec();
+		IPAddress ip;
+		uint16_t port = 0;
+		Ref<NetSocket> socket = listen_socket->accept(ip, port);
+		if (socket.is_null()) {
+			continue;
 		}
-		
-		if (peer.is_null()) {
-			OS::get_singleton()->delay_usec(10000); // 10ms delay
+
+		MutexLock lock(connections_lock);
+		if (connections.size() >= MAX_CONNECTIONS) {
+			socket->close(); // The client retries; accepting more would only queue behind the main thread.
 			continue;
 		}
-	
+		Connection *connection = memnew(Connection);
+		connection->owner = this;
+		connection->tcp.instantiate();
+		connection->tcp->accept_socket(socket, ip, port);
+		connection->tcp->set_no_delay(true);
+		connections.push_back(connection);
+		connection->thread.start(_connection_thread_func, connection);
+	}
+}
+
+void AIToolServer::_reap_connections(bool p_wait_all) {
+	MutexLock lock(connections_lock);
+	List<Connection *>::Element *E = connections.front();
+	while (E) {
+		List<Connection *>::Element *next = E->next();
+		Connection *connection = E->get();
+		if (p_wait_all || connection->finished.is_set()) {
+			connection->thread.wait_to_finish();
+			memdelete(connection);
+			connections.erase(E);
+		}
+		E = next;
+	}
+}
+
+bool AIToolServer::_read_more(Connection *p_connection, uint64_t p_deadline) {
 	while (true) {
-		// Read request data
-		if (req_pos >= 4096) {
-			_clear_client();
+		if (server_quit.is_set() || OS::get_singleton()->get_ticks_msec() >= p_deadline) {
+			return false;
+		}
+		const Error err = p_connection->tcp->wait(NetSocket::POLL_TYPE_IN, WAIT_SLICE_MSEC);
+		if (err == OK) {
 			break;
 		}
-		
-		int received = 0;
-		Error err = peer->get_partial_data(&req_buf[req_pos], 1, received);
-		if (err != OK || received != 1) {
+		if (err != ERR_BUSY) {
+			return false;
+		}
+	}
+
+	const int available = p_connection->tcp->get_available_bytes();
+	if (available <= 0) {
+		return false; // Readable with nothing to read: the client closed the connection.
+	}
+
+	LocalVector<uint8_t> &buffer = p_connection->buffer;
+	if (p_connection->read_pos > 0 && p_connection->read_pos >= buffer.size() / 2) {
+		// Drop handled requests once they make up most of the buffer.
+		const uint32_t remaining = buffer.size() - p_connection->read_pos;
+		if (remaining > 0) {
+			memmove(buffer.ptr(), buffer.ptr() + p_connection->read_pos, remaining);
+		}
+		buffer.resize(remaining);
+		p_connection->read_pos = 0;
+	}
+
+	const uint32_t old_size = buffer.size();
+	buffer.resize(old_size + available);
+	int received = 0;
+	const Error err = p_connection->tcp->get_partial_data(buffer.ptr() + old_size, available, received);
+	buffer.resize(old_size + MAX(received, 0));
+	return err == OK && received > 0;
+}
+
+bool AIToolServer::_ensure_bytes(Connection *p_connection, uint32_t p_count, uint64_t p_deadline) {
+	while (p_connection->buffer.size() - p_connection->read_pos < p_count) {
+		if (!_read_more(p_connection, p_deadline)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int AIToolServer::_find(const Connection *p_connection, const char *p_pattern, uint32_t p_from) const {
+	const uint32_t pattern_length = strlen(p_pattern);
+	const uint32_t size = p_connection->buffer.size();
+	if (size < pattern_length) {
+		return -1;
+	}
+	const uint8_t *data = p_connection->buffer.ptr();
+	for (uint32_t i = MAX(p_from, p_connection->read_pos); i <= size - pattern_length; i++) {
+		if (memcmp(data + i, p_pattern, pattern_length) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+bool AIToolServer::_read_chunked_body(Connection *p_connection, uint64_t p_deadline, LocalVector<uint8_t> &r_body, int &r_status) {
+	r_status = 400;
+	while (true) {
+		int line_end;
+		while ((line_end = _find(p_connection, "\r\n", p_connection->read_pos)) < 0) {
+			if (p_connection->buffer.size() - p_connection->read_pos > 1024 || !_read_more(p_connection, p_deadline)) {
+				return false;
+			}
+		}
+		String size_line = String::utf8((const char *)p_connection->buffer.ptr() + p_connection->read_pos, line_end - p_connection->read_pos);
+		size_line = size_line.get_slicec(';', 0).strip_edges(); // Ignore chunk extensions.
+		if (size_line.is_empty() || !size_line.is_valid_hex_number(false)) {
+			return false;
+		}
+		const int64_t chunk_size = size_line.hex_to_int();
+		p_connection->read_pos = line_end + 2;
+
+		if (chunk_size == 0) {
+			// Skip trailer fields up to the terminating empty line.
+			while (true) {
+				while ((line_end = _find(p_connection, "\r\n", p_connection->read_pos)) < 0) {
+					if (p_connection->buffer.size() - p_connection->read_pos > MAX_HEADER_SIZE || !_read_more(p_connection, p_deadline)) {
+						return false;
+					}
+				}
+				const bool empty = (uint32_t)line_end == p_connection->read_pos;
+				p_connection->read_pos = line_end + 2;
+				if (empty) {
+					return true;
+				}
+			}
+		}
+
+		if (chunk_size < 0 || r_body.size() + chunk_size > MAX_BODY_SIZE) {
+			r_status = 413;
+			return false;
+		}
+		if (!_ensure_bytes(p_connection, chunk_size + 2, p_deadline)) {
+			return false;
+		}
+		const uint32_t old_size = r_body.size();
+		r_body.resize(old_size + chunk_size);
+		memcpy(r_body.ptr() + old_size, p_connection->buffer.ptr() + p_connection->read_pos, chunk_size);
+		p_connection->read_pos += chunk_size + 2;
+	}
+}
+
+void AIToolServer::_send_response(Connection *p_connection, int p_status, const String &p_body, bool p_keep_alive) {
+	String status_text;
+	switch (p_status) {
+		case 200:
+			status_text = "OK";
+			break;
+		case 204:
+			status_text = "No Content";
+			break;
+		case 400:
+			status_text = "Bad Request";
 			break;
+		case 413:
+			status_text = "Payload Too Large";
+			break;
+		case 431:
+			status_text = "Request Header Fields Too Large";
+			break;
+		default:
+			status_text = "Service Unavailable";
+			break;
+	}
+
+	const CharString body = p_body.utf8();
+	StringBuilder response_builder;
+	response_builder.append("HTTP/1.1 " + itos(p_status) + " " + status_text + "\r\n");
+	response_builder.append("Content-Type: application/json\r\n");
+	response_builder.append("Content-Length: " + itos(body.length()) + "\r\n");
+	response_builder.append("Access-Control-Allow-Origin: *\r\n");
+	response_builder.append("Access-Control-Allow-Methods: POST, OPTIONS\r\n");
+	response_builder.append("Access-Control-Allow-Headers: Content-Type\r\n");
+	response_builder.append(p_keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+	response_builder.append("\r\n");
+	const CharString headers = response_builder.as_string().utf8();
+
+	// One write, so the response never waits on a delayed ACK between parts.
+	LocalVector<uint8_t> response;
+	response.resize(headers.length() + body.length());
+	memcpy(response.ptr(), headers.get_data(), headers.length());
+	if (body.length() > 0) {
+		memcpy(response.ptr() + headers.length(), body.get_data(), body.length());
+	}
+	p_connection->tcp->put_data(response.ptr(), response.size());
+}
+
+void AIToolServer::_connection_loop(Connection *p_connection) {
+	while (!server_quit.is_set()) {
+		// Wait for the next request on this connection.
+		const uint64_t idle_deadline = OS::get_singleton()->get_ticks_msec() + KEEP_ALIVE_TIMEOUT_MSEC;
+		int header_end;
+		while ((header_end = _find(p_connection, "\r\n\r\n", p_connection->read_pos)) < 0) {
+			if (p_connection->buffer.size() - p_connection->read_pos > MAX_HEADER_SIZE) {
+				_send_response(p_connection, 431, "{\"error\":\"Request headers too large\"}", false);
+				return;
+			}
+			if (!_read_more(p_connection, idle_deadline)) {
+				return;
+			}
 		}
-		req_pos++;
-		
-		// Check for end of headers
-		if (req_pos >= 4 && String::chr(req_buf[req_pos - 4]) + String::chr(req_buf[req_pos - 3]) + String::chr(req_buf[req_pos - 2]) + String::chr(req_buf[req_pos - 1]) == "\r\n\r\n") {
-			String request_str = String::utf8((const char *)req_buf, req_pos);
-			
-			// Parse HTTP request
-			PackedStringArray lines = request_str.split("\r\n");
-			if (lines.size() == 0) {
-				_clear_client();
-				break;
+
+		const String header_text = String::utf8((const char *)p_connection->buffer.ptr() + p_connection->read_pos, header_end - p_connection->read_pos);
+		p_connection->read_pos = header_end + 4;
+
+		const Vector<String> lines = header_text.split("\r\n");
+		const Vector<String> request_line = lines[0].split(" ", false);
+		if (request_line.size() < 3) {
+			_send_response(p_connection, 400, "{\"error\":\"Malformed request line\"}", false);
+			return;
+		}
+		const String method = request_line[0];
+		const String path = request_line[1];
+
+		int64_t content_length = 0;
+		bool chunked = false;
+		String connection_header;
+		for (int i = 1; i < lines.size(); i++) {
+			const int colon = lines[i].find_char(':');
+			if (colon <= 0) {
+				continue;
 			}
-			
-			PackedStringArray request_line = lines[0].split(" ");
-			if (request_line.size() < 2) {
-				_clear_client();
-				break;
+			const String name = lines[i].substr(0, colon).strip_edges().to_lower();
+			const String value = lines[i].substr(colon + 1).strip_edges();
+			if (name == "content-length") {
+				content_length = value.to_int();
+			} else if (name == "transfer-encoding") {
+				chunked = value.to_lower().contains("chunked");
+			} else if (name == "connection") {
+				connection_header = value.to_lower();
 			}
-			
-			String method = request_line[0];
-			String path = request_line[1];
-			
-			// Find Content-Length
-			int content_length = 0;
-			for (int i = 1; i < lines.size(); i++) {
-				if (lines[i].begins_with("Content-Length:")) {
-					content_length = lines[i].substr(15).strip_edges().to_int();
-					break;
-				}
+		}
+		// HTTP/1.1 connections persist unless the client opts out.
+		const bool keep_alive = request_line[2] == "HTTP/1.1" ? connection_header != "close" : connection_header == "keep-alive";
+
+		const uint64_t request_deadline = OS::get_singleton()->get_ticks_msec() + REQUEST_TIMEOUT_MSEC;
+		LocalVector<uint8_t> body_bytes;
+		if (chunked) {
+			int status = 400;
+			if (!_read_chunked_body(p_connection, request_deadline, body_bytes, status)) {
+				_send_response(p_connection, status, "{\"error\":\"Invalid or incomplete chunked body\"}", false);
+				return;
+			}
+		} else if (content_length > 0) {
+			if (content_length > MAX_BODY_SIZE) {
+				_send_response(p_connection, 413, "{\"error\":\"Request body too large\"}", false);
+				return;
 			}
-			
-			// Read body if present
-			String body = "";
-			if (content_length > 0) {
-				PackedByteArray body_bytes;
-				body_bytes.resize(content_length);
-				int body_read = 0;
-				while (body_read < content_length) {
-					int chunk_received = 0;
-					Error chunk_err = peer->get_partial_data(&body_bytes.ptrw()[body_read], content_length - body_read, chunk_received);
-					if (chunk_err != OK || chunk_received <= 0) break;
-					body_read += chunk_received;
+			if (!_ensure_bytes(p_connection, content_length, request_deadline)) {
+				return;
+			}
+			body_bytes.resize(content_length);
+			memcpy(body_bytes.ptr(), p_connection->buffer.ptr() + p_connection->read_pos, content_length);
+			p_connection->read_pos += content_length;
+		}
+
+		if (method == "OPTIONS") {
+			// CORS preflight.
+			_send_response(p_connection, 204, String(), keep_alive);
+		} else {
+			PendingRequest request;
+			request.method = method;
+			request.path = path;
+			Ref<JSON> json;
+			json.instantiate();
+			const String body = body_bytes.is_empty() ? String() : String::utf8((const char *)body_bytes.ptr(), body_bytes.size());
+			if (json->parse(body) != OK || json->get_data().get_type() != Variant::DICTIONARY) {
+				_send_response(p_connection, 200, "{\"error\":\"Invalid JSON\"}", keep_alive);
+			} else {
+				request.data = json->get_data();
+				request.batch = request.data.get("calls", Variant()).get_type() == Variant::ARRAY;
+				if (!_enqueue_request(&request)) {
+					_send_response(p_connection, 503, "{\"error\":\"Editor is busy, retry later\"}", keep_alive);
+				} else if (request.batch) {
+					if (!_stream_batch_response(p_connection, &request, keep_alive)) {
+						return;
+					}
+				} else {
+					request.done.wait();
+					_send_response(p_connection, 200, JSON::stringify(request.response), keep_alive);
 				}
-				body = String::utf8((const char *)body_bytes.ptr(), body_read);
 			}
-			
-			// Handle the request
-			Dictionary response_data = _handle_tool_request(method, path, body);
-			
-			// Send response
-			Ref<JSON> response_json;
-			response_json.instantiate();
-			String response_body = response_json->stringify(response_data);
-			PackedByteArray body_bytes = response_body.to_utf8_buffer();
-			
-			StringBuilder response_builder;
-			response_builder.append("HTTP/1.1 200 OK\r\n");
-			response_builder.append("Content-Type: application/json\r\n");
-			response_builder.append("Content-Length: " + itos(body_bytes.size()) + "\r\n");
-			response_builder.append("Access-Control-Allow-Origin: *\r\n");
-			response_builder.append("Access-Control-Allow-Methods: POST, OPTIONS\r\n");
-			response_builder.append("Access-Control-Allow-Headers: Content-Type\r\n");
-			response_builder.append("Connection: close\r\n");
-			response_builder.append("\r\n");
-			
-			String headers = response_builder.as_string();
-			PackedByteArray headers_bytes = headers.to_utf8_buffer();
-			
-			// Send headers first
-			peer->put_data(headers_bytes.ptr(), headers_bytes.size());
-			// Then send body
-			peer->put_data(body_bytes.ptr(), body_bytes.size());
-			
-			_clear_client();
-			break;
 		}
-		
-		OS::get_singleton()->delay_usec(10000); // 10ms delay
+
+		if (!keep_alive) {
+			return;
+		}
+	}
+}
+
+bool AIToolServer::_stream_batch_response(Connection *p_connection, PendingRequest *p_request, bool p_keep_alive) {
+	StringBuilder headers;
+	headers.append("HTTP/1.1 200 OK\r\n");
+	headers.append("Content-Type: application/x-ndjson\r\n");
+	headers.append("Transfer-Encoding: chunked\r\n");
+	headers.append("Access-Control-Allow-Origin: *\r\n");
+	headers.append(p_keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+	headers.append("\r\n");
+	const CharString header_bytes = headers.as_string().utf8();
+	bool write_ok = p_connection->tcp->put_data((const uint8_t *)header_bytes.get_data(), header_bytes.length()) == OK;
+
+	// Keep consuming after a write error: the request lives on this stack
+	// frame and must not go away before the main thread is done with it.
+	bool done = false;
+	while (!done) {
+		p_request->stream_ready.wait();
+		List<String> lines;
+		{
+			MutexLock lock(p_request->stream_lock);
+			lines = p_request->stream_lines;
+			p_request->stream_lines.clear();
+			done = p_request->stream_done;
+		}
+		for (const String &line : lines) {
+			if (!write_ok) {
+				break;
+			}
+			const CharString data = (line + "\n").utf8();
+			const CharString size_line = (String::num_int64(data.length(), 16) + "\r\n").utf8();
+			LocalVector<uint8_t> chunk;
+			chunk.resize(size_line.length() + data.length() + 2);
+			memcpy(chunk.ptr(), size_line.get_data(), size_line.length());
+			memcpy(chunk.ptr() + size_line.length(), data.get_data(), data.length());
+			chunk[chunk.size() - 2] = '\r';
+			chunk[chunk.size() - 1] = '\n';
+			write_ok = p_connection->tcp->put_data(chunk.ptr(), chunk.size()) == OK;
+		}
+	}
+	if (write_ok) {
+		static const char terminator[] = "0\r\n\r\n";
+		write_ok = p_connection->tcp->put_data((const uint8_t *)terminator, sizeof(terminator) - 1) == OK;
+	}
+	return write_ok;
+}
+
+void AIToolServer::_push_stream_line(PendingRequest *p_request, const String &p_line, bool p_last) {
+	// Post before unlocking: once the connection thread sees `stream_done`
+	// it returns and the request, which lives on its stack, goes away.
+	MutexLock lock(p_request->stream_lock);
+	p_request->stream_lines.push_back(p_line);
+	if (p_last) {
+		p_request->stream_done = true;
+	}
+	p_request->stream_ready.post();
+}
+
+void AIToolServer::_push_batch_result(PendingRequest *p_request, int p_index, const Dictionary &p_result) {
+	// Only read here: this may run on a worker thread while the main thread
+	// is in the batch.
+	const Array calls = p_request->data["calls"];
+	const Dictionary call = calls[p_index];
+	Dictionary line;
+	line["index"] = p_index;
+	if (call.has("id")) {
+		line["id"] = call["id"];
+	}
+	line["function_name"] = call.has("function_name") ? call["function_name"] : call.get("name", "");
+	line["result"] = p_result;
+	_push_stream_line(p_request, JSON::stringify(line, "", false), false);
+}
+
+void AIToolServer::_on_batch_result(void *p_userdata, int p_index, const Dictionary &p_result) {
+	PendingRequest *request = static_cast<PendingRequest *>(p_userdata);
+	_push_batch_result(request, request->batch_indices[p_index], p_result);
+}
+
+void AIToolServer::_handle_batch_request(PendingRequest *p_request) {
+	Array calls = p_request->data["calls"];
+	if (p_request->method != "POST") {
+		Dictionary line;
+		line["error"] = "Method not allowed";
+		line["done"] = true;
+		_push_stream_line(p_request, JSON::stringify(line, "", false), true);
+		return;
+	}
+
+	// Apply the same argument defaults as single calls. The calls array is
+	// rebuilt so the callback can keep reading the original request.
+	Array prepared;
+	LocalVector<int> screenshots;
+	for (int i = 0; i < calls.size(); i++) {
+		Dictionary call = Dictionary(calls[i]).duplicate();
+		const String name = call.has("function_name") ? call["function_name"] : call.get("name", "");
+		if (name == "take_screenshot") {
+			screenshots.push_back(i);
+			continue;
+		}
+		if (call.get("arguments", Variant()).get_type() == Variant::DICTIONARY) {
+			Dictionary args = Dictionary(call["arguments"]).duplicate();
+			_normalize_tool_args(name, args);
+			call["arguments"] = args;
+		}
+		prepared.push_back(call);
+		p_request->batch_indices.push_back(i);
+	}
+
+	if (!prepared.is_empty()) {
+		EditorTools::execute_tool_batch(prepared, &AIToolServer::_on_batch_result, p_request);
 	}
+	// Captures start once the rest of the batch has run, so they show its
+	// final state.
+	for (const int index : screenshots) {
+		_start_capture(p_request, index, Dictionary(calls[index]).get("arguments", Variant()));
+	}
+	p_request->batch_finished = true;
+	_finish_batch_if_done(p_request);
+}
+
+void AIToolServer::_finish_batch_if_done(PendingRequest *p_request) {
+	if (!p_request->batch_finished || p_request->pending_captures > 0) {
+		return;
+	}
+	Dictionary line;
+	line["done"] = true;
+	line["count"] = Array(p_request->data["calls"]).size();
+	_push_stream_line(p_request, JSON::stringify(line, "", false), true);
+}
+
+void AIToolServer::_start_capture(PendingRequest *p_request, int p_index, const Variant &p_args) {
+	Dictionary args;
+	if (p_args.get_type() == Variant::DICTIONARY) {
+		args = p_args;
+	} else if (p_args.get_type() == Variant::STRING) {
+		// Batch calls may pass their arguments as a JSON string.
+		const Variant parsed = JSON::parse_string(p_args);
+		if (parsed.get_type() == Variant::DICTIONARY) {
+			args = parsed;
+		}
+	}
+
+	Capture capture;
+	capture.request = p_request;
+	capture.index = p_index;
+	const uint64_t id = ++last_capture_id;
+	captures.insert(id, capture);
+	if (p_index >= 0) {
+		p_request->pending_captures++;
+	}
+	AIScreenshotCapture::capture_async(args, callable_mp(this, &AIToolServer::_on_capture_finished).bind(id));
+}
+
+void AIToolServer::_on_capture_finished(const Dictionary &p_result, uint64_t p_capture_id) {
+	HashMap<uint64_t, Capture>::Iterator E = captures.find(p_capture_id);
+	if (!E) {
+		return; // Released by stop().
+	}
+	const Capture capture = E->value;
+	captures.remove(E);
+
+	if (capture.index < 0) {
+		capture.request->response = p_result;
+		capture.request->done.post();
+		return;
+	}
+	_push_batch_result(capture.request, capture.index, p_result);
+	capture.request->pending_captures--;
+	_finish_batch_if_done(capture.request);
+}
+
+bool AIToolServer::_enqueue_request(PendingRequest *p_request) {
+	MutexLock lock(queue_lock);
+	if (server_quit.is_set() || request_queue.size() >= MAX_QUEUED_REQUESTS) {
+		return false;
+	}
+	request_queue.push_back(p_request);
+	if (!dispatch_queued) {
+		// One deferred call drains everything queued before the next frame.
+		dispatch_queued = true;
+		callable_mp(this, &AIToolServer::_dispatch_requests).call_deferred();
+	}
+	return true;
+}
+
+void AIToolServer::_dispatch_requests() {
+	List<PendingRequest *> batch;
+	{
+		MutexLock lock(queue_lock);
+		batch = request_queue;
+		request_queue.clear();
+		dispatch_queued = false;
+	}
+	for (PendingRequest *request : batch) {
+		if (request->batch) {
+			_handle_batch_request(request);
+		} else if (request->method == "POST" && String(request->data.get("function_name", "")) == "take_screenshot") {
+			_start_capture(request, -1, request->data.get("arguments", Variant()));
+		} else {
+			request->response = _handle_tool_request(request->method, request->path, request->data);
+			request->done.post();
+		}
 	}
 }
 
 Error AIToolServer::listen(int p_port) {
-	server.instantiate();
-	Error err = server->listen(p_port, IPAddress("127.0.0.1"));
+	ERR_FAIL_COND_V(is_listening(), ERR_ALREADY_IN_USE);
+
+	listen_socket = Ref<NetSocket>(NetSocket::create());
+	IP::Type ip_type = IP::TYPE_IPV4;
+	Error err = listen_socket->open(NetSocket::TYPE_TCP, ip_type);
+	if (err == OK) {
+		listen_socket->set_blocking_enabled(false);
+		listen_socket->set_reuse_address_enabled(true);
+		err = listen_socket->bind(IPAddress("127.0.0.1"), p_port);
+	}
+	if (err == OK) {
+		err = listen_socket->listen(MAX_CONNECTIONS);
+	}
 	if (err != OK) {
+		listen_socket->close();
+		listen_socket.unref();
 		print_line("ERROR: Failed to start AI tool server on port " + itos(p_port));
 		return err;
 	}
@@ -294,31 +630,58 @@ Error AIToolServer::listen(int p_port) {
 	print_line("AI Tool Server: Started on port " + itos(p_port));
 	
 	server_quit.clear();
-	server_thread.start(_server_thread_poll, this);
+	accept_thread.start(_accept_thread_func, this);
 	
 	return OK;
 }
 
 void AIToolServer::stop() {
+	if (listen_socket.is_null()) {
+		return;
+	}
 	server_quit.set();
-	if (server_thread.is_started()) {
-		server_thread.wait_to_finish();
+	if (accept_thread.is_started()) {
+		accept_thread.wait_to_finish();
+	}
+
+	// Release connections waiting on the main thread so they can exit.
+	{
+		MutexLock lock(queue_lock);
+		for (PendingRequest *request : request_queue) {
+			if (request->batch) {
+				_push_stream_line(request, "{\"error\":\"Tool server stopped\",\"done\":true}", true);
+			} else {
+				request->response["error"] = "Tool server stopped";
+				request->done.post();
+			}
+		}
+		request_queue.clear();
+	}
+	for (const KeyValue<uint64_t, Capture> &E : captures) {
+		PendingRequest *request = E.value.request;
+		if (E.value.index < 0) {
+			request->response["error"] = "Tool server stopped";
+			request->done.post();
+		} else if (--request->pending_captures == 0) {
+			_push_stream_line(request, "{\"error\":\"Tool server stopped\",\"done\":true}", true);
+		}
 	}
-	server.unref();
-	_clear_client();
+	captures.clear();
+	_reap_connections(true);
+
+	listen_socket->close();
+	listen_socket.unref();
 	
 	print_line("AI Tool Server: Stopped");
 }
 
 bool AIToolServer::is_listening() const {
-	return server.is_valid() && server->is_listening();
+	return listen_socket.is_valid() && listen_socket->is_open();
 }
 
 AIToolServer::AIToolServer() {
-	req_pos = 0;
-	memset(req_buf, 0, sizeof(req_buf));
 }
 
 AIToolServer::~AIToolServer() {
 	stop();
-} 
\ No newline at end of file
+}
@@ -1,31 +1,119 @@
 #pragma once
 
+#include "core/io/net_socket.h"
 #include "core/io/stream_peer_tcp.h"
-#include "core/io/tcp_server.h"
-#include "core/os/thread.h"
 #include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/list.h"
+#include "core/templates/local_vector.h"
 
+// Local HTTP/1.1 endpoint the backend calls to run editor tools.
+//
+// An accept thread waits on the listening socket and gives each client its
+// own connection thread, which blocks on socket readiness instead of
+// sleeping between polls, keeps the connection alive across requests and
+// reads both Content-Length and chunked bodies. Tools touch the scene tree,
+// so parsed requests are handed to the main thread through a bounded queue
+// and the connection thread waits for the result.
+//
+// A body with a `calls` array is a batch: it runs through
+// EditorTools::execute_tool_batch() and each result is streamed back as one
+// NDJSON line of a chunked response as soon as it is ready, followed by a
+// final `{"done": true}` line.
+//
+// take_screenshot calls, single or in a batch, go through
+// AIScreenshotCapture::capture_async(), so the GPU readback and the encoding
+// happen off the main thread; the connection thread keeps waiting for the
+// result.
 class AIToolServer : public RefCounted {
 	GDCLASS(AIToolServer, RefCounted);
 
 private:
-	Ref<TCPServer> server;
-	Ref<StreamPeerTCP> tcp;
-	Ref<StreamPeer> peer;
-	uint8_t req_buf[4096];
-	int req_pos = 0;
-	uint64_t time = 0;
-	
+	static constexpr int MAX_CONNECTIONS = 8;
+	static constexpr int MAX_QUEUED_REQUESTS = 32;
+	static constexpr int MAX_HEADER_SIZE = 64 * 1024;
+	static constexpr int MAX_BODY_SIZE = 64 * 1024 * 1024;
+	static constexpr int WAIT_SLICE_MSEC = 250; // Blocked threads re-check for shutdown this often.
+	static constexpr uint64_t KEEP_ALIVE_TIMEOUT_MSEC = 30000;
+	static constexpr uint64_t REQUEST_TIMEOUT_MSEC = 30000;
+
+	struct PendingRequest {
+		String method;
+		String path;
+		Dictionary data;
+		Dictionary response;
+		Semaphore done;
+
+		// Batch requests stream results instead of filling `response`.
+		bool batch = false;
+		Mutex stream_lock;
+		List<String> stream_lines;
+		bool stream_done = false;
+		Semaphore stream_ready; // Posted once per pushed line.
+		// Index in `calls` of each call passed to EditorTools::execute_tool_batch().
+		LocalVector<int> batch_indices;
+		// Main thread only. The final line is pushed once both are done.
+		bool batch_finished = false;
+		int pending_captures = 0;
+	};
+
+	struct Capture {
+		PendingRequest *request = nullptr;
+		int index = -1; // Index in the batch's `calls`, -1 for a single request.
+	};
+
+	struct Connection {
+		AIToolServer *owner = nullptr;
+		Ref<StreamPeerTCP> tcp;
+		Thread thread;
+		SafeFlag finished;
+		LocalVector<uint8_t> buffer;
+		uint32_t read_pos = 0; // Bytes before this belong to requests already handled.
+	};
+
+	Ref<NetSocket> listen_socket;
+	Thread accept_thread;
 	SafeFlag server_quit;
-	Mutex server_lock;
-	Thread server_thread;
-	
-	void _clear_client();
-	void _send_response();
-	void _poll();
-	Dictionary _handle_tool_request(const String &p_method, const String &p_path, const String &p_body);
-	
-	static void _server_thread_poll(void *data);
+
+	Mutex connections_lock;
+	List<Connection *> connections;
+
+	Mutex queue_lock;
+	List<PendingRequest *> request_queue;
+	bool dispatch_queued = false;
+
+	// Screenshots being captured, main thread only.
+	HashMap<uint64_t, Capture> captures;
+	uint64_t last_capture_id = 0;
+
+	// Connection threads.
+	void _accept_loop();
+	void _reap_connections(bool p_wait_all);
+	void _connection_loop(Connection *p_connection);
+	bool _read_more(Connection *p_connection, uint64_t p_deadline);
+	bool _ensure_bytes(Connection *p_connection, uint32_t p_count, uint64_t p_deadline);
+	int _find(const Connection *p_connection, const char *p_pattern, uint32_t p_from) const;
+	bool _read_chunked_body(Connection *p_connection, uint64_t p_deadline, LocalVector<uint8_t> &r_body, int &r_status);
+	void _send_response(Connection *p_connection, int p_status, const String &p_body, bool p_keep_alive);
+	bool _stream_batch_response(Connection *p_connection, PendingRequest *p_request, bool p_keep_alive);
+	bool _enqueue_request(PendingRequest *p_request);
+
+	// Main thread.
+	void _dispatch_requests();
+	Dictionary _handle_tool_request(const String &p_method, const String &p_path, const Dictionary &p_request);
+	void _handle_batch_request(PendingRequest *p_request);
+	void _finish_batch_if_done(PendingRequest *p_request);
+	void _start_capture(PendingRequest *p_request, int p_index, const Variant &p_args);
+	void _on_capture_finished(const Dictionary &p_result, uint64_t p_capture_id);
+	static void _normalize_tool_args(const String &p_function_name, Dictionary &r_args);
+	static void _push_stream_line(PendingRequest *p_request, const String &p_line, bool p_last);
+	static void _push_batch_result(PendingRequest *p_request, int p_index, const Dictionary &p_result);
+	static void _on_batch_result(void *p_userdata, int p_index, const Dictionary &p_result);
+
+	static void _accept_thread_func(void *p_userdata);
+	static void _connection_thread_func(void *p_userdata);
 
 protected:
 	static void _bind_methods();
@@ -37,4 +125,4 @@ public:
 	void stop();
 	Error listen(int p_port = 8001);
 	bool is_listening() const;
-}; 
\ No newline at end of file
+};
@@ -5,6 +5,7 @@
 #include "scene/gui/panel_container.h"
 #include "scene/gui/scroll_container.h"
 #include "scene/gui/label.h"
+#include "core/string/string_builder.h"
 #include "editor/script/script_editor_plugin.h"
 #include "editor/script/script_text_editor.h"
 #include "editor/editor_interface.h"
@@ -81,32 +82,13 @@ void DiffViewer::set_diff(const String &p_path, const String &p_original, const
     for (int i = 0; i < hunks_container->get_child_count(); i++) {
         hunks_container->get_child(i)->queue_free();
     }
-    hunks.clear();
+    hunk_checks.clear();
 
-    // Debug: Print the texts being compared
-    print_line("DEBUG: Original text length: " + String::num_int64(p_original.length()));
-    print_line("DEBUG: Modified text length: " + String::num_int64(p_modified.length()));
+    // Reopening the same edit reuses the cached diff.
+    diff = AITextDiff::compute(original_text, modified_text);
+    hunks = diff.get_hunks();
 
-    Vector<String> original_lines_vec = original_text.split("\n");
-    std::vector<String> original_lines;
-    for (int i = 0; i < original_lines_vec.size(); i++) {
-        original_lines.push_back(original_lines_vec[i]);
-    }
-
-    Vector<String> modified_lines_vec = modified_text.split("\n");
-    std::vector<String> modified_lines;
-    for (int i = 0; i < modified_lines_vec.size(); i++) {
-        modified_lines.push_back(modified_lines_vec[i]);
-    }
-
-    dtl::Diff<String, std::vector<String>> d(original_lines, modified_lines);
-    d.compose();
-    d.composeUnifiedHunks();
-
-    const auto &uni_hunks = d.getUniHunks();
-    print_line("DEBUG: Number of hunks found: " + String::num_int64(uni_hunks.size()));
-
-    if (uni_hunks.empty()) {
+    if (hunks.is_empty()) {
         // If no hunks, create a simple message
         PanelContainer *panel = memnew(PanelContainer);
         hunks_container->add_child(panel);
@@ -120,21 +102,8 @@ void DiffViewer::set_diff(const String &p_path, const String &p_original, const
         return;
     }
 
-    for (const auto &hunk : uni_hunks) {
-        DiffHunk diff_hunk;
-        diff_hunk.hunk.a = hunk.a;
-        diff_hunk.hunk.b = hunk.b;
-        diff_hunk.hunk.c = hunk.c;
-        diff_hunk.hunk.d = hunk.d;
-        diff_hunk.accepted = true; // Default to accepted
-        for (const auto &line : hunk.change) {
-            DiffLine diff_line;
-            diff_line.text = line.first;
-            diff_line.type = line.second.type;
-            diff_hunk.lines.push_back(diff_line);
-        }
-        hunks.push_back(diff_hunk);
-
+    const Vector<AITextDiff::Line> &lines = diff.get_lines();
+    for (const AITextDiff::Hunk &hunk : hunks) {
         PanelContainer *panel = memnew(PanelContainer);
         hunks_container->add_child(panel);
 
@@ -142,9 +111,10 @@ void DiffViewer::set_diff(const String &p_path, const String &p_original, const
         panel->add_child(vb);
 
         CheckBox *checkbox = memnew(CheckBox);
-        checkbox->set_text("@@ -" + String::num_int64(hunk.a) + "," + String::num_int64(hunk.b) + " +" + String::num_int64(hunk.c) + "," + String::num_int64(hunk.d) + " @@");
+        checkbox->set_text("@@ -" + String::num_int64(hunk.old_start + 1) + "," + String::num_int64(hunk.old_count) + " +" + String::num_int64(hunk.new_start + 1) + "," + String::num_int64(hunk.new_count) + " @@");
         checkbox->set_pressed(true);
         vb->add_child(checkbox);
+        hunk_checks.push_back(checkbox);
 
         RichTextLabel *diff_label = memnew(RichTextLabel);
         diff_label->set_use_bbcode(true);
@@ -154,72 +124,35 @@ void DiffViewer::set_diff(const String &p_path, const String &p_original, const
         diff_label->set_custom_minimum_size(Size2(0, 100));
         vb->add_child(diff_label);
 
-        String diff_text = "";
-        for (const auto &line : diff_hunk.lines) {
-            if (line.type == dtl::SES_ADD) {
-                diff_text += "[color=green]+" + line.text.xml_escape() + "[/color]\n";
-            } else if (line.type == dtl::SES_DELETE) {
-                diff_text += "[color=red]-" + line.text.xml_escape() + "[/color]\n";
+        StringBuilder diff_text;
+        for (int i = hunk.first_line; i < hunk.first_line + hunk.line_count; i++) {
+            const AITextDiff::Line &line = lines[i];
+            const String text = diff.get_line_text(line).xml_escape();
+            if (line.op == AITextDiff::OP_INSERT) {
+                diff_text.append("[color=green]+" + text + "[/color]\n");
+            } else if (line.op == AITextDiff::OP_DELETE) {
+                diff_text.append("[color=red]-" + text + "[/color]\n");
             } else {
-                diff_text += " " + line.text.xml_escape() + "\n";
+                diff_text.append(" " + text + "\n");
             }
         }
-        
-        print_line("DEBUG: Setting diff text for hunk: " + diff_text.substr(0, 100) + "...");
-        diff_label->set_text(diff_text);
+        diff_label->set_text(diff_text.as_string());
     }
 }
 
 String DiffViewer::get_final_content() {
-    String new_content = "";
-    Vector<String> original_lines = original_text.split("\n");
-    int last_line = 0;
-
+    Vector<bool> accepted;
+    accepted.resize(hunks.size());
     for (int i = 0; i < hunks.size(); i++) {
-        const DiffHunk &diff_hunk = hunks[i];
-        
-        // Get checkbox state from UI
-        PanelContainer *panel = Object::cast_to<PanelContainer>(hunks_container->get_child(i));
-        if (panel) {
-            VBoxContainer *vb = Object::cast_to<VBoxContainer>(panel->get_child(0));
-            if (vb) {
-                CheckBox *checkbox = Object::cast_to<CheckBox>(vb->get_child(0));
-                if (checkbox) {
-                    // Apply the hunk if checkbox is checked
-                    if (checkbox->is_pressed()) {
-                        // Add lines before this hunk
-                        for (int j = last_line; j < diff_hunk.hunk.a - 1; j++) {
-                            if (j < original_lines.size()) {
-                                new_content += original_lines[j] + "\n";
-                            }
-                        }
-                        // Add modified lines (excluding deletions)
-                        for (const auto &line : diff_hunk.lines) {
-                            if (line.type != dtl::SES_DELETE) {
-                                new_content += line.text + "\n";
-                            }
-                        }
-                        last_line = diff_hunk.hunk.a + diff_hunk.hunk.b - 1;
-                    } else {
-                        // Keep original lines
-                        for (int j = last_line; j < diff_hunk.hunk.a + diff_hunk.hunk.b - 1; j++) {
-                            if (j < original_lines.size()) {
-                                new_content += original_lines[j] + "\n";
-                            }
-                        }
-                        last_line = diff_hunk.hunk.a + diff_hunk.hunk.b - 1;
-                    }
-                }
-            }
-        }
+        accepted.write[i] = i < hunk_checks.size() && hunk_checks[i]->is_pressed();
     }
+    return diff.apply_hunks(hunks, accepted);
+}
 
-    // Add remaining lines
-    for (int i = last_line; i < original_lines.size(); i++) {
-        new_content += original_lines[i] + "\n";
+void DiffViewer::_set_all_hunks_pressed(bool p_pressed) {
+    for (CheckBox *checkbox : hunk_checks) {
+        checkbox->set_pressed(p_pressed);
     }
-
-    return new_content;
 }
 
 bool DiffViewer::has_script_open(const String &p_path) {
@@ -306,39 +239,16 @@ void DiffViewer::_on_accept_pressed() {
 }
 
 void DiffViewer::_on_accept_all_pressed() {
-    for (int i = 0; i < hunks_container->get_child_count(); i++) {
-        PanelContainer *panel = Object::cast_to<PanelContainer>(hunks_container->get_child(i));
-        if (panel) {
-            VBoxContainer *vb = Object::cast_to<VBoxContainer>(panel->get_child(0));
-            if (vb) {
-                CheckBox *checkbox = Object::cast_to<CheckBox>(vb->get_child(0));
-                if (checkbox) {
-                    checkbox->set_pressed(true);
-                }
-            }
-        }
-    }
+    _set_all_hunks_pressed(true);
     apply_to_script_editor();
     hide();
 }
 
 void DiffViewer::_on_reject_all_pressed() {
-    for (int i = 0; i < hunks_container->get_child_count(); i++) {
-        PanelContainer *panel = Object::cast_to<PanelContainer>(hunks_container->get_child(i));
-        VBoxContainer *vb = Object::cast_to<VBoxContainer>(panel->get_child(0));
-        CheckBox *checkbox = Object::cast_to<CheckBox>(vb->get_child(0));
-        checkbox->set_pressed(false);
-    }
+    _set_all_hunks_pressed(false);
 }
 
 void DiffViewer::_on_reject_pressed() {
-    for (int i = 0; i < hunks_container->get_child_count(); i++) {
-        PanelContainer *panel = Object::cast_to<PanelContainer>(hunks_container->get_child(i));
-        VBoxContainer *vb = Object::cast_to<VBoxContainer>(panel->get_child(0));
-        CheckBox *checkbox = Object::cast_to<CheckBox>(vb->get_child(0));
-        if (checkbox->is_pressed()) {
-            checkbox->set_pressed(false);
-        }
-    }
+    _set_all_hunks_pressed(false);
     hide();
 }
@@ -5,21 +5,9 @@
 #include "scene/gui/box_container.h"
 #include "scene/gui/button.h"
 #include "scene/gui/check_box.h"
-#include "dtl.hpp"
-#include <vector>
+#include "editor/ai/ai_text_diff.h"
 #include "common.h"
 
-struct DiffLine {
-    String text;
-    dtl::edit_t type;
-};
-
-struct DiffHunk {
-    dtl::uniHunk<String> hunk;
-    Vector<DiffLine> lines;
-    bool accepted = true; // Track acceptance state
-};
-
 class DiffViewer : public PopupPanel {
     GDCLASS(DiffViewer, PopupPanel);
 
@@ -34,7 +22,11 @@ private:
     String modified_text;
     String path;
 
-    Vector<DiffHunk> hunks;
+    AITextDiff diff;
+    Vector<AITextDiff::Hunk> hunks;
+    Vector<CheckBox *> hunk_checks;
+
+    void _set_all_hunks_pressed(bool p_pressed);
 
 protected:
     void _notification(int p_what);
@@ -31,6 +31,7 @@
 #include "register_editor_types.h"
 
 #include "core/object/script_language.h"
+#include "editor/ai/editor_tools.h"
 #include "editor/animation/animation_tree_editor_plugin.h"
 #include "editor/audio/audio_stream_editor_plugin.h"
 #include "editor/audio/audio_stream_randomizer_editor_plugin.h"
@@ -313,6 +314,7 @@ void unregister_editor_types() {
 	OS::get_singleton()->benchmark_begin_measure("Editor", "Unregister Types");
 
 	EditorNode::cleanup();
+	EditorTools::cleanup();
 	EditorInterface::free();
 
 	if (EditorPaths::get_singleton()) {
@@ -35,6 +35,7 @@
 #include "core/io/json.h"
 #include "core/math/expression.h"
 #include "core/os/keyboard.h"
+#include "editor/ai/ai_text_diff.h"
 #include "editor/debugger/editor_debugger_node.h"
 #include "editor/doc/editor_help.h"
 #include "editor/docks/filesystem_dock.h"
@@ -53,9 +54,6 @@
 #include "editor/gui/editor_file_dialog.h"
 #include "scene/resources/style_box_flat.h"
 
-// dtl diff library
-#include "dtl.hpp"
-
 void ConnectionInfoDialog::ok_pressed() {
 }
 
@@ -2900,155 +2898,6 @@ void ScriptTextEditor::validate() {
 	code_editor->validate_script();
 }
 
-// Simple Myers O(ND) Diff Algorithm Implementation
-class MyersDiff {
-private:
-	Vector<String> original_lines;
-	Vector<String> modified_lines;
-	
-	struct Point {
-		int x, y;
-		Point(int x = 0, int y = 0) : x(x), y(y) {}
-		Point operator+(const Point& other) const { return Point(x + other.x, y + other.y); }
-	};
-	
-	Vector<MyersDiffEdit> compute_diff() {
-		int N = original_lines.size();
-		int M = modified_lines.size();
-		
-		// Handle edge cases
-		if (N == 0 && M == 0) {
-			return Vector<MyersDiffEdit>();
-		}
-		
-		if (N == 0) {
-			// All insertions
-			Vector<MyersDiffEdit> result_diff;
-			for (int i = 0; i < M; i++) {
-				MyersDiffEdit edit;
-				edit.type = MyersDiffEdit::INSERT;
-				edit.text = modified_lines[i];
-				edit.original_line = 0;
-				edit.modified_line = i;
-				result_diff.push_back(edit);
-			}
-			return result_diff;
-		}
-		
-		if (M == 0) {
-			// All deletions
-			Vector<MyersDiffEdit> result_diff;
-			for (int i = 0; i < N; i++) {
-				MyersDiffEdit edit;
-				edit.type = MyersDiffEdit::DELETE;
-				edit.text = original_lines[i];
-				edit.original_line = i;
-				edit.modified_line = 0;
-				result_diff.push_back(edit);
-			}
-			return result_diff;
-		}
-		
-		int max_d = N + M;
-		
-		// V array for the algorithm
-		Vector<int> V;
-		V.resize(2 * max_d + 1);
-		for (int i = 0; i < V.size(); i++) {
-			V.write[i] = -1;
-		}
-		V.write[max_d + 1] = 0;
-		
-		// Find the shortest edit script
-		Vector<Vector<int>> trace;
-		
-		for (int d = 0; d <= max_d; d++) {
-			Vector<int> v_copy = V;
-			trace.push_back(v_copy);
-			
-			for (int k = -d; k <= d; k += 2) {
-				int x;
-				if (k == -d || (k != d && V[max_d + k - 1] < V[max_d + k + 1])) {
-					x = V[max_d + k + 1];
-				} else {
-					x = V[max_d + k - 1] + 1;
-				}
-				
-				int y = x - k;
-				
-				while (x < N && y < M && original_lines[x] == modified_lines[y]) {
-					x++;
-					y++;
-				}
-				
-				V.write[max_d + k] = x;
-				
-				if (x >= N && y >= M) {
-					// Found the solution, now backtrack
-					Vector<MyersDiffEdit> result_diff;
-					
-					x = N;
-					y = M;
-					
-					for (int trace_d = d; trace_d >= 0; trace_d--) {
-						const Vector<int> &v = trace[trace_d];
-						int k = x - y;
-						
-						int prev_k;
-						if (k == -trace_d || (k != trace_d && v[max_d + k - 1] < v[max_d + k + 1])) {
-							prev_k = k + 1;
-						} else {
-							prev_k = k - 1;
-						}
-						
-						int prev_x = (trace_d > 0) ? v[max_d + prev_k] : 0;
-						int prev_y = prev_x - prev_k;
-						
-						while (x > prev_x && y > prev_y) {
-							x--;
-							y--;
-						}
-						
-						if (trace_d > 0) {
-							if (x > prev_x) {
-								MyersDiffEdit edit;
-								edit.type = MyersDiffEdit::DELETE;
-								edit.text = original_lines[x - 1];
-								edit.original_line = x - 1;
-								edit.modified_line = y;
-								result_diff.push_back(edit);
-								x = prev_x;
-							} else if (y > prev_y) {
-								MyersDiffEdit edit;
-								edit.type = MyersDiffEdit::INSERT;
-								edit.text = modified_lines[y - 1];
-								edit.original_line = x;
-								edit.modified_line = y;
-								result_diff.push_back(edit);
-								y = prev_y;
-							}
-						}
-					}
-					
-					// Reverse the diff since we built it backwards
-					result_diff.reverse();
-					return result_diff;
-				}
-			}
-		}
-		
-		// Fallback - should not happen
-		return Vector<MyersDiffEdit>();
-	}
-	
-public:
-	Vector<MyersDiffEdit> diff(const Vector<String>& orig, const Vector<String>& mod) {
-		original_lines = orig;
-		modified_lines = mod;
-		return compute_diff();
-	}
-};
-
 // Simple unified diff viewer - no live editing, just static comparison
 void ScriptTextEditor::set_diff(const String &p_original_content, const String &p_modified_content) {
 	_clear_diff_data();
@@ -3067,9 +2916,6 @@ void ScriptTextEditor::set_diff(const String &p_original_content, const String &
 
 void ScriptTextEditor::_show_unified_diff(const String &p_original, const String &p_modified) {
     // Show the complete modified file with change indicators
-    Vector<String> original_lines = p_original.split("\n");
-    Vector<String> modified_lines = p_modified.split("\n");
-
     CodeEdit *te = code_editor->get_text_editor();
     // Set content once
     te->set_text(modified_content);
@@ -3081,19 +2927,25 @@ void ScriptTextEditor::_show_unified_diff(const String &p_original, const String
         te->set_line_background_color(i, Color(0, 0, 0, 0));
     }
 
-    // Compute highlights: changed lines (within overlap) and added lines (beyond original)
-    const int overlap = MIN(original_lines.size(), modified_lines.size());
+    // Inserted lines that replace deleted ones are shown as changed, the
+    // rest as added.
+    const AITextDiff diff = AITextDiff::compute(p_original, p_modified);
+    const Vector<AITextDiff::Line> &diff_lines = diff.get_lines();
     Vector<int> changed_lines;
     Vector<int> added_lines;
 
-    for (int i = 0; i < overlap; i++) {
-        if (original_lines[i] != modified_lines[i]) {
-            changed_lines.push_back(i);
+    bool block_has_deletions = false;
+    for (const AITextDiff::Line &line : diff_lines) {
+        if (line.op == AITextDiff::OP_EQUAL) {
+            block_has_deletions = false;
+        } else if (line.op == AITextDiff::OP_DELETE) {
+            block_has_deletions = true;
+        } else if (block_has_deletions) {
+            changed_lines.push_back(line.new_line);
+        } else {
+            added_lines.push_back(line.new_line);
         }
     }
-    for (int i = overlap; i < modified_lines.size(); i++) {
-        added_lines.push_back(i);
-    }
 
     // Colors
     const Color changed_color = Color(0.2, 0.6, 1.0, 0.25); // Blue-ish for modified lines
@@ -31,7 +31,6 @@
 #pragma once
 
 #include "script_editor_plugin.h"
-#include "dtl/dtl.hpp"
 
 #include "editor/gui/code_editor.h"
 #include "scene/gui/color_picker.h"
@@ -55,22 +54,6 @@ public:
 	ConnectionInfoDialog();
 };
 
-// Forward declarations and structures for diff functionality
-struct MyersDiffEdit {
-	enum Type { EQUAL, DELETE, INSERT };
-	Type type;
-	String text;
-	int original_line;
-	int modified_line;
-};
-
-struct DiffDisplayLine {
-	enum Type { UNCHANGED, ADDED, REMOVED };
-	Type type;
-	String content;
-	int line_number;
-};
-
 class ScriptTextEditor : public ScriptEditorBase {
 	GDCLASS(ScriptTextEditor, ScriptEditorBase);
 
@@ -124,13 +107,6 @@ class ScriptTextEditor : public ScriptEditorBase {
 	Color safe_line_number_color = Color(1, 1, 1);
 
 	// Simple diff system - read-only unified diff viewer
-	struct MyersDiffEdit {
-		enum Type { INSERT, DELETE, EQUAL } type = EQUAL;
-		String text;
-		int original_line = 0;
-		int modified_line = 0;
-	};
-	
 	int diff_gutter = -1;  // Keep this for existing gutter code
 	String original_content;
 	String modified_content;
@@ -0,0 +1,271 @@
+/**************************************************************************/
+/*  test_http_connection_pool.h                                           */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+
+#pragma once
+
+#include "core/io/http_connection_pool.h"
+#include "core/io/stream_peer_tcp.h"
+#include "core/io/tcp_server.h"
+#include "core/os/thread.h"
+#include "tests/test_macros.h"
+
+#include <functional>
+
+namespace TestHTTPConnectionPool {
+
+const int PORT = 12346;
+const IPAddress LOCALHOST("127.0.0.1");
+const uint32_t SLEEP_DURATION = 1000;
+const uint64_t MAX_WAIT_USEC = 2000000;
+
+bool wait_for_condition(std::function<bool()> f_test) {
+	const uint64_t time = OS::get_singleton()->get_ticks_usec();
+	while (!f_test() && (OS::get_singleton()->get_ticks_usec() - time) < MAX_WAIT_USEC) {
+		OS::get_singleton()->delay_usec(SLEEP_DURATION);
+	}
+	return f_test();
+}
+
+String url(const String &p_path) {
+	return "http://127.0.0.1:" + itos(PORT) + p_path;
+}
+
+Ref<StreamPeerTCP> accept_connection(const Ref<TCPServer> &p_server) {
+	wait_for_condition([&]() {
+		return p_server->is_connection_available();
+	});
+	REQUIRE(p_server->is_connection_available());
+	Ref<StreamPeerTCP> peer = p_server->take_connection();
+	REQUIRE(peer.is_valid());
+	return peer;
+}
+
+// Reads a request up to the blank line; the tests only send requests without a body.
+String read_request(const Ref<StreamPeerTCP> &p_peer) {
+	String request;
+	wait_for_condition([&]() {
+		p_peer->poll();
+		while (p_peer->get_available_bytes() > 0 && !request.ends_with("\r\n\r\n")) {
+			uint8_t byte = 0;
+			p_peer->get_data(&byte, 1);
+			request += char32_t(byte);
+		}
+		return request.ends_with("\r\n\r\n");
+	});
+	return request;
+}
+
+void send_response(const Ref<StreamPeerTCP> &p_peer, const String &p_body, bool p_close = false) {
+	String response = "HTTP/1.1 200 OK\r\nContent-Length: " + itos(p_body.length()) + "\r\n";
+	if (p_close) {
+		response += "Connection: close\r\n";
+	}
+	response += "\r\n" + p_body;
+	const CharString data = response.utf8();
+	p_peer->put_data((const uint8_t *)data.get_data(), data.length());
+}
+
+struct ServerThreadData {
+	Ref<TCPServer> server;
+	int connections = 0;
+	int requests = 0;
+};
+
+// Answers every request with `Connection: close`, one request per connection.
+void serve_closing_connections(void *p_userdata) {
+	ServerThreadData *data = (ServerThreadData *)p_userdata;
+	for (int i = 0; i < data->requests; i++) {
+		if (!wait_for_condition([&]() { return data->server->is_connection_available(); })) {
+			return;
+		}
+		Ref<StreamPeerTCP> peer = data->server->take_connection();
+		data->connections++;
+		const String request = read_request(peer);
+		send_response(peer, request.get_slicec(' ', 1), true);
+		OS::get_singleton()->delay_usec(10000);
+		peer->disconnect_from_host();
+	}
+}
+
+TEST_CASE("[HTTPConnectionPool] Requests to the same host reuse the connection") {
+	Ref<TCPServer> server;
+	server.instantiate();
+	REQUIRE_EQ(server->listen(PORT, LOCALHOST), OK);
+
+	HTTPConnectionPool *pool = HTTPConnectionPool::get_singleton();
+	REQUIRE(pool != nullptr);
+
+	HTTPConnectionPool::Request request;
+	request.url = url("/first");
+	request.timeout = 2.0;
+	const HTTPConnectionPool::RequestID first = pool->request(request);
+	REQUIRE(first != HTTPConnectionPool::INVALID_REQUEST_ID);
+
+	Ref<StreamPeerTCP> peer = accept_connection(server);
+	CHECK(read_request(peer).begins_with("GET /first HTTP/1.1"));
+	send_response(peer, "first");
+	CHECK(wait_for_condition([&]() { return !pool->is_request_pending(first); }));
+
+	request.url = url("/second");
+	const HTTPConnectionPool::RequestID second = pool->request(request);
+	CHECK(read_request(peer).begins_with("GET /second HTTP/1.1"));
+	CHECK_FALSE(server->is_connection_available());
+	send_response(peer, "second");
+	CHECK(wait_for_condition([&]() { return !pool->is_request_pending(second); }));
+
+	pool->close_idle_connections();
+	server->stop();
+}
+
+TEST_CASE("[HTTPConnectionPool] A connection closed by the server is replaced") {
+	Ref<TCPServer> server;
+	server.instantiate();
+	REQUIRE_EQ(server->listen(PORT, LOCALHOST), OK);
+
+	HTTPConnectionPool *pool = HTTPConnectionPool::get_singleton();
+	HTTPConnectionPool::Request request;
+	request.url = url("/first");
+	request.timeout = 2.0;
+	const HTTPConnectionPool::RequestID first = pool->request(request);
+
+	Ref<StreamPeerTCP> peer = accept_connection(server);
+	read_request(peer);
+	send_response(peer, "first");
+	CHECK(wait_for_condition([&]() { return !pool->is_request_pending(first); }));
+
+	// The server drops the idle keep-alive connection.
+	peer->disconnect_from_host();
+	OS::get_singleton()->delay_usec(10000);
+
+	request.url = url("/second");
+	const HTTPConnectionPool::RequestID second = pool->request(request);
+	Ref<StreamPeerTCP> new_peer = accept_connection(server);
+	CHECK(read_request(new_peer).begins_with("GET /second HTTP/1.1"));
+	send_response(new_peer, "second");
+	CHECK(wait_for_condition([&]() { return !pool->is_request_pending(second); }));
+
+	pool->close_idle_connections();
+	server->stop();
+}
+
+TEST_CASE("[HTTPConnectionPool] Cancelling a request closes its connection") {
+	Ref<TCPServer> server;
+	server.instantiate();
+	REQUIRE_EQ(server->listen(PORT, LOCALHOST), OK);
+
+	HTTPConnectionPool *pool = HTTPConnectionPool::get_singleton();
+	const HTTPConnectionPool::RequestID id = pool->request(url("/slow"), HTTPClient::METHOD_GET, Vector<String>(), String(), Callable());
+	REQUIRE(id != HTTPConnectionPool::INVALID_REQUEST_ID);
+
+	Ref<StreamPeerTCP> peer = accept_connection(server);
+	CHECK(read_request(peer).begins_with("GET /slow HTTP/1.1"));
+	CHECK(pool->is_request_pending(id));
+
+	pool->cancel(id);
+	CHECK_FALSE(pool->is_request_pending(id));
+	CHECK(wait_for_condition([&]() {
+		peer->poll();
+		return peer->get_status() != StreamPeerTCP::STATUS_CONNECTED;
+	}));
+
+	server->stop();
+}
+
+TEST_CASE("[HTTPConnectionPool] Queued requests time out") {
+	Ref<TCPServer> server;
+	server.instantiate();
+	REQUIRE_EQ(server->listen(PORT, LOCALHOST), OK);
+
+	HTTPConnectionPool *pool = HTTPConnectionPool::get_singleton();
+	const int max_connections = pool->get_max_connections_per_host();
+	pool->set_max_connections_per_host(1);
+
+	HTTPConnectionPool::Request request;
+	request.url = url("/busy");
+	const HTTPConnectionPool::RequestID busy = pool->request(request);
+	Ref<StreamPeerTCP> peer = accept_connection(server);
+	CHECK(read_request(peer).begins_with("GET /busy HTTP/1.1"));
+
+	// Never gets a connection while the first request is unanswered.
+	request.url = url("/queued");
+	request.timeout = 0.2;
+	const HTTPConnectionPool::RequestID queued = pool->request(request);
+	CHECK(pool->is_request_pending(queued));
+	CHECK(wait_for_condition([&]() { return !pool->is_request_pending(queued); }));
+	CHECK(pool->is_request_pending(busy));
+
+	pool->cancel(busy);
+	pool->set_max_connections_per_host(max_connections);
+	server->stop();
+}
+
+TEST_CASE("[HTTPConnectionPool] Blocking requests and Connection: close") {
+	ServerThreadData data;
+	data.server.instantiate();
+	data.requests = 2;
+	REQUIRE_EQ(data.server->listen(PORT, LOCALHOST), OK);
+
+	Thread server_thread;
+	server_thread.start(serve_closing_connections, &data);
+
+	HTTPConnectionPool *pool = HTTPConnectionPool::get_singleton();
+	HTTPConnectionPool::Request request;
+	request.timeout = 2.0;
+	for (const String path : { "/one", "/two" }) {
+		request.url = url(path);
+		HTTPConnectionPool::Response response;
+		CHECK_EQ(pool->request_blocking(request, response), OK);
+		CHECK_EQ(response.result, HTTPConnectionPool::RESULT_SUCCESS);
+		CHECK_EQ(response.code, 200);
+		CHECK_EQ(String::utf8((const char *)response.body.ptr(), response.body.size()), path);
+	}
+
+	server_thread.wait_to_finish();
+	// The server asked for each connection to be closed, so none was reused.
+	CHECK_EQ(data.connections, 2);
+
+	data.server->stop();
+}
+
+TEST_CASE("[HTTPConnectionPool] Invalid URLs are rejected") {
+	HTTPConnectionPool *pool = HTTPConnectionPool::get_singleton();
+
+	ERR_PRINT_OFF;
+	CHECK_EQ(pool->request(String("ftp://127.0.0.1/file"), HTTPClient::METHOD_GET, Vector<String>(), String(), Callable()), HTTPConnectionPool::INVALID_REQUEST_ID);
+
+	HTTPConnectionPool::Request request;
+	request.url = "not a url";
+	HTTPConnectionPool::Response response;
+	CHECK_EQ(pool->request_blocking(request, response), ERR_INVALID_PARAMETER);
+	ERR_PRINT_ON;
+}
+
+} // namespace TestHTTPConnectionPool
@@ -32,6 +32,7 @@
 
 #include "core/core_bind.h"
 #include "core/core_constants.h"
+#include "core/io/resource.h"
 #include "core/object/class_db.h"
 
 #include "tests/test_macros.h"
@@ -895,4 +896,49 @@ TEST_SUITE("[ClassDB]") {
 		}
 	}
 }
+
+TEST_CASE("[ClassDB] Class list version") {
+	const uint64_t version = ClassDB::get_class_list_version();
+	CHECK(version > 0);
+
+	ClassDB::is_parent_class("Node2D", "Node");
+	CHECK_MESSAGE(ClassDB::get_class_list_version() == version, "Queries should not change the class list version.");
+
+	ClassDB::set_class_enabled("Node2D", false);
+	CHECK(ClassDB::get_class_list_version() > version);
+	ClassDB::set_class_enabled("Node2D", true);
+	CHECK(ClassDB::is_class_enabled("Node2D"));
+}
+
+TEST_CASE("[ClassDB] Inherited member lookups") {
+	MethodBind *get_class = ClassDB::get_method("Object", "get_class");
+	REQUIRE(get_class != nullptr);
+	CHECK_MESSAGE(ClassDB::get_method("Resource", "get_class") == get_class, "Methods should be found on base classes.");
+	CHECK(ClassDB::get_method("Resource", "get_name") != nullptr);
+	CHECK(ClassDB::get_method("Object", "get_name") == nullptr);
+	CHECK(ClassDB::get_method("NonExistentClass", "get_class") == nullptr);
+
+	Ref<Resource> resource;
+	resource.instantiate();
+
+	bool valid = false;
+	CHECK(ClassDB::set_property(resource.ptr(), "resource_name", "Flat", &valid));
+	CHECK(valid);
+	CHECK_FALSE(ClassDB::set_property(resource.ptr(), "not_a_property", 1));
+
+	Variant value;
+	CHECK(ClassDB::get_property(resource.ptr(), "resource_name", value));
+	CHECK(value == Variant("Flat"));
+
+	CHECK_MESSAGE(ClassDB::get_property(resource.ptr(), "NOTIFICATION_POSTINITIALIZE", value), "Inherited constants should be readable.");
+	CHECK(value == Variant(Object::NOTIFICATION_POSTINITIALIZE));
+
+	CHECK(ClassDB::get_property(resource.ptr(), "get_class", value));
+	CHECK(value.get_type() == Variant::CALLABLE);
+
+	CHECK(ClassDB::get_property(resource.ptr(), "changed", value));
+	CHECK(value.get_type() == Variant::SIGNAL);
+
+	CHECK_FALSE(ClassDB::get_property(resource.ptr(), "not_a_property", value));
+}
 } // namespace TestClassDB
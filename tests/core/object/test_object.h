@@ -314,6 +314,15 @@ TEST_CASE("[Object] Absent name getter") {
 			"The returned value should equal nil variant.");
 }
 
+class SignalCounterObject : public Object {
+public:
+	int count = 0;
+
+	void increment() {
+		count++;
+	}
+};
+
 TEST_CASE("[Object] Signals") {
 	Object object;
 
@@ -431,6 +440,31 @@ TEST_CASE("[Object] Signals") {
 		SIGNAL_UNWATCH(&object, "my_custom_signal");
 	}
 
+	SUBCASE("Emitting should pick up connections changed since the previous emission") {
+		SignalCounterObject first;
+		SignalCounterObject second;
+		SignalCounterObject one_shot;
+
+		object.connect("my_custom_signal", callable_mp(&first, &SignalCounterObject::increment));
+		object.emit_signal("my_custom_signal");
+		CHECK(first.count == 1);
+
+		object.connect("my_custom_signal", callable_mp(&second, &SignalCounterObject::increment));
+		object.connect("my_custom_signal", callable_mp(&one_shot, &SignalCounterObject::increment), Object::CONNECT_ONE_SHOT);
+		object.emit_signal("my_custom_signal");
+		object.emit_signal("my_custom_signal");
+		CHECK(first.count == 3);
+		CHECK(second.count == 2);
+		CHECK_MESSAGE(one_shot.count == 1, "One-shot connections should only be called once.");
+
+		object.disconnect("my_custom_signal", callable_mp(&first, &SignalCounterObject::increment));
+		object.emit_signal("my_custom_signal");
+		CHECK(first.count == 3);
+		CHECK(second.count == 3);
+
+		object.disconnect("my_custom_signal", callable_mp(&second, &SignalCounterObject::increment));
+	}
+
 	SUBCASE("Connecting and then disconnecting many signals should not leave anything behind") {
 		List<Object::Connection> signal_connections;
 		Object targets[100];
@@ -0,0 +1,186 @@
+/**************************************************************************/
+/*  test_string_name.h                                                    */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/os/thread.h"
+#include "core/string/string_name.h"
+#include "core/templates/safe_refcount.h"
+
+#include "tests/test_macros.h"
+
+namespace TestStringName {
+
+TEST_CASE("[StringName] Interning") {
+	const StringName from_c_string = StringName("test_string_name_interning");
+	const StringName from_string = StringName(String("test_string_name_interning"));
+
+	CHECK_MESSAGE(
+			from_c_string.data_unique_pointer() == from_string.data_unique_pointer(),
+			"Equal names should share the same entry.");
+	CHECK(from_c_string == String("test_string_name_interning"));
+	CHECK(from_c_string.hash() == String("test_string_name_interning").hash());
+
+	CHECK_MESSAGE(StringName("").is_empty(), "Empty names should not be interned.");
+	CHECK_MESSAGE(StringName(String()).is_empty(), "Empty names should not be interned.");
+}
+
+// Returns names that land in the same shard of the table, which picks shards by
+// the low bits of the hash. Matching 8 bits covers any shard count up to 256.
+static Vector<String> make_names_in_one_shard(const String &p_prefix, int p_count) {
+	Vector<String> names;
+	for (int i = 0; names.size() < p_count; i++) {
+		const String name = p_prefix + itos(i);
+		if ((name.hash() & 0xFF) == 0x2A) {
+			names.push_back(name);
+		}
+	}
+	return names;
+}
+
+TEST_CASE("[StringName] Released names can be interned again") {
+	// More released names in one shard than the sweep threshold (256).
+	const int name_count = 400;
+	const int revived_count = 10;
+	const Vector<String> names = make_names_in_one_shard("test_string_name_released_", name_count);
+
+	Vector<const void *> pointers;
+	{
+		Vector<StringName> interned;
+		for (const String &name : names) {
+			interned.push_back(StringName(name));
+			pointers.push_back(interned[interned.size() - 1].data_unique_pointer());
+		}
+		const uint32_t released_before = StringName::get_table_stats().released;
+		interned.clear();
+		CHECK(StringName::get_table_stats().released == released_before + name_count);
+	}
+
+	// Released entries stay in the table until swept, and are brought back as they were.
+	Vector<StringName> revived;
+	for (int i = 0; i < revived_count; i++) {
+		revived.push_back(StringName(names[i]));
+		CHECK_MESSAGE(revived[i].data_unique_pointer() == pointers[i], "A released name should be revived in place.");
+		CHECK(revived[i] == names[i]);
+	}
+	const uint32_t released_before_sweep = StringName::get_table_stats().released;
+
+	// Adding a new name to the shard sweeps out the released entries.
+	const Vector<String> sweeping = make_names_in_one_shard("test_string_name_sweeping_", 1);
+	const StringName sweeper = StringName(sweeping[0]);
+	CHECK_MESSAGE(
+			StringName::get_table_stats().released <= released_before_sweep - (name_count - revived_count),
+			"Inserting into a shard with enough released names should sweep them.");
+
+	for (int i = 0; i < revived_count; i++) {
+		CHECK_MESSAGE(revived[i].data_unique_pointer() == pointers[i], "Live names should survive a sweep.");
+		CHECK(revived[i] == names[i]);
+		CHECK(StringName(names[i]).data_unique_pointer() == pointers[i]);
+	}
+
+	// Swept names are interned again from scratch.
+	const String name = names[name_count - 1];
+	const StringName first = StringName(name);
+	const StringName second = StringName(name);
+	CHECK(first.data_unique_pointer() == second.data_unique_pointer());
+	CHECK(String(first) == name);
+}
+
+TEST_CASE("[StringName] Swept names are freed by a later sweep") {
+	const int name_count = 300;
+	const uint32_t awaiting_before = StringName::get_table_stats().awaiting_free;
+	for (int round = 0; round < 4; round++) {
+		{
+			Vector<StringName> interned;
+			for (const String &name : make_names_in_one_shard(vformat("test_string_name_round_%d_", round), name_count)) {
+				interned.push_back(StringName(name));
+			}
+		}
+		// Sweeps the names just released, and frees those of earlier rounds.
+		const StringName sweeper = StringName(make_names_in_one_shard(vformat("test_string_name_round_sweeper_%d_", round), 1)[0]);
+		CHECK_MESSAGE(
+				StringName::get_table_stats().awaiting_free <= awaiting_before + name_count,
+				"Swept names should not pile up across sweeps.");
+	}
+}
+
+struct ConcurrentInternState {
+	static const int THREAD_COUNT = 8;
+	static const int SHARED_NAME_COUNT = 100;
+	static const int ITERATIONS = 5000;
+
+	StringName shared[SHARED_NAME_COUNT];
+	SafeNumeric<int> next_thread;
+	SafeNumeric<int> errors;
+
+	static void thread_func(void *p_userdata) {
+		ConcurrentInternState *state = static_cast<ConcurrentInternState *>(p_userdata);
+		const int thread = state->next_thread.postincrement();
+		for (int i = 0; i < ITERATIONS; i++) {
+			const int index = (i * 7 + thread) % SHARED_NAME_COUNT;
+			const StringName name = StringName(vformat("test_string_name_shared_%d", index));
+			if (name.data_unique_pointer() != state->shared[index].data_unique_pointer()) {
+				state->errors.increment();
+			}
+
+			// Names released right away, and often raced for by other threads.
+			const String transient = vformat("test_string_name_transient_%d", i % 512);
+			if (StringName(transient) != transient) {
+				state->errors.increment();
+			}
+		}
+	}
+};
+
+TEST_CASE("[StringName] Concurrent interning") {
+	ConcurrentInternState state;
+	for (int i = 0; i < ConcurrentInternState::SHARED_NAME_COUNT; i++) {
+		state.shared[i] = StringName(vformat("test_string_name_shared_%d", i));
+	}
+
+	const StringName::TableStats stats_before = StringName::get_table_stats();
+
+	Thread threads[ConcurrentInternState::THREAD_COUNT];
+	for (Thread &thread : threads) {
+		thread.start(&ConcurrentInternState::thread_func, &state);
+	}
+	for (Thread &thread : threads) {
+		thread.wait_to_finish();
+	}
+
+	CHECK_MESSAGE(state.errors.get() == 0,
+			"Every thread should resolve a name to the same entry.");
+
+	const StringName::TableStats stats_after = StringName::get_table_stats();
+	CHECK_MESSAGE(stats_after.hits > stats_before.hits,
+			"Names that are already interned should be found without locking.");
+}
+
+} // namespace TestStringName
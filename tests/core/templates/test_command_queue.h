@@ -484,6 +484,77 @@ TEST_CASE("[Stress][CommandQueue] Stress test command queue") {
 			ProjectSettings::get_singleton()->property_get_revert(COMMAND_QUEUE_SETTING));
 }
 
+class MultiWriterState {
+public:
+	static const int WRITER_COUNT = 4;
+	// Enough commands to go through many pages of the queue.
+	static const int COMMANDS_PER_WRITER = 20000;
+
+	CommandQueueMT command_queue;
+	SafeNumeric<int> next_writer;
+	SafeFlag writing_done;
+	int received[WRITER_COUNT] = {};
+	int order_errors = 0;
+	int ret_errors = 0;
+
+	void receive(int p_writer, int p_sequence) {
+		if (p_sequence != received[p_writer]) {
+			order_errors++;
+		}
+		received[p_writer] = p_sequence + 1;
+	}
+	int twice(int p_value) {
+		return p_value * 2;
+	}
+
+	static void writer_func(void *p_userdata) {
+		MultiWriterState *state = static_cast<MultiWriterState *>(p_userdata);
+		int writer = state->next_writer.postincrement();
+		for (int i = 0; i < COMMANDS_PER_WRITER; i++) {
+			state->command_queue.push(state, &MultiWriterState::receive, writer, i);
+			if (i % 1000 == 0) {
+				int ret = 0;
+				state->command_queue.push_and_ret(state, &MultiWriterState::twice, &ret, i);
+				if (ret != i * 2) {
+					state->ret_errors++;
+				}
+			}
+		}
+	}
+	static void reader_func(void *p_userdata) {
+		MultiWriterState *state = static_cast<MultiWriterState *>(p_userdata);
+		while (!state->writing_done.is_set()) {
+			state->command_queue.flush_if_pending();
+		}
+		state->command_queue.flush_all();
+	}
+};
+
+TEST_CASE("[CommandQueue] Test multiple writers across pages") {
+	MultiWriterState state;
+
+	Thread reader;
+	reader.start(&MultiWriterState::reader_func, &state);
+	Thread writers[MultiWriterState::WRITER_COUNT];
+	for (Thread &writer : writers) {
+		writer.start(&MultiWriterState::writer_func, &state);
+	}
+	for (Thread &writer : writers) {
+		writer.wait_to_finish();
+	}
+	state.writing_done.set();
+	reader.wait_to_finish();
+
+	for (int i = 0; i < MultiWriterState::WRITER_COUNT; i++) {
+		CHECK_MESSAGE(state.received[i] == MultiWriterState::COMMANDS_PER_WRITER,
+				"Every command of every writer should have been executed.");
+	}
+	CHECK_MESSAGE(state.order_errors == 0,
+			"Commands from the same writer should be executed in push order.");
+	CHECK_MESSAGE(state.ret_errors == 0,
+			"Synchronous commands should return their result to the writer.");
+}
+
 TEST_CASE("[CommandQueue] Test Parameter Passing Semantics") {
 	SharedThreadState sts;
 	sts.init_threads();
@@ -106,6 +106,87 @@ TEST_CASE("[WorkerThreadPool] Process elements using group tasks") {
 	}
 }
 
+TEST_CASE("[WorkerThreadPool] Process large groups claimed in chunks") {
+	for (const int count : { 1, 3, 1000, 100000 }) {
+		for (const int tasks : { -1, 1, 64 }) {
+			counter.clear();
+			counter.resize(count);
+			WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_native_group_task(static_group_test, (void *)2, count, tasks, true);
+			WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+
+			bool all_run_once = true;
+			for (int i = 1; i < count; i++) {
+				all_run_once &= counter[i].get() == 1;
+			}
+			CHECK_MESSAGE(all_run_once, vformat("Every element should run exactly once (%d elements, %d tasks).", count, tasks));
+			// Element 0 also accumulates 2 per processed element.
+			CHECK_EQ(counter[0].get(), 1 + 2 * count);
+		}
+	}
+}
+
+// More than a thread's deque holds, so posting spills over to the shared queues.
+static const uint32_t NESTED_CHILD_COUNT = 2048;
+static SafeNumeric<uint32_t> nested_wait_errors;
+
+static void static_nested_child_test(void *p_arg) {
+	counter[(uint64_t)p_arg].increment();
+}
+
+static void static_nested_parent_test(void *p_arg) {
+	LocalVector<WorkerThreadPool::TaskID> children;
+	children.resize(NESTED_CHILD_COUNT);
+	for (uint32_t i = 0; i < NESTED_CHILD_COUNT; i++) {
+		children[i] = WorkerThreadPool::get_singleton()->add_native_task(static_nested_child_test, (void *)(uintptr_t)((uint64_t)p_arg * NESTED_CHILD_COUNT + i), true);
+	}
+	for (const WorkerThreadPool::TaskID child : children) {
+		if (WorkerThreadPool::get_singleton()->wait_for_task_completion(child) != OK) {
+			nested_wait_errors.increment();
+		}
+	}
+}
+
+TEST_CASE("[WorkerThreadPool] Run tasks posted from worker threads and past queue capacity") {
+	const uint32_t parent_count = 8;
+	counter.clear();
+	counter.resize(parent_count * NESTED_CHILD_COUNT);
+	nested_wait_errors.set(0);
+
+	LocalVector<WorkerThreadPool::TaskID> parents;
+	for (uint32_t i = 0; i < parent_count; i++) {
+		parents.push_back(WorkerThreadPool::get_singleton()->add_native_task(static_nested_parent_test, (void *)(uintptr_t)i, true));
+	}
+	for (const WorkerThreadPool::TaskID parent : parents) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(parent);
+	}
+
+	CHECK_EQ(nested_wait_errors.get(), 0u);
+	bool all_run_once = true;
+	for (uint32_t i = 0; i < counter.size(); i++) {
+		all_run_once &= counter[i].get() == 1;
+	}
+	CHECK_MESSAGE(all_run_once, "Every task posted from a worker thread should run exactly once.");
+
+	// Posted from this thread, more than the injection queue holds.
+	const uint32_t task_count = 10000;
+	counter.clear();
+	counter.resize(task_count);
+	LocalVector<WorkerThreadPool::TaskID> tasks;
+	tasks.resize(task_count);
+	for (uint32_t i = 0; i < task_count; i++) {
+		tasks[i] = WorkerThreadPool::get_singleton()->add_native_task(static_nested_child_test, (void *)(uintptr_t)i, true);
+	}
+	for (const WorkerThreadPool::TaskID task : tasks) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(task);
+	}
+
+	all_run_once = true;
+	for (uint32_t i = 0; i < task_count; i++) {
+		all_run_once &= counter[i].get() == 1;
+	}
+	CHECK_MESSAGE(all_run_once, "Every task posted past the injection queue capacity should run exactly once.");
+}
+
 static void static_test_daemon(void *p_arg) {
 	while (!exit.is_set()) {
 		counter[0].add(1);
@@ -0,0 +1,364 @@
+/**************************************************************************/
+/*  test_ai_chat_benchmark.h                                              */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/http_connection_pool.h"
+#include "core/io/json.h"
+#include "core/object/message_queue.h"
+#include "core/os/memory.h"
+#include "core/os/os.h"
+#include "editor/ai/ai_tool_cache.h"
+#include "editor/docks/ai_chat_dock.h"
+#include "scene/gui/text_edit.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/timer.h"
+#include "scene/main/window.h"
+
+#include "tests/test_macros.h"
+#include "tests/test_utils.h"
+
+// Drives a real AIChatDock from the tests, through the same entry points the
+// UI and the connection pool use.
+class TestAIChatDockAccessor {
+public:
+	using ChatMessage = AIChatDock::ChatMessage;
+
+	// Saves go to `p_root` instead of the project's conversations, starting empty.
+	static void use_conversation_store(AIChatDock *p_dock, const String &p_root) {
+		if (p_dock->save_thread_busy) {
+			p_dock->_on_background_save_finished();
+		}
+		p_dock->save_pending = false;
+		p_dock->conversation_store.set_root(p_root);
+		p_dock->conversation_store.clear();
+		p_dock->conversations.clear();
+		p_dock->current_conversation_index = -1;
+	}
+	static void create_conversation(AIChatDock *p_dock) {
+		p_dock->_create_new_conversation_instant();
+	}
+	static void send_message(AIChatDock *p_dock, const String &p_text) {
+		p_dock->input_field->set_text(p_text);
+		p_dock->_on_send_button_pressed();
+	}
+	// True once the exchange is over: no request in flight or about to be
+	// sent, and no tool still running.
+	static bool is_idle(const AIChatDock *p_dock) {
+		return !p_dock->is_waiting_for_response && p_dock->chat_request == HTTPConnectionPool::INVALID_REQUEST_ID && p_dock->pending_tool_tasks == 0 && p_dock->_chunked_messages.is_empty();
+	}
+	// What the delayed save timer does, on this thread. Only the messages
+	// changed since the last save are written.
+	static void save(AIChatDock *p_dock) {
+		p_dock->save_pending = false;
+		if (p_dock->save_timer) {
+			p_dock->save_timer->stop();
+		}
+		p_dock->_save_conversations();
+	}
+	static Vector<ChatMessage> get_history(AIChatDock *p_dock) {
+		return p_dock->_get_current_chat_history();
+	}
+	static String get_conversation_id(AIChatDock *p_dock) {
+		return p_dock->conversations[p_dock->current_conversation_index].id;
+	}
+	static AIConversationStore &get_conversation_store(AIChatDock *p_dock) {
+		return p_dock->conversation_store;
+	}
+};
+
+// Sends chat messages from a real AIChatDock to `backend/mock_backend.py`,
+// which replays recorded /chat streams over HTTP, and reports where the
+// editor spends its time. Skipped by default; run it with:
+//
+//     godot --test --test-case="*[AIChat][Benchmark]*" --no-skip
+//
+// The mock is started with `python3` unless GODOT_AI_CHAT_BENCHMARK_URL
+// points at a running one (its /chat URL). Set GODOT_AI_CHAT_BENCHMARK_REPORT
+// to a file path to also write the report as JSON, for tracking the numbers
+// per commit.
+namespace TestAIChatBenchmark {
+
+static constexpr int MOCK_PORT = 8765; // Away from the dev backend's 8000.
+static constexpr uint64_t FRAME_BUDGET_USEC = 16667;
+static constexpr uint64_t FRAME_SLEEP_USEC = 1000;
+static constexpr uint64_t EXCHANGE_TIMEOUT_USEC = 30000000;
+static constexpr int ITERATIONS = 20;
+
+struct StageStats {
+	uint64_t total_usec = 0;
+	uint64_t max_usec = 0;
+	uint64_t calls = 0;
+	int64_t memory_delta = 0;
+
+	void add(uint64_t p_usec) {
+		total_usec += p_usec;
+		max_usec = MAX(max_usec, p_usec);
+		calls++;
+	}
+
+	Dictionary to_dict() const {
+		Dictionary entry;
+		entry["total_usec"] = total_usec;
+		entry["mean_usec"] = calls ? double(total_usec) / calls : 0.0;
+		entry["max_usec"] = max_usec;
+		entry["calls"] = calls;
+		return entry;
+	}
+};
+
+// The dock handles a body chunk in one call (decoding, parsing, markdown and
+// inline tool dispatch), so the stream is measured per frame, as the
+// connection pool delivers chunks through the message queue.
+enum Stage {
+	STAGE_SEND, // Send button: user bubble, then the request is built on later frames.
+	STAGE_FRAME, // Message queue flush: chunks, tools, request packing, scrolling.
+	STAGE_SAVE, // Incremental save of the conversation.
+	STAGE_MAX,
+};
+
+static const char *stage_names[STAGE_MAX] = { "send", "frame", "save" };
+
+struct Benchmark {
+	StageStats stages[STAGE_MAX];
+	StageStats exchanges; // Send until idle, including the mock's pacing.
+	uint64_t hitches = 0;
+	uint64_t peak_memory = 0;
+
+	struct Scope {
+		Benchmark *benchmark;
+		Stage stage;
+		uint64_t start_usec;
+		uint64_t start_memory;
+
+		Scope(Benchmark *p_benchmark, Stage p_stage) :
+				benchmark(p_benchmark), stage(p_stage), start_usec(OS::get_singleton()->get_ticks_usec()), start_memory(Memory::get_mem_usage()) {}
+		~Scope() {
+			const uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - start_usec;
+			StageStats &stats = benchmark->stages[stage];
+			stats.add(elapsed);
+			stats.memory_delta += int64_t(Memory::get_mem_usage()) - int64_t(start_memory);
+			// Each stage runs in a frame of its own.
+			if (elapsed > FRAME_BUDGET_USEC) {
+				benchmark->hitches++;
+			}
+			benchmark->peak_memory = MAX(benchmark->peak_memory, Memory::get_mem_usage());
+		}
+	};
+
+	Dictionary to_dict() const {
+		Dictionary report;
+		Dictionary stage_report;
+		for (int i = 0; i < STAGE_MAX; i++) {
+			Dictionary entry = stages[i].to_dict();
+			// Only tracked by builds with DEBUG_ENABLED.
+			entry["memory_delta"] = stages[i].memory_delta;
+			stage_report[stage_names[i]] = entry;
+		}
+		report["iterations"] = ITERATIONS;
+		report["stages"] = stage_report;
+		report["exchanges"] = exchanges.to_dict();
+		report["hitches"] = hitches;
+		report["peak_memory"] = peak_memory;
+		return report;
+	}
+};
+
+// What the dock should end up with, read from the recording.
+struct Recording {
+	int turns = 0;
+	int tool_results = 0; // Tools the editor ran, plus those the backend ran.
+	String answer; // Streamed by the last turn.
+};
+
+static Recording load_recording(const String &p_dir) {
+	Recording recording;
+	Ref<DirAccess> dir = DirAccess::open(p_dir);
+	if (dir.is_null()) {
+		return recording;
+	}
+	PackedStringArray files = dir->get_files();
+	files.sort();
+	for (const String &file : files) {
+		if (file.get_extension() != "ndjson") {
+			continue;
+		}
+		recording.turns++;
+		recording.answer = String();
+		const PackedStringArray lines = FileAccess::get_file_as_string(p_dir.path_join(file)).split("\n", false);
+		for (const String &line : lines) {
+			const Dictionary data = JSON::parse_string(line);
+			const String status = data.get("status", "");
+			if (status == "executing_tools") {
+				const Dictionary assistant_message = data.get("assistant_message", Dictionary());
+				recording.tool_results += Array(assistant_message.get("tool_calls", Array())).size();
+			} else if (status == "tool_completed") {
+				recording.tool_results++;
+			} else if (data.has("content_delta")) {
+				recording.answer += String(data["content_delta"]);
+			}
+		}
+	}
+	return recording;
+}
+
+// Returns the /chat URL to send to, or an empty string if the mock couldn't be started.
+static String start_mock_backend(OS::ProcessID &r_pid) {
+	r_pid = 0;
+	const String url = OS::get_singleton()->get_environment("GODOT_AI_CHAT_BENCHMARK_URL");
+	if (!url.is_empty()) {
+		return url;
+	}
+
+	List<String> args;
+	args.push_back(TestUtils::get_executable_dir().path_join("../backend/mock_backend.py"));
+	args.push_back("--session");
+	args.push_back(TestUtils::get_data_path("ai_chat/tool_round_trip"));
+	args.push_back("--port");
+	args.push_back(itos(MOCK_PORT));
+	args.push_back("--quiet");
+	if (OS::get_singleton()->create_process("python3", args, &r_pid) != OK) {
+		return String();
+	}
+
+	HTTPConnectionPool::Request health;
+	health.url = vformat("http://127.0.0.1:%d/health", MOCK_PORT);
+	health.timeout = 1.0;
+	for (int attempt = 0; attempt < 50; attempt++) {
+		HTTPConnectionPool::Response response;
+		if (HTTPConnectionPool::get_singleton()->request_blocking(health, response) == OK && response.code == 200) {
+			return vformat("http://127.0.0.1:%d/chat", MOCK_PORT);
+		}
+		OS::get_singleton()->delay_usec(100000);
+	}
+	OS::get_singleton()->kill(r_pid);
+	r_pid = 0;
+	return String();
+}
+
+// Runs frames until the dock is done with the exchange.
+static bool run_exchange(Benchmark &r_benchmark, AIChatDock *p_dock, const String &p_message) {
+	const uint64_t start_usec = OS::get_singleton()->get_ticks_usec();
+	{
+		Benchmark::Scope scope(&r_benchmark, STAGE_SEND);
+		TestAIChatDockAccessor::send_message(p_dock, p_message);
+	}
+	while (OS::get_singleton()->get_ticks_usec() - start_usec < EXCHANGE_TIMEOUT_USEC) {
+		OS::get_singleton()->delay_usec(FRAME_SLEEP_USEC);
+		{
+			Benchmark::Scope scope(&r_benchmark, STAGE_FRAME);
+			MessageQueue::get_singleton()->flush();
+		}
+		if (TestAIChatDockAccessor::is_idle(p_dock)) {
+			r_benchmark.exchanges.add(OS::get_singleton()->get_ticks_usec() - start_usec);
+			return true;
+		}
+	}
+	return false;
+}
+
+TEST_CASE("[Editor][AIChat][Benchmark] Replay a recorded tool round-trip" * doctest::skip()) {
+	const Recording recording = load_recording(TestUtils::get_data_path("ai_chat/tool_round_trip"));
+	REQUIRE_MESSAGE(recording.turns == 2, "The recorded session should have a tool-call turn and an answer turn.");
+
+	OS::ProcessID mock_pid = 0;
+	const String url = start_mock_backend(mock_pid);
+	REQUIRE_MESSAGE(!url.is_empty(), "The mock backend should be reachable (is python3 installed?).");
+
+	AIChatDock *dock = memnew(AIChatDock);
+	SceneTree::get_singleton()->get_root()->add_child(dock);
+	// Entering the tree resolves the endpoint from the environment.
+	dock->set_api_endpoint(url);
+	TestAIChatDockAccessor::use_conversation_store(dock, TestUtils::get_temp_path("ai_chat_benchmark"));
+
+	Benchmark benchmark;
+	int tool_results = 0;
+	int unknown_tools = 0;
+	int answers = 0;
+	int saved_conversations = 0;
+	for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+		TestAIChatDockAccessor::create_conversation(dock);
+		REQUIRE_MESSAGE(run_exchange(benchmark, dock, "Make the player movement frame rate independent."), "The exchange should finish.");
+		{
+			Benchmark::Scope scope(&benchmark, STAGE_SAVE);
+			TestAIChatDockAccessor::save(dock);
+		}
+
+		const Vector<TestAIChatDockAccessor::ChatMessage> history = TestAIChatDockAccessor::get_history(dock);
+		for (const TestAIChatDockAccessor::ChatMessage &message : history) {
+			if (message.role != "tool") {
+				continue;
+			}
+			tool_results++;
+			const Dictionary result = message.tool_results.is_empty() ? Dictionary() : Dictionary(message.tool_results[0]);
+			if (String(result.get("message", "")).begins_with("Unknown tool")) {
+				unknown_tools++;
+			}
+		}
+		if (!history.is_empty() && history[history.size() - 1].role == "assistant" && history[history.size() - 1].content == recording.answer) {
+			answers++;
+		}
+
+		Array saved;
+		TestAIChatDockAccessor::get_conversation_store(dock).load_messages(TestAIChatDockAccessor::get_conversation_id(dock), saved);
+		if (saved.size() == history.size()) {
+			saved_conversations++;
+		}
+	}
+
+	CHECK_MESSAGE(answers == ITERATIONS, "Every exchange should end with the recorded answer, streamed in full.");
+	CHECK(tool_results == recording.tool_results * ITERATIONS);
+	CHECK(unknown_tools == 0);
+	CHECK_MESSAGE(saved_conversations == ITERATIONS, "Every conversation should be saved in full.");
+
+	SceneTree::get_singleton()->get_root()->remove_child(dock);
+	TestAIChatDockAccessor::get_conversation_store(dock).clear();
+	memdelete(dock);
+	AIToolCache::clear();
+	HTTPConnectionPool::get_singleton()->close_idle_connections();
+	if (mock_pid != 0) {
+		OS::get_singleton()->kill(mock_pid);
+	}
+
+	const Dictionary report = benchmark.to_dict();
+	const String report_json = JSON::stringify(report, "\t", false);
+	MESSAGE(report_json.utf8().get_data());
+
+	const String report_path = OS::get_singleton()->get_environment("GODOT_AI_CHAT_BENCHMARK_REPORT");
+	if (!report_path.is_empty()) {
+		Ref<FileAccess> file = FileAccess::open(report_path, FileAccess::WRITE);
+		REQUIRE(file.is_valid());
+		file->store_string(report_json);
+	}
+}
+
+} // namespace TestAIChatBenchmark
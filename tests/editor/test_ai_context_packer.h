@@ -0,0 +1,107 @@
+/**************************************************************************/
+/*  test_ai_context_packer.h                                              */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+
+#pragma once
+
+#include "editor/docks/ai_context_packer.h"
+
+#include "tests/test_macros.h"
+
+namespace TestAIContextPacker {
+
+static Dictionary make_message(const String &p_role, const Variant &p_content) {
+	Dictionary message;
+	message["role"] = p_role;
+	message["content"] = p_content;
+	return message;
+}
+
+TEST_CASE("[AIContextPacker] Packing leaves the input messages unchanged") {
+	Array parts;
+	Dictionary text_part;
+	text_part["type"] = "text";
+	text_part["text"] = "What does this script do?";
+	parts.push_back(text_part);
+
+	Dictionary file;
+	file["name"] = "player.gd";
+	file["path"] = "res://player.gd";
+	file["content"] = "extends CharacterBody2D";
+	Dictionary user_message = make_message("user", parts);
+	user_message["attached_files"] = Array({ file });
+
+	Array messages;
+	messages.push_back(user_message);
+	const int hash_before = messages.hash();
+
+	AIContextPacker packer;
+	const Array packed = packer.pack(messages);
+	CHECK(messages.hash() == hash_before);
+	CHECK(parts.size() == 1);
+	CHECK(Array(Dictionary(packed[0])["content"]).size() == 2);
+}
+
+TEST_CASE("[AIContextPacker] Tool results and attachments count toward the budget") {
+	const Dictionary plain = make_message("tool", "done");
+	Dictionary with_results = plain.duplicate();
+	Dictionary tool_result;
+	tool_result["output"] = String("x").repeat(4000);
+	with_results["tool_results"] = Array({ tool_result });
+	CHECK(AIContextPacker::estimate_message_tokens(with_results) >= AIContextPacker::estimate_message_tokens(plain) + 1000);
+
+	Dictionary with_image = make_message("user", "Look at this");
+	Dictionary image;
+	image["is_image"] = true;
+	image["base64_data"] = String("A").repeat(40000);
+	with_image["attached_files"] = Array({ image });
+	const int image_tokens = AIContextPacker::estimate_message_tokens(with_image) - AIContextPacker::estimate_message_tokens(make_message("user", "Look at this"));
+	CHECK_MESSAGE(image_tokens > 0, "Images should be counted.");
+	CHECK_MESSAGE(image_tokens < 10000, "Images should be counted per image, not per base64 character.");
+}
+
+TEST_CASE("[AIContextPacker] Leading system messages are never summarized") {
+	Array messages;
+	messages.push_back(make_message("system", "You are a Godot assistant."));
+	const String long_text = String("Lorem ipsum dolor sit amet. ").repeat(400);
+	for (int i = 0; i < 6; i++) {
+		messages.push_back(make_message("user", long_text));
+		messages.push_back(make_message("assistant", long_text));
+	}
+
+	AIContextPacker packer;
+	packer.set_token_budget(8000);
+	const Array packed = packer.pack(messages);
+	REQUIRE(packer.get_last_stats().summarized_messages > 0);
+	CHECK(Dictionary(packed[0])["content"] == "You are a Godot assistant.");
+	CHECK(String(Dictionary(packed[1])["content"]).begins_with("Summary of the earlier conversation"));
+}
+
+} // namespace TestAIContextPacker
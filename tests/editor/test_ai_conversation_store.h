@@ -0,0 +1,96 @@
+/**************************************************************************/
+/*  test_ai_conversation_store.h                                          */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/io/file_access.h"
+#include "editor/docks/ai_conversation_store.h"
+
+#include "tests/test_macros.h"
+#include "tests/test_utils.h"
+
+namespace TestAIConversationStore {
+
+static Array make_messages(int p_from, int p_count) {
+	Array messages;
+	for (int i = p_from; i < p_from + p_count; i++) {
+		Dictionary message;
+		message["role"] = i % 2 == 0 ? "user" : "assistant";
+		message["content"] = vformat("Message %d", i);
+		messages.push_back(message);
+	}
+	return messages;
+}
+
+TEST_CASE("[AIConversationStore] Records after a torn record are replayed") {
+	const String root = TestUtils::get_temp_path("ai_conversation_store");
+	AIConversationStore store;
+	store.set_root(root);
+	store.clear();
+
+	REQUIRE(store.append("torn", 0, make_messages(0, 3)) == OK);
+	{
+		// What an interrupted write leaves behind.
+		Ref<FileAccess> file = FileAccess::open(root.path_join("logs/torn.log"), FileAccess::READ_WRITE);
+		REQUIRE(file.is_valid());
+		file->seek_end();
+		file->store_string("{\"at\":3,\"messages\":[{\"role\":\"us");
+	}
+	REQUIRE(store.append("torn", 3, make_messages(3, 2)) == OK);
+
+	AIConversationStore reloaded;
+	reloaded.set_root(root);
+	Array messages;
+	REQUIRE(reloaded.load_messages("torn", messages) == OK);
+	REQUIRE(messages.size() == 5);
+	CHECK(Dictionary(messages[4])["content"] == "Message 4");
+
+	SUBCASE("Compaction keeps the records after a torn record") {
+		// Rewrite the last message until the journal is compacted.
+		for (int i = 0; i < 64; i++) {
+			Dictionary last;
+			last["role"] = "user";
+			last["content"] = vformat("Edit %d", i);
+			REQUIRE(reloaded.append("torn", 4, Array({ last })) == OK);
+		}
+
+		AIConversationStore compacted;
+		compacted.set_root(root);
+		REQUIRE(compacted.load_messages("torn", messages) == OK);
+		REQUIRE(messages.size() == 5);
+		CHECK(Dictionary(messages[3])["content"] == "Message 3");
+		CHECK(Dictionary(messages[4])["content"] == "Edit 63");
+		CHECK_MESSAGE(FileAccess::get_file_as_string(root.path_join("logs/torn.log")).count("\n") < 64, "The journal should have been compacted.");
+	}
+
+	store.clear();
+}
+
+} // namespace TestAIConversationStore
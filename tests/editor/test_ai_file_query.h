@@ -0,0 +1,103 @@
+/**************************************************************************/
+/*  test_ai_file_query.h                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "editor/ai/ai_file_query.h"
+
+#include "tests/test_macros.h"
+#include "tests/test_utils.h"
+
+namespace TestAIFileQuery {
+
+TEST_CASE("[AIFileQuery] Content search pages start at the first matching files") {
+	const String root = TestUtils::get_temp_path("ai_file_query");
+	Ref<DirAccess> dir = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	if (dir->dir_exists(root)) {
+		dir->change_dir(root);
+		dir->erase_contents_recursive();
+	}
+	REQUIRE(DirAccess::make_dir_recursive_absolute(root) == OK);
+
+	// Enough candidates to be split across workers, every seventh without
+	// the needle.
+	constexpr int FILE_COUNT = 400;
+	Vector<String> matching;
+	for (int i = 0; i < FILE_COUNT; i++) {
+		const String path = root.path_join(vformat("file_%04d.txt", i));
+		Ref<FileAccess> file = FileAccess::open(path, FileAccess::WRITE);
+		REQUIRE(file.is_valid());
+		if (i % 7 == 3) {
+			file->store_string("nothing to see\n");
+		} else {
+			file->store_string(vformat("line one\nthe Needle %d\n", i));
+			matching.push_back(path);
+		}
+	}
+
+	AIFileQuery::Query query;
+	query.root = root;
+	query.content = "needle";
+	query.limit = 3;
+	for (int offset : { 0, 3, 10, 40 }) {
+		query.offset = offset;
+		// Files finish in any order, so repeat to catch early exits that
+		// drop earlier matches.
+		for (int attempt = 0; attempt < 20; attempt++) {
+			AIFileQuery::Result result;
+			String error;
+			REQUIRE(AIFileQuery::execute(query, result, error) == OK);
+			REQUIRE(result.entries.size() == 3);
+			for (int i = 0; i < 3; i++) {
+				CHECK_MESSAGE(result.entries[i].path == matching[offset + i], vformat("Offset %d, entry %d.", offset, i));
+				CHECK(result.entries[i].matches.size() == 1);
+			}
+			CHECK(result.has_more);
+			CHECK(result.total > offset + 3);
+		}
+	}
+
+	query.offset = matching.size() - 2;
+	AIFileQuery::Result last_page;
+	String error;
+	REQUIRE(AIFileQuery::execute(query, last_page, error) == OK);
+	REQUIRE(last_page.entries.size() == 2);
+	CHECK(last_page.entries[1].path == matching[matching.size() - 1]);
+	CHECK_FALSE(last_page.has_more);
+	CHECK_FALSE(last_page.total_is_lower_bound);
+	CHECK(last_page.total == matching.size());
+
+	dir->change_dir(root);
+	dir->erase_contents_recursive();
+}
+
+} // namespace TestAIFileQuery
@@ -47,6 +47,7 @@
 #include "tests/core/io/test_config_file.h"
 #include "tests/core/io/test_file_access.h"
 #include "tests/core/io/test_http_client.h"
+#include "tests/core/io/test_http_connection_pool.h"
 #include "tests/core/io/test_image.h"
 #include "tests/core/io/test_ip.h"
 #include "tests/core/io/test_json.h"
@@ -93,6 +94,7 @@
 #include "tests/core/string/test_fuzzy_search.h"
 #include "tests/core/string/test_node_path.h"
 #include "tests/core/string/test_string.h"
+#include "tests/core/string/test_string_name.h"
 #include "tests/core/string/test_translation.h"
 #include "tests/core/string/test_translation_server.h"
 #include "tests/core/templates/test_a_hash_map.h"
@@ -154,6 +156,13 @@
 #include "tests/servers/test_text_server.h"
 #include "tests/test_validate_testing.h"
 
+#ifdef TOOLS_ENABLED
+#include "tests/editor/test_ai_chat_benchmark.h"
+#include "tests/editor/test_ai_context_packer.h"
+#include "tests/editor/test_ai_conversation_store.h"
+#include "tests/editor/test_ai_file_query.h"
+#endif // TOOLS_ENABLED
+
 #ifndef ADVANCED_GUI_DISABLED
 #include "tests/scene/test_code_edit.h"
 #include "tests/scene/test_color_picker.h"